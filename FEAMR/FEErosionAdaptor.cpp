@@ -47,6 +47,7 @@ BEGIN_FECORE_CLASS(FEErosionAdaptor, FEMeshAdaptor)
 	ADD_PARAMETER(m_nsort, "sort");
 	ADD_PARAMETER(m_bremoveIslands, "remove_islands");
 	ADD_PARAMETER(m_erodeSurfaces, "erode_surfaces")->setEnums("no\0yes\0grow\0reconstruct\0");
+	ADD_PARAMETER(m_bcompact, "compact_data");
 
 	ADD_PROPERTY(m_criterion, "criterion");
 END_FECORE_CLASS();
@@ -60,6 +61,7 @@ FEErosionAdaptor::FEErosionAdaptor(FEModel* fem) : FEMeshAdaptor(fem)
 
 	m_criterion = nullptr;
 	m_bremoveIslands = false;
+	m_bcompact = true;
 }
 
 bool FEErosionAdaptor::Apply(int iteration)
@@ -127,6 +129,10 @@ bool FEErosionAdaptor::Apply(int iteration)
 	// remove any islands
 	if (m_bremoveIslands) RemoveIslands(topo);
 
+	// eroded elements are normally not activated again, so we can release most of their data
+	// (elements that are activated again get new data, see FEDomain::RestoreMaterialPointData)
+	if (m_bcompact) CompactErodedElementData();
+
 	// if any nodes were orphaned, we need to deactivate them as well
 	DeactivateOrphanedNodes();
 
@@ -230,6 +236,30 @@ void FEErosionAdaptor::RemoveIslands(FEMeshTopo& topo)
 	}
 }
 
+// The material point data of inactive elements is compacted, i.e. only the data of 
+// the first integration point is kept. This data is still used for output.
+void FEErosionAdaptor::CompactErodedElementData()
+{
+	FEMesh& mesh = GetFEModel()->GetMesh();
+	int ncompact = 0;
+	for (int i = 0; i < mesh.Domains(); ++i)
+	{
+		FEDomain& dom = mesh.Domain(i);
+		int NE = dom.Elements();
+#pragma omp parallel for reduction(+:ncompact)
+		for (int j = 0; j < NE; ++j)
+		{
+			FEElement& el = dom.ElementRef(j);
+			if ((el.isActive() == false) && (el.IsDataCompact() == false))
+			{
+				el.CompactData();
+				ncompact++;
+			}
+		}
+	}
+	if (ncompact > 0) feLog("\tReleased material point data of %d elements\n", ncompact);
+}
+
 void FEErosionAdaptor::DeactivateOrphanedNodes()
 {
 	FEModel& fem = *GetFEModel();
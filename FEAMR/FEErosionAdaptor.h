@@ -50,6 +50,7 @@ private:
 	void GrowErodedSurfaces(FEMeshTopo& topo);
 	void ReconstructSurfaces(FEMeshTopo& topo);
 	void UpdateLinearConstraints();
+	void CompactErodedElementData();
 
 private:
 	int		m_maxIters;			// max iterations per time step
@@ -57,6 +58,7 @@ private:
 	int		m_maxelem;			// the max nr of elements to erode per adaptation iteration
 	int		m_nsort;			// sort option (0 = none, 1 = smallest to largest, 2 = largest to smallest)
 	int		m_erodeSurfaces;	// option to erode surfaces
+	bool	m_bcompact;			// release material point data of eroded elements
 
 	FEMeshAdaptorCriterion* m_criterion;
 
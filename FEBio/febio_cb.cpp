@@ -30,6 +30,7 @@ SOFTWARE.*/
 #include "febio_cb.h"
 #include <FEBioLib/FEBioModel.h>
 #include <FEBioLib/version.h>
+#include <FECore/AsyncFileWriter.h>
 #include "console.h"
 #include "Interrupt.h"
 #include "breakpoint.h"
@@ -139,6 +140,9 @@ bool interrupt_cb(FEModel* pfem, unsigned int nwhen, void* pd)
 
 		std::cout << "User interruption\n";
 
+		// make sure the log and data files are up to date
+		AsyncFileWriter::FlushAll();
+
 		// get a pointer to the app
 		FEBioApp* app = FEBioApp::GetInstance();
 
@@ -185,6 +185,10 @@ bool FEFSIErosionVolumeRatio::Apply(int iteration)
             if (++nel > m_maxElems) break;
         }
         else {
+            // The material point data of eroded elements may have been released
+            // (see FEErosionAdaptor), so it has to be created again.
+            FEDomain* dom = dynamic_cast<FEDomain*>(pe->GetMeshPartition()); assert(dom);
+            if (dom) dom->RestoreMaterialPointData(*pe);
             pe->setActive();
         }
     }
@@ -36,6 +36,7 @@ SOFTWARE.*/
 #include <FECore/sys.h>
 #include "FEBioFluidSolutes.h"
 #include <FECore/FELinearSystem.h>
+#include <FECore/ScratchArena.h>
 
 #ifndef SQR
 #define SQR(x) ((x)*(x))
@@ -293,28 +294,31 @@ void FEFluidSolutesDomain3D::InternalForces(FEGlobalVector& R)
     int nsol = m_pMat->Solutes();
     int ndpn = 4+nsol;
     
-#pragma omp parallel for shared (NE)
-    for (int i=0; i<NE; ++i)
+#pragma omp parallel shared (NE)
     {
-        // element force vector
+        // element force vector and LM vector (reused for all elements of a thread)
         vector<double> fe;
         vector<int> lm;
-        
-        // get the element
-        FESolidElement& el = m_Elem[i];
-        
-        // get the element force vector and initialize it to zero
-        int ndof = ndpn*el.Nodes();
-        fe.assign(ndof, 0);
-        
-        // calculate internal force vector
-        ElementInternalForce(el, fe);
-        
-        // get the element's LM vector
-        UnpackLM(el, lm);
-        
-        // assemble element 'fe'-vector into global R vector
-        R.Assemble(el.m_node, lm, fe);
+
+#pragma omp for
+        for (int i=0; i<NE; ++i)
+        {
+            // get the element
+            FESolidElement& el = m_Elem[i];
+
+            // get the element force vector and initialize it to zero
+            int ndof = ndpn*el.Nodes();
+            fe.assign(ndof, 0);
+
+            // calculate internal force vector
+            ElementInternalForce(el, fe);
+
+            // get the element's LM vector
+            UnpackLM(el, lm);
+
+            // assemble element 'fe'-vector into global R vector
+            R.Assemble(el.m_node, lm, fe);
+        }
     }
 }
 
@@ -351,6 +355,8 @@ void FEFluidSolutesDomain3D::ElementInternalForce(FESolidElement& el, vector<dou
     // repeat for all integration points
     for (n=0; n<nint; ++n)
     {
+        ScratchScope scope;
+
         FEMaterialPoint& mp = *el.GetMaterialPoint(n);
         FEFluidMaterialPoint& pt = *(mp.ExtractData<FEFluidMaterialPoint>());
         FEFluidSolutesMaterialPoint& spt = *(mp.ExtractData<FEFluidSolutesMaterialPoint>());
@@ -373,7 +379,7 @@ void FEFluidSolutesDomain3D::ElementInternalForce(FESolidElement& el, vector<dou
         double penalty = m_pMat->m_penalty;
         
         // evaluate the chat
-        vector<double> chat(nsol,0);
+        ScratchArray<double> chat(nsol, 0.0);
         double phiwhat = 0;
         
         // chemical reactions
@@ -401,8 +407,8 @@ void FEFluidSolutesDomain3D::ElementInternalForce(FESolidElement& el, vector<dou
         
         double dms = m_pMat->m_diffMtmSupp;
         
-        vector<int> z(nsol);
-        vector<vec3d> jd(nsol);
+        ScratchArray<int> z(nsol);
+        ScratchArray<vec3d> jd(nsol);
         vec3d je(0,0,0);
         double osmc = m_pMat->GetOsmoticCoefficient()->OsmoticCoefficient(mp);
         for (int isol=0; isol<nsol; ++isol) {
@@ -412,8 +418,8 @@ void FEFluidSolutesDomain3D::ElementInternalForce(FESolidElement& el, vector<dou
             je += jd[isol]*z[isol];
         }
         
-        vector<double> dkdt(nsol,0);
-        vector<vec3d> gradk(nsol,vec3d(0,0,0));
+        ScratchArray<double> dkdt(nsol, 0.0);
+        ScratchArray<vec3d> gradk(nsol, vec3d(0,0,0));
         for (int isol=0; isol<nsol; ++isol)
         {
             dkdt[isol] = pt.m_efdot*spt.m_dkdJ[isol];
@@ -714,6 +720,8 @@ void FEFluidSolutesDomain3D::ElementStiffness(FESolidElement &el, matrix &ke)
     // calculate element stiffness matrix
     for (n=0; n<nint; ++n)
     {
+        ScratchScope scope;
+
         // calculate jacobian
         detJ = invjac0(el, Ji, n)*gw[n]*tp.alphaf;
         
@@ -747,11 +755,11 @@ void FEFluidSolutesDomain3D::ElementStiffness(FESolidElement &el, matrix &ke)
         double penalty = m_pMat->m_penalty;
         double osmc = m_pMat->GetOsmoticCoefficient()->OsmoticCoefficient(mp);
         double dodJ = m_pMat->GetOsmoticCoefficient()->Tangent_OsmoticCoefficient_Strain(mp);
-        vector<double> dodc(nsol);
-        vector<double> M(nsol);
-        vector<int> z(nsol);
-        vector<double> d0(nsol);
-        vector<vector<double>> d0c(nsol, vector<double>(nsol));
+        ScratchArray<double> dodc(nsol);
+        ScratchArray<double> M(nsol);
+        ScratchArray<int> z(nsol);
+        ScratchArray<double> d0(nsol);
+        ScratchMatrix<double> d0c(nsol, nsol);
         
         for (int isol=0; isol<nsol; ++isol) {
             // get the charge number
@@ -764,13 +772,13 @@ void FEFluidSolutesDomain3D::ElementStiffness(FESolidElement &el, matrix &ke)
         }
         
         //Get dk/dt (partial differential wrt time)
-        vector<double> dkdt(nsol,0);
-        vector<vec3d> gradk(nsol,vec3d(0,0,0));
-        vector<double> sum1(nsol,0);
-        vector<vec3d> sum2(nsol,vec3d(0,0,0));
-        vector<vec3d> sum3(nsol,vec3d(0,0,0));
+        ScratchArray<double> dkdt(nsol, 0.0);
+        ScratchArray<vec3d> gradk(nsol, vec3d(0,0,0));
+        ScratchArray<double> sum1(nsol, 0.0);
+        ScratchArray<vec3d> sum2(nsol, vec3d(0,0,0));
+        ScratchArray<vec3d> sum3(nsol, vec3d(0,0,0));
         vec3d ovJ(0,0,0);
-        vector<vec3d> ovc(nsol,vec3d(0,0,0));
+        ScratchArray<vec3d> ovc(nsol, vec3d(0,0,0));
         for (int isol=0; isol<nsol; ++isol)
         {
             dkdt[isol] = pt.m_efdot*spt.m_dkdJ[isol];
@@ -792,8 +800,8 @@ void FEFluidSolutesDomain3D::ElementStiffness(FESolidElement &el, matrix &ke)
         ovJ *= R*T*dms;
         
         // evaluate the chat
-        vector<double> vbardzdc(nsol, 0.0);
-        vector<vector<double>> dchatdc(nsol, vector<double>(nsol, 0.0));
+        ScratchArray<double> vbardzdc(nsol, 0.0);
+        ScratchMatrix<double> dchatdc(nsol, nsol, 0.0);
         
         // chemical reactions
         for (int isol = 0; isol < nsol; ++isol)
@@ -883,31 +891,35 @@ void FEFluidSolutesDomain3D::StiffnessMatrix(FELinearSystem& LS)
     // repeat over all solid elements
     int NE = (int)m_Elem.size();
     
-#pragma omp parallel for shared (NE)
-    for (int iel=0; iel<NE; ++iel)
+#pragma omp parallel shared (NE)
     {
-        FESolidElement& el = m_Elem[iel];
-        
-        // element stiffness matrix
-        FEElementMatrix ke(el);
-        
-        // create the element's stiffness matrix
-        int nsol = m_pMat->Solutes();
-        int ndpn = 4 + nsol;
-        int ndof = ndpn*el.Nodes();
-        ke.resize(ndof, ndof);
-        ke.zero();
-        
-        // calculate material stiffness
-        ElementStiffness(el, ke);
-        
-        // get the element's LM vector
+        // element stiffness matrix and LM vector (reused for all elements of a thread)
+        FEElementMatrix ke;
         vector<int> lm;
-        UnpackLM(el, lm);
-        ke.SetIndices(lm);
-        
-        // assemble element matrix in global stiffness matrix
-        LS.Assemble(ke);
+
+#pragma omp for
+        for (int iel=0; iel<NE; ++iel)
+        {
+            FESolidElement& el = m_Elem[iel];
+            ke.SetNodes(el.m_node);
+
+            // create the element's stiffness matrix
+            int nsol = m_pMat->Solutes();
+            int ndpn = 4 + nsol;
+            int ndof = ndpn*el.Nodes();
+            ke.resize(ndof, ndof);
+            ke.zero();
+
+            // calculate material stiffness
+            ElementStiffness(el, ke);
+
+            // get the element's LM vector
+            UnpackLM(el, lm);
+            ke.SetIndices(lm);
+
+            // assemble element matrix in global stiffness matrix
+            LS.Assemble(ke);
+        }
     }
 }
 
@@ -30,6 +30,7 @@ SOFTWARE.*/
 #include "FEBioModel.h"
 #include "FEBioPlot/FEBioPlotFile.h"
 #include "FEBioPlot/VTKPlotFile.h"
+#include "FEBioPlot/VTUPlotFile.h"
 #include "FEBioXML/FEBioImport.h"
 #include "FEBioXML/FERestartImport.h"
 #include <FECore/NodeDataRecord.h>
@@ -55,6 +56,7 @@ SOFTWARE.*/
 #include "FECore/log.h"
 #include "FECore/FECoreKernel.h"
 #include "FECore/DumpFile.h"
+#include <FECore/DumpArchive.h>
 #include "FECore/DOFS.h"
 #include <FECore/FEAnalysis.h>
 #include <NumCore/MatrixTools.h>
@@ -63,6 +65,7 @@ SOFTWARE.*/
 #include <FECore/FEMaterial.h>
 #include <FECore/FEPlotDataStore.h>
 #include <FECore/FETimeStepController.h>
+#include <FECore/ScratchArena.h>
 #include "febio.h"
 #include "version.h"
 #include <iostream>
@@ -719,7 +722,7 @@ void FEBioModel::DumpData(int nevent)
 	
 	if (bdump)
 	{
-		DumpFile ar(*this);
+		DumpArchive ar(*this);
 		if (ar.Create(m_sdump.c_str()) == false)
 		{
 			feLogWarning("Failed creating restart file (%s).\n", m_sdump.c_str());
@@ -727,7 +730,8 @@ void FEBioModel::DumpData(int nevent)
 		else
 		{
 			Serialize(ar);
-			feLogInfo("\nRestart point created. Archive name is %s.", m_sdump.c_str());
+			if (ar.Close()) feLogInfo("\nRestart point created. Archive name is %s.", m_sdump.c_str());
+			else feLogWarning("Failed writing restart file (%s).\n", m_sdump.c_str());
 		}
 	}
 }
@@ -1424,6 +1428,8 @@ void FEBioModel::SerializeIOData(DumpStream &ar)
 			m_plot = xplt;
 		}
 		else if (data.GetPlotFileType() == "vtk") m_plot = new VTKPlotFile(this);
+		else if (data.GetPlotFileType() == "vtu") m_plot = new VTUPlotFile(this, false);
+		else if (data.GetPlotFileType() == "pvtu") m_plot = new VTUPlotFile(this, true);
 
 		if (m_plot) m_plot->Serialize(ar);
 
@@ -1546,6 +1552,24 @@ bool FEBioModel::InitPlotFile()
 			SetPlotFilename(sz);
 		}
 	}
+	else if ((data.GetPlotFileType() == "vtu") || (data.GetPlotFileType() == "pvtu"))
+	{
+		VTUPlotFile* vtu = new VTUPlotFile(this, data.GetPlotFileType() == "pvtu");
+		m_plot = vtu;
+
+		// see if a valid plot file name is defined.
+		const std::string& splt = GetPlotFileName();
+		if (splt.empty())
+		{
+			// if not, we take the input file name and set the extension to .pvd
+			char sz[1024] = { 0 };
+			strcpy(sz, GetInputFileName().c_str());
+			char* ch = strrchr(sz, '.');
+			if (ch) *ch = 0;
+			strcat(sz, ".pvd");
+			SetPlotFilename(sz);
+		}
+	}
 	else return false;
 
 	return true;
@@ -1699,6 +1723,8 @@ bool FEBioModel::Reset()
 			FEPlotDataStore& data = GetPlotDataStore();
 			if      (data.GetPlotFileType() == "febio") m_plot = new FEBioPlotFile(this);
 			else if (data.GetPlotFileType() == "vtk"  ) m_plot = new VTKPlotFile(this);
+			else if (data.GetPlotFileType() == "vtu"  ) m_plot = new VTUPlotFile(this, false);
+			else if (data.GetPlotFileType() == "pvtu" ) m_plot = new VTUPlotFile(this, true);
 			hint = 0;
 		}
 
@@ -1819,6 +1845,17 @@ void FEBioModel::on_cb_solved()
 		Timer::time_str(linsol_time    , sztime); feLog("\t   time in linear solver ........ : %s (%lg sec)\n\n", sztime, linsol_time);
 		Timer::time_str(ti.total_time  , sztime); feLog("\tTotal elapsed time .............. : %s (%lg sec)\n\n", sztime, ti.total_time);
 
+		// scratch memory used by the element routines
+		ScratchArenaStats sa = ScratchArena::GetStats();
+		if (sa.nrequests > 0)
+		{
+			feLog(" S C R A T C H   M E M O R Y\n\n");
+			feLog("\tNumber of threads ............... : %d\n\n", (int)sa.narenas);
+			feLog("\tScratch allocations ............. : %.0lf\n\n", (double)sa.nrequests);
+			feLog("\tHeap allocations ................ : %d\n\n", (int)sa.nblocks);
+			feLog("\tPeak usage per thread ........... : %.1lf KB\n\n", sa.peak / 1024.0);
+		}
+
 		m_log.SetMode(old_mode);
 
 		bool bconv = IsSolved();
@@ -1922,14 +1959,29 @@ bool FEBioModel::Restart(const char* szfile)
 	else
 	{
 		// Open the dump file
-		DumpFile ar(*this);
-		if (ar.Open(szfile) == false)
+		if (DumpArchive::IsValidFile(szfile))
 		{
-			return false;
+			DumpArchive ar(*this);
+			if (ar.Open(szfile) == false)
+			{
+				return false;
+			}
+
+			// try reading the file
+			Serialize(ar);
 		}
+		else
+		{
+			// this is an older, uncompressed archive
+			DumpFile ar(*this);
+			if (ar.Open(szfile) == false)
+			{
+				return false;
+			}
 
-		// try reading the file
-		Serialize(ar);
+			// try reading the file
+			Serialize(ar);
+		}
 	}
 
 
@@ -29,6 +29,7 @@ SOFTWARE.*/
 #include <FECore/log.h>
 #include <FEBioXML/FERestartImport.h>
 #include <FECore/DumpFile.h>
+#include <FECore/DumpArchive.h>
 #include <FECore/FEAnalysis.h>
 #include "FEBioModelBuilder.h"
 
@@ -49,14 +50,21 @@ bool FEBioRestart::Init(const char* szfile)
 	{
 		// the file is binary so just read the dump file and return
 
-		// open the archive
-		DumpFile ar(fem);
-		if (ar.Open(szfile) == false) { fprintf(stderr, "FATAL ERROR: failed opening restart archive\n"); return false; }
+		// open the archive (older archives are not compressed)
+		DumpArchive car(fem);
+		DumpFile dar(fem);
+		DumpStream* par = nullptr;
+		if (DumpArchive::IsValidFile(szfile))
+		{
+			if (car.Open(szfile)) par = &car;
+		}
+		else if (dar.Open(szfile)) par = &dar;
+		if (par == nullptr) { fprintf(stderr, "FATAL ERROR: failed opening restart archive\n"); return false; }
 
 		// read the archive
 		try
 		{
-			fem.Serialize(ar);
+			fem.Serialize(*par);
 		}
 		catch (std::exception e)
 		{
@@ -32,7 +32,6 @@ SOFTWARE.*/
 //-----------------------------------------------------------------------------
 LogFileStream::LogFileStream()
 {
-	m_fp = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -44,44 +43,35 @@ LogFileStream::~LogFileStream()
 //-----------------------------------------------------------------------------
 void LogFileStream::close()
 {
-	if (m_fp) fclose(m_fp);
-	m_fp = 0;
+	m_file.close();
 }
 
 //-----------------------------------------------------------------------------
 void LogFileStream::flush()
 {
-	if (m_fp) fflush(m_fp);
+	m_file.flush();
 }
 
 //-----------------------------------------------------------------------------
 bool LogFileStream::open(const char* szfile)
 {
 	m_fileName = szfile;
-	if (m_fp) close();
-	m_fp = fopen(szfile, "wt");
-	return (m_fp != NULL);
+	return m_file.open(szfile, "wt");
 }
 
 //-----------------------------------------------------------------------------
 bool LogFileStream::append(const char* szfile)
 {
 	// make sure we don't have a log file already open
-	if (m_fp)
-	{
-		fseek(m_fp, SEEK_END, 0);
-		return true;
-	}
+	if (m_file.isOpen()) return true;
 
 	// create the log file
 	m_fileName = szfile;
-	m_fp = fopen(szfile, "a+t");
-
-	return (m_fp != NULL);
+	return m_file.open(szfile, "a+t");
 }
 
 //-----------------------------------------------------------------------------
 void LogFileStream::print(const char* sztxt)
 {
-	if (m_fp) fprintf(m_fp, "%s", sztxt);
+	m_file.print(sztxt);
 }
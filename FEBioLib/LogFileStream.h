@@ -28,6 +28,7 @@ SOFTWARE.*/
 
 #pragma once
 #include "LogStream.h"
+#include <FECore/AsyncFileWriter.h>
 #include "stdio.h"
 #include <string>
 
@@ -51,8 +52,8 @@ public:
 	// close the file stream
 	void close();
 
-	// get the file handle
-	FILE* GetFileHandle() { return m_fp; }
+	// get the file handle (flushes the stream first)
+	FILE* GetFileHandle() { return m_file.GetFileHandle(); }
 
 	// get the file name
 	const std::string& GetFileName() const { return m_fileName; }
@@ -65,6 +66,6 @@ public:
 	void flush();
 
 private:
-	FILE*		m_fp;
-	std::string	m_fileName;
+	AsyncFileWriter	m_file;	// output is written on a background thread
+	std::string		m_fileName;
 };
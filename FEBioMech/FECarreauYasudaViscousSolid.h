@@ -33,6 +33,9 @@ class FECarreauYasudaViscousSolid : public FEElasticMaterial
 {
 public:
     FECarreauYasudaViscousSolid(FEModel* pfem) : FEElasticMaterial(pfem) {}
+
+    //! the response depends on the deformation history
+    bool IsPathDependent() const override { return true; }
     
 public:
     FEParamDouble   m_mu0;  //!< shear viscosity at zero shear rate
@@ -38,6 +38,9 @@ class FECarterHayesOld : public FEElasticMaterial, public FERemodelingInterface
 {
 public:
 	FECarterHayesOld(FEModel* pfem) : FEElasticMaterial(pfem) {}
+
+	//! the response depends on the deformation history
+	bool IsPathDependent() const override { return true; }
 	
 public:
 	double	m_c;	//!< c coefficient for calculation of Young's modulus
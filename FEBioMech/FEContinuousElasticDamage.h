@@ -40,6 +40,9 @@ class FEDamageElasticFiber : public FEElasticFiberMaterial
 public:
 	FEDamageElasticFiber(FEModel* fem);
 
+	//! the response depends on the deformation history
+	bool IsPathDependent() const override { return true; }
+
 	double Damage(FEMaterialPoint& mp);
 	double Damage(FEMaterialPoint& mp, int n);
 
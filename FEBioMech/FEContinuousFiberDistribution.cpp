@@ -28,6 +28,7 @@ SOFTWARE.*/
 
 #include "stdafx.h"
 #include "FEContinuousFiberDistribution.h"
+#include <atomic>
 
 BEGIN_FECORE_CLASS(FEContinuousFiberDistribution, FEElasticMaterial)
 
@@ -46,6 +47,10 @@ FEContinuousFiberDistribution::FEContinuousFiberDistribution(FEModel* pfem) : FE
 	m_pFmat = 0;
 	m_pFDD = 0;
 	m_pFint = 0;
+
+	m_bconstScheme = false;
+	m_bconstFDD = false;
+	m_tableID = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -59,12 +64,72 @@ FEMaterialPointData* FEContinuousFiberDistribution::CreateMaterialPointData()
     return mp;
 }
 
+//-----------------------------------------------------------------------------
+namespace {
+	// Integrated fiber density and normalized weights of a fiber density that doesn't
+	// depend on the material point. The table stores the density parameters it was
+	// evaluated with and is re-evaluated when those change (e.g. when a parameter is
+	// perturbed by a sensitivity analysis or set by an optimization).
+	struct DensityTable
+	{
+		int					id;		// table ID of the material
+		std::vector<double>	param;	// density parameters
+		double				IFD;	// integrated fiber density
+		std::vector<double>	wn;		// normalized weights R*w/IFD
+	};
+
+	// Scratch buffers for the fiber directions and weights, and the density tables.
+	// These are per thread and keep their capacity, so evaluating a material point
+	// does not allocate.
+	struct CFDBuffers
+	{
+		std::vector<vec3d>	a0;
+		std::vector<double>	w;
+		std::vector<double>	param;
+		std::vector<DensityTable>	tab;
+	};
+
+	CFDBuffers& ThreadBuffers()
+	{
+		static thread_local CFDBuffers buf;
+		return buf;
+	}
+
+	// IDs for the density tables. A new ID is assigned each time a material is initialized.
+	std::atomic<int> nextTableID(1);
+}
+
 //-----------------------------------------------------------------------------
 bool FEContinuousFiberDistribution::Init()
 {
     // initialize base class
 	if (FEElasticMaterial::Init() == false) return false;
 
+	// If the fiber density does not depend on the material point, the integrated
+	// fiber density and the normalized weights are tabulated (see FiberDirections).
+	m_bconstFDD = m_pFDD->IsConstant();
+	m_tableID = nextTableID++;
+
+	// If the integration points don't depend on the material point, tabulate them,
+	// so we don't need to create an iterator at every evaluation.
+	m_fiber.clear();
+	m_w.clear();
+	m_bconstScheme = m_pFint->IsConstant();
+	if (m_bconstScheme)
+	{
+		FEFiberIntegrationSchemeIterator* it = m_pFint->GetIterator(nullptr);
+		if (it->IsValid())
+		{
+			do
+			{
+				m_fiber.push_back(it->m_fiber);
+				m_w.push_back(it->m_weight);
+			}
+			while (it->Next());
+		}
+		delete it;
+	}
+
 	return true;
 }
 
@@ -77,19 +142,73 @@ void FEContinuousFiberDistribution::Serialize(DumpStream& ar)
 }
 
 //-----------------------------------------------------------------------------
-//! calculate stress at material point
-mat3ds FEContinuousFiberDistribution::Stress(FEMaterialPoint& mp)
-{ 
-	FEElasticMaterialPoint& pt = *mp.ExtractData<FEElasticMaterialPoint>();
-    FEFiberMaterialPoint& fp = *mp.ExtractData<FEFiberMaterialPoint>();
-
-	// calculate stress
-	mat3ds s; s.zero();
+int FEContinuousFiberDistribution::FiberDirections(FEMaterialPoint& mp, std::vector<vec3d>& a0, std::vector<double>& w)
+{
+	FEFiberMaterialPoint& fp = *mp.ExtractData<FEFiberMaterialPoint>();
 
 	// get the local coordinate system
 	mat3d Q = GetLocalCS(mp);
-    
-    double IFD = IntegratedFiberDensity(mp);
+
+	a0.clear();
+	w.clear();
+
+	// Get this thread's density table, if the density doesn't depend on the material point.
+	const DensityTable* tab = nullptr;
+	if (m_bconstFDD)
+	{
+		CFDBuffers& buf = ThreadBuffers();
+		m_pFDD->GetParameterValues(buf.param);
+
+		DensityTable* t = nullptr;
+		for (DensityTable& ti : buf.tab)
+		{
+			if (ti.id == m_tableID) { t = &ti; break; }
+		}
+
+		if ((t == nullptr) || (t->param != buf.param))
+		{
+			if (t == nullptr)
+			{
+				// tables of materials that were re-initialized or deleted are never
+				// looked up again, so just start over when there are too many.
+				if (buf.tab.size() >= 64) buf.tab.clear();
+				buf.tab.push_back(DensityTable());
+				t = &buf.tab.back();
+				t->id = m_tableID;
+			}
+			t->param = buf.param;
+			EvaluateDensityTable(t->IFD, t->wn);
+		}
+		tab = t;
+	}
+
+	if (m_bconstScheme)
+	{
+		int n = (int)m_fiber.size();
+		a0.resize(n);
+		w.resize(n);
+		for (int i = 0; i < n; ++i) a0[i] = fp.FiberPreStretch(Q*m_fiber[i]);
+
+		if (tab)
+		{
+			for (int i = 0; i < n; ++i) w[i] = tab->wn[i];
+		}
+		else
+		{
+			// the integrated fiber density uses the same integration points
+			double IFD = 0.0;
+			for (int i = 0; i < n; ++i)
+			{
+				w[i] = m_pFDD->FiberDensity(mp, m_fiber[i])*m_w[i];
+				IFD += w[i];
+			}
+			if (IFD == 0.0) IFD = 1.0;
+			for (int i = 0; i < n; ++i) w[i] /= IFD;
+		}
+		return n;
+	}
+
+	double IFD = (tab ? tab->IFD : IntegratedFiberDensity(mp));
 
 	// obtain an integration point iterator
 	FEFiberIntegrationSchemeIterator* it = m_pFint->GetIterator(&mp);
@@ -102,13 +221,10 @@ mat3ds FEContinuousFiberDistribution::Stress(FEMaterialPoint& mp)
 
 			// evaluate ellipsoidally distributed material coefficients
 			double R = m_pFDD->FiberDensity(mp, N);
-            
-            // convert fiber to global coordinates
-            vec3d n0 = Q*N;
-            
-			// calculate the stress
-			double wn = it->m_weight;
-			s += m_pFmat->FiberStress(mp, fp.FiberPreStretch(n0))*(R*wn);
+
+			// convert fiber to global coordinates
+			a0.push_back(fp.FiberPreStretch(Q*N));
+			w.push_back(R*it->m_weight / IFD);
 		}
 		while (it->Next());
 	}
@@ -116,92 +232,50 @@ mat3ds FEContinuousFiberDistribution::Stress(FEMaterialPoint& mp)
 	// don't forget to delete the iterator
 	delete it;
 
-	// divide by IFD
-	return s / IFD;
+	return (int)a0.size();
 }
 
 //-----------------------------------------------------------------------------
-//! calculate tangent stiffness at material point
-tens4ds FEContinuousFiberDistribution::Tangent(FEMaterialPoint& mp)
+void FEContinuousFiberDistribution::EvaluateDensityTable(double& IFD, std::vector<double>& wn)
 {
-	FEElasticMaterialPoint& pt = *mp.ExtractData<FEElasticMaterialPoint>();
-    FEFiberMaterialPoint& fp = *mp.ExtractData<FEFiberMaterialPoint>();
+	// The density functions ignore the material point in this case.
+	FEMaterialPoint mp;
+	IFD = IntegratedFiberDensity(mp);
 
-	// get the local coordinate system
-	mat3d Q = GetLocalCS(mp);
-    
-    double IFD = IntegratedFiberDensity(mp);
-
-	// initialize stress tensor
-	tens4ds c;
-	c.zero();
-
-	FEFiberIntegrationSchemeIterator* it = m_pFint->GetIterator(&mp);
-	if (it->IsValid())
+	wn.clear();
+	if (m_bconstScheme)
 	{
-		do
-		{
-            // get the fiber direction for that fiber distribution
-            vec3d& N = it->m_fiber;
-            
-            // evaluate ellipsoidally distributed material coefficients
-            double R = m_pFDD->FiberDensity(mp, N);
-            
-            // convert fiber to global coordinates
-            vec3d n0 = Q*N;
-
-			// calculate the tangent
-			c += m_pFmat->FiberTangent(mp, fp.FiberPreStretch(n0))*(R*it->m_weight);
-		}
-		while (it->Next());
+		wn.resize(m_fiber.size());
+		for (size_t i = 0; i < m_fiber.size(); ++i)
+			wn[i] = m_pFDD->FiberDensity(mp, m_fiber[i])*m_w[i] / IFD;
 	}
+}
 
-	// don't forget to delete the iterator
-	delete it;
-    
-	// divide by IFD
-	return c / IFD;
+//-----------------------------------------------------------------------------
+//! calculate stress at material point
+mat3ds FEContinuousFiberDistribution::Stress(FEMaterialPoint& mp)
+{ 
+	CFDBuffers& buf = ThreadBuffers();
+	int n = FiberDirections(mp, buf.a0, buf.w);
+	return m_pFmat->FiberStressSum(mp, buf.a0.data(), buf.w.data(), n);
+}
+
+//-----------------------------------------------------------------------------
+//! calculate tangent stiffness at material point
+tens4ds FEContinuousFiberDistribution::Tangent(FEMaterialPoint& mp)
+{
+	CFDBuffers& buf = ThreadBuffers();
+	int n = FiberDirections(mp, buf.a0, buf.w);
+	return m_pFmat->FiberTangentSum(mp, buf.a0.data(), buf.w.data(), n);
 }
 
 //-----------------------------------------------------------------------------
 //! calculate strain energy density at material point
-//double FEContinuousFiberDistribution::StrainEnergyDensity(FEMaterialPoint& pt) { return m_pFint->StrainEnergyDensity(pt); }
 double FEContinuousFiberDistribution::StrainEnergyDensity(FEMaterialPoint& mp)
 { 
-	FEElasticMaterialPoint& pt = *mp.ExtractData<FEElasticMaterialPoint>();
-    FEFiberMaterialPoint& fp = *mp.ExtractData<FEFiberMaterialPoint>();
-
-	// get the local coordinate system
-	mat3d Q = GetLocalCS(mp);
-    
-    double IFD = IntegratedFiberDensity(mp);
-
-	double sed = 0.0;
-	FEFiberIntegrationSchemeIterator* it = m_pFint->GetIterator(&mp);
-	if (it->IsValid())
-	{
-		do
-		{
-            // get the fiber direction for that fiber distribution
-            vec3d& N = it->m_fiber;
-            
-            // evaluate ellipsoidally distributed material coefficients
-            double R = m_pFDD->FiberDensity(mp, N);
-            
-            // convert fiber to global coordinates
-            vec3d n0 = Q*N;
-
-			// calculate the stress
-			sed += m_pFmat->FiberStrainEnergyDensity(mp, fp.FiberPreStretch(n0))*(R*it->m_weight);
-		}
-		while (it->Next());
-	}
-
-	// don't forget to delete the iterator
-	delete it;
-
-	// divide by IFD
-	return sed / IFD;
+	CFDBuffers& buf = ThreadBuffers();
+	int n = FiberDirections(mp, buf.a0, buf.w);
+	return m_pFmat->FiberStrainEnergyDensitySum(mp, buf.a0.data(), buf.w.data(), n);
 }
 
 //-----------------------------------------------------------------------------
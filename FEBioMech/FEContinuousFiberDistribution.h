@@ -32,6 +32,7 @@ SOFTWARE.*/
 #include "FEFiberDensityDistribution.h"
 #include "FEFiberIntegrationScheme.h"
 #include "FEFiberMaterialPoint.h"
+#include <vector>
 
 //  This material is a container for a fiber material, a fiber density
 //  distribution, and an integration scheme.
@@ -64,10 +65,27 @@ public:
 private:
 	double IntegratedFiberDensity(FEMaterialPoint& pt);
 
+	// Evaluate the (pre-stretched) global fiber directions and the normalized weights
+	// R*w/IFD at this material point. Returns the number of fibers.
+	int FiberDirections(FEMaterialPoint& mp, std::vector<vec3d>& a0, std::vector<double>& w);
+
+	// Evaluate the integrated fiber density and the normalized weights R*w/IFD for a
+	// fiber density that doesn't depend on the material point.
+	void EvaluateDensityTable(double& IFD, std::vector<double>& wn);
+
 protected:
 	FEFiberMaterial*			m_pFmat;    // pointer to fiber material
 	FEFiberDensityDistribution* m_pFDD;     // pointer to fiber density distribution
 	FEFiberIntegrationScheme*   m_pFint;    // pointer to fiber integration scheme
 
+private:
+	// Tabulated integration points. These are only used when the integration points
+	// don't depend on the material point (m_bconstScheme).
+	bool				m_bconstScheme;
+	bool				m_bconstFDD;	// fiber density does not depend on material point
+	std::vector<vec3d>	m_fiber;		// local fiber directions
+	std::vector<double>	m_w;			// integration weights
+	int					m_tableID;		// identifies the (per-thread) density tables of this material
+
 	DECLARE_FECORE_CLASS();
 };
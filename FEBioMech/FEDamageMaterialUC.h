@@ -39,6 +39,9 @@ class FEDamageMaterialUC : public FEUncoupledMaterial
 {
 public:
 	FEDamageMaterialUC(FEModel* pfem);
+
+	//! the response depends on the deformation history
+	bool IsPathDependent() const override { return true; }
     
 public:
 	//! calculate stress at material point
@@ -35,6 +35,9 @@ class FEDamageMooneyRivlin : public FEUncoupledMaterial
 public:
 	FEDamageMooneyRivlin(FEModel* pfem);
 
+	//! the response depends on the deformation history
+	bool IsPathDependent() const override { return true; }
+
 public:
 	double	c1;	//!< Mooney-Rivlin coefficient C1
 	double	c2;	//!< Mooney-Rivlin coefficient C2
@@ -40,6 +40,9 @@ class FEDamageNeoHookean : public FEElasticMaterial
 public:
 	FEDamageNeoHookean(FEModel* pfem);
 
+	//! the response depends on the deformation history
+	bool IsPathDependent() const override { return true; }
+
 public:
 	double	m_E;	//!< Young's modulus
 	double	m_v;	//!< Poisson's ratio
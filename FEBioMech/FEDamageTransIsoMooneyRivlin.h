@@ -65,6 +65,9 @@ class FEDamageTransIsoMooneyRivlin : public FEUncoupledMaterial
 public:
 	FEDamageTransIsoMooneyRivlin(FEModel* pfem);
 
+	//! the response depends on the deformation history
+	bool IsPathDependent() const override { return true; }
+
 public:
 	// Mooney-Rivlin parameters
 	double	m_c1;	//!< Mooney-Rivlin coefficient C1
@@ -105,6 +105,9 @@ class FEElasticMultigeneration : public FEElasticMaterial
 {
 public:
 	FEElasticMultigeneration(FEModel* pfem);
+
+	//! the response depends on the deformation history
+	bool IsPathDependent() const override { return true; }
 		
 	// returns a pointer to a new material point object
     FEMaterialPointData* CreateMaterialPointData() override;
@@ -577,6 +577,19 @@ void FEElasticSolidDomain::Update(const FETimeInfo& tp)
 //! Update element state data (mostly stresses, but some other stuff as well)
 //! \todo Remove the remodeling solid stuff
 void FEElasticSolidDomain::UpdateElementStress(int iel, const FETimeInfo& tp)
+{
+	// update the kinematics first
+	UpdateElementKinematics(iel, tp);
+
+	// loop over the integration points and calculate
+	// the stress at the integration point
+	FESolidElement& el = m_Elem[iel];
+	int nint = el.GaussPoints();
+	for (int n = 0; n < nint; ++n) UpdatePointStress(el, n, tp);
+}
+
+//-----------------------------------------------------------------------------
+void FEElasticSolidDomain::UpdateElementKinematics(int iel, const FETimeInfo& tp)
 {
     double dt =tp.timeIncrement;
     
@@ -605,8 +618,6 @@ void FEElasticSolidDomain::UpdateElementStress(int iel, const FETimeInfo& tp)
 		}
 	}
 
-	// loop over the integration points and calculate
-	// the stress at the integration point
 	for (int n=0; n<nint; ++n)
 	{
 		FEMaterialPoint& mp = *el.GetMaterialPoint(n);
@@ -642,33 +653,46 @@ void FEElasticSolidDomain::UpdateElementStress(int iel, const FETimeInfo& tp)
 
         // update specialized material points
         m_pMat->UpdateSpecializedMaterialPoints(mp, tp);
-        
-		// calculate the stress at this material point
-//		pt.m_s = m_pMat->Stress(mp);
-		pt.m_s = (m_secant_stress ? m_pMat->SecantStress(mp) : m_pMat->Stress(mp));
-        
-        // adjust stress for strain energy conservation
-		// (Apply only for mid-point rule)
-		if (m_alphaf == 0.5)
-		{
-			FEElasticMaterial* pme = dynamic_cast<FEElasticMaterial*>(m_pMat);
+    }
+}
 
-			// evaluate strain energy at current time
-			mat3d Ftmp = pt.m_F;
-			double Jtmp = pt.m_J;
-			pt.m_F = Ft;
-			pt.m_J = Jt;
-			pt.m_Wt = pme->StrainEnergyDensity(mp);
-			pt.m_F = Ftmp;
-			pt.m_J = Jtmp;
-
-            mat3ds D = pt.RateOfDeformation();
-            double D2 = D.dotdot(D);
-			if (D2 > std::numeric_limits<double>::epsilon())
-			{
-				pt.m_s += D * (((pt.m_Wt - pt.m_Wp) / (dt * pt.m_J) - pt.m_s.dotdot(D)) / D2);
-			}
-        }
+//-----------------------------------------------------------------------------
+void FEElasticSolidDomain::UpdatePointStress(FESolidElement& el, int n, const FETimeInfo& tp)
+{
+	double dt = tp.timeIncrement;
+
+	FEMaterialPoint& mp = *el.GetMaterialPoint(n);
+	FEElasticMaterialPoint& pt = *(mp.ExtractData<FEElasticMaterialPoint>());
+
+	// calculate the stress at this material point
+//	pt.m_s = m_pMat->Stress(mp);
+	pt.m_s = (m_secant_stress ? m_pMat->SecantStress(mp) : m_pMat->Stress(mp));
+
+    // adjust stress for strain energy conservation
+	// (Apply only for mid-point rule)
+	if (m_alphaf == 0.5)
+	{
+		FEElasticMaterial* pme = dynamic_cast<FEElasticMaterial*>(m_pMat);
+
+		// get the deformation gradient and determinant at current time
+		mat3d Ft;
+		double Jt = defgrad(el, Ft, n);
+
+		// evaluate strain energy at current time
+		mat3d Ftmp = pt.m_F;
+		double Jtmp = pt.m_J;
+		pt.m_F = Ft;
+		pt.m_J = Jt;
+		pt.m_Wt = pme->StrainEnergyDensity(mp);
+		pt.m_F = Ftmp;
+		pt.m_J = Jtmp;
+
+        mat3ds D = pt.RateOfDeformation();
+        double D2 = D.dotdot(D);
+		if (D2 > std::numeric_limits<double>::epsilon())
+		{
+			pt.m_s += D * (((pt.m_Wt - pt.m_Wp) / (dt * pt.m_J) - pt.m_s.dotdot(D)) / D2);
+		}
     }
 }
 
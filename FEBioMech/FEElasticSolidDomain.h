@@ -78,6 +78,18 @@ public: // overrides from FEElasticDomain
 	// update the element stress
 	virtual void UpdateElementStress(int iel, const FETimeInfo& tp);
 
+protected:
+	// These are the two parts of UpdateElementStress, which domains that evaluate
+	// the stresses separately (e.g. to balance the load) can call directly.
+
+	// update the kinematics of the element's integration points
+	void UpdateElementKinematics(int iel, const FETimeInfo& tp);
+
+	// update the stress at an integration point (after its kinematics are updated)
+	void UpdatePointStress(FESolidElement& el, int n, const FETimeInfo& tp);
+
+public:
+
 	//! intertial forces for dynamic problems
 	void InertialForces(FEGlobalVector& R, vector<double>& F) override;
 
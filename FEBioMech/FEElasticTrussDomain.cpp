@@ -162,8 +162,12 @@ void FEElasticTrussDomain::Activate()
 //-----------------------------------------------------------------------------
 void FEElasticTrussDomain::PreSolveUpdate(const FETimeInfo& timeInfo)
 {
-	ForEachMaterialPoint([&](FEMaterialPoint& mp) {
-		mp.Update(timeInfo);
+	ForEachElement([&](FEElement& el) {
+		if (el.isActive())
+		{
+			int ni = el.GaussPoints();
+			for (int j = 0; j < ni; ++j) el.GetMaterialPoint(j)->Update(timeInfo);
+		}
 	});
 }
 
@@ -28,11 +28,67 @@ SOFTWARE.*/
 
 #include "stdafx.h"
 #include "FEFiberDensityDistribution.h"
+#include <FECore/FEModel.h>
 
 #ifndef SQR
 #define SQR(x) ((x)*(x))
 #endif
 
+//-----------------------------------------------------------------------------
+// A parameter is constant if it isn't mapped or defined by an expression and
+// has no load controller attached.
+bool FEFiberDensityDistribution::IsConstantParameter(FEParamDouble& p)
+{
+	if (p.isConst() == false) return false;
+	FEParam* pp = FindParameterFromData(&p);
+	return ((pp != nullptr) && (GetFEModel()->GetLoadController(pp) == nullptr));
+}
+
+bool FEFiberDensityDistribution::IsConstantParameter(FEParamVec3& p)
+{
+	if (p.isConst() == false) return false;
+	FEParam* pp = FindParameterFromData(&p);
+	return ((pp != nullptr) && (GetFEModel()->GetLoadController(pp) == nullptr));
+}
+
+//-----------------------------------------------------------------------------
+void FEFiberDensityDistribution::GetParameterValues(std::vector<double>& v)
+{
+	v.clear();
+	FEParameterList& pl = GetParameterList();
+	FEParamIterator pi = pl.first();
+	for (int i = 0; i < pl.Parameters(); ++i, ++pi)
+	{
+		FEParam& p = *pi;
+		for (int j = 0; j < p.dim(); ++j)
+		{
+			switch (p.type())
+			{
+			case FE_PARAM_INT   : v.push_back((double) p.value<int>(j)); break;
+			case FE_PARAM_DOUBLE: v.push_back(p.value<double>(j)); break;
+			case FE_PARAM_DOUBLE_MAPPED:
+			{
+				FEParamDouble& d = p.value<FEParamDouble>(j);
+				if (d.isConst()) v.push_back(d.constValue());
+			}
+			break;
+			case FE_PARAM_VEC3D_MAPPED:
+			{
+				FEParamVec3& d = p.value<FEParamVec3>(j);
+				if (d.isConst())
+				{
+					vec3d r = d.constValue();
+					v.push_back(r.x); v.push_back(r.y); v.push_back(r.z);
+				}
+			}
+			break;
+			default:
+				break;
+			}
+		}
+	}
+}
+
 //-----------------------------------------------------------------------------
 // define the ellipsoidal fiber density distributionmaterial parameters
 BEGIN_FECORE_CLASS(FEEllipsoidalFiberDensityDistribution, FEFiberDensityDistribution)
@@ -55,6 +111,11 @@ double FEEllipsoidalFiberDensityDistribution::FiberDensity(FEMaterialPoint& mp,
     return R;
 }
 
+bool FEEllipsoidalFiberDensityDistribution::IsConstant()
+{
+	return IsConstantParameter(m_spa);
+}
+
 //-----------------------------------------------------------------------------
 // define the 3d von Mises fiber density distribution material parameters
 BEGIN_FECORE_CLASS(FEVonMises3DFiberDensityDistribution, FEFiberDensityDistribution)
@@ -70,6 +131,11 @@ double FEVonMises3DFiberDensityDistribution::FiberDensity(FEMaterialPoint& mp, c
     return R;
 }
 
+bool FEVonMises3DFiberDensityDistribution::IsConstant()
+{
+	return IsConstantParameter(m_b);
+}
+
 //-----------------------------------------------------------------------------
 // define the 3d 2-fiber family axisymmetric von Mises fiber density distribution material parameters
 BEGIN_FECORE_CLASS(FEVonMises3DTwoFDDAxisymmetric, FEFiberDensityDistribution)
@@ -98,6 +164,11 @@ double FEVonMises3DTwoFDDAxisymmetric::FiberDensity(FEMaterialPoint& mp, const v
     return R;
 }
 
+bool FEVonMises3DTwoFDDAxisymmetric::IsConstant()
+{
+	return IsConstantParameter(m_b) && IsConstantParameter(m_c);
+}
+
 //-----------------------------------------------------------------------------
 // define the ellipsoidal fiber density distributionmaterial parameters
 BEGIN_FECORE_CLASS(FEEllipticalFiberDensityDistribution, FEFiberDensityDistribution)
@@ -115,6 +186,11 @@ double FEEllipticalFiberDensityDistribution::FiberDensity(FEMaterialPoint& mp, c
     return R;
 }
 
+bool FEEllipticalFiberDensityDistribution::IsConstant()
+{
+	return IsConstantParameter(m_spa[0]) && IsConstantParameter(m_spa[1]);
+}
+
 //-----------------------------------------------------------------------------
 // define the 2d von Mises fiber density distribution material parameters
 BEGIN_FECORE_CLASS(FEVonMises2DFiberDensityDistribution, FEFiberDensityDistribution)
@@ -131,6 +207,11 @@ double FEVonMises2DFiberDensityDistribution::FiberDensity(FEMaterialPoint& mp, c
     return R;
 }
 
+bool FEVonMises2DFiberDensityDistribution::IsConstant()
+{
+	return IsConstantParameter(m_b);
+}
+
 
 //-----------------------------------------------------------------------------
 BEGIN_FECORE_CLASS(FEStructureTensorDistribution, FEFiberDensityDistribution)
@@ -42,6 +42,21 @@ public:
     // Evaluation of fiber density along n0
     virtual double FiberDensity(FEMaterialPoint& mp, const vec3d& n0) = 0;
 
+	// Returns true if the density doesn't depend on the material point or time.
+	// (In that case, the fiber densities can be evaluated once and reused.)
+	virtual bool IsConstant() { return false; }
+
+	// Collect the current values of the (constant) parameters. Tabulated densities
+	// store these values, so they can be updated when a parameter is changed
+	// (e.g. by a sensitivity analysis or an optimization).
+	void GetParameterValues(std::vector<double>& v);
+
+protected:
+	// helper functions for testing whether a parameter is constant in space and time
+	bool IsConstantParameter(FEParamDouble& p);
+	bool IsConstantParameter(FEParamVec3& p);
+
+public:
     FECORE_BASE_CLASS(FEFiberDensityDistribution)
 };
 
@@ -54,6 +69,8 @@ public:
     FESphericalFiberDensityDistribution(FEModel* pfem) : FEFiberDensityDistribution(pfem) {}
     
     double FiberDensity(FEMaterialPoint& mp, const vec3d& n0) override { return 1.0; }
+
+	bool IsConstant() override { return true; }
 };
 
 //---------------------------------------------------------------------------
@@ -65,6 +82,8 @@ public:
 	FEEllipsoidalFiberDensityDistribution(FEModel* pfem);
     
     double FiberDensity(FEMaterialPoint& mp, const vec3d& n0) override;
+
+	bool IsConstant() override;
     
 public:
     FEParamVec3 m_spa;      // semi-principal axes of ellipsoid
@@ -82,6 +101,8 @@ public:
     FEVonMises3DFiberDensityDistribution(FEModel* pfem) : FEFiberDensityDistribution(pfem) { m_b = 0; }
     
     double FiberDensity(FEMaterialPoint& mp, const vec3d& n0) override;
+
+	bool IsConstant() override;
     
 public:
     FEParamDouble m_b;         // concentration parameter
@@ -99,6 +120,8 @@ public:
 	FEVonMises3DTwoFDDAxisymmetric(FEModel* pfem);
     
     double FiberDensity(FEMaterialPoint& mp, const vec3d& n0) override;
+
+	bool IsConstant() override;
     
 public:
     FEParamDouble	m_b;		// concentration parameter
@@ -117,6 +140,8 @@ public:
     FECircularFiberDensityDistribution(FEModel* pfem) : FEFiberDensityDistribution(pfem) {}
     
     double FiberDensity(FEMaterialPoint& mp, const vec3d& n0) override { return 1.0; }
+
+	bool IsConstant() override { return true; }
 };
 
 //---------------------------------------------------------------------------
@@ -128,6 +153,8 @@ public:
     FEEllipticalFiberDensityDistribution(FEModel* pfem) : FEFiberDensityDistribution(pfem) { m_spa[0] = 1; m_spa[1] = 1; }
     
     double FiberDensity(FEMaterialPoint& mp, const vec3d& n0) override;
+
+	bool IsConstant() override;
     
 public:
     FEParamDouble m_spa[2];    // semi-principal axes of ellipse
@@ -145,6 +172,8 @@ public:
     FEVonMises2DFiberDensityDistribution(FEModel* pfem) : FEFiberDensityDistribution(pfem) { m_b = 0; }
     
     double FiberDensity(FEMaterialPoint& mp, const vec3d& n0) override;
+
+	bool IsConstant() override;
     
 public:
     FEParamDouble m_b;         // concentration parameter
@@ -206,6 +206,121 @@ double FEFiberExpPow::FiberStrainEnergyDensity(FEMaterialPoint& mp, const vec3d&
     return sed;
 }
 
+//-----------------------------------------------------------------------------
+// Same as FiberStress, summed over n fibers, but the material parameters and
+// deformation tensors are only evaluated once.
+mat3ds FEFiberExpPow::FiberStressSum(FEMaterialPoint& mp, const vec3d* a0, const double* w, int n)
+{
+	FEElasticMaterialPoint& pt = *mp.ExtractData<FEElasticMaterialPoint>();
+
+	mat3d &F = pt.m_F;
+	double J = pt.m_J;
+	mat3ds C = pt.RightCauchyGreen();
+
+	double lam0 = m_lam0(mp);
+	double I0 = lam0*lam0;
+	double ksi = m_ksi(mp);
+	double mu = m_mu(mp);
+	double alpha = m_alpha(mp);
+	double beta = m_beta(mp);
+
+	mat3ds BmI;
+	if (mu != 0.0) BmI = pt.LeftCauchyGreen() - mat3dd(1);
+
+	const double eps = m_epsf*std::numeric_limits<double>::epsilon();
+	mat3ds s; s.zero();
+	for (int i = 0; i < n; ++i)
+	{
+		const vec3d& n0 = a0[i];
+		double In_I0 = n0*(C*n0) - I0;
+		if (In_I0 >= eps)
+		{
+			vec3d nt = F*n0;
+			mat3ds N = dyad(nt);
+			double Wl = ksi*pow(In_I0, beta - 1.0)*exp(alpha*pow(In_I0, beta));
+			mat3ds si = N*(2.0*Wl / J);
+			if (mu != 0.0) si += (N*BmI).sym()*(mu / J);
+			s += si*w[i];
+		}
+	}
+
+	return s;
+}
+
+//-----------------------------------------------------------------------------
+tens4ds FEFiberExpPow::FiberTangentSum(FEMaterialPoint& mp, const vec3d* a0, const double* w, int n)
+{
+	FEElasticMaterialPoint& pt = *mp.ExtractData<FEElasticMaterialPoint>();
+
+	mat3d &F = pt.m_F;
+	double J = pt.m_J;
+	mat3ds C = pt.RightCauchyGreen();
+
+	double lam0 = m_lam0(mp);
+	double I0 = lam0*lam0;
+	double ksi = m_ksi(mp);
+	double mu = m_mu(mp);
+	double alpha = m_alpha(mp);
+	double beta = m_beta(mp);
+
+	mat3ds B;
+	if (mu != 0.0) B = pt.LeftCauchyGreen();
+
+	const double eps = m_epsf*std::numeric_limits<double>::epsilon();
+	tens4ds c; c.zero();
+	for (int i = 0; i < n; ++i)
+	{
+		const vec3d& n0 = a0[i];
+		double In_I0 = n0*(C*n0) - I0;
+		if (In_I0 >= eps)
+		{
+			vec3d nt = F*n0;
+			mat3ds N = dyad(nt);
+			double tmp = alpha*pow(In_I0, beta);
+			double Wll = ksi*pow(In_I0, beta - 2.0)*((tmp + 1)*beta - 1.0)*exp(tmp);
+			tens4ds ci = dyad1s(N)*(4.0*Wll / J);
+			if (mu != 0.0) ci += dyad4s(N, B)*(mu / J);
+			c += ci*w[i];
+		}
+	}
+
+	return c;
+}
+
+//-----------------------------------------------------------------------------
+double FEFiberExpPow::FiberStrainEnergyDensitySum(FEMaterialPoint& mp, const vec3d* a0, const double* w, int n)
+{
+	FEElasticMaterialPoint& pt = *mp.ExtractData<FEElasticMaterialPoint>();
+
+	mat3ds C = pt.RightCauchyGreen();
+
+	double lam0 = m_lam0(mp);
+	double I0 = lam0*lam0;
+	double ksi = m_ksi(mp);
+	double mu = m_mu(mp);
+	double alpha = m_alpha(mp);
+	double beta = m_beta(mp);
+
+	mat3ds C2;
+	if (mu != 0.0) C2 = C.sqr();
+
+	double sed = 0.0;
+	for (int i = 0; i < n; ++i)
+	{
+		const vec3d& n0 = a0[i];
+		double In = n0*(C*n0);
+		double In_I0 = In - I0;
+		if (In_I0 >= 0)
+		{
+			double sedi = (alpha > 0 ? ksi / (alpha*beta)*(exp(alpha*pow(In_I0, beta)) - 1) : ksi / beta*pow(In_I0, beta));
+			if (mu != 0.0) sedi += mu*(n0*(C2*n0) - 2 * (In - 1) - 1) / 4.0;
+			sed += sedi*w[i];
+		}
+	}
+
+	return sed;
+}
+
 // define the material parameters
 BEGIN_FECORE_CLASS(FEElasticFiberExpPow, FEElasticFiberMaterial)
 	ADD_PARAMETER(m_fib.m_alpha, FE_RANGE_GREATER_OR_EQUAL(0.0), "alpha");
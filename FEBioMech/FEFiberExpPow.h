@@ -49,6 +49,11 @@ public:
 	
 	//! Strain energy density
 	double FiberStrainEnergyDensity(FEMaterialPoint& mp, const vec3d& a0) override;
+
+	// weighted sums over several fiber directions
+	mat3ds FiberStressSum(FEMaterialPoint& mp, const vec3d* a0, const double* w, int n) override;
+	tens4ds FiberTangentSum(FEMaterialPoint& mp, const vec3d* a0, const double* w, int n) override;
+	double FiberStrainEnergyDensitySum(FEMaterialPoint& mp, const vec3d* a0, const double* w, int n) override;
     
 protected:
 	FEParamDouble       m_alpha;	// coefficient of (In-I0) in exponential
@@ -50,6 +50,9 @@ public:
 	// get iterator
 	FEFiberIntegrationSchemeIterator* GetIterator(FEMaterialPoint* mp) override;
 
+	// the integration points don't depend on the material point
+	bool IsConstant() const override { return true; }
+
 protected:
 	void InitIntegrationRule();  
 
@@ -71,5 +71,9 @@ public:
 	// The passed material point pointer will be zero when evaluating the integrated fiber density
 	virtual FEFiberIntegrationSchemeIterator* GetIterator(FEMaterialPoint* mp = 0) = 0;
 
+	// Returns true if the integration points don't depend on the material point. 
+	// The fiber directions and weights of such schemes can be tabulated once.
+	virtual bool IsConstant() const { return false; }
+
 	FECORE_BASE_CLASS(FEFiberIntegrationScheme)
 };
@@ -36,6 +36,27 @@ FEMaterialPointData* FEFiberMaterial::CreateMaterialPointData()
 	return new FEFiberMaterialPoint(nullptr);
 }
 
+mat3ds FEFiberMaterial::FiberStressSum(FEMaterialPoint& mp, const vec3d* fiber, const double* w, int n)
+{
+	mat3ds s; s.zero();
+	for (int i = 0; i < n; ++i) s += FiberStress(mp, fiber[i])*w[i];
+	return s;
+}
+
+tens4ds FEFiberMaterial::FiberTangentSum(FEMaterialPoint& mp, const vec3d* fiber, const double* w, int n)
+{
+	tens4ds c; c.zero();
+	for (int i = 0; i < n; ++i) c += FiberTangent(mp, fiber[i])*w[i];
+	return c;
+}
+
+double FEFiberMaterial::FiberStrainEnergyDensitySum(FEMaterialPoint& mp, const vec3d* fiber, const double* w, int n)
+{
+	double sed = 0.0;
+	for (int i = 0; i < n; ++i) sed += FiberStrainEnergyDensity(mp, fiber[i])*w[i];
+	return sed;
+}
+
 //===========================================================================================
 FEFiberMaterialUncoupled::FEFiberMaterialUncoupled(FEModel* fem) : FEMaterialProperty(fem)
 {
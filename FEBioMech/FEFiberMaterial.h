@@ -42,6 +42,16 @@ public:
 	virtual tens4ds FiberTangent(FEMaterialPoint& mp, const vec3d& fiber) = 0;
 
 	virtual double FiberStrainEnergyDensity(FEMaterialPoint& mp, const vec3d& fiber) = 0;
+
+public:
+	// Weighted sums over n fiber directions, e.g. sum_i w[i]*FiberStress(mp, fiber[i]).
+	// The default implementations call the single-fiber functions. Fiber materials can
+	// override these to evaluate everything that doesn't depend on the fiber direction only once.
+	virtual mat3ds FiberStressSum(FEMaterialPoint& mp, const vec3d* fiber, const double* w, int n);
+
+	virtual tens4ds FiberTangentSum(FEMaterialPoint& mp, const vec3d* fiber, const double* w, int n);
+
+	virtual double FiberStrainEnergyDensitySum(FEMaterialPoint& mp, const vec3d* fiber, const double* w, int n);
 };
 
 // fiber materials for use in uncoupled materials
@@ -60,6 +60,9 @@ class FEKinematicGrowth : public FEElasticMaterial
 {
 public:
     FEKinematicGrowth(FEModel* pfem);
+
+    //! the response depends on the deformation history
+    bool IsPathDependent() const override { return true; }
     
     //! Initialization routine
     bool Init() override;
@@ -122,8 +122,12 @@ void FELinearTrussDomain::Activate()
 
 void FELinearTrussDomain::PreSolveUpdate(const FETimeInfo& timeInfo)
 {
-	ForEachMaterialPoint([&](FEMaterialPoint& mp) {
-		mp.Update(timeInfo);
+	ForEachElement([&](FEElement& el) {
+		if (el.isActive())
+		{
+			int ni = el.GaussPoints();
+			for (int j = 0; j < ni; ++j) el.GetMaterialPoint(j)->Update(timeInfo);
+		}
 	});
 }
 
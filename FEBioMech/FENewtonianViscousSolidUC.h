@@ -33,6 +33,9 @@ class FENewtonianViscousSolidUC : public FEUncoupledMaterial
 {
 public:
     FENewtonianViscousSolidUC(FEModel* pfem);
+
+    //! the response depends on the deformation history
+    bool IsPathDependent() const override { return true; }
     
 public:
     double	m_kappa;	//!< bulk viscosity
@@ -37,6 +37,9 @@ class FERVEFatigueMaterial : public FEElasticMaterial
 {
 public:
     FERVEFatigueMaterial(FEModel* pfem);
+
+    //! the response depends on the deformation history
+    bool IsPathDependent() const override { return true; }
     
 public:
     //! calculate stress at material point
@@ -40,6 +40,9 @@ class FEReactiveFatigue : public FEElasticMaterial
 {
 public:
     FEReactiveFatigue(FEModel* pfem);
+
+    //! the response depends on the deformation history
+    bool IsPathDependent() const override { return true; }
     
 public:
     //! calculate stress at material point
@@ -39,6 +39,9 @@ class FEReactivePlasticDamage : public FEElasticMaterial
 {
 public:
 	FEReactivePlasticDamage(FEModel* pfem);
+
+	//! the response depends on the deformation history
+	bool IsPathDependent() const override { return true; }
     
 public:
     //! data initialization and checking
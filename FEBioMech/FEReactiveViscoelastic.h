@@ -44,6 +44,9 @@ class FEReactiveViscoelasticMaterial :	public FEElasticMaterial
 public:
 	//! default constructor
 	FEReactiveViscoelasticMaterial(FEModel* pfem);
+
+	//! the response depends on the deformation history
+	bool IsPathDependent() const override { return true; }
        
 	//! get the elastic base material
 	FEElasticMaterial* GetBaseMaterial() { return m_pBase; }
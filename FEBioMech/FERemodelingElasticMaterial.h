@@ -102,6 +102,9 @@ class FEBIOMECH_API FERemodelingElasticMaterial : public FEElasticMaterial, publ
 public:
 	//! constructor
 	FERemodelingElasticMaterial(FEModel* pfem);
+
+	//! the response depends on the deformation history
+	bool IsPathDependent() const override { return true; }
 	
 	//! strain energy density function
 	double StrainEnergyDensity(FEMaterialPoint& pt) override;
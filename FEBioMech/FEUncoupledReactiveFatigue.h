@@ -39,6 +39,9 @@ class FEUncoupledReactiveFatigue : public FEUncoupledMaterial
 {
 public:
     FEUncoupledReactiveFatigue(FEModel* pfem);
+
+    //! the response depends on the deformation history
+    bool IsPathDependent() const override { return true; }
     
 public:
     //! calculate stress at material point
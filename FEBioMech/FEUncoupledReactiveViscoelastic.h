@@ -44,6 +44,9 @@ class FEUncoupledReactiveViscoelasticMaterial :	public FEUncoupledMaterial
 public:
     //! default constructor
     FEUncoupledReactiveViscoelasticMaterial(FEModel* pfem);
+
+    //! the response depends on the deformation history
+    bool IsPathDependent() const override { return true; }
         
     //! get the elastic base material
 	FEUncoupledMaterial* GetBaseMaterial() { return m_pBase; }
@@ -43,6 +43,9 @@ public:
 public:
     //! default constructor
     FEViscoElasticDamage(FEModel* pfem);
+
+    //! the response depends on the deformation history
+    bool IsPathDependent() const override { return true; }
     
 public:
     //! initialization
@@ -81,6 +81,9 @@ public:
 	//! default constructor
 	FEViscoElasticMaterial(FEModel* pfem);
 
+	//! the response depends on the deformation history
+	bool IsPathDependent() const override { return true; }
+
 	//! get the elastic base material
 	FEElasticMaterial* GetBaseMaterial();
 
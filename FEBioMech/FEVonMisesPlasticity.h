@@ -86,6 +86,9 @@ class FEVonMisesPlasticity : public FESolidMaterial
 public:
 	FEVonMisesPlasticity(FEModel* pfem);
 
+	//! the response depends on the deformation history
+	bool IsPathDependent() const override { return true; }
+
 public:
 	double	m_E;	//!< Young's modulus
 	double	m_v;	//!< Poisson's ratio
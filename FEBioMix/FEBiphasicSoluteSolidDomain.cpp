@@ -276,6 +276,8 @@ void FEBiphasicSoluteSolidDomain::PreSolveUpdate(const FETimeInfo& timeInfo)
     for (size_t iel=0; iel<m_Elem.size(); ++iel)
     {
         FESolidElement& el = m_Elem[iel];
+        if (el.isActive() == false) continue;
+
         int neln = el.Nodes();
         for (int i=0; i<neln; ++i)
         {
@@ -511,6 +511,8 @@ void FEMultiphasicShellDomain::PreSolveUpdate(const FETimeInfo& timeInfo)
     for (size_t iel=0; iel<m_Elem.size(); ++iel)
     {
         FEShellElement& el = m_Elem[iel];
+        if (el.isActive() == false) continue;
+
         int neln = el.Nodes();
         for (int i=0; i<neln; ++i)
         {
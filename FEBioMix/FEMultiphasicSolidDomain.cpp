@@ -34,6 +34,7 @@ SOFTWARE.*/
 #include <FECore/DOFS.h>
 #include <FEBioMech/FEBioMech.h>
 #include <FECore/FELinearSystem.h>
+#include <FECore/ScratchArena.h>
 #include <FECore/sys.h>
 
 #ifndef SQR
@@ -454,6 +455,7 @@ void FEMultiphasicSolidDomain::Reset()
             ps.m_crd.clear();
             for (int j=0; j<m_pMat->Reactions(); ++j)
                 m_pMat->GetReaction(j)->ResetElementData(mp);
+            ps.m_bzhat = ps.m_bdzhat = false;
         }
     }
     m_breset = true;
@@ -470,6 +472,8 @@ void FEMultiphasicSolidDomain::PreSolveUpdate(const FETimeInfo& timeInfo)
     for (size_t iel=0; iel<m_Elem.size(); ++iel)
     {
         FESolidElement& el = m_Elem[iel];
+        if (el.isActive() == false) continue;
+
         int neln = el.Nodes();
         for (int i=0; i<neln; ++i)
         {
@@ -521,6 +525,7 @@ void FEMultiphasicSolidDomain::PreSolveUpdate(const FETimeInfo& timeInfo)
             // reset chemical reaction element data
             for (int j=0; j<m_pMat->Reactions(); ++j)
                 m_pMat->GetReaction(j)->InitializeElementData(mp);
+            ps.m_bzhat = ps.m_bdzhat = false;
             
             mp.Update(timeInfo);
         }
@@ -530,34 +535,37 @@ void FEMultiphasicSolidDomain::PreSolveUpdate(const FETimeInfo& timeInfo)
 //-----------------------------------------------------------------------------
 void FEMultiphasicSolidDomain::InternalForces(FEGlobalVector& R)
 {
-    size_t NE = m_Elem.size();
+    int NE = (int)m_Elem.size();
     
     // get nodal DOFS
     int nsol = m_pMat->Solutes();
     int ndpn = 4+nsol;
     
-#pragma omp parallel for
-    for (int i=0; i<NE; ++i)
+#pragma omp parallel
     {
-        // element force vector
+        // element force vector and LM vector (reused for all elements of a thread)
         vector<double> fe;
         vector<int> lm;
-        
-        // get the element
-        FESolidElement& el = m_Elem[i];
-        
-        // get the element force vector and initialize it to zero
-        int ndof = ndpn*el.Nodes();
-        fe.assign(ndof, 0);
-        
-        // calculate internal force vector
-        ElementInternalForce(el, fe);
-        
-        // get the element's LM vector
-        UnpackLM(el, lm);
-        
-        // assemble element 'fe'-vector into global R vector
-        R.Assemble(el.m_node, lm, fe);
+
+#pragma omp for
+        for (int i=0; i<NE; ++i)
+        {
+            // get the element
+            FESolidElement& el = m_Elem[i];
+
+            // get the element force vector and initialize it to zero
+            int ndof = ndpn*el.Nodes();
+            fe.assign(ndof, 0);
+
+            // calculate internal force vector
+            ElementInternalForce(el, fe);
+
+            // get the element's LM vector
+            UnpackLM(el, lm);
+
+            // assemble element 'fe'-vector into global R vector
+            R.Assemble(el.m_node, lm, fe);
+        }
     }
 }
 
@@ -591,6 +599,8 @@ void FEMultiphasicSolidDomain::ElementInternalForce(FESolidElement& el, vector<d
     // repeat for all integration points
     for (n=0; n<nint; ++n)
     {
+        ScratchScope scope;
+
         FEMaterialPoint& mp = *el.GetMaterialPoint(n);
         FEElasticMaterialPoint& pt = *(mp.ExtractData<FEElasticMaterialPoint>());
         FEBiphasicMaterialPoint& bpt = *(mp.ExtractData<FEBiphasicMaterialPoint>());
@@ -620,9 +630,8 @@ void FEMultiphasicSolidDomain::ElementInternalForce(FESolidElement& el, vector<d
         // get the flux
         vec3d& w = bpt.m_w;
         
-        vector<vec3d> j(spt.m_j);
-        vector<int> z(nsol);
-        vector<double> kappa(spt.m_k);
+        const vector<vec3d>& j = spt.m_j;
+        ScratchArray<int> z(nsol);
         vec3d je(0,0,0);
         
         for (isol=0; isol<nsol; ++isol) {
@@ -633,16 +642,17 @@ void FEMultiphasicSolidDomain::ElementInternalForce(FESolidElement& el, vector<d
         
         // evaluate the porosity, its derivative w.r.t. J, and its gradient
         double phiw = m_pMat->Porosity(mp);
-        vector<double> chat(nsol,0);
+        ScratchArray<double> chat(nsol, 0.0);
         
         // get the solvent supply
         double phiwhat = 0;
         if (m_pMat->GetSolventSupply()) phiwhat = m_pMat->GetSolventSupply()->Supply(mp);
         
         // chemical reactions
+        EvaluateReactionSupplies(mp);
         for (i=0; i<nreact; ++i) {
             FEChemicalReaction* pri = m_pMat->GetReaction(i);
-            double zhat = pri->ReactionSupply(mp);
+            double zhat = spt.m_zhat[i];
             phiwhat += phiw*pri->m_Vbar*zhat;
             for (isol=0; isol<nsol; ++isol)
                 chat[isol] += phiw*zhat*pri->m_v[isol];
@@ -676,34 +686,37 @@ void FEMultiphasicSolidDomain::ElementInternalForce(FESolidElement& el, vector<d
 //-----------------------------------------------------------------------------
 void FEMultiphasicSolidDomain::InternalForcesSS(FEGlobalVector& R)
 {
-    size_t NE = m_Elem.size();
+    int NE = (int)m_Elem.size();
     
     // get nodal DOFS
     int nsol = m_pMat->Solutes();
     int ndpn = 4+nsol;
     
-#pragma omp parallel for
-    for (int i=0; i<NE; ++i)
+#pragma omp parallel
     {
-        // element force vector
+        // element force vector and LM vector (reused for all elements of a thread)
         vector<double> fe;
         vector<int> lm;
-        
-        // get the element
-        FESolidElement& el = m_Elem[i];
-        
-        // get the element force vector and initialize it to zero
-        int ndof = ndpn*el.Nodes();
-        fe.assign(ndof, 0);
-        
-        // calculate internal force vector
-        ElementInternalForceSS(el, fe);
-        
-        // get the element's LM vector
-        UnpackLM(el, lm);
-        
-        // assemble element 'fe'-vector into global R vector
-        R.Assemble(el.m_node, lm, fe);
+
+#pragma omp for
+        for (int i=0; i<NE; ++i)
+        {
+            // get the element
+            FESolidElement& el = m_Elem[i];
+
+            // get the element force vector and initialize it to zero
+            int ndof = ndpn*el.Nodes();
+            fe.assign(ndof, 0);
+
+            // calculate internal force vector
+            ElementInternalForceSS(el, fe);
+
+            // get the element's LM vector
+            UnpackLM(el, lm);
+
+            // assemble element 'fe'-vector into global R vector
+            R.Assemble(el.m_node, lm, fe);
+        }
     }
 }
 
@@ -737,6 +750,8 @@ void FEMultiphasicSolidDomain::ElementInternalForceSS(FESolidElement& el, vector
     // repeat for all integration points
     for (n=0; n<nint; ++n)
     {
+        ScratchScope scope;
+
         FEMaterialPoint& mp = *el.GetMaterialPoint(n);
         FEElasticMaterialPoint& pt = *(mp.ExtractData<FEElasticMaterialPoint>());
         FEBiphasicMaterialPoint& bpt = *(mp.ExtractData<FEBiphasicMaterialPoint>());
@@ -759,9 +774,8 @@ void FEMultiphasicSolidDomain::ElementInternalForceSS(FESolidElement& el, vector
         // get the flux
         vec3d& w = bpt.m_w;
         
-        vector<vec3d> j(spt.m_j);
-        vector<int> z(nsol);
-        vector<double> kappa(spt.m_k);
+        const vector<vec3d>& j = spt.m_j;
+        ScratchArray<int> z(nsol);
         vec3d je(0,0,0);
         
         for (isol=0; isol<nsol; ++isol) {
@@ -772,16 +786,17 @@ void FEMultiphasicSolidDomain::ElementInternalForceSS(FESolidElement& el, vector
         
         // evaluate the porosity, its derivative w.r.t. J, and its gradient
         double phiw = m_pMat->Porosity(mp);
-        vector<double> chat(nsol,0);
+        ScratchArray<double> chat(nsol, 0.0);
         
         // get the solvent supply
         double phiwhat = 0;
         if (m_pMat->GetSolventSupply()) phiwhat = m_pMat->GetSolventSupply()->Supply(mp);
         
         // chemical reactions
+        EvaluateReactionSupplies(mp);
         for (i=0; i<nreact; ++i) {
             FEChemicalReaction* pri = m_pMat->GetReaction(i);
-            double zhat = pri->ReactionSupply(mp);
+            double zhat = spt.m_zhat[i];
             phiwhat += phiw*pri->m_Vbar*zhat;
             for (isol=0; isol<nsol; ++isol)
                 chat[isol] += phiw*zhat*pri->m_v[isol];
@@ -821,29 +836,33 @@ void FEMultiphasicSolidDomain::StiffnessMatrix(FELinearSystem& LS, bool bsymm)
     // repeat over all solid elements
     int NE = (int)m_Elem.size();
     
-#pragma omp parallel for
-    for (int iel=0; iel<NE; ++iel)
+#pragma omp parallel
     {
-		FESolidElement& el = m_Elem[iel];
+        // element stiffness matrix and LM vector (reused for all elements of a thread)
+        FEElementMatrix ke;
+        vector<int> lm;
 
-        // element stiffness matrix
-        FEElementMatrix ke(el);
+#pragma omp for
+        for (int iel=0; iel<NE; ++iel)
+        {
+            FESolidElement& el = m_Elem[iel];
+            ke.SetNodes(el.m_node);
 
-        // allocate stiffness matrix
-        int neln = el.Nodes();
-        int ndof = neln*ndpn;
-        ke.resize(ndof, ndof);
-        
-        // calculate the element stiffness matrix
-        ElementMultiphasicStiffness(el, ke, bsymm);
+            // allocate stiffness matrix
+            int neln = el.Nodes();
+            int ndof = neln*ndpn;
+            ke.resize(ndof, ndof);
 
-		// get the lm vector
-		vector<int> lm;
-		UnpackLM(el, lm);
-		ke.SetIndices(lm);
+            // calculate the element stiffness matrix
+            ElementMultiphasicStiffness(el, ke, bsymm);
 
-        // assemble element matrix in global stiffness matrix
-		LS.Assemble(ke);
+            // get the lm vector
+            UnpackLM(el, lm);
+            ke.SetIndices(lm);
+
+            // assemble element matrix in global stiffness matrix
+            LS.Assemble(ke);
+        }
     }
 }
 
@@ -856,29 +875,33 @@ void FEMultiphasicSolidDomain::StiffnessMatrixSS(FELinearSystem& LS, bool bsymm)
     // repeat over all solid elements
     int NE = (int)m_Elem.size();
     
-#pragma omp parallel for
-    for (int iel=0; iel<NE; ++iel)
+#pragma omp parallel
     {
-		FESolidElement& el = m_Elem[iel];
+        // element stiffness matrix and LM vector (reused for all elements of a thread)
+        FEElementMatrix ke;
+        vector<int> lm;
 
-        // element stiffness matrix
-        FEElementMatrix ke(el);
+#pragma omp for
+        for (int iel=0; iel<NE; ++iel)
+        {
+            FESolidElement& el = m_Elem[iel];
+            ke.SetNodes(el.m_node);
 
-        // allocate stiffness matrix
-        int neln = el.Nodes();
-        int ndof = neln*ndpn;
-        ke.resize(ndof, ndof);
-        
-        // calculate the element stiffness matrix
-        ElementMultiphasicStiffnessSS(el, ke, bsymm);
+            // allocate stiffness matrix
+            int neln = el.Nodes();
+            int ndof = neln*ndpn;
+            ke.resize(ndof, ndof);
+
+            // calculate the element stiffness matrix
+            ElementMultiphasicStiffnessSS(el, ke, bsymm);
 
-		// get the lm vector
-		vector<int> lm;
-		UnpackLM(el, lm);
-		ke.SetIndices(lm);
+            // get the lm vector
+            UnpackLM(el, lm);
+            ke.SetIndices(lm);
 
-        // assemble element matrix in global stiffness matrix
-		LS.Assemble(ke);
+            // assemble element matrix in global stiffness matrix
+            LS.Assemble(ke);
+        }
     }
 }
 
@@ -915,6 +938,8 @@ bool FEMultiphasicSolidDomain::ElementMultiphasicStiffness(FESolidElement& el, m
     // loop over gauss-points
     for (int n=0; n<nint; ++n)
     {
+        ScratchScope scope;
+
         FEMaterialPoint& mp = *el.GetMaterialPoint(n);
         FEElasticMaterialPoint&  ept = *(mp.ExtractData<FEElasticMaterialPoint >());
         FEBiphasicMaterialPoint& ppt = *(mp.ExtractData<FEBiphasicMaterialPoint>());
@@ -950,21 +975,21 @@ bool FEMultiphasicSolidDomain::ElementMultiphasicStiffness(FESolidElement& el, m
         vec3d w = ppt.m_w;
         vec3d gradp = ppt.m_gradp;
         
-        vector<double> c(spt.m_c);
-        vector<vec3d> gradc(spt.m_gradc);
-        vector<int> z(nsol);
+        const vector<double>& c = spt.m_c;
+        const vector<vec3d>& gradc = spt.m_gradc;
+        ScratchArray<int> z(nsol);
         
-        vector<double> kappa(spt.m_k);
+        const vector<double>& kappa = spt.m_k;
         
         // get the charge number
         for (int isol=0; isol<nsol; ++isol)
             z[isol] = m_pMat->GetSolute(isol)->ChargeNumber();
         
-        vector<double> dkdJ(spt.m_dkdJ);
-        vector< vector<double> > dkdc(spt.m_dkdc);
-        vector< vector<double> > dkdr(spt.m_dkdr);
-        vector< vector<double> > dkdJr(spt.m_dkdJr);
-        vector< vector< vector<double> > > dkdrc(spt.m_dkdrc);
+        const vector<double>& dkdJ = spt.m_dkdJ;
+        const vector< vector<double> >& dkdc = spt.m_dkdc;
+        const vector< vector<double> >& dkdr = spt.m_dkdr;
+        const vector< vector<double> >& dkdJr = spt.m_dkdJr;
+        const vector< vector< vector<double> > >& dkdrc = spt.m_dkdrc;
         
         // evaluate the porosity and its derivative
         double phiw = m_pMat->Porosity(mp);
@@ -979,43 +1004,36 @@ bool FEMultiphasicSolidDomain::ElementMultiphasicStiffness(FESolidElement& el, m
         mat3ds K = m_pMat->GetPermeability()->Permeability(mp);
         tens4dmm dKdE = m_pMat->GetPermeability()->Tangent_Permeability_Strain(mp);
         
-        vector<mat3ds> dKdc(nsol);
-        vector<mat3ds> D(nsol);
-        vector<tens4dmm> dDdE(nsol);
-        vector< vector<mat3ds> > dDdc(nsol, vector<mat3ds>(nsol));
-        vector<double> D0(nsol);
-        vector< vector<double> > dD0dc(nsol, vector<double>(nsol));
-        vector<double> dodc(nsol);
-        vector<mat3ds> dTdc(nsol);
-        vector<mat3ds> ImD(nsol);
+        ScratchArray<mat3ds> dKdc(nsol);
+        ScratchArray<mat3ds> D(nsol);
+        ScratchArray<tens4dmm> dDdE(nsol);
+        ScratchMatrix<mat3ds> dDdc(nsol, nsol);
+        ScratchArray<double> D0(nsol);
+        ScratchMatrix<double> dD0dc(nsol, nsol);
+        ScratchArray<double> dodc(nsol);
+        ScratchArray<mat3ds> dTdc(nsol);
+        ScratchArray<mat3ds> ImD(nsol);
         mat3dd I(1);
         
         // evaluate the solvent supply and its derivatives
         mat3ds Phie; Phie.zero();
         double Phip = 0;
-        vector<double> Phic(nsol,0);
-        vector<mat3ds> dchatde(nsol);
+        ScratchArray<double> Phic(nsol, 0.0);
+        ScratchArray<mat3ds> dchatde(nsol);
         if (m_pMat->GetSolventSupply()) {
             Phie = m_pMat->GetSolventSupply()->Tangent_Supply_Strain(mp);
             Phip = m_pMat->GetSolventSupply()->Tangent_Supply_Pressure(mp);
         }
         
         // chemical reactions
-		vector<double> reactionSupply(nreact, 0.0);
-		vector<mat3ds> tangentReactionSupplyStrain(nreact);
-		vector< vector<double> > tangentReactionSupplyConcentration(nreact, vector<double>(nsol));
+		EvaluateReactionSupplyTangents(mp);
+		const double* reactionSupply = spt.m_zhat.data();
+		const mat3ds* tangentReactionSupplyStrain = spt.m_dzhatde.data();
+		const double* tangentReactionSupplyConcentration = spt.m_dzhatdc.data();
 		for (int i = 0; i < nreact; ++i)
 		{
 			FEChemicalReaction* reacti = m_pMat->GetReaction(i);
 
-			reactionSupply[i] = reacti->ReactionSupply(mp);
-			tangentReactionSupplyStrain[i] = reacti->Tangent_ReactionSupply_Strain(mp);
-
-			for (int isol = 0; isol < nsol; ++isol)
-			{
-				tangentReactionSupplyConcentration[i][isol] = reacti->Tangent_ReactionSupply_Concentration(mp, isol);
-			}
-
 			Phie += reacti->m_Vbar*(I*reactionSupply[i]
 				+ tangentReactionSupplyStrain [i]*(J*phiw));
 
@@ -1061,7 +1079,7 @@ bool FEMultiphasicSolidDomain::ElementMultiphasicStiffness(FESolidElement& el, m
 					*(I*reactionSupply[ireact]
 					+ tangentReactionSupplyStrain[ireact] *(J*phiw));
 
-                Phic[isol] += phiw* reacti->m_Vbar*tangentReactionSupplyConcentration[ireact][isol];
+                Phic[isol] += phiw* reacti->m_Vbar*tangentReactionSupplyConcentration[ireact*nsol + isol];
             }
         }
         
@@ -1074,8 +1092,8 @@ bool FEMultiphasicSolidDomain::ElementMultiphasicStiffness(FESolidElement& el, m
         mat3ds Ki = K.inverse();
         mat3ds Ke(0,0,0,0,0,0);
         tens4d G = (dyad1(Ki,I) - dyad4(Ki,I)*2)*2 - ddot(dyad2(Ki,Ki),dKdE);
-        vector<mat3ds> Gc(nsol);
-        vector<mat3ds> dKedc(nsol);
+        ScratchArray<mat3ds> Gc(nsol);
+        ScratchArray<mat3ds> dKedc(nsol);
         for (int isol=0; isol<nsol; ++isol) {
             Ke += ImD[isol]*(kappa[isol]*c[isol]/D0[isol]);
             G += dyad1(ImD[isol],I)*(R*T*c[isol]*J/D0[isol]/phiw*(dkdJ[isol]-kappa[isol]/phiw*dpdJ))
@@ -1094,12 +1112,15 @@ bool FEMultiphasicSolidDomain::ElementMultiphasicStiffness(FESolidElement& el, m
         
         // calculate all the matrices
         vec3d vtmp,gp,qpu;
-        vector<vec3d> gc(nsol),qcu(nsol),wc(nsol),jce(nsol);
-        vector< vector<vec3d> > jc(nsol, vector<vec3d>(nsol));
+        ScratchArray<vec3d> gc(nsol);
+        ScratchArray<vec3d> qcu(nsol);
+        ScratchArray<vec3d> wc(nsol);
+        ScratchArray<vec3d> jce(nsol);
+        ScratchMatrix<vec3d> jc(nsol, nsol);
         mat3d wu, jue;
-        vector<mat3d> ju(nsol);
-        vector< vector<double> > qcc(nsol, vector<double>(nsol));
-        vector< vector<double> > dchatdc(nsol, vector<double>(nsol));
+        ScratchArray<mat3d> ju(nsol);
+        ScratchMatrix<double> qcc(nsol, nsol);
+        ScratchMatrix<double> dchatdc(nsol, nsol);
         double sum;
         mat3ds De;
         for (int i=0; i<neln; ++i)
@@ -1209,7 +1230,7 @@ bool FEMultiphasicSolidDomain::ElementMultiphasicStiffness(FESolidElement& el, m
                 }
                 
                 // calculate data for the kcc matrix
-                jce.assign(nsol, vec3d(0,0,0));
+                jce.assign(vec3d(0,0,0));
                 for (int isol=0; isol<nsol; ++isol) {
                     for (int jsol=0; jsol<nsol; ++jsol) {
                         if (jsol != isol) {
@@ -1234,7 +1255,7 @@ bool FEMultiphasicSolidDomain::ElementMultiphasicStiffness(FESolidElement& el, m
 							FEChemicalReaction* reacti = m_pMat->GetReaction(ireact);
 
                             dchatdc[isol][jsol] += reacti->m_v[isol]
-                            * tangentReactionSupplyConcentration[ireact][jsol];
+                            * tangentReactionSupplyConcentration[ireact*nsol + jsol];
 
                             double sum1 = 0;
                             double sum2 = 0;
@@ -1245,7 +1266,7 @@ bool FEMultiphasicSolidDomain::ElementMultiphasicStiffness(FESolidElement& el, m
                                 ((J-phi0)*dkdrc[isol][isbm][jsol]-dkdc[isol][jsol]/m_pMat->SBMDensity(isbm));
                             }
                             double zhat = reactionSupply[ireact];
-                            double dzdc = tangentReactionSupplyConcentration[ireact][jsol];
+                            double dzdc = tangentReactionSupplyConcentration[ireact*nsol + jsol];
                             if (jsol != isol) {
                                 qcc[isol][jsol] -= H[j]*phiw*c[isol]*(dzdc*sum1+zhat*sum2);
                             }
@@ -1317,6 +1338,8 @@ bool FEMultiphasicSolidDomain::ElementMultiphasicStiffnessSS(FESolidElement& el,
     // loop over gauss-points
     for (n=0; n<nint; ++n)
     {
+        ScratchScope scope;
+
         FEMaterialPoint& mp = *el.GetMaterialPoint(n);
         FEElasticMaterialPoint&  ept = *(mp.ExtractData<FEElasticMaterialPoint >());
         FEBiphasicMaterialPoint& ppt = *(mp.ExtractData<FEBiphasicMaterialPoint>());
@@ -1352,19 +1375,19 @@ bool FEMultiphasicSolidDomain::ElementMultiphasicStiffnessSS(FESolidElement& el,
         vec3d w = ppt.m_w;
         vec3d gradp = ppt.m_gradp;
         
-        vector<double> c(spt.m_c);
-        vector<vec3d> gradc(spt.m_gradc);
-        vector<int> z(nsol);
+        const vector<double>& c = spt.m_c;
+        const vector<vec3d>& gradc = spt.m_gradc;
+        ScratchArray<int> z(nsol);
         
-        vector<double> zz(nsol);
-        vector<double> kappa(spt.m_k);
+        ScratchArray<double> zz(nsol);
+        const vector<double>& kappa = spt.m_k;
         
         // get the charge number
         for (isol=0; isol<nsol; ++isol)
             z[isol] = m_pMat->GetSolute(isol)->ChargeNumber();
         
-        vector<double> dkdJ(spt.m_dkdJ);
-        vector< vector<double> > dkdc(spt.m_dkdc);
+        const vector<double>& dkdJ = spt.m_dkdJ;
+        const vector< vector<double> >& dkdc = spt.m_dkdc;
         
         // evaluate the porosity and its derivative
         double phiw = m_pMat->Porosity(mp);
@@ -1378,22 +1401,22 @@ bool FEMultiphasicSolidDomain::ElementMultiphasicStiffnessSS(FESolidElement& el,
         mat3ds K = m_pMat->GetPermeability()->Permeability(mp);
         tens4dmm dKdE = m_pMat->GetPermeability()->Tangent_Permeability_Strain(mp);
         
-        vector<mat3ds> dKdc(nsol);
-        vector<mat3ds> D(nsol);
-        vector<tens4dmm> dDdE(nsol);
-        vector< vector<mat3ds> > dDdc(nsol, vector<mat3ds>(nsol));
-        vector<double> D0(nsol);
-        vector< vector<double> > dD0dc(nsol, vector<double>(nsol));
-        vector<double> dodc(nsol);
-        vector<mat3ds> dTdc(nsol);
-        vector<mat3ds> ImD(nsol);
+        ScratchArray<mat3ds> dKdc(nsol);
+        ScratchArray<mat3ds> D(nsol);
+        ScratchArray<tens4dmm> dDdE(nsol);
+        ScratchMatrix<mat3ds> dDdc(nsol, nsol);
+        ScratchArray<double> D0(nsol);
+        ScratchMatrix<double> dD0dc(nsol, nsol);
+        ScratchArray<double> dodc(nsol);
+        ScratchArray<mat3ds> dTdc(nsol);
+        ScratchArray<mat3ds> ImD(nsol);
         mat3dd I(1);
         
         // evaluate the solvent supply and its derivatives
         double phiwhat = 0;
         mat3ds Phie; Phie.zero();
         double Phip = 0;
-        vector<double> Phic(nsol,0);
+        ScratchArray<double> Phic(nsol, 0.0);
         if (m_pMat->GetSolventSupply()) {
             phiwhat = m_pMat->GetSolventSupply()->Supply(mp);
             Phie = m_pMat->GetSolventSupply()->Tangent_Supply_Strain(mp);
@@ -1401,9 +1424,10 @@ bool FEMultiphasicSolidDomain::ElementMultiphasicStiffnessSS(FESolidElement& el,
         }
         
         // chemical reactions
+        EvaluateReactionSupplyTangents(mp);
         for (i=0; i<nreact; ++i)
-            Phie += m_pMat->GetReaction(i)->m_Vbar*(I*m_pMat->GetReaction(i)->ReactionSupply(mp)
-                                                    +m_pMat->GetReaction(i)->Tangent_ReactionSupply_Strain(mp)*(J*phiw));
+            Phie += m_pMat->GetReaction(i)->m_Vbar*(I*spt.m_zhat[i]
+                                                    +spt.m_dzhatde[i]*(J*phiw));
         
         for (isol=0; isol<nsol; ++isol) {
             // evaluate the permeability derivatives
@@ -1444,8 +1468,8 @@ bool FEMultiphasicSolidDomain::ElementMultiphasicStiffnessSS(FESolidElement& el,
         mat3ds Ki = K.inverse();
         mat3ds Ke(0,0,0,0,0,0);
         tens4d G = (dyad1(Ki,I) - dyad4(Ki,I)*2)*2 - ddot(dyad2(Ki,Ki),dKdE);
-        vector<mat3ds> Gc(nsol);
-        vector<mat3ds> dKedc(nsol);
+        ScratchArray<mat3ds> Gc(nsol);
+        ScratchArray<mat3ds> dKedc(nsol);
         for (isol=0; isol<nsol; ++isol) {
             Ke += ImD[isol]*(kappa[isol]*c[isol]/D0[isol]);
             G += dyad1(ImD[isol],I)*(R*T*c[isol]*J/D0[isol]/phiw*(dkdJ[isol]-kappa[isol]/phiw*dpdJ))
@@ -1464,11 +1488,13 @@ bool FEMultiphasicSolidDomain::ElementMultiphasicStiffnessSS(FESolidElement& el,
         
         // calculate all the matrices
         vec3d vtmp,gp,qpu;
-        vector<vec3d> gc(nsol),wc(nsol),jce(nsol);
-        vector< vector<vec3d> > jc(nsol, vector<vec3d>(nsol));
+        ScratchArray<vec3d> gc(nsol);
+        ScratchArray<vec3d> wc(nsol);
+        ScratchArray<vec3d> jce(nsol);
+        ScratchMatrix<vec3d> jc(nsol, nsol);
         mat3d wu, jue;
-        vector<mat3d> ju(nsol);
-        vector< vector<double> > dchatdc(nsol, vector<double>(nsol));
+        ScratchArray<mat3d> ju(nsol);
+        ScratchMatrix<double> dchatdc(nsol, nsol);
         double sum;
         mat3ds De;
         for (i=0; i<neln; ++i)
@@ -1557,7 +1583,7 @@ bool FEMultiphasicSolidDomain::ElementMultiphasicStiffnessSS(FESolidElement& el,
                 }
                 
                 // calculate data for the kcc matrix
-                jce.assign(nsol, vec3d(0,0,0));
+                jce.assign(vec3d(0,0,0));
                 for (isol=0; isol<nsol; ++isol) {
                     for (jsol=0; jsol<nsol; ++jsol) {
                         if (jsol != isol) {
@@ -1576,7 +1602,7 @@ bool FEMultiphasicSolidDomain::ElementMultiphasicStiffnessSS(FESolidElement& el,
                         dchatdc[isol][jsol] = 0;
                         for (ireact=0; ireact<nreact; ++ireact)
                             dchatdc[isol][jsol] += m_pMat->GetReaction(ireact)->m_v[isol]
-                            *m_pMat->GetReaction(ireact)->Tangent_ReactionSupply_Concentration(mp,jsol);
+                            *spt.m_dzhatdc[ireact*nsol + jsol];
                     }
                 }
                 
@@ -1754,6 +1780,45 @@ void FEMultiphasicSolidDomain::UpdateElementStress(int iel, double dt)
         for (int j=0; j<m_pMat->Reactions(); ++j)
             pmb->GetReaction(j)->UpdateElementData(mp);
         
+        // the reaction supplies need to be re-evaluated for the new state
+        spt.m_bzhat = spt.m_bdzhat = false;
     }
     if (m_breset) m_breset = false;
 }
+
+//-----------------------------------------------------------------------------
+void FEMultiphasicSolidDomain::EvaluateReactionSupplies(FEMaterialPoint& mp)
+{
+	FESolutesMaterialPoint& spt = *(mp.ExtractData<FESolutesMaterialPoint>());
+	if (spt.m_bzhat) return;
+
+	const int nreact = m_pMat->Reactions();
+	spt.m_zhat.resize(nreact);
+	for (int i = 0; i < nreact; ++i)
+		spt.m_zhat[i] = m_pMat->GetReaction(i)->ReactionSupply(mp);
+
+	spt.m_bzhat = true;
+}
+
+//-----------------------------------------------------------------------------
+void FEMultiphasicSolidDomain::EvaluateReactionSupplyTangents(FEMaterialPoint& mp)
+{
+	EvaluateReactionSupplies(mp);
+
+	FESolutesMaterialPoint& spt = *(mp.ExtractData<FESolutesMaterialPoint>());
+	if (spt.m_bdzhat) return;
+
+	const int nreact = m_pMat->Reactions();
+	const int nsol = m_pMat->Solutes();
+	spt.m_dzhatde.resize(nreact);
+	spt.m_dzhatdc.resize(nreact*nsol);
+	for (int i = 0; i < nreact; ++i)
+	{
+		FEChemicalReaction* reacti = m_pMat->GetReaction(i);
+		spt.m_dzhatde[i] = reacti->Tangent_ReactionSupply_Strain(mp);
+		for (int isol = 0; isol < nsol; ++isol)
+			spt.m_dzhatdc[i*nsol + isol] = reacti->Tangent_ReactionSupply_Concentration(mp, isol);
+	}
+
+	spt.m_bdzhat = true;
+}
@@ -103,6 +103,13 @@ public:
     //! calculates the element triphasic stiffness matrix
     bool ElementMultiphasicStiffnessSS(FESolidElement& el, matrix& ke, bool bsymm);
     
+protected:
+	//! evaluate the chemical reaction supplies of a material point (if not up to date)
+	void EvaluateReactionSupplies(FEMaterialPoint& mp);
+
+	//! evaluate the chemical reaction supplies and their tangents (if not up to date)
+	void EvaluateReactionSupplyTangents(FEMaterialPoint& mp);
+
 protected: // overridden from FEElasticDomain, but not implemented in this domain
     void BodyForce(FEGlobalVector& R, FEBodyForce& bf) override {}
     void InertialForces(FEGlobalVector& R, vector<double>& F) override {}
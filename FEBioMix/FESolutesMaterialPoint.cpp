@@ -46,6 +46,7 @@ FESolutesMaterialPoint::FESolutesMaterialPoint(FEMaterialPointData* ppt) : FEMat
 	m_rhor = 0;
 	m_strain = 0;
 	m_pe = m_pi = 0;
+	m_bzhat = m_bdzhat = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -94,6 +95,10 @@ void FESolutesMaterialPoint::Init()
     m_ide.clear();
     m_idi.clear();
     m_bsb.clear();
+	m_bzhat = m_bdzhat = false;
+	m_zhat.clear();
+	m_dzhatde.clear();
+	m_dzhatdc.clear();
     
 	// don't forget to initialize the base class
 	FEMaterialPointData::Init();
@@ -115,6 +120,9 @@ void FESolutesMaterialPoint::Serialize(DumpStream& ar)
 	ar & m_ce & m_ide;
 	ar & m_ci & m_idi;
 	ar & m_bsb;
+
+	// the reaction supplies are not stored, but must be re-evaluated
+	if (ar.IsLoading()) m_bzhat = m_bdzhat = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -89,5 +89,12 @@ public:
     std::vector<int>     m_ide;      //!< solute IDs on external side
     std::vector<int>     m_idi;      //!< solute IDs on internal side
     std::vector<bool>   m_bsb;  //!< flag indicating that solute is solid-bound
+
+	// chemical reaction supplies (evaluated at most once after each update of the point)
+	bool				m_bzhat;	//!< m_zhat is up to date
+	bool				m_bdzhat;	//!< m_dzhatde and m_dzhatdc are up to date
+	std::vector<double>	m_zhat;		//!< molar supply of each reaction
+	std::vector<mat3ds>	m_dzhatde;	//!< tangent of m_zhat with strain
+	std::vector<double>	m_dzhatdc;	//!< tangent of m_zhat with effective concentration (reaction-major)
 };
 
@@ -128,11 +128,20 @@ bool FEConstrainedLMOptimizeMethod::Solve(FEOptimizeData *pOpt, vector<double>&
 				b[i] = con.b;
 			}
 
-			int ret = dlevmar_blec_dif(objfun, p.data(), q.data(), ma, ndata, lb.data(), ub.data(), A.data(), b.data(), NC, 0, itmax, opts, 0, 0, 0, (void*) this);
+			// When we can solve concurrently, we provide the Jacobian ourselves so that
+			// all forward differences are evaluated as one batch. With a sensitivity 
+			// analysis, the Jacobian is calculated together with the function values.
+			if ((opt.MaxWorkers() > 1) || opt.UseSensitivities())
+				dlevmar_blec_der(objfun, jacfun, p.data(), q.data(), ma, ndata, lb.data(), ub.data(), A.data(), b.data(), NC, 0, itmax, opts, 0, 0, 0, (void*) this);
+			else
+				dlevmar_blec_dif(objfun, p.data(), q.data(), ma, ndata, lb.data(), ub.data(), A.data(), b.data(), NC, 0, itmax, opts, 0, 0, 0, (void*) this);
 		}
 		else
 		{
-			int ret = dlevmar_bc_dif(objfun, p.data(), q.data(), ma, ndata, lb.data(), ub.data(), 0, itmax, opts, 0, 0, 0, (void*) this);
+			if ((opt.MaxWorkers() > 1) || opt.UseSensitivities())
+				dlevmar_bc_der(objfun, jacfun, p.data(), q.data(), ma, ndata, lb.data(), ub.data(), 0, itmax, opts, 0, 0, 0, (void*) this);
+			else
+				dlevmar_bc_dif(objfun, p.data(), q.data(), ma, ndata, lb.data(), ub.data(), 0, itmax, opts, 0, 0, 0, (void*) this);
 		}
 
 		amin.resize(ma);
@@ -159,14 +168,10 @@ bool FEConstrainedLMOptimizeMethod::Solve(FEOptimizeData *pOpt, vector<double>&
 }
 
 //-----------------------------------------------------------------------------
-void FEConstrainedLMOptimizeMethod::ObjFun(double* p, double* hx, int m, int n)
+void FEConstrainedLMOptimizeMethod::ClampParameters(double* p, int m, vector<double>& a, bool blog)
 {
-	// get the optimization data
 	FEOptimizeData& opt = *GetOptimizeData();
-	FEObjectiveFunction& obj = opt.GetObjective();
-
-	// evaluate at a
-	vector<double> a(m);
+	a.resize(m);
 	for (int i = 0; i < m; ++i)
 	{
 		FEInputParameter& var = *opt.GetInputParameter(i);
@@ -178,25 +183,119 @@ void FEConstrainedLMOptimizeMethod::ObjFun(double* p, double* hx, int m, int n)
 	{
 		FEInputParameter& var = *opt.GetInputParameter(i);
 		if (a[i] < var.MinValue()) {
-			feLogEx(opt.GetFEModel(), "Warning: clamping %s to min (was %lg)\n", var.GetName().c_str(), a[i]);
+			if (blog) feLogEx(opt.GetFEModel(), "Warning: clamping %s to min (was %lg)\n", var.GetName().c_str(), a[i]);
 			a[i] = var.MinValue();
 		}
 		else if (a[i] >= var.MaxValue()) {
-			feLogEx(opt.GetFEModel(), "Warning: clamping %s to max (was %lg)\n", var.GetName().c_str(), a[i]);
+			if (blog) feLogEx(opt.GetFEModel(), "Warning: clamping %s to max (was %lg)\n", var.GetName().c_str(), a[i]);
 			a[i] = var.MaxValue();
 		}
 	}
+}
+
+//-----------------------------------------------------------------------------
+void FEConstrainedLMOptimizeMethod::ObjFun(double* p, double* hx, int m, int n)
+{
+	// get the optimization data
+	FEOptimizeData& opt = *GetOptimizeData();
+
+	// evaluate at a
+	vector<double> a;
+	ClampParameters(p, m, a, true);
 
 	// solve the problem
-	if (opt.FESolve(a) == false) throw FEErrorTermination();
+	vector<double> y(n, 0.0);
+	m_dyda.clear();
+	if (opt.UseSensitivities())
+	{
+		// (If the sensitivities are not available, m_dyda is empty and the
+		//  Jacobian is calculated with finite differences.)
+		if (opt.FESolveSensitivity(a, y, m_dyda) == false) throw FEErrorTermination();
+	}
+	else
+	{
+		if (opt.FESolve(a) == false) throw FEErrorTermination();
+
+		// evaluate the measurement vector
+		opt.GetObjective().Evaluate(y);
+	}
 
 	// store the measurement vector
-	vector<double> y(n, 0.0);
-	opt.GetObjective().Evaluate(y);
 	for (int i = 0; i < n; ++i) hx[i] = y[i];
 
 	// store the last calculated values
 	m_yopt = y;
+	m_plast.assign(p, p + m);
+}
+
+//-----------------------------------------------------------------------------
+// Calculates the Jacobian (n x m, row-major) with forward differences, using the
+// same step size as levmar's dif-functions. All perturbed problems are solved as 
+// one batch. The function values at p are usually available from the last call to ObjFun.
+void FEConstrainedLMOptimizeMethod::JacFun(double* p, double* jac, int m, int n)
+{
+	FEOptimizeData& opt = *GetOptimizeData();
+
+	bool bhave = ((int)m_plast.size() == m) && ((int)m_yopt.size() == n);
+	for (int i = 0; bhave && (i < m); ++i) bhave = (m_plast[i] == p[i]);
+
+	// see if we can use the sensitivities
+	if (opt.UseSensitivities())
+	{
+		if (bhave == false)
+		{
+			vector<double> hx(n);
+			ObjFun(p, hx.data(), m, n);
+			bhave = true;
+		}
+
+		if ((int)m_dyda.size() == m)
+		{
+			// the Jacobian is w.r.t. the scaled parameters
+			for (int j = 0; j < m; ++j)
+			{
+				double s = opt.GetInputParameter(j)->ScaleFactor();
+				for (int i = 0; i < n; ++i) jac[i*m + j] = m_dyda[j][i] * s;
+			}
+			return;
+		}
+	}
+
+	// setup the parameters
+	vector<double> pi(p, p + m);
+	vector<double> h(m);
+	vector< vector<double> > A;
+	if (bhave == false)
+	{
+		vector<double> a;
+		ClampParameters(p, m, a, false);
+		A.push_back(a);
+	}
+	for (int j = 0; j < m; ++j)
+	{
+		double d = fabs(1e-4*p[j]);
+		if (d < m_fdiff) d = m_fdiff;
+		h[j] = d;
+
+		pi[j] = p[j] + d;
+		vector<double> a;
+		ClampParameters(pi.data(), m, a, false);
+		A.push_back(a);
+		pi[j] = p[j];
+	}
+
+	// solve all problems
+	vector< vector<double> > Y;
+	vector<double> fobj;
+	if (opt.FESolveBatch(A, Y, fobj) == false) throw FEErrorTermination();
+
+	const vector<double>& y0 = (bhave ? m_yopt : Y[0]);
+	int offset = (bhave ? 0 : 1);
+	for (int j = 0; j < m; ++j)
+	{
+		const vector<double>& y1 = Y[j + offset];
+		for (int i = 0; i < n; ++i) jac[i*m + j] = (y1[i] - y0[i]) / h[j];
+	}
 }
 
 #endif
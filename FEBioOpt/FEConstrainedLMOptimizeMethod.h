@@ -52,6 +52,17 @@ protected:
 		return clm->ObjFun(p, hx, m , n);
 	}
 
+	void JacFun(double* p, double* jac, int m, int n);
+
+	static void jacfun(double* p, double* jac, int m, int n, void* adata) 
+	{ 
+		FEConstrainedLMOptimizeMethod* clm = (FEConstrainedLMOptimizeMethod*)adata;
+		return clm->JacFun(p, jac, m , n);
+	}
+
+	// clamp the (unscaled) parameters to the box constraints
+	void ClampParameters(double* p, int m, vector<double>& a, bool blog);
+
 public:
 	double	m_tau;		// scale factor for mu
 	double	m_objtol;	// objective tolerance
@@ -62,6 +73,8 @@ public:
 
 public:
 	vector<double>	m_yopt;	// optimal y-values
+	vector<double>	m_plast;	// parameters of last call to ObjFun
+	vector< vector<double> >	m_dyda;	// sensitivities of last call to ObjFun (if available)
 
 	DECLARE_FECORE_CLASS();
 };
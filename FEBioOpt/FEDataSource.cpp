@@ -57,6 +57,48 @@ void FEDataSource::Reset()
 	
 }
 
+//=================================================================================================
+void FECurveSensitivity::Init(int nparams, const PointCurve& rf)
+{
+	m_dx.assign(nparams, PointCurve());
+	m_dy.assign(nparams, PointCurve());
+	m_last = -1;
+	for (int i = 0; i < rf.Points(); ++i) Add(rf.Point(i).x());
+}
+
+void FECurveSensitivity::Clear()
+{
+	for (PointCurve& c : m_dx) c.Clear();
+	for (PointCurve& c : m_dy) c.Clear();
+	m_last = -1;
+}
+
+void FECurveSensitivity::Add(double x)
+{
+	for (PointCurve& c : m_dx) m_last = c.Add(x, 0.0);
+	for (PointCurve& c : m_dy) c.Add(x, 0.0);
+}
+
+void FECurveSensitivity::SetLast(int n, double dx, double dy)
+{
+	if ((n < 0) || (n >= (int)m_dy.size()) || (m_last < 0)) return;
+	double x = m_dy[n].Point(m_last).x();
+	m_dx[n].SetPoint(m_last, x, dx);
+	m_dy[n].SetPoint(m_last, x, dy);
+}
+
+double FECurveSensitivity::Evaluate(int n, double x, const PointCurve& rf) const
+{
+	if ((n < 0) || (n >= (int)m_dy.size())) return 0.0;
+
+	// The curve points move in both directions, so we need to correct for the
+	// change in the ordinate.
+	double dy = m_dy[n].value(x);
+	double dx = m_dx[n].value(x);
+	if (dx == 0.0) return dy;
+	return dy - rf.derive(x)*dx;
+}
+
 //=================================================================================================
 bool FEDataParameter::update(FEModel* pmdl, unsigned int nwhen, void* pd)
 {
@@ -78,6 +120,7 @@ void FEDataParameter::update()
 
 	// add the data pair to the loadcurve
 	m_rf.Add(x, y);
+	m_drf.Add(x);
 }
 
 FEDataParameter::FEDataParameter(FEModel* fem) : FEDataSource(fem)
@@ -354,6 +397,7 @@ void FEDataParameter::Reset()
 {
 	// reset the reaction force load curve
 	m_rf.Clear();
+	m_drf.Clear();
 	FEDataSource::Reset();
 }
 
@@ -362,6 +406,28 @@ double FEDataParameter::Evaluate(double x)
 	return m_rf.value(x);
 }
 
+void FEDataParameter::InitSensitivities(int nparams)
+{
+	m_drf.Init(nparams, m_rf);
+}
+
+void FEDataParameter::GetSensitivityData(std::vector<double>& v)
+{
+	v.resize(2);
+	v[0] = m_fx();
+	v[1] = m_fy();
+}
+
+void FEDataParameter::SetSensitivityData(int n, const std::vector<double>& dv)
+{
+	m_drf.SetLast(n, dv[0], dv[1]);
+}
+
+double FEDataParameter::EvaluateSensitivity(int n, double x)
+{
+	return m_drf.Evaluate(n, x, m_rf);
+}
+
 //=================================================================================================
 FEDataFilterPositive::FEDataFilterPositive(FEModel* fem) : FEDataSource(fem)
 {
@@ -397,6 +463,13 @@ double FEDataFilterPositive::Evaluate(double t)
 	return (v >= 0.0 ? v : -v);
 }
 
+double FEDataFilterPositive::EvaluateSensitivity(int n, double t)
+{
+	double v = m_src->Evaluate(t);
+	double dv = m_src->EvaluateSensitivity(n, t);
+	return (v >= 0.0 ? dv : -dv);
+}
+
 
 //=================================================================================================
 FENodeDataFilterSum::FENodeDataFilterSum(FEModel* fem) : FEDataSource(fem)
@@ -435,6 +508,8 @@ void FENodeDataFilterSum::Reset()
 {
 	m_rf.Clear();
 	m_rf.Add(0, 0);
+	m_drf.Clear();
+	m_drf.Add(0);
 }
 
 // evaluate data source at x
@@ -458,6 +533,19 @@ void FENodeDataFilterSum::update()
 	double time = m_fem.GetTime().currentTime;
 
 	FEMesh* mesh = m_nodeSet->GetMesh();
+	double sum = value();
+
+	// evaluate the current reaction force value
+	double x = time;
+	double y = sum;
+
+	// add the data pair to the loadcurve
+	m_rf.Add(x, y);
+	m_drf.Add(x);
+}
+
+double FENodeDataFilterSum::value()
+{
 	FENodeSet& ns = *m_nodeSet;
 	double sum = 0.0;
 	for (int i = 0; i < m_nodeSet->Size(); ++i)
@@ -465,13 +553,28 @@ void FENodeDataFilterSum::update()
 		double vi = m_data->value(*ns.Node(i));
 		sum += vi;
 	}
+	return sum;
+}
 
-	// evaluate the current reaction force value
-	double x = time;
-	double y = sum;
+void FENodeDataFilterSum::InitSensitivities(int nparams)
+{
+	m_drf.Init(nparams, m_rf);
+}
 
-	// add the data pair to the loadcurve
-	m_rf.Add(x, y);
+void FENodeDataFilterSum::GetSensitivityData(std::vector<double>& v)
+{
+	v.assign(1, value());
+}
+
+void FENodeDataFilterSum::SetSensitivityData(int n, const std::vector<double>& dv)
+{
+	// the ordinate is the time, which doesn't depend on the parameters
+	m_drf.SetLast(n, 0.0, dv[0]);
+}
+
+double FENodeDataFilterSum::EvaluateSensitivity(int n, double x)
+{
+	return m_drf.Evaluate(n, x, m_rf);
 }
 
 FEElemDataFilterSum::FEElemDataFilterSum(FEModel* fem) : FEDataSource(fem)
@@ -510,6 +613,8 @@ void FEElemDataFilterSum::Reset()
 {
 	m_rf.Clear();
 	m_rf.Add(0, 0);
+	m_drf.Clear();
+	m_drf.Add(0);
 }
 
 // evaluate data source at x
@@ -533,6 +638,19 @@ void FEElemDataFilterSum::update()
 	double time = m_fem.GetTime().currentTime;
 
 	FEMesh* mesh = m_elemSet->GetMesh();
+	double sum = value();
+
+	// evaluate the current reaction force value
+	double x = time;
+	double y = sum;
+
+	// add the data pair to the loadcurve
+	m_rf.Add(x, y);
+	m_drf.Add(x);
+}
+
+double FEElemDataFilterSum::value()
+{
 	FEElementSet& eset = *m_elemSet;
 	double sum = 0.0;
 	for (int i = 0; i < eset.Elements(); ++i)
@@ -540,11 +658,26 @@ void FEElemDataFilterSum::update()
 		double vi = m_data->value(eset.Element(i));
 		sum += vi;
 	}
+	return sum;
+}
 
-	// evaluate the current reaction force value
-	double x = time;
-	double y = sum;
+void FEElemDataFilterSum::InitSensitivities(int nparams)
+{
+	m_drf.Init(nparams, m_rf);
+}
 
-	// add the data pair to the loadcurve
-	m_rf.Add(x, y);
+void FEElemDataFilterSum::GetSensitivityData(std::vector<double>& v)
+{
+	v.assign(1, value());
+}
+
+void FEElemDataFilterSum::SetSensitivityData(int n, const std::vector<double>& dv)
+{
+	// the ordinate is the time, which doesn't depend on the parameters
+	m_drf.SetLast(n, 0.0, dv[0]);
+}
+
+double FEElemDataFilterSum::EvaluateSensitivity(int n, double x)
+{
+	return m_drf.Evaluate(n, x, m_rf);
 }
@@ -51,10 +51,55 @@ public:
 	// Evaluate source at x
 	virtual double Evaluate(double x) = 0;
 
+public: // sensitivity support (see FEObjectiveFunction)
+	// return true if this data source supports sensitivities
+	virtual bool HasSensitivities() { return false; }
+
+	// prepare for recording the sensitivities of nparams parameters
+	virtual void InitSensitivities(int nparams) {}
+
+	// get the current values of the model data that is recorded
+	virtual void GetSensitivityData(std::vector<double>& v) {}
+
+	// set the derivatives of the data w.r.t. parameter n for the last recorded point
+	virtual void SetSensitivityData(int n, const std::vector<double>& dv) {}
+
+	// evaluate the derivative of the source at x w.r.t. parameter n
+	virtual double EvaluateSensitivity(int n, double x) { return 0.0; }
+
 protected:
 	FEModel&			m_fem;	//!< reference to model
 };
 
+//-------------------------------------------------------------------------------------------------
+// Helper class for data sources that record a curve during the solve. For each parameter, it stores
+// the derivatives of the curve points, which are kept in sync with the points of the curve.
+class FECurveSensitivity
+{
+public:
+	FECurveSensitivity() {}
+
+	// allocate curves for nparams parameters, with a zero derivative for each point of rf
+	void Init(int nparams, const PointCurve& rf);
+
+	// clear all points
+	void Clear();
+
+	// add a point (call when a point is added to the curve)
+	void Add(double x);
+
+	// set the derivatives of the last point
+	void SetLast(int n, double dx, double dy);
+
+	// evaluate the derivative of the curve rf at x w.r.t. parameter n
+	double Evaluate(int n, double x, const PointCurve& rf) const;
+
+private:
+	std::vector<PointCurve>	m_dx;	//!< derivatives of ordinates
+	std::vector<PointCurve>	m_dy;	//!< derivatives of values
+	int						m_last = -1;
+};
+
 //-------------------------------------------------------------------------------------------------
 // The FEDataParameter class is a data source the extracts data from a model parameter. The parameter
 // must be set with SetParameterName before calling Init. 
@@ -82,6 +127,13 @@ public:
 	// evaluate the current value
 	double value() { return m_fy(); }
 
+public:
+	bool HasSensitivities() override { return true; }
+	void InitSensitivities(int nparams) override;
+	void GetSensitivityData(std::vector<double>& v) override;
+	void SetSensitivityData(int n, const std::vector<double>& dv) override;
+	double EvaluateSensitivity(int n, double x) override;
+
 private:
 	static bool update(FEModel* pmdl, unsigned int nwhen, void* pd);
 	void update();
@@ -92,6 +144,7 @@ private:
 	std::function<double()>	m_fx;				//!< pointer to ordinate value
 	std::function<double()>	m_fy;				//!< pointer to variable data
 	PointCurve		m_rf;	//!< reaction force data
+	FECurveSensitivity	m_drf;	//!< sensitivities of reaction force data
 };
 
 //-------------------------------------------------------------------------------------------------
@@ -116,6 +169,13 @@ public:
 	// evaluate data source at x
 	double Evaluate(double x) override;
 
+public:
+	bool HasSensitivities() override { return m_src->HasSensitivities(); }
+	void InitSensitivities(int nparams) override { m_src->InitSensitivities(nparams); }
+	void GetSensitivityData(std::vector<double>& v) override { m_src->GetSensitivityData(v); }
+	void SetSensitivityData(int n, const std::vector<double>& dv) override { m_src->SetSensitivityData(n, dv); }
+	double EvaluateSensitivity(int n, double x) override;
+
 private:
 	FEDataSource*	m_src;
 };
@@ -137,15 +197,24 @@ public:
 	// evaluate data source at x
 	double Evaluate(double x) override;
 
+public:
+	bool HasSensitivities() override { return true; }
+	void InitSensitivities(int nparams) override;
+	void GetSensitivityData(std::vector<double>& v) override;
+	void SetSensitivityData(int n, const std::vector<double>& dv) override;
+	double EvaluateSensitivity(int n, double x) override;
+
 
 private:
 	static bool update(FEModel* pmdl, unsigned int nwhen, void* pd);
 	void update();
+	double value();
 
 private:
 	FELogNodeData*	m_data;
 	FENodeSet*		m_nodeSet;
 	PointCurve		m_rf;
+	FECurveSensitivity	m_drf;
 };
 
 class FEElemDataFilterSum : public FEDataSource
@@ -165,12 +234,21 @@ public:
 	// evaluate data source at x
 	double Evaluate(double x) override;
 
+public:
+	bool HasSensitivities() override { return true; }
+	void InitSensitivities(int nparams) override;
+	void GetSensitivityData(std::vector<double>& v) override;
+	void SetSensitivityData(int n, const std::vector<double>& dv) override;
+	double EvaluateSensitivity(int n, double x) override;
+
 private:
 	static bool update(FEModel* pmdl, unsigned int nwhen, void* pd);
 	void update();
+	double value();
 
 private:
 	FELogElemData*	m_data;
 	FEElementSet*	m_elemSet;
 	PointCurve		m_rf;
+	FECurveSensitivity	m_drf;
 };
@@ -0,0 +1,221 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#include "stdafx.h"
+#include "FEDirectSensitivity.h"
+#include "FEOptimizeData.h"
+#include <FECore/FEModel.h>
+#include <FECore/FEMaterial.h>
+#include <FECore/FEAnalysis.h>
+#include <FECore/FENewtonSolver.h>
+#include <FECore/FEException.h>
+#include <FECore/Callback.h>
+#include <FECore/log.h>
+
+//-----------------------------------------------------------------------------
+FEDirectSensitivity::FEDirectSensitivity(FEModel* fem) : m_fem(fem)
+{
+	m_obj = nullptr;
+	m_eps = 1e-6;
+	m_bcallback = false;
+	m_bactive = false;
+	m_bok = false;
+}
+
+//-----------------------------------------------------------------------------
+void FEDirectSensitivity::SetParameters(const std::vector<FEInputParameter*>& params)
+{
+	m_params = params;
+}
+
+//-----------------------------------------------------------------------------
+void FEDirectSensitivity::SetObjective(FEObjectiveFunction* obj)
+{
+	m_obj = obj;
+}
+
+//-----------------------------------------------------------------------------
+// see if a material or any of its properties has a path-dependent response
+static bool IsPathDependent(FECoreBase* pc)
+{
+	FEMaterial* pm = dynamic_cast<FEMaterial*>(pc);
+	if (pm && pm->IsPathDependent()) return true;
+
+	int NP = pc->Properties();
+	for (int i = 0; i < NP; ++i)
+	{
+		FECoreBase* pi = pc->GetProperty(i);
+		if (pi && IsPathDependent(pi)) return true;
+	}
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+// The sensitivities are calculated from the change in the residual, so this only
+// works for material parameters. Prescribed values are only applied when a time
+// step starts, and load-controlled parameters are overwritten when the load
+// parameters are evaluated.
+static bool HasDirectSensitivity(FEModel* fem, FEInputParameter* var)
+{
+	FEModelParameter* mp = dynamic_cast<FEModelParameter*>(var);
+	if (mp == nullptr) return false;
+
+	FEParam* p = mp->GetParam();
+	if ((p == nullptr) || (dynamic_cast<FEMaterialBase*>(p->parent()) == nullptr)) return false;
+
+	return (fem->GetLoadController(p) == nullptr);
+}
+
+//-----------------------------------------------------------------------------
+bool FEDirectSensitivity::BeginRun()
+{
+	m_bactive = false;
+	m_bok = false;
+	if ((m_obj == nullptr) || (m_obj->HasSensitivities() == false)) return false;
+
+	// The derivatives of history variables are not calculated, so the sensitivities
+	// of path-dependent materials would be wrong.
+	for (int i = 0; i < m_fem->Materials(); ++i)
+	{
+		FEMaterial* pm = m_fem->GetMaterial(i);
+		if (IsPathDependent(pm))
+		{
+			feLogWarningEx(m_fem, "Sensitivities are not supported for path-dependent material %s.", pm->GetName().c_str());
+			return false;
+		}
+	}
+
+	for (FEInputParameter* var : m_params)
+	{
+		if (HasDirectSensitivity(m_fem, var) == false)
+		{
+			feLogWarningEx(m_fem, "Sensitivities are not supported for parameter %s.", var->GetName().c_str());
+			return false;
+		}
+	}
+
+	// The objective registers its callbacks during initialization, so by registering
+	// ours here, we'll be called after the objective has recorded its data.
+	if (m_bcallback == false)
+	{
+		m_fem->AddCallback(callback, CB_MAJOR_ITERS, (void*)this);
+		m_bcallback = true;
+	}
+
+	m_obj->InitSensitivities((int)m_params.size());
+	m_bactive = true;
+	m_bok = true;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+bool FEDirectSensitivity::EndRun()
+{
+	bool bok = (m_bactive && m_bok);
+	m_bactive = false;
+	return bok;
+}
+
+//-----------------------------------------------------------------------------
+bool FEDirectSensitivity::callback(FEModel* fem, unsigned int nwhen, void* pd)
+{
+	FEDirectSensitivity* ds = (FEDirectSensitivity*)pd;
+	if (ds->m_bactive && ds->m_bok)
+	{
+		try {
+			ds->m_bok = ds->Update();
+		}
+		catch (FEException& e)
+		{
+			feLogWarningEx(fem, "Sensitivity analysis failed: %s", e.what());
+			ds->m_bok = false;
+		}
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// calculate the sensitivities at the current converged state
+bool FEDirectSensitivity::Update()
+{
+	FEAnalysis* step = m_fem->GetCurrentStep();
+	if (step == nullptr) return false;
+
+	// only (quasi-)static analyses are path-independent
+	if (step->m_nanalysis != 0) return false;
+
+	FENewtonSolver* solver = dynamic_cast<FENewtonSolver*>(step->GetFESolver());
+	if (solver == nullptr) return false;
+
+	// the stiffness matrix at the converged state is used for all parameters
+	if (solver->FactorStiffness() == false) return false;
+
+	int neq = solver->NumberOfEquations();
+	std::vector<double> R0(neq), R1(neq), du(neq), zero(neq, 0.0);
+
+	// residual and data at converged state
+	solver->Residual(R0);
+	std::vector<double> v0, v1, dv;
+	m_obj->GetSensitivityData(v0);
+
+	int nparams = (int)m_params.size();
+	for (int n = 0; n < nparams; ++n)
+	{
+		FEInputParameter& var = *m_params[n];
+		double a = var.GetValue();
+		double h = m_eps*(fabs(a) + fabs(var.ScaleFactor()));
+
+		// change in residual at the converged solution
+		var.SetValue(a + h);
+		m_fem->Update();
+		solver->Residual(R1);
+		for (int i = 0; i < neq; ++i) R1[i] -= R0[i];
+
+		// solution increment
+		solver->SolveLinearSystem(du, R1);
+
+		// evaluate data at perturbed solution
+		// (reaction forces are evaluated in the residual)
+		solver->UpdateConverged(du);
+		solver->Residual(R1);
+		m_obj->GetSensitivityData(v1);
+
+		int m = (int)v0.size();
+		dv.resize(m);
+		for (int i = 0; i < m; ++i) dv[i] = (v1[i] - v0[i]) / h;
+		m_obj->SetSensitivityData(n, dv);
+
+		// restore converged state
+		var.SetValue(a);
+		solver->UpdateConverged(zero);
+	}
+
+	// this restores the reaction forces
+	solver->Residual(R0);
+
+	return true;
+}
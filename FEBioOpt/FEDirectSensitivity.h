@@ -0,0 +1,88 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#pragma once
+#include <vector>
+
+class FEModel;
+class FEInputParameter;
+class FEObjectiveFunction;
+
+//-----------------------------------------------------------------------------
+//! This class calculates the derivatives of the objective's function values 
+//! with respect to the input parameters with a direct differentiation method,
+//! so that they don't have to be calculated with finite differences, which 
+//! requires a solve of the FE model for each parameter.
+//!
+//! After each converged time step, the stiffness matrix K is factored at the
+//! converged state. The derivative of the solution w.r.t. parameter a then 
+//! follows from K*du/da = dR/da, where dR/da is the change in the residual for 
+//! a small change of the parameter, evaluated at the converged solution. The 
+//! model data that the objective needs is then evaluated at the state u + du 
+//! to obtain its derivatives. 
+//!
+//! This assumes that the response is path-independent (e.g. hyperelastic 
+//! materials in a quasi-static analysis), since the derivatives of any history
+//! variables are not calculated. Therefore, no sensitivities are calculated for 
+//! models with path-dependent materials (see FEMaterial::IsPathDependent) or 
+//! for dynamic analyses, and the caller has to fall back to finite differences.
+//! The same holds for parameters that don't feed directly into the residual,
+//! so only material parameters that are not load-controlled are supported.
+class FEDirectSensitivity
+{
+public:
+	FEDirectSensitivity(FEModel* fem);
+
+	//! Set the parameters and the objective function.
+	void SetParameters(const std::vector<FEInputParameter*>& params);
+	void SetObjective(FEObjectiveFunction* obj);
+
+	//! set the relative size of the parameter perturbations
+	void SetPerturbation(double eps) { m_eps = eps; }
+
+	//! Call this before the model is solved. Returns false if the 
+	//! objective function does not support sensitivities.
+	bool BeginRun();
+
+	//! Call this after the model was solved. Returns false if the sensitivities
+	//! could not be calculated for all time steps.
+	bool EndRun();
+
+private:
+	static bool callback(FEModel* fem, unsigned int nwhen, void* pd);
+	bool Update();
+
+private:
+	FEModel*				m_fem;
+	FEObjectiveFunction*	m_obj;
+	std::vector<FEInputParameter*>	m_params;
+
+	double	m_eps;			//!< relative parameter perturbation
+	bool	m_bcallback;	//!< callback was registered
+	bool	m_bactive;		//!< calculate sensitivities in current run
+	bool	m_bok;			//!< sensitivities were calculated successfully
+};
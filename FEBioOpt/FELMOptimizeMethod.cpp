@@ -196,30 +196,55 @@ void FELMOptimizeMethod::ObjFun(vector<double>& x, vector<double>& a, vector<dou
 		}
 	}
 	
-	// evaluate at a
-	if (opt.FESolve(a) == false) throw FEErrorTermination();
-	
-	opt.GetObjective().Evaluate(y);
-	m_yopt = y;
-
-	// now calculate the derivatives using forward differences
 	int ndata = (int)x.size();
-	vector<double> a1(a);
-	vector<double> y1(ndata);
 	int ma = (int)a.size();
+
+	// with a sensitivity analysis, a single solve gives the derivatives as well
+	bool bhavey = false;
+	if (opt.UseSensitivities())
+	{
+		vector< vector<double> > dy;
+		if (opt.FESolveSensitivity(a, y, dy) == false) throw FEErrorTermination();
+		m_yopt = y;
+		if ((int)dy.size() == ma)
+		{
+			for (int i = 0; i < ma; ++i)
+				for (int j = 0; j < ndata; ++j) dyda[j][i] = dy[i][j];
+			return;
+		}
+
+		// The solution at a is known, so only the perturbations need to be solved.
+		bhavey = true;
+	}
+
+	// We need the solution at a and at a perturbation of each parameter (for the 
+	// forward differences). These are all independent, so we solve them as one batch.
+	int n0 = (bhavey ? 0 : 1);
+	vector< vector<double> > A(ma + n0, a), Y;
+	vector<double> fobj;
 	for (int i=0; i<ma; ++i)
 	{
 		FEInputParameter& var = *opt.GetInputParameter(i);
 
 		double b = var.ScaleFactor();
 
-		a1[i] = a1[i] + dir*m_fdiff*(fabs(b) + fabs(a[i]));
-		assert(a1[i] != a[i]);
+		A[i + n0][i] = a[i] + dir*m_fdiff*(fabs(b) + fabs(a[i]));
+		assert(A[i + n0][i] != a[i]);
+	}
+	if (opt.FESolveBatch(A, Y, fobj) == false) throw FEErrorTermination();
 
-		if (opt.FESolve(a1) == false) throw FEErrorTermination();
-		opt.GetObjective().Evaluate(y1);
-		for (int j=0; j<ndata; ++j) dyda[j][i] = (y1[j] - y[j])/(a1[i] - a[i]);
-		a1[i] = a[i];
+	// evaluate at a
+	if (bhavey == false)
+	{
+		y = Y[0];
+		m_yopt = y;
+	}
+
+	// now calculate the derivatives using forward differences
+	for (int i=0; i<ma; ++i)
+	{
+		const vector<double>& y1 = Y[i + n0];
+		for (int j=0; j<ndata; ++j) dyda[j][i] = (y1[j] - y[j])/(A[i + n0][i] - a[i]);
 	}
 }
 
@@ -70,13 +70,24 @@ double FEObjectiveFunction::Evaluate(vector<double>& y)
 	// evaluate the functions
 	EvaluateFunctions(y);
 
+	return EvaluateObjective(y);
+}
+
+double FEObjectiveFunction::EvaluateObjective(const vector<double>& y)
+{
 	// get the measurement vector
+	int ndata = Measurements();
 	vector<double> y0(ndata);
 	GetMeasurements(y0);
 
 	vector<double> x(ndata);
 	for (int i = 0; i < ndata; ++i) x[i] = i + 1;
 	GetXValues(x);
+	if ((int)x.size() != ndata)
+	{
+		x.resize(ndata);
+		for (int i = 0; i < ndata; ++i) x[i] = i + 1;
+	}
 
 	// evaluate regression coefficient R^2
 	double rsq = RegressionCoefficient(y0, y);
@@ -115,6 +126,28 @@ double FEObjectiveFunction::RegressionCoefficient(const std::vector<double>& y0,
 	return rsq;
 }
 
+void FEObjectiveFunction::InitSensitivities(int nparams)
+{
+	m_dfda.assign(nparams, vector<double>(Measurements(), 0.0));
+}
+
+void FEObjectiveFunction::GetSensitivityData(std::vector<double>& v)
+{
+	v.resize(Measurements());
+	EvaluateFunctions(v);
+}
+
+void FEObjectiveFunction::SetSensitivityData(int n, const std::vector<double>& dv)
+{
+	// the functions are evaluated at the end, so we only need the last time step
+	m_dfda[n] = dv;
+}
+
+void FEObjectiveFunction::EvaluateSensitivities(int n, std::vector<double>& df)
+{
+	df = m_dfda[n];
+}
+
 //=============================================================================
 
 //----------------------------------------------------------------------------
@@ -190,24 +223,58 @@ void FEDataFitObjective::GetMeasurements(vector<double>& y0)
 	for (int i = 0; i<ndata; ++i) y0[i] = m_lc.Point(i).y();
 }
 
+// The x values are those of the measurements, so they are known even if the functions
+// were not evaluated by this process (e.g. when the model was solved by a worker process).
 void FEDataFitObjective::GetXValues(std::vector<double>& x)
 {
-	x = m_x;
+	int ndata = m_lc.Points();
+	x.resize(ndata);
+	for (int i = 0; i<ndata; ++i) x[i] = m_lc.Point(i).x();
 }
 
 //----------------------------------------------------------------------------
 void FEDataFitObjective::EvaluateFunctions(vector<double>& f)
 {
 	int ndata = m_lc.Points();
-	m_x.resize(ndata);
 	for (int i = 0; i<ndata; ++i)
 	{
 		double xi = m_lc.Point(i).x();
-		m_x[i] = xi;
 		f[i] = m_src->Evaluate(xi);
 	}
 }
 
+//----------------------------------------------------------------------------
+bool FEDataFitObjective::HasSensitivities()
+{
+	return m_src->HasSensitivities();
+}
+
+void FEDataFitObjective::InitSensitivities(int nparams)
+{
+	m_src->InitSensitivities(nparams);
+}
+
+void FEDataFitObjective::GetSensitivityData(std::vector<double>& v)
+{
+	m_src->GetSensitivityData(v);
+}
+
+void FEDataFitObjective::SetSensitivityData(int n, const std::vector<double>& dv)
+{
+	m_src->SetSensitivityData(n, dv);
+}
+
+void FEDataFitObjective::EvaluateSensitivities(int n, std::vector<double>& df)
+{
+	int ndata = m_lc.Points();
+	df.resize(ndata);
+	for (int i = 0; i < ndata; ++i)
+	{
+		double xi = m_lc.Point(i).x();
+		df[i] = m_src->EvaluateSensitivity(n, xi);
+	}
+}
+
 //=============================================================================
 
 bool FEMinimizeObjective::ParamFunction::Init()
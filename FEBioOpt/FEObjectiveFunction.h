@@ -69,6 +69,10 @@ public:
 	// evaluate objective function
 	double Evaluate();
 
+	// evaluate the objective function from function values that were 
+	// calculated before (see EvaluateFunctions)
+	double EvaluateObjective(const std::vector<double>& f);
+
 	// print output to screen or not
 	void SetVerbose(bool b) { m_verbose = b; }
 
@@ -94,9 +98,32 @@ public: // These functions need to be implemented by derived classes
 	// get the x values (ignore if not applicable)
 	virtual void GetXValues(std::vector<double>& x) {}
 
+public: // Support for direct sensitivity analysis (see FEDirectSensitivity)
+	// The sensitivity analysis calls GetSensitivityData after each converged time step, once
+	// at the converged state and once at a perturbed state for each parameter, and passes the 
+	// derivatives of that data back via SetSensitivityData. By default, the data are the function
+	// values themselves, which is correct for objectives that evaluate the functions at the end of the run.
+
+	// return true if the objective supports sensitivities
+	virtual bool HasSensitivities() { return true; }
+
+	// prepare for recording the sensitivities of nparams parameters
+	virtual void InitSensitivities(int nparams);
+
+	// collect the model data the function values depend on
+	virtual void GetSensitivityData(std::vector<double>& v);
+
+	// store the derivatives of the data w.r.t. parameter n
+	virtual void SetSensitivityData(int n, const std::vector<double>& dv);
+
+	// evaluate the derivatives of the function values w.r.t. parameter n (i.e. df_i/da_n)
+	virtual void EvaluateSensitivities(int n, std::vector<double>& df);
+
 private:
 	FEModel*	m_fem;
 	bool	m_verbose;		//!< print data flag
+
+	std::vector< std::vector<double> >	m_dfda;	//!< function value derivatives
 };
 
 //=============================================================================
@@ -135,10 +162,16 @@ public:
 
 	void GetXValues(std::vector<double>& x);
 
+public:
+	bool HasSensitivities() override;
+	void InitSensitivities(int nparams) override;
+	void GetSensitivityData(std::vector<double>& v) override;
+	void SetSensitivityData(int n, const std::vector<double>& dv) override;
+	void EvaluateSensitivities(int n, std::vector<double>& df) override;
+
 private:
 	PointCurve			m_lc;		//!< data load curve for evaluating measurements
 	FEDataSource*		m_src;		//!< source for evaluating functions
-	std::vector<double>	m_x;
 };
 
 //=============================================================================
@@ -34,11 +34,21 @@ SOFTWARE.*/
 #include <FECore/FEModel.h>
 #include <FECore/FEAnalysis.h>
 #include <FECore/log.h>
+#include <FECore/FEModelCache.h>
+#include <FECore/AsyncFileWriter.h>
+#include <FECore/sys.h>
+#include <deque>
+#include <stdint.h>
+#ifndef WIN32
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
 //=============================================================================
 
 //-----------------------------------------------------------------------------
 FEModelParameter::FEModelParameter(FEModel* fem) : FEInputParameter(fem)
 {
+	m_param = nullptr;
 	m_pd = 0;
 }
 
@@ -69,6 +79,7 @@ bool FEModelParameter::Init()
 		}
 
 		// store the pointer to the parameter
+		m_param = val.param();
 		m_pd = pd;
 	}
 	else
@@ -98,12 +109,15 @@ bool FEModelParameter::SetValue(double newValue)
 //=============================================================================
 
 //-----------------------------------------------------------------------------
-FEOptimizeData::FEOptimizeData(FEModel* fem) : m_fem(fem)
+FEOptimizeData::FEOptimizeData(FEModel* fem) : m_fem(fem), m_warmStart(fem), m_sens(fem)
 {
 	m_pSolver = 0;
 	m_pTask = 0;
 	m_niter = 0;
 	m_obj = 0;
+	m_maxWorkers = 1;
+	m_bsens = false;
+	m_bsensRun = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -127,6 +141,9 @@ bool FEOptimizeData::Init()
 		m_fem->GetStep(i)->SetPlotLevel(FE_PLOT_NEVER);
 	}
 
+	// The model is solved many times, so we keep the data that only depends on the geometry
+	FEModelCache::Scope cache(true);
+
 	// do the initialization of the task
 	GetFEModel()->BlockLog();
 	if (m_pTask->Init(0) == false) return false;
@@ -146,6 +163,10 @@ bool FEOptimizeData::Init()
 	if (m_obj == 0) return false;
 	if (m_obj->Init() == false) return false;
 
+	// setup sensitivity analysis
+	m_sens.SetParameters(m_Var);
+	m_sens.SetObjective(m_obj);
+
 	return true;
 }
 
@@ -155,6 +176,9 @@ bool FEOptimizeData::Solve()
 	// make sure we have a task that will solve the FE model
 	if (m_pTask == 0) return false;
 
+	// keep the data that only depends on the geometry (see Init)
+	FEModelCache::Scope cache(true);
+
 	// go for it!
 	int NVAR = (int) m_Var.size();
 	vector<double> amin(NVAR, 0.0);
@@ -219,6 +243,71 @@ bool FEOptimizeData::FESolve(const vector<double>& a)
 	// increase iterator counter
 	m_niter++;
 
+	// set the input parameters
+	if (SetInputParameters(a) == false) return false;
+
+	// report the new values
+	LogInputParameters(m_niter);
+
+	// solve the FE problem
+	return RunModel();
+}
+
+//-----------------------------------------------------------------------------
+bool FEOptimizeData::FESolveSensitivity(const vector<double>& a, vector<double>& y, vector< vector<double> >& dyda)
+{
+	dyda.clear();
+
+	// see if the objective supports sensitivities
+	FEObjectiveFunction& obj = GetObjective();
+	if (obj.HasSensitivities() == false)
+	{
+		feLogWarning("The objective function does not support sensitivities. Finite differences will be used.");
+		m_bsens = false;
+		if (FESolve(a) == false) return false;
+		obj.Evaluate(y);
+		return true;
+	}
+
+	// increase iterator counter
+	m_niter++;
+
+	// set the input parameters
+	if (SetInputParameters(a) == false) return false;
+
+	// report the new values
+	LogInputParameters(m_niter);
+
+	// solve the FE problem
+	m_bsensRun = true;
+	bool bret = RunModel();
+	m_bsensRun = false;
+	bool bsens = m_sens.EndRun();
+	if (bret == false) return false;
+
+	// evaluate the functions
+	obj.Evaluate(y);
+
+	// If the sensitivities could not be calculated, they won't be for the next 
+	// parameters either, so we use finite differences from now on.
+	if (bsens == false)
+	{
+		feLogWarning("Sensitivities could not be calculated. Finite differences will be used.");
+		m_bsens = false;
+		return true;
+	}
+
+	// evaluate the derivatives
+	int nvar = InputParameters();
+	dyda.resize(nvar);
+	for (int i = 0; i < nvar; ++i) obj.EvaluateSensitivities(i, dyda[i]);
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+bool FEOptimizeData::SetInputParameters(const vector<double>& a)
+{
 	// reset objective function data
 	FEObjectiveFunction& obj = GetObjective();
 	obj.Reset();
@@ -231,15 +320,27 @@ bool FEOptimizeData::FESolve(const vector<double>& a)
 		FEInputParameter& var = *GetInputParameter(i);
 		var.SetValue(a[i]);
 	}
+	return true;
+}
 
-	// report the new values
-	feLog("\n----- Iteration: %d -----\n", m_niter);
+//-----------------------------------------------------------------------------
+void FEOptimizeData::LogInputParameters(int niter)
+{
+	feLog("\n----- Iteration: %d -----\n", niter);
+	int nvar = InputParameters();
 	for (int i = 0; i<nvar; ++i)
 	{
 		FEInputParameter& var = *GetInputParameter(i);
 		string name = var.GetName();
 		feLog("%-15s = %lg\n", name.c_str(), var.GetValue());
 	}
+}
+
+//-----------------------------------------------------------------------------
+bool FEOptimizeData::RunModel()
+{
+	bool bwarm = m_warmStart.BeginRun();
+	if (m_bsensRun) m_sens.BeginRun();
 
 	// reset the FEM data
 	FEModel& fem = *GetFEModel();
@@ -252,5 +353,182 @@ bool FEOptimizeData::FESolve(const vector<double>& a)
 	bool bret = RunTask();
 	fem.UnBlockLog();
 
+	m_warmStart.EndRun(bret);
+
+	// if a warm start failed, try again with a cold start
+	if (bwarm && (bret == false))
+	{
+		feLog("Warm start failed. Solving again from scratch.\n");
+		m_warmStart.Clear();
+		GetObjective().Reset();
+		return RunModel();
+	}
+
+	return bret;
+}
+
+//-----------------------------------------------------------------------------
+bool FEOptimizeData::FESolveBatch(const vector< vector<double> >& a, vector< vector<double> >& y, vector<double>& fobj)
+{
+	FEObjectiveFunction& obj = GetObjective();
+	int N = (int)a.size();
+	y.assign(N, vector<double>());
+	fobj.assign(N, 0.0);
+
+#ifndef WIN32
+	if ((m_maxWorkers > 1) && (N > 1))
+	{
+		vector<bool> ok(N, false);
+		bool bret = FESolveWorkers(a, y, ok);
+
+		// report the results in the same order as a serial run would
+		for (int i = 0; i < N; ++i)
+		{
+			m_niter++;
+			SetInputParameters(a[i]);
+			LogInputParameters(m_niter);
+			if (ok[i] == false) return false;
+			fobj[i] = obj.EvaluateObjective(y[i]);
+		}
+		return bret;
+	}
+#endif
+
+	for (int i = 0; i < N; ++i)
+	{
+		if (FESolve(a[i]) == false) return false;
+		fobj[i] = obj.Evaluate(y[i]);
+	}
+	return true;
+}
+
+#ifndef WIN32
+//-----------------------------------------------------------------------------
+// Each problem is solved in a child process that is forked from this process,
+// so it works on its own copy of the model. The function values are sent back 
+// through a pipe, followed by the time steps that the warm start recorded, so that
+// the next run can be warm-started from the first problem that converged. 
+// The child processes run single-threaded and don't write any output.
+bool FEOptimizeData::FESolveWorkers(const vector< vector<double> >& a, vector< vector<double> >& y, vector<bool>& ok)
+{
+	FEObjectiveFunction& obj = GetObjective();
+	int N = (int)a.size();
+	int ndata = obj.Measurements();
+
+	// the children inherit our buffers, so make sure they are empty
+	fflush(stdout);
+	fflush(stderr);
+	AsyncFileWriter::FlushAll();
+
+	struct WORKER { pid_t pid; int fd; int index; };
+	std::deque<WORKER> running;
+	int next = 0;
+	int nwarm = N;	// problem that the warm start schedule was taken from
+	bool bret = true;
+	while ((next < N) || (running.empty() == false))
+	{
+		// start as many workers as we're allowed
+		while ((next < N) && ((int)running.size() < m_maxWorkers))
+		{
+			int fd[2];
+			if (pipe(fd) != 0) break;
+
+			pid_t pid = fork();
+			if (pid == 0)
+			{
+				// this is the child process
+				close(fd[0]);
+				AsyncFileWriter::DiscardOutput();
+				omp_set_num_threads(1);
+
+				int32_t n[2] = { -1, 0 };
+				std::vector<double> yi(ndata, 0.0), ws;
+				GetFEModel()->BlockLog();
+				try {
+					if (SetInputParameters(a[next]) && RunModel())
+					{
+						obj.EvaluateFunctions(yi);
+						m_warmStart.GetSchedule(ws);
+						yi.insert(yi.end(), ws.begin(), ws.end());
+						n[0] = ndata;
+						n[1] = (int32_t)ws.size();
+					}
+				}
+				catch (...)
+				{
+					// exceptions must not leave the child process
+					n[0] = -1;
+					n[1] = 0;
+				}
+
+				bool bok = (write(fd[1], n, sizeof(n)) == sizeof(n));
+				const char* pd = (const char*)yi.data();
+				size_t nbytes = (n[0] > 0 ? (n[0] + n[1])*sizeof(double) : 0);
+				while (bok && (nbytes > 0))
+				{
+					ssize_t nw = write(fd[1], pd, nbytes);
+					if (nw <= 0) bok = false;
+					else { pd += nw; nbytes -= nw; }
+				}
+				close(fd[1]);
+				_exit(bok ? 0 : 1);
+			}
+
+			close(fd[1]);
+			if (pid < 0) { close(fd[0]); break; }
+
+			WORKER w = { pid, fd[0], next++ };
+			running.push_back(w);
+		}
+
+		// we couldn't start a new process, so solve this one ourselves
+		if (running.empty())
+		{
+			feLogWarning("Failed to start worker process. Solving serially.");
+			for (; next < N; ++next)
+			{
+				GetFEModel()->BlockLog();
+				ok[next] = (SetInputParameters(a[next]) && RunModel());
+				if (ok[next]) { y[next].resize(ndata); obj.EvaluateFunctions(y[next]); }
+				else bret = false;
+			}
+			break;
+		}
+
+		// collect the results of the oldest worker
+		WORKER w = running.front();
+		running.pop_front();
+
+		int32_t n[2] = { -1, 0 };
+		bool bok = (read(w.fd, n, sizeof(n)) == sizeof(n)) && (n[0] == ndata) && (n[1] >= 0);
+		std::vector<double> yi(bok ? ndata + n[1] : 0, 0.0);
+		char* pd = (char*)yi.data();
+		size_t nbytes = yi.size()*sizeof(double);
+		while (bok && (nbytes > 0))
+		{
+			ssize_t nr = read(w.fd, pd, nbytes);
+			if (nr <= 0) bok = false;
+			else { pd += nr; nbytes -= nr; }
+		}
+		close(w.fd);
+
+		y[w.index].assign(ndata, 0.0);
+		if (bok)
+		{
+			std::copy(yi.begin(), yi.begin() + ndata, y[w.index].begin());
+			if ((n[1] > 0) && (w.index < nwarm))
+			{
+				m_warmStart.SetSchedule(std::vector<double>(yi.begin() + ndata, yi.end()));
+				nwarm = w.index;
+			}
+		}
+
+		int status = 0;
+		waitpid(w.pid, &status, 0);
+		ok[w.index] = bok;
+		if (bok == false) bret = false;
+	}
+
 	return bret;
 }
+#endif
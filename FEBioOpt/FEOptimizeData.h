@@ -30,6 +30,8 @@ SOFTWARE.*/
 #include <FECore/FEModel.h>
 #include <FECore/FECoreTask.h>
 #include "FEObjectiveFunction.h"
+#include "FEWarmStart.h"
+#include "FEDirectSensitivity.h"
 #include <vector>
 #include <string>
 
@@ -102,8 +104,12 @@ public:
 	//! should return false is the passed value is invalid
 	bool SetValue(double newValue);
 
+	//! the model parameter
+	FEParam* GetParam() { return m_param; }
+
 private:
 	string	m_name;		//!< variable name
+	FEParam*	m_param;	//!< the model parameter (can be null)
 	double*	m_pd;		//!< pointer to variable data
 	double	m_val;		//!< value
 };
@@ -141,6 +147,45 @@ public:
 	//! solve the FE problem with a new set of parameters
 	bool FESolve(const std::vector<double>& a);
 
+	//! Solve the FE problem for several sets of parameters. For each set, the function values
+	//! of the objective are returned in y and the objective value in fobj. If more than one 
+	//! worker is allowed, the problems are solved concurrently in separate worker processes.
+	bool FESolveBatch(const std::vector< std::vector<double> >& a, std::vector< std::vector<double> >& y, std::vector<double>& fobj);
+
+	//! set the max number of concurrent solves (in worker processes)
+	void SetMaxWorkers(int n) { m_maxWorkers = n; }
+
+	//! get the max number of concurrent solves
+	int MaxWorkers() const { return m_maxWorkers; }
+
+	//! start each solve with the time steps of the previous converged solve
+	void SetWarmStart(bool b) { m_warmStart.Enable(b); }
+
+	//! Solve the FE problem with a new set of parameters, evaluate the function values y, and 
+	//! calculate their derivatives (dyda[i][j] = dy_j/da_i) with a direct sensitivity analysis. 
+	//! Returns false if the problem could not be solved. If the sensitivities could not be 
+	//! calculated, dyda is empty and sensitivities are turned off (see UseSensitivities).
+	bool FESolveSensitivity(const std::vector<double>& a, std::vector<double>& y, std::vector< std::vector<double> >& dyda);
+
+	//! use sensitivity analysis instead of finite differences for the derivatives of the function values
+	void SetUseSensitivities(bool b) { m_bsens = b; }
+
+	//! see if sensitivity analysis should be used
+	bool UseSensitivities() const { return m_bsens; }
+
+private:
+	//! set the input parameters
+	bool SetInputParameters(const std::vector<double>& a);
+
+	//! report the values of the input parameters
+	void LogInputParameters(int niter);
+
+	//! reset and solve the FE model
+	bool RunModel();
+
+	//! solve the FE problems in forked worker processes
+	bool FESolveWorkers(const std::vector< std::vector<double> >& a, std::vector< std::vector<double> >& y, std::vector<bool>& ok);
+
 public:
 	// return the number of input parameters
 	int InputParameters() { return (int)m_Var.size(); }
@@ -183,6 +228,14 @@ protected:
 
 	FEOptimizeMethod*	m_pSolver;
 
+	int		m_maxWorkers;	//!< max nr of concurrent solves
+
+	FEWarmStart	m_warmStart;	//!< replays time steps of previous solve
+
+	bool				m_bsens;		//!< use sensitivity analysis
+	bool				m_bsensRun;		//!< calculate sensitivities during next run
+	FEDirectSensitivity	m_sens;			//!< calculates sensitivities
+
 	std::vector<FEInputParameter*>	    m_Var;
 	std::vector<OPT_LIN_CONSTRAINT>		m_LinCon;
 };
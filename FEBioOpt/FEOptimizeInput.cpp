@@ -151,6 +151,28 @@ void FEOptimizeInput::ParseOptions(XMLTag& tag)
 						else throw XMLReader::InvalidValue(tag);
 					}
 				}
+				else if (tag == "max_workers")
+				{
+					// max nr of forward problems that are solved concurrently
+					int n = 1;
+					tag.value(n);
+					if (n < 1) throw XMLReader::InvalidValue(tag);
+					m_opt->SetMaxWorkers(n);
+				}
+				else if (tag == "warm_start")
+				{
+					// reuse the time steps of the previous solve
+					bool b = false;
+					tag.value(b);
+					m_opt->SetWarmStart(b);
+				}
+				else if (tag == "sensitivity")
+				{
+					// use sensitivity analysis for derivatives
+					bool b = false;
+					tag.value(b);
+					m_opt->SetUseSensitivities(b);
+				}
 				else throw XMLReader::InvalidTag(tag);
 			}
 			++tag;
@@ -29,6 +29,7 @@ SOFTWARE.*/
 #include <FECore/FEModel.h>
 #include <FECore/FEAnalysis.h>
 #include <FECore/log.h>
+#include <FECore/FEModelCache.h>
 
 FESweepParam::FESweepParam()
 {
@@ -59,7 +60,7 @@ void FESweepParam::SetValue(double v)
 	*m_pd = v;
 }
 
-FEParameterSweep::FEParameterSweep(FEModel* fem) : FECoreTask(fem)
+FEParameterSweep::FEParameterSweep(FEModel* fem) : FECoreTask(fem), m_warmStart(fem)
 {
 	m_niter = 0;
 }
@@ -70,6 +71,9 @@ bool FEParameterSweep::Init(const char* szfile)
 	// read the control file
 	if (Input(szfile) == false) return false;
 
+	// The model is solved many times, so we keep the data that only depends on the geometry
+	FEModelCache::Scope cache(true);
+
 	// initialize the model
 	if (GetFEModel()->Init() == false) return false;
 
@@ -163,6 +167,12 @@ bool FEParameterSweep::Input(const char* szfile)
 			// looks good, so throw it on the pile
 			m_params.push_back(p);
 		}
+		else if (tag == "warm_start")
+		{
+			bool b = false;
+			tag.value(b);
+			m_warmStart.Enable(b);
+		}
 		else throw XMLReader::InvalidTag(tag);
 		++tag;
 	} while (!tag.isend());
@@ -176,6 +186,9 @@ bool FEParameterSweep::Input(const char* szfile)
 //! Run the optimization module
 bool FEParameterSweep::Run()
 {
+	// keep the data that only depends on the geometry (see Init)
+	FEModelCache::Scope cache(true);
+
 	size_t ma = m_params.size();
 	vector<double> a(ma);
 	for (size_t i = 0; i<ma; ++i)
@@ -225,6 +238,7 @@ bool FEParameterSweep::FESolve(const vector<double>& a)
 
 	// reset the FEM data
 	FEModel& fem = *GetFEModel();
+	bool bwarm = m_warmStart.BeginRun();
 	fem.BlockLog();
 
 	// reset model
@@ -234,6 +248,20 @@ bool FEParameterSweep::FESolve(const vector<double>& a)
 	bool bret = fem.Solve();
 
 	fem.UnBlockLog();
+	m_warmStart.EndRun(bret);
+
+	// if a warm start failed, try again with a cold start
+	if (bwarm && (bret == false))
+	{
+		feLog("Warm start failed. Solving again from scratch.\n");
+		m_warmStart.Clear();
+		m_warmStart.BeginRun();
+		fem.BlockLog();
+		fem.Reset();
+		bret = fem.Solve();
+		fem.UnBlockLog();
+		m_warmStart.EndRun(bret);
+	}
 
 	return bret;
 }
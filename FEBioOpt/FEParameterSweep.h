@@ -26,6 +26,7 @@ SOFTWARE.*/
 
 #pragma once
 #include <FECore/FECoreTask.h>
+#include "FEWarmStart.h"
 
 // This class represents a parameter that will be swept
 class FESweepParam
@@ -64,4 +65,5 @@ private:
 private:
 	vector<FESweepParam>	m_params;
 	int						m_niter;
+	FEWarmStart				m_warmStart;	//!< replays time steps of previous solve
 };
@@ -0,0 +1,163 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#include "stdafx.h"
+#include "FEWarmStart.h"
+#include <FECore/FEModel.h>
+#include <FECore/FEAnalysis.h>
+#include <FECore/FETimeStepController.h>
+#include <FECore/Callback.h>
+
+//-----------------------------------------------------------------------------
+FEWarmStart::FEWarmStart(FEModel* fem) : m_fem(fem)
+{
+	m_benable = false;
+	m_bcallback = false;
+	m_breplay = false;
+}
+
+//-----------------------------------------------------------------------------
+void FEWarmStart::Enable(bool b)
+{
+	m_benable = b;
+	if (b && (m_bcallback == false))
+	{
+		m_fem->AddCallback(callback, CB_UPDATE_TIME | CB_MAJOR_ITERS | CB_TIMESTEP_FAILED, (void*)this);
+		m_bcallback = true;
+	}
+	if (b == false) Clear();
+}
+
+//-----------------------------------------------------------------------------
+void FEWarmStart::Clear()
+{
+	m_schedule.clear();
+	m_record.clear();
+	m_breplay = false;
+}
+
+//-----------------------------------------------------------------------------
+// The schedule is packed as the nr of steps, followed by the nr of time steps 
+// and the time step sizes of each step.
+void FEWarmStart::GetSchedule(std::vector<double>& d) const
+{
+	d.clear();
+	if (m_schedule.empty()) return;
+	d.push_back((double)m_schedule.size());
+	for (const std::vector<double>& dt : m_schedule)
+	{
+		d.push_back((double)dt.size());
+		d.insert(d.end(), dt.begin(), dt.end());
+	}
+}
+
+//-----------------------------------------------------------------------------
+void FEWarmStart::SetSchedule(const std::vector<double>& d)
+{
+	m_schedule.clear();
+	if (d.empty()) return;
+
+	size_t nsteps = (size_t)d[0];
+	size_t i = 1;
+	m_schedule.resize(nsteps);
+	for (size_t n = 0; n < nsteps; ++n)
+	{
+		size_t ndt = (i < d.size() ? (size_t)d[i++] : 0);
+		if (i + ndt > d.size()) { m_schedule.clear(); return; }
+		m_schedule[n].assign(d.begin() + i, d.begin() + i + ndt);
+		i += ndt;
+	}
+}
+
+//-----------------------------------------------------------------------------
+bool FEWarmStart::BeginRun()
+{
+	m_record.clear();
+	m_breplay = (m_benable && (m_schedule.empty() == false));
+	return m_breplay;
+}
+
+//-----------------------------------------------------------------------------
+void FEWarmStart::EndRun(bool bconverged)
+{
+	// only keep time steps that led to a converged solution
+	if (m_benable && bconverged) m_schedule = m_record;
+	m_record.clear();
+	m_breplay = false;
+}
+
+//-----------------------------------------------------------------------------
+bool FEWarmStart::callback(FEModel* fem, unsigned int nwhen, void* pd)
+{
+	FEWarmStart* ws = (FEWarmStart*)pd;
+	if (ws->m_benable == false) return true;
+
+	switch (nwhen)
+	{
+	case CB_UPDATE_TIME: ws->OnUpdateTime(); break;
+	case CB_MAJOR_ITERS: ws->OnConverged(); break;
+	case CB_TIMESTEP_FAILED: ws->m_breplay = false; break;
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// set the time step size for the next time step
+void FEWarmStart::OnUpdateTime()
+{
+	if (m_breplay == false) return;
+
+	int nstep = m_fem->GetCurrentStepIndex();
+	FEAnalysis* step = m_fem->GetCurrentStep();
+	if ((step == nullptr) || (nstep < 0) || (nstep >= (int)m_schedule.size())) return;
+
+	// The time stepper needs to control steps with must-points, since it
+	// decides which time steps are must-points.
+	FETimeStepController* tc = step->m_timeController;
+	if (tc && (tc->m_must_points.empty() == false)) return;
+
+	const std::vector<double>& dt = m_schedule[nstep];
+	int n = step->m_ntimesteps;
+	if ((n < (int)dt.size()) && (dt[n] > 0.0)) step->m_dt = dt[n];
+}
+
+//-----------------------------------------------------------------------------
+// record the size of a converged time step
+void FEWarmStart::OnConverged()
+{
+	int nstep = m_fem->GetCurrentStepIndex();
+	FEAnalysis* step = m_fem->GetCurrentStep();
+	if ((step == nullptr) || (nstep < 0)) return;
+	if (nstep >= (int)m_record.size()) m_record.resize(nstep + 1);
+
+	// m_ntimesteps was already incremented
+	std::vector<double>& dt = m_record[nstep];
+	int n = step->m_ntimesteps - 1;
+	if (n < 0) return;
+	if (n >= (int)dt.size()) dt.resize(n + 1, 0.0);
+	dt[n] = m_fem->GetTime().timeIncrement;
+}
@@ -0,0 +1,77 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#pragma once
+#include <vector>
+
+class FEModel;
+
+//-----------------------------------------------------------------------------
+//! This class records the time step sizes of a converged run of the model and 
+//! replays them in the next run. This is used when the same model is solved many
+//! times for slightly different parameters (optimization, parameter sweeps), so
+//! that the next run doesn't have to rediscover the time step sizes that work.
+//! If a time step fails during a replay, the time stepper takes over again.
+class FEWarmStart
+{
+public:
+	FEWarmStart(FEModel* fem);
+
+	//! Enable or disable warm starts.
+	void Enable(bool b);
+
+	//! see if warm starts are enabled
+	bool IsEnabled() const { return m_benable; }
+
+	//! Call this before each run. Returns true if the run will be warm-started.
+	bool BeginRun();
+
+	//! Call this after each run with the return value of the run.
+	void EndRun(bool bconverged);
+
+	//! Forget the recorded time steps
+	void Clear();
+
+	//! Get or set the recorded time steps, packed into one array. This is used to 
+	//! pass the recording of a run in a worker process back to the main process.
+	void GetSchedule(std::vector<double>& d) const;
+	void SetSchedule(const std::vector<double>& d);
+
+private:
+	static bool callback(FEModel* fem, unsigned int nwhen, void* pd);
+	void OnUpdateTime();
+	void OnConverged();
+
+private:
+	FEModel*	m_fem;
+	bool		m_benable;
+	bool		m_bcallback;	//!< callback was registered
+	bool		m_breplay;		//!< replay the time steps during the current run
+
+	std::vector< std::vector<double> >	m_schedule;	//!< time steps (per analysis step) of last converged run
+	std::vector< std::vector<double> >	m_record;	//!< time steps of the current run
+};
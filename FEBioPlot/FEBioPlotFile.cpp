@@ -57,6 +57,7 @@ FEBioPlotFile::DICTIONARY_ITEM::DICTIONARY_ITEM(const FEBioPlotFile::DICTIONARY_
 	m_arrayNames = item.m_arrayNames;
 	m_szname[0] = 0;
 	m_szunit[0] = 0;
+	m_enc = item.m_enc;
 	if (item.m_szname[0]) strcpy(m_szname, item.m_szname);
 	if (item.m_szunit[0]) strcpy(m_szunit, item.m_szunit);
 }
@@ -446,6 +447,7 @@ bool FEBioPlotFile::Dictionary::AddGlobalVariable(FEPlotData* ps, const char* sz
 			strcpy(it.m_szunit, ps->GetUnits());
 		}
 		m_Glob.push_back(it);
+		m_last = &m_Glob.back();
 		return true;
 	}
 	return false;
@@ -475,6 +477,7 @@ bool FEBioPlotFile::Dictionary::AddNodalVariable(FEPlotData* ps, const char* szn
 			strcpy(it.m_szunit, ps->GetUnits());
 		}
 		m_Node.push_back(it);
+		m_last = &m_Node.back();
 		return true;
 	}
 	return false;
@@ -498,6 +501,7 @@ bool FEBioPlotFile::Dictionary::AddDomainVariable(FEPlotData* ps, const char* sz
 			strcpy(it.m_szunit, ps->GetUnits());
 		}
 		m_Elem.push_back(it);
+		m_last = &m_Elem.back();
 		return true;
 	}
 	return false;
@@ -521,6 +525,7 @@ bool FEBioPlotFile::Dictionary::AddSurfaceVariable(FEPlotData* ps, const char* s
 			strcpy(it.m_szunit, ps->GetUnits());
 		}
 		m_Face.push_back(it);
+		m_last = &m_Face.back();
 		return true;
 	}
 	return false;
@@ -564,6 +569,8 @@ void FEBioPlotFile::Dictionary::Defaults(FEModel& fem)
 //-----------------------------------------------------------------------------
 void FEBioPlotFile::Dictionary::Clear()
 {
+	m_last = nullptr;
+
 	list<DICTIONARY_ITEM>::iterator it = m_Glob.begin();
 	for (int i = 0; i < (int)m_Glob.size(); ++i, ++it) delete it->m_psave;
 	m_Glob.clear();
@@ -613,6 +620,51 @@ FEBioPlotFile::FEBioPlotFile(FEModel* fem) : PlotFile(fem)
 	m_meshesWritten = 0;
 	m_exportUnitsFlag = false;
 	m_exportErodedElements = true;
+	m_encoder = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+FEBioPlotFile::~FEBioPlotFile()
+{
+	for (auto& it : m_encoders) delete it.second;
+	m_encoders.clear();
+}
+
+//-----------------------------------------------------------------------------
+PlotFieldEncoder* FEBioPlotFile::GetEncoder(DICTIONARY_ITEM& it)
+{
+	if (it.m_enc.IsEncoded() == false) return nullptr;
+	auto p = m_encoders.find(&it);
+	if (p != m_encoders.end()) return p->second;
+	PlotFieldEncoder* enc = new PlotFieldEncoder(it.m_enc);
+	m_encoders[&it] = enc;
+	return enc;
+}
+
+//-----------------------------------------------------------------------------
+bool FEBioPlotFile::HasEncodedVariables()
+{
+	PlotFile::Dictionary& dic = GetDictionary();
+	list<DICTIONARY_ITEM>* l[] = { &dic.GlobalVariableList(), &dic.NodalVariableList(), &dic.DomainVariableList(), &dic.SurfaceVariableList() };
+	for (auto pl : l)
+	{
+		for (DICTIONARY_ITEM& it : *pl) if (it.m_enc.IsEncoded()) return true;
+	}
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+// Write the data of one region. If the variable is encoded, the data is 
+// written as an encoded record (see PlotFieldEncoder).
+void FEBioPlotFile::WriteFieldData(int nid, std::vector<float>& a)
+{
+	if (m_encoder == nullptr) m_ar.WriteData(nid, a);
+	else
+	{
+		std::vector<unsigned char> buf;
+		m_encoder->Encode(nid, a, buf);
+		m_ar.WriteChunk(nid, buf);
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -683,12 +735,66 @@ bool FEBioPlotFile::IsValid() const
 //-----------------------------------------------------------------------------
 void FEBioPlotFile::Close()
 {
+	if ((m_ncompress == FILESTREAM_COMPRESS_BLOCKS) && m_ar.IsValid()) WriteStateIndex();
 	m_ar.Close();
+	m_stateIndex.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Write the state index at the end of the file. 
+void FEBioPlotFile::WriteStateIndex()
+{
+	if (m_stateIndex.empty()) return;
+
+	STATE_INDEX_TRAILER trailer;
+	trailer.states = (unsigned int)m_stateIndex.size();
+	trailer.indexSize = (unsigned int)(6 * sizeof(unsigned int) + m_stateIndex.size() * sizeof(STATE_INDEX_ENTRY) + sizeof(STATE_INDEX_TRAILER));
+	trailer.magic = PLT_INDEX_MAGIC;
+
+	// the index is not compressed so that readers can find it
+	m_ar.SetCompression(0);
+	m_ar.BeginChunk(PLT_STATE_INDEX);
+	{
+		m_ar.WriteChunk(PLT_STATE_INDEX_DATA, m_stateIndex);
+		m_ar.WriteChunk(PLT_STATE_INDEX_TRAILER, trailer);
+	}
+	m_ar.EndChunk();
+}
+
+//-----------------------------------------------------------------------------
+// Read the state index from the end of the file (if present). This is used when 
+// appending, so that the new index will also contain the states of the previous run.
+bool FEBioPlotFile::ReadStateIndex()
+{
+	m_stateIndex.clear();
+
+	STATE_INDEX_TRAILER trailer;
+	m_ar.Seek(-(long long)sizeof(STATE_INDEX_TRAILER), SEEK_END);
+	if (m_ar.read((char*)&trailer, sizeof(STATE_INDEX_TRAILER)) != IO_OK) return false;
+	if (trailer.magic != PLT_INDEX_MAGIC) return false;
+
+	m_ar.Seek(-(long long)trailer.indexSize, SEEK_END);
+	unsigned int nid = 0, nsize = 0;
+	m_ar.read(nid); m_ar.read(nsize);
+	if (nid != PLT_STATE_INDEX) return false;
+	m_ar.read(nid); m_ar.read(nsize);
+	if ((nid != PLT_STATE_INDEX_DATA) || (nsize != trailer.states * sizeof(STATE_INDEX_ENTRY))) return false;
+
+	m_stateIndex.resize(trailer.states);
+	if ((trailer.states > 0) && (m_ar.read((char*)m_stateIndex.data(), nsize) != IO_OK))
+	{
+		m_stateIndex.clear();
+		return false;
+	}
+	return true;
 }
 
 //-----------------------------------------------------------------------------
 void FEBioPlotFile::Clear()
 {
+	for (auto& it : m_encoders) delete it.second;
+	m_encoders.clear();
+
 	PlotFile::Dictionary& dic = GetDictionary();
 	dic.Clear();
 	m_Surf.clear();
@@ -702,6 +808,7 @@ bool FEBioPlotFile::Open(const char *szfile)
 	FEModel* fem = GetFEModel();
 
 	m_meshesWritten = 0;
+	m_stateIndex.clear();
 
 	// open the archive
 	m_ar.Create(szfile);
@@ -760,6 +867,7 @@ bool FEBioPlotFile::WriteHeader(FEModel& fem)
 {
 	// setup the header
 	unsigned int nversion = PLT_VERSION;
+	if ((m_ncompress == FILESTREAM_COMPRESS_BLOCKS) || HasEncodedVariables()) nversion = PLT_VERSION_EXT;
 
 	// output header
 	m_ar.WriteChunk(PLT_HDR_VERSION, nversion);
@@ -873,6 +981,12 @@ void FEBioPlotFile::WriteDictionaryItem(DICTIONARY_ITEM& it)
 	{
 		m_ar.WriteChunk(PLT_DIC_ITEM_UNITS, it.m_szunit, STR_SIZE);
 	}
+
+	if (it.m_enc.IsEncoded())
+	{
+		unsigned int flags = (unsigned int)it.m_enc.m_flags;
+		m_ar.WriteChunk(PLT_DIC_ITEM_ENCODING, flags);
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -1580,6 +1694,9 @@ bool FEBioPlotFile::Write(float ftime, int flag)
 	FEModel& fem = *GetFEModel();
 	PlotFile::Dictionary& dic = GetDictionary();
 
+	// record where this state starts (for the state index)
+	long long stateOffset = m_ar.Tell();
+
 	// compress these sections if requested
 	m_ar.SetCompression(m_ncompress);
 	m_ar.BeginChunk(PLT_STATE);
@@ -1654,6 +1771,17 @@ bool FEBioPlotFile::Write(float ftime, int flag)
 	}
 	m_ar.EndChunk();
 
+	// add the state to the index
+	if (m_ncompress == FILESTREAM_COMPRESS_BLOCKS)
+	{
+		STATE_INDEX_ENTRY e;
+		e.time = ftime;
+		e.status = flag;
+		e.offset = stateOffset;
+		e.size = m_ar.Tell() - stateOffset;
+		m_stateIndex.push_back(e);
+	}
+
 	return true;
 }
 
@@ -1671,7 +1799,12 @@ void FEBioPlotFile::WriteGlobalData(FEModel& fem)
 			m_ar.WriteChunk(PLT_STATE_VAR_ID, nid);
 			m_ar.BeginChunk(PLT_STATE_VAR_DATA);
 			{
-				if (it->m_psave) WriteGlobalDataField(fem, it->m_psave);
+				if (it->m_psave)
+				{
+					m_encoder = GetEncoder(*it);
+					WriteGlobalDataField(fem, it->m_psave);
+					m_encoder = nullptr;
+				}
 			}
 			m_ar.EndChunk();
 		}
@@ -1693,7 +1826,12 @@ void FEBioPlotFile::WriteNodeData(FEModel& fem)
 			m_ar.WriteChunk(PLT_STATE_VAR_ID, nid);
 			m_ar.BeginChunk(PLT_STATE_VAR_DATA);
 			{
-				if (it->m_psave) WriteNodeDataField(fem, it->m_psave);
+				if (it->m_psave)
+				{
+					m_encoder = GetEncoder(*it);
+					WriteNodeDataField(fem, it->m_psave);
+					m_encoder = nullptr;
+				}
 			}
 			m_ar.EndChunk();
 		}
@@ -1715,7 +1853,12 @@ void FEBioPlotFile::WriteDomainData(FEModel& fem)
 			m_ar.WriteChunk(PLT_STATE_VAR_ID, nid);
 			m_ar.BeginChunk(PLT_STATE_VAR_DATA);
 			{
-				if (it->m_psave) WriteDomainDataField(fem, it->m_psave);
+				if (it->m_psave)
+				{
+					m_encoder = GetEncoder(*it);
+					WriteDomainDataField(fem, it->m_psave);
+					m_encoder = nullptr;
+				}
 			}
 			m_ar.EndChunk();
 		}
@@ -1737,7 +1880,12 @@ void FEBioPlotFile::WriteSurfaceData(FEModel& fem)
 			m_ar.WriteChunk(PLT_STATE_VAR_ID, nid);
 			m_ar.BeginChunk(PLT_STATE_VAR_DATA);
 			{
-				if (it->m_psave) WriteSurfaceDataField(fem, it->m_psave);
+				if (it->m_psave)
+				{
+					m_encoder = GetEncoder(*it);
+					WriteSurfaceDataField(fem, it->m_psave);
+					m_encoder = nullptr;
+				}
 			}
 			m_ar.EndChunk();
 		}
@@ -1755,7 +1903,7 @@ void FEBioPlotFile::WriteGlobalDataField(FEModel& fem, FEPlotData* pd)
 		// pad mismatches
 		assert(a.size() == ndata);
 		if (a.size() != ndata) a.resize(ndata, 0.f);
-		m_ar.WriteData(0, a.data());
+		WriteFieldData(0, a.data());
 	}
 }
 
@@ -1774,7 +1922,7 @@ void FEBioPlotFile::WriteNodeDataField(FEModel &fem, FEPlotData* pd)
 		// pad mismatches
 		assert(a.size() == N*ndata);
 		if (a.size() != N * ndata) a.resize(N*ndata, 0.f);
-		m_ar.WriteData(0, a.data());
+		WriteFieldData(0, a.data());
 	}
 }
 
@@ -1830,7 +1978,7 @@ void FEBioPlotFile::WriteSurfaceDataField(FEModel& fem, FEPlotData* pd)
 					if (a.size() == nsize)
 					{
 						// assumed padding is already there, or not needed
-						m_ar.WriteData(i + 1, a.data());
+						WriteFieldData(i + 1, a.data());
 					}
 					else
 					{
@@ -1852,7 +2000,7 @@ void FEBioPlotFile::WriteSurfaceDataField(FEModel& fem, FEPlotData* pd)
 						}
 
 						// write the padded data
-						m_ar.WriteData(i + 1, b.data());
+						WriteFieldData(i + 1, b.data());
 					}
 				}
 			}
@@ -1923,7 +2071,7 @@ void FEBioPlotFile::WriteDomainDataField(FEModel &fem, FEPlotData* pd)
 			if (pd->Save(D, a))
 			{
 				assert(a.size() == nsize);
-				m_ar.WriteData(item[i] + 1, a.data());
+				WriteFieldData(item[i] + 1, a.data());
 			}
 		}
 	}
@@ -1939,15 +2087,18 @@ bool FEBioPlotFile::Append(const char *szfile)
 	FEPlotDataStore& pltData = fem->GetPlotDataStore();
 	SetCompression(pltData.GetPlotCompression());
 
+	// pick up the state index of the previous run
+	m_stateIndex.clear();
+	if (m_ncompress == FILESTREAM_COMPRESS_BLOCKS) ReadStateIndex();
+
 	// add plot variables
 	for (int n = 0; n < pltData.PlotVariables(); ++n)
 	{
 		FEPlotVariable& vi = pltData.GetPlotVariable(n);
 		const std::string& varName = vi.Name();
-		const std::string& domName = vi.DomainName();
 
 		// add the plot output variable
-		if (AddVariable(varName.c_str(), vi.m_item, domName.c_str()) == false)
+		if (AddVariable(vi) == false)
 		{
 			feLog("FATAL ERROR: Output variable \"%s\" is not defined\n", varName.c_str());
 			throw "FATAL ERROR";
@@ -29,12 +29,14 @@ SOFTWARE.*/
 #pragma once
 #include "PlotFile.h"
 #include "PltArchive.h"
+#include "PlotFieldEncoder.h"
 #include "FECore/FESolidDomain.h"
 #include "FECore/FEShellDomain.h"
 #include "FECore/FEBeamDomain.h"
 #include "FECore/FEDiscreteDomain.h"
 #include "FECore/FEDomain2D.h"
 #include <list>
+#include <map>
 
 //-----------------------------------------------------------------------------
 //! This class implements the facilities to export FE data in the FEBio
@@ -47,7 +49,9 @@ public:
 	// 3.2: added PLT_ELEMENTSET_SECTION
 	// 3.3: node IDs are now stored in Node Section
 	// 3.4: added PLT_ELEM_LINE3
-	enum { PLT_VERSION = 0x0034 };
+	// 3.5: added block compression (compression = 2), PLT_STATE_INDEX and encoded variables (PLT_DIC_ITEM_ENCODING)
+	//      (only written when one of these features is used, otherwise the file is a 3.4 file)
+	enum { PLT_VERSION = 0x0034, PLT_VERSION_EXT = 0x0035 };
 
 	// file tags
 	enum { 
@@ -68,6 +72,7 @@ public:
 			PLT_DIC_ITEM_ARRAYSIZE		= 0x01020005,	// added in version 0x05
 			PLT_DIC_ITEM_ARRAYNAME		= 0x01020006,	// added in version 0x05
 			PLT_DIC_ITEM_UNITS			= 0x01020007,	// added in version 4.0
+			PLT_DIC_ITEM_ENCODING		= 0x01020008,	// added in version 3.5 (see PlotFieldEncoder)
 			PLT_DIC_GLOBAL				= 0x01021000,
 //			PLT_DIC_MATERIAL			= 0x01022000,	// this was removed
 			PLT_DIC_NODAL				= 0x01023000,
@@ -163,8 +168,33 @@ public:
 				PLT_FACE_DATA			= 0x02020500,
 			PLT_MESH_STATE				= 0x02030000,
 				PLT_ELEMENT_STATE		= 0x02030001,
-			PLT_OBJECTS_STATE			= 0x02040000
+			PLT_OBJECTS_STATE			= 0x02040000,
+
+		PLT_STATE_INDEX					= 0x03000000,	// new in 3.5
+			PLT_STATE_INDEX_DATA		= 0x03000001,
+			PLT_STATE_INDEX_TRAILER		= 0x03000002
+	};
+
+	// Entry of the state index. The index is written (uncompressed) at the end of 
+	// block compressed files so that readers can seek directly to a state.
+	struct STATE_INDEX_ENTRY
+	{
+		float		time;		// state time
+		int			status;		// state status flag
+		long long	offset;		// file offset of the state's block frame
+		long long	size;		// size (in bytes) of the state's block frame
+	};
+
+	// The last 12 bytes of a block compressed file. 
+	// The index chunk starts at (end of file - indexSize).
+	struct STATE_INDEX_TRAILER
+	{
+		unsigned int	states;		// number of entries in the index
+		unsigned int	indexSize;	// total size of the PLT_STATE_INDEX chunk (including its header)
+		unsigned int	magic;		// PLT_INDEX_MAGIC
 	};
+	enum { PLT_INDEX_MAGIC = 0x58444946 };	// 'FIDX'
+
 	// --- element types ---
 	enum Elem_Type { 
 		PLT_ELEM_HEX, 
@@ -236,6 +266,7 @@ public:
 
 public:
 	FEBioPlotFile(FEModel* fem);
+	~FEBioPlotFile();
 
 	//! Open the plot database
 	bool Open(const char* szfile) override;
@@ -309,6 +340,18 @@ protected:
 
 	void WriteMeshState(FEMesh& mesh);
 
+	void WriteStateIndex();
+	bool ReadStateIndex();
+
+	// write the data of a region of the variable that is currently being written
+	void WriteFieldData(int nid, std::vector<float>& a);
+
+	// get the encoder for a dictionary item (or null if the item is not encoded)
+	PlotFieldEncoder* GetEncoder(DICTIONARY_ITEM& it);
+
+	// see if any variable is encoded
+	bool HasEncodedVariables();
+
 protected:
 	bool ReadDictionary();
 	bool ReadDicList();
@@ -325,6 +368,11 @@ protected:
 
 	std::vector<Surface>	m_Surf;
 
+	std::vector<STATE_INDEX_ENTRY>	m_stateIndex;	// state index (only for block compression)
+
+	std::map<DICTIONARY_ITEM*, PlotFieldEncoder*>	m_encoders;	// encoders of encoded variables
+	PlotFieldEncoder*	m_encoder;	// encoder of variable that is being written
+
 	std::vector<PointObject*>	m_Points;
 	std::vector<LineObject*>		m_Lines;
 };
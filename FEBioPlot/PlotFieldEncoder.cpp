@@ -0,0 +1,190 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#include "stdafx.h"
+#include "PlotFieldEncoder.h"
+#include <math.h>
+#include <float.h>
+#include <string.h>
+
+// largest quantized value we allow before falling back to lossless encoding
+#define QUANTIZE_MAX	1073741824.0	// = 2^30
+
+//-----------------------------------------------------------------------------
+static inline unsigned int float_bits(float f)
+{
+	unsigned int u; memcpy(&u, &f, sizeof(float)); return u;
+}
+
+static inline float bits_float(unsigned int u)
+{
+	float f; memcpy(&f, &u, sizeof(float)); return f;
+}
+
+//-----------------------------------------------------------------------------
+PlotFieldEncoder::PlotFieldEncoder(const FEPlotEncoding& enc) : m_enc(enc)
+{
+}
+
+//-----------------------------------------------------------------------------
+void PlotFieldEncoder::Reset()
+{
+	m_region.clear();
+}
+
+//-----------------------------------------------------------------------------
+void PlotFieldEncoder::Encode(int region, const std::vector<float>& a, std::vector<unsigned char>& out)
+{
+	const int n = (int)a.size();
+	Region& r = m_region[region];
+
+	// see if we need to write a key frame
+	unsigned int flags = (unsigned int) m_enc.m_flags;
+	bool keyFrame = ((int)r.ref.size() != n) || ((m_enc.m_keyFrame > 0) && (r.frames >= m_enc.m_keyFrame));
+	if (keyFrame || ((flags & PLOT_ENCODE_DELTA) == 0))
+	{
+		flags &= ~PLOT_ENCODE_DELTA;
+		r.ref.assign(n, 0.f);
+		r.frames = 0;
+	}
+	r.frames++;
+	float* ref = (n > 0 ? r.ref.data() : nullptr);
+
+	// determine the quantization step
+	float step = 0.f;
+	if (flags & PLOT_ENCODE_QUANTIZE)
+	{
+		double amax = 0.0;
+		for (int i = 0; i < n; ++i) { double ai = fabs((double)a[i]); if (ai > amax) amax = ai; }
+
+		double tol = m_enc.m_abstol;
+		if (m_enc.m_reltol * amax > tol) tol = m_enc.m_reltol * amax;
+
+		// the reconstructed values are stored as floats, so leave room for the rounding error
+		tol -= (amax + tol) * FLT_EPSILON;
+		step = (float)(2.0 * tol);
+
+		// make sure the quantized values fit (and that there are no inf/nan values)
+		if (step > 0.f)
+		{
+			double dmax = 0.0;
+			for (int i = 0; i < n; ++i)
+			{
+				double di = fabs((double)a[i] - (double)ref[i]);
+				if (!(di <= dmax)) dmax = di;	// this also catches nan's
+			}
+			if (!(dmax / step < QUANTIZE_MAX)) step = 0.f;
+		}
+		if (step <= 0.f) { flags &= ~PLOT_ENCODE_QUANTIZE; step = 0.f; }
+	}
+
+	// encode the words and update the reference to what a reader will reconstruct
+	std::vector<unsigned int> w(n);
+	if (flags & PLOT_ENCODE_QUANTIZE)
+	{
+		const double s = step;
+#pragma omp parallel for
+		for (int i = 0; i < n; ++i)
+		{
+			int q = (int)floor(((double)a[i] - (double)ref[i]) / s + 0.5);
+			w[i] = (unsigned int)q;
+			ref[i] = (float)((double)ref[i] + q * s);
+		}
+	}
+	else
+	{
+#pragma omp parallel for
+		for (int i = 0; i < n; ++i)
+		{
+			w[i] = float_bits(a[i]) ^ float_bits(ref[i]);
+			ref[i] = a[i];
+		}
+	}
+
+	// write the record
+	const size_t hdr = 2 * sizeof(unsigned int) + sizeof(float);
+	out.resize(hdr + (size_t)n * sizeof(unsigned int));
+	unsigned int count = (unsigned int)n;
+	memcpy(&out[0], &flags, sizeof(unsigned int));
+	memcpy(&out[4], &count, sizeof(unsigned int));
+	memcpy(&out[8], &step, sizeof(float));
+	if (n == 0) return;
+
+	unsigned char* pd = &out[hdr];
+	if (flags & PLOT_ENCODE_SHUFFLE)
+	{
+		// store all the first bytes, then all second bytes, etc.
+		const unsigned char* pw = (const unsigned char*)w.data();
+#pragma omp parallel for
+		for (int b = 0; b < 4; ++b)
+		{
+			unsigned char* pb = pd + (size_t)b * n;
+			for (int i = 0; i < n; ++i) pb[i] = pw[4 * (size_t)i + b];
+		}
+	}
+	else memcpy(pd, w.data(), (size_t)n * sizeof(unsigned int));
+}
+
+//-----------------------------------------------------------------------------
+bool PlotFieldEncoder::Decode(const unsigned char* pd, size_t nsize, std::vector<float>& ref)
+{
+	const size_t hdr = 2 * sizeof(unsigned int) + sizeof(float);
+	if (nsize < hdr) return false;
+
+	unsigned int flags, count;
+	float step;
+	memcpy(&flags, pd, sizeof(unsigned int));
+	memcpy(&count, pd + 4, sizeof(unsigned int));
+	memcpy(&step , pd + 8, sizeof(float));
+	const int n = (int)count;
+	if (nsize != hdr + (size_t)n * sizeof(unsigned int)) return false;
+
+	if ((flags & PLOT_ENCODE_DELTA) == 0) ref.assign(n, 0.f);
+	else if ((int)ref.size() != n) return false;
+
+	std::vector<unsigned int> w(n);
+	pd += hdr;
+	if (flags & PLOT_ENCODE_SHUFFLE)
+	{
+		unsigned char* pw = (unsigned char*)w.data();
+		for (int b = 0; b < 4; ++b)
+			for (int i = 0; i < n; ++i) pw[4 * (size_t)i + b] = pd[(size_t)b * n + i];
+	}
+	else if (n > 0) memcpy(w.data(), pd, (size_t)n * sizeof(unsigned int));
+
+	if (flags & PLOT_ENCODE_QUANTIZE)
+	{
+		const double s = step;
+		for (int i = 0; i < n; ++i) ref[i] = (float)((double)ref[i] + (int)w[i] * s);
+	}
+	else
+	{
+		for (int i = 0; i < n; ++i) ref[i] = bits_float(w[i] ^ float_bits(ref[i]));
+	}
+
+	return true;
+}
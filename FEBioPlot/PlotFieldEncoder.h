@@ -0,0 +1,75 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#pragma once
+#include <FECore/FEPlotDataStore.h>
+#include <vector>
+#include <map>
+
+//-----------------------------------------------------------------------------
+//! This class encodes the state data of a plot variable. It keeps track of the
+//! data that a reader will reconstruct for each region, so that the temporal
+//! deltas do not accumulate quantization errors.
+//!
+//! Layout of an encoded record (one per region and state):
+//!   uint   flags  (encoding flags that were applied to this record)
+//!   uint   count  (number of float values)
+//!   float  step   (quantization step, 0 if not quantized)
+//!   count 32-bit words (byte-plane shuffled if PLOT_ENCODE_SHUFFLE is set)
+//!
+//! The words are:
+//!   - quantized:      q = round((x - ref)/step), reconstructed as ref + q*step
+//!   - not quantized:  bits(x) XOR bits(ref)
+//! where ref is the reconstructed value of the previous state if PLOT_ENCODE_DELTA 
+//! is set in the record flags, and zero otherwise (i.e. for key frames).
+class PlotFieldEncoder
+{
+public:
+	PlotFieldEncoder(const FEPlotEncoding& enc);
+
+	//! encode the data for a region
+	void Encode(int region, const std::vector<float>& a, std::vector<unsigned char>& out);
+
+	//! decode a record (the reference data is updated)
+	static bool Decode(const unsigned char* pd, size_t nsize, std::vector<float>& ref);
+
+	//! reset the encoder (next state will be a key frame)
+	void Reset();
+
+	const FEPlotEncoding& GetEncoding() const { return m_enc; }
+
+private:
+	struct Region
+	{
+		std::vector<float>	ref;		// reconstructed data of last state
+		int					frames;		// states since last key frame
+	};
+
+private:
+	FEPlotEncoding			m_enc;
+	std::map<int, Region>	m_region;
+};
@@ -94,6 +94,19 @@ bool PlotFile::AddVariable(const char* sz, vector<int>& item, const char* szdom)
 	return m_dic.AddVariable(GetFEModel(), sz, item, szdom);
 }
 
+//-----------------------------------------------------------------------------
+bool PlotFile::AddVariable(const FEPlotVariable& var)
+{
+	std::vector<int> item = var.m_item;
+	if (AddVariable(var.Name().c_str(), item, var.DomainName().c_str()) == false) return false;
+
+	// copy the encoding
+	DICTIONARY_ITEM* it = m_dic.LastVariable();
+	if (it) it->m_enc = var.m_enc;
+
+	return true;
+}
+
 //-----------------------------------------------------------------------------
 // build the dictionary
 void PlotFile::BuildDictionary()
@@ -103,10 +116,9 @@ void PlotFile::BuildDictionary()
 	{
 		FEPlotVariable& vi = pltData.GetPlotVariable(n);
 		const std::string& varName = vi.Name();
-		const std::string& domName = vi.DomainName();
 
 		// add the plot output variable
-		if (AddVariable(varName.c_str(), vi.m_item, domName.c_str()) == false)
+		if (AddVariable(vi) == false)
 		{
 			feLog("FATAL ERROR: Output variable \"%s\" is not defined\n", varName.c_str());
 			throw "FATAL ERROR";
@@ -29,6 +29,7 @@ SOFTWARE.*/
 #pragma once
 #include "FECore/FEMesh.h"
 #include "FECore/FEPlotData.h"
+#include "FECore/FEPlotDataStore.h"
 
 //-----------------------------------------------------------------------------
 class FEModel;
@@ -57,11 +58,14 @@ public:
 		std::vector<string>	m_arrayNames;	// names of array components (optional)
 		char			m_szname[STR_SIZE];
 		char			m_szunit[STR_SIZE];
+		FEPlotEncoding	m_enc;		// (optional) encoding of the data
 	};
 
 	class Dictionary
 	{
 	public:
+		Dictionary() : m_last(nullptr) {}
+
 		bool AddVariable(FEModel* pfem, const char* szname, std::vector<int>& item, const char* szdom = "");
 
 		int GlobalVariables() { return (int)m_Glob.size(); }
@@ -73,6 +77,9 @@ public:
 
 		void Clear();
 
+		// the item that was added last (or null)
+		DICTIONARY_ITEM* LastVariable() { return m_last; }
+
 	public:
 		list<DICTIONARY_ITEM>& GlobalVariableList() { return m_Glob; }
 		list<DICTIONARY_ITEM>& MaterialVariableList() { return m_Mat; }
@@ -93,6 +100,7 @@ public:
 		list<DICTIONARY_ITEM>	m_Node;		// Node variables
 		list<DICTIONARY_ITEM>	m_Elem;		// Domain variables
 		list<DICTIONARY_ITEM>	m_Face;		// Surface variables
+		DICTIONARY_ITEM*		m_last;		// last item added
 
 		friend class PlotFile;
 	};
@@ -134,6 +142,7 @@ protected:
 	bool AddVariable(FEPlotData* ps, const char* szname);
 	bool AddVariable(const char* sz);
 	bool AddVariable(const char* sz, std::vector<int>& item, const char* szdom = "");
+	bool AddVariable(const FEPlotVariable& var);
 
 private:
 	Dictionary	m_dic;	//!< dictionary
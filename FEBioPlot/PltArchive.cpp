@@ -30,9 +30,18 @@ SOFTWARE.*/
 #include "PltArchive.h"
 #include <assert.h>
 
+#include <algorithm>
+
 #ifdef HAVE_ZLIB
 #include "zlib.h"
-static z_stream strm;
+#endif
+
+#ifdef WIN32
+#define ftell64 _ftelli64
+#define fseek64 _fseeki64
+#else
+#define ftell64 ftello
+#define fseek64 fseeko
 #endif
 
 //=============================================================================
@@ -47,6 +56,12 @@ FileStream::FileStream(FILE* fp, bool owner)
 	m_ncompress = 0;
 	m_fp = fp;
 	m_fileOwner = owner;
+	m_bstreaming = false;
+#ifdef HAVE_ZLIB
+	m_strm = new z_stream;
+#else
+	m_strm = nullptr;
+#endif
 }
 
 FileStream::~FileStream()
@@ -56,6 +71,10 @@ FileStream::~FileStream()
 	delete [] m_pout;
 	m_buf = 0;
 	m_pout = 0;
+#ifdef HAVE_ZLIB
+	delete (z_stream*)m_strm;
+#endif
+	m_strm = nullptr;
 }
 
 bool FileStream::Open(const char* szfile)
@@ -68,7 +87,11 @@ bool FileStream::Open(const char* szfile)
 bool FileStream::Append(const char* szfile)
 {
 	m_fp = fopen(szfile, "a+b");
-	return (m_fp != 0);
+	if (m_fp == 0) return false;
+
+	// make sure the file position reports the end of the file
+	fseek64(m_fp, 0, SEEK_END);
+	return true;
 }
 
 bool FileStream::Create(const char* szfile)
@@ -89,9 +112,21 @@ void FileStream::Close()
 
 void FileStream::BeginStreaming()
 {
+	m_bstreaming = true;
+	if (m_ncompress == FILESTREAM_COMPRESS_BLOCKS)
+	{
+		// write out anything that is still buffered before we start collecting the chunk
+		m_bstreaming = false;
+		Flush();
+		m_bstreaming = true;
+		m_raw.clear();
+		return;
+	}
+
 #ifdef HAVE_ZLIB
 	if (m_ncompress)
 	{
+		z_stream& strm = *(z_stream*)m_strm;
 		strm.zalloc = Z_NULL;
 		strm.zfree = Z_NULL;
 		strm.opaque = Z_NULL;
@@ -103,9 +138,18 @@ void FileStream::BeginStreaming()
 void FileStream::EndStreaming()
 {
 	Flush();
+	m_bstreaming = false;
+
+	if (m_ncompress == FILESTREAM_COMPRESS_BLOCKS)
+	{
+		WriteBlocks();
+		return;
+	}
+
 #ifdef HAVE_ZLIB
 	if (m_ncompress)
 	{
+		z_stream& strm = *(z_stream*)m_strm;
 		strm.avail_in = 0;
 		strm.next_in = 0;
 
@@ -129,6 +173,63 @@ void FileStream::EndStreaming()
 #endif
 }
 
+// Compresses the collected chunk data in independent blocks and writes the block frame.
+// Since the blocks do not share any compression state they can be processed in parallel 
+// and a reader can decompress them in parallel (or skip them) as well.
+void FileStream::WriteBlocks()
+{
+	const size_t N = m_raw.size();
+	const int nblocks = (int)((N + FILESTREAM_BLOCK_SIZE - 1) / FILESTREAM_BLOCK_SIZE);
+
+	std::vector<unsigned int> rawSize(nblocks), compSize(nblocks);
+	std::vector< std::vector<unsigned char> > out(nblocks);
+
+#ifdef HAVE_ZLIB
+	unsigned int codec = FILESTREAM_CODEC_ZLIB;
+#else
+	unsigned int codec = FILESTREAM_CODEC_STORE;
+#endif
+
+#pragma omp parallel for schedule(dynamic)
+	for (int i = 0; i < nblocks; ++i)
+	{
+		size_t n0 = (size_t)i * FILESTREAM_BLOCK_SIZE;
+		size_t n = std::min((size_t)FILESTREAM_BLOCK_SIZE, N - n0);
+		const unsigned char* src = m_raw.data() + n0;
+		rawSize[i] = (unsigned int)n;
+		compSize[i] = (unsigned int)n;
+
+#ifdef HAVE_ZLIB
+		uLongf len = compressBound((uLong)n);
+		out[i].resize(len);
+		if ((compress2(out[i].data(), &len, src, (uLong)n, Z_BEST_SPEED) == Z_OK) && (len < n))
+		{
+			// store the compressed block
+			out[i].resize(len);
+			compSize[i] = (unsigned int)len;
+			continue;
+		}
+#endif
+		// the block does not compress, so store it as is
+		out[i].assign(src, src + n);
+	}
+
+	// write the frame header
+	unsigned int hdr[3] = { FILESTREAM_BLOCK_MAGIC, codec, (unsigned int)nblocks };
+	fwrite(hdr, sizeof(unsigned int), 3, m_fp);
+	if (nblocks > 0)
+	{
+		fwrite(rawSize.data(), sizeof(unsigned int), nblocks, m_fp);
+		fwrite(compSize.data(), sizeof(unsigned int), nblocks, m_fp);
+	}
+
+	// write the blocks
+	for (int i = 0; i < nblocks; ++i) fwrite(out[i].data(), 1, out[i].size(), m_fp);
+	fflush(m_fp);
+
+	m_raw.clear();
+}
+
 void FileStream::Write(void* pd, size_t Size, size_t Count)
 {
 	unsigned char* pdata = (unsigned char*) pd;
@@ -154,9 +255,18 @@ void FileStream::Write(void* pd, size_t Size, size_t Count)
 
 void FileStream::Flush()
 {
+	if ((m_ncompress == FILESTREAM_COMPRESS_BLOCKS) && m_bstreaming)
+	{
+		// just collect the data. It will be compressed in EndStreaming.
+		m_raw.insert(m_raw.end(), m_buf, m_buf + m_current);
+		m_current = 0;
+		return;
+	}
+
 #ifdef HAVE_ZLIB
-	if (m_ncompress)
+	if ((m_ncompress == FILESTREAM_COMPRESS_ZLIB) && m_bstreaming)
 	{
+		z_stream& strm = *(z_stream*)m_strm;
 		strm.avail_in = m_current;
 		strm.next_in = m_buf;
 
@@ -202,6 +312,16 @@ void FileStream::seek(long noff, int norigin)
 	fseek(m_fp, noff, norigin);
 }
 
+long long FileStream::tell64()
+{
+	return (long long) ftell64(m_fp);
+}
+
+void FileStream::seek64(long long noff, int norigin)
+{
+	fseek64(m_fp, noff, norigin);
+}
+
 
 //=============================================================================
 // PltArchive
@@ -246,6 +366,16 @@ void PltArchive::SetCompression(int n)
 	if (m_fp) m_fp->SetCompression(n);
 }
 
+long long PltArchive::Tell()
+{
+	return (m_fp ? m_fp->tell64() : 0);
+}
+
+void PltArchive::Seek(long long noff, int norigin)
+{
+	if (m_fp) m_fp->seek64(noff, norigin);
+}
+
 void PltArchive::Flush()
 {
 	if (m_fp && m_pRoot)
@@ -38,6 +38,29 @@ SOFTWARE.*/
 //-----------------------------------------------------------------------------
 enum IOResult { IO_ERROR, IO_OK, IO_END };
 
+//-----------------------------------------------------------------------------
+// Compression modes of the file stream
+// 0 = no compression
+// 1 = one zlib stream per top-level chunk
+// 2 = top-level chunks are split in fixed-size blocks that are compressed 
+//     independently (and in parallel). Each chunk is then written as a block frame:
+//       uint    FILESTREAM_BLOCK_MAGIC
+//       uint    codec (FILESTREAM_CODEC_STORE or FILESTREAM_CODEC_ZLIB)
+//       uint    number of blocks (n)
+//       uint[n] uncompressed size of each block
+//       uint[n] compressed size of each block (equal to uncompressed size if the block is stored)
+//       data of all blocks
+enum FileStreamCompression {
+	FILESTREAM_COMPRESS_NONE = 0,
+	FILESTREAM_COMPRESS_ZLIB = 1,
+	FILESTREAM_COMPRESS_BLOCKS = 2
+};
+
+#define FILESTREAM_BLOCK_MAGIC	0x4B4C4246	// 'FBLK'
+#define FILESTREAM_BLOCK_SIZE	1048576		// = 1M
+#define FILESTREAM_CODEC_STORE	0
+#define FILESTREAM_CODEC_ZLIB	1
+
 //-----------------------------------------------------------------------------
 //! helper class for writing buffered data to file
 class FileStream
@@ -60,6 +83,10 @@ public:
 	long tell();
 	void seek(long noff, int norigin);
 
+	// 64-bit file positioning
+	long long tell64();
+	void seek64(long long noff, int norigin);
+
 	void BeginStreaming();
 	void EndStreaming();
 
@@ -69,6 +96,9 @@ public:
 
 	bool IsValid() { return (m_fp != nullptr); }
 
+private:
+	void WriteBlocks();
+
 private:
 	FILE*	m_fp;
 	bool	m_fileOwner;
@@ -77,6 +107,10 @@ private:
 	unsigned char*	m_buf;	//!< buffer
 	unsigned char*	m_pout;	//!< temp buffer when writing
 	int		m_ncompress;	//!< compression level
+	void*	m_strm;			//!< zlib stream (only used when HAVE_ZLIB is defined)
+
+	bool	m_bstreaming;	//!< inside Begin/EndStreaming
+	std::vector<unsigned char>	m_raw;	//!< uncompressed data of current chunk (block compression)
 };
 
 class OBranch;
@@ -352,6 +386,12 @@ public:
 
 	bool IsValid() const { return (m_fp != 0); }
 
+	// current (64-bit) file position
+	long long Tell();
+
+	// set the (64-bit) file position
+	void Seek(long long noff, int norigin);
+
 protected:
 	FileStream*	m_fp;		// pointer to file stream
 	bool		m_bSaving;	// read or write mode?
@@ -55,6 +55,58 @@ enum VTK_CELLTYPE {
 };
 
 
+//-----------------------------------------------------------------------------
+int vtk_cell_type(int shape)
+{
+	int vtk_type;
+	switch (shape) {
+		case ET_HEX8   : vtk_type = VTK_HEXAHEDRON; break;
+		case ET_TET4   : vtk_type = VTK_TETRA; break;
+		case ET_PENTA6 : vtk_type = VTK_WEDGE; break;
+		case ET_PYRA5  : vtk_type = VTK_PYRAMID; break;
+		case ET_QUAD4  : vtk_type = VTK_QUAD; break;
+		case ET_TRI3   : vtk_type = VTK_TRIANGLE; break;
+		case ET_TRUSS2 : vtk_type = VTK_LINE; break;
+		case ET_HEX20  : vtk_type = VTK_QUADRATIC_HEXAHEDRON; break;
+		case ET_QUAD8  : vtk_type = VTK_QUADRATIC_QUAD; break;
+//		case ET_BEAM3  : vtk_type = VTK_QUADRATIC_EDGE; break;
+		case ET_TET10  : vtk_type = VTK_QUADRATIC_TETRA; break;
+		case ET_TET15  : vtk_type = VTK_QUADRATIC_TETRA; break;
+		case ET_PENTA15: vtk_type = VTK_QUADRATIC_WEDGE; break;
+		case ET_HEX27  : vtk_type = VTK_QUADRATIC_HEXAHEDRON; break;
+		case ET_PYRA13 : vtk_type = VTK_QUADRATIC_PYRAMID; break;
+		case ET_TRI6   : vtk_type = VTK_QUADRATIC_TRIANGLE; break;
+		case ET_QUAD9  : vtk_type = VTK_QUADRATIC_QUAD; break;
+		default: vtk_type = -1; break;
+	}
+	return vtk_type;
+}
+
+//-----------------------------------------------------------------------------
+int vtk_cell_nodes(int vtk_type)
+{
+	switch (vtk_type)
+	{
+	case VTK_VERTEX              : return 1;
+	case VTK_LINE                : return 2;
+	case VTK_TRIANGLE            : return 3;
+	case VTK_QUAD                : return 4;
+	case VTK_TETRA               : return 4;
+	case VTK_HEXAHEDRON          : return 8;
+	case VTK_WEDGE               : return 6;
+	case VTK_PYRAMID             : return 5;
+	case VTK_QUADRATIC_EDGE      : return 3;
+	case VTK_QUADRATIC_TRIANGLE  : return 6;
+	case VTK_QUADRATIC_QUAD      : return 8;
+	case VTK_QUADRATIC_TETRA     : return 10;
+	case VTK_QUADRATIC_HEXAHEDRON: return 20;
+	case VTK_QUADRATIC_WEDGE     : return 15;
+	case VTK_QUADRATIC_PYRAMID   : return 13;
+	}
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
 VTKPlotFile::VTKPlotFile(FEModel* fem) : PlotFile(fem)
 {
 	m_fp = nullptr;
@@ -177,28 +229,7 @@ void VTKPlotFile::WriteCells()
 	for (int j = 0; j<m.Elements(); ++j)
     {
 		FEElement& el = *m.Element(j);
-		int vtk_type;
-        switch (el.Shape()) {
-            case ET_HEX8   : vtk_type = VTK_HEXAHEDRON; break;
-            case ET_TET4   : vtk_type = VTK_TETRA; break;
-            case ET_PENTA6 : vtk_type = VTK_WEDGE; break;
-            case ET_PYRA5  : vtk_type = VTK_PYRAMID; break;
-            case ET_QUAD4  : vtk_type = VTK_QUAD; break;
-            case ET_TRI3   : vtk_type = VTK_TRIANGLE; break;
-            case ET_TRUSS2 : vtk_type = VTK_LINE; break;
-            case ET_HEX20  : vtk_type = VTK_QUADRATIC_HEXAHEDRON; break;
-            case ET_QUAD8  : vtk_type = VTK_QUADRATIC_QUAD; break;
-//            case ET_BEAM3  : vtk_type = VTK_QUADRATIC_EDGE; break;
-            case ET_TET10  : vtk_type = VTK_QUADRATIC_TETRA; break;
-            case ET_TET15  : vtk_type = VTK_QUADRATIC_TETRA; break;
-            case ET_PENTA15: vtk_type = VTK_QUADRATIC_WEDGE; break;
-            case ET_HEX27  : vtk_type = VTK_QUADRATIC_HEXAHEDRON; break;
-            case ET_PYRA13 : vtk_type = VTK_QUADRATIC_PYRAMID; break;
-            case ET_TRI6   : vtk_type = VTK_QUADRATIC_TRIANGLE; break;
-            case ET_QUAD9  : vtk_type = VTK_QUADRATIC_QUAD; break;
-            default: vtk_type = -1; break;
-        }
-            
+		int vtk_type = vtk_cell_type(el.Shape());
         fprintf(m_fp, "%d\n", vtk_type);
     }
 }
@@ -27,6 +27,12 @@ SOFTWARE.*/
 #include "PlotFile.h"
 #include <stdio.h>
 
+//! returns the VTK cell type for an element shape (or -1 if not supported)
+int vtk_cell_type(int shape);
+
+//! returns the number of nodes of a VTK cell type
+int vtk_cell_nodes(int vtk_type);
+
 //! This class stores the FEBio results to a family of VTK files. 
 class VTKPlotFile : public PlotFile
 {
@@ -0,0 +1,574 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#include "stdafx.h"
+#include "VTUPlotFile.h"
+#include "VTKPlotFile.h"
+#include <FECore/FEModel.h>
+#include <FECore/FEPlotDataStore.h>
+#include <FECore/FEDomain.h>
+#include <FECore/DumpStream.h>
+#include <sstream>
+
+#define VTK_POLY_VERTEX	2
+
+//-----------------------------------------------------------------------------
+static const char* vtk_byte_order()
+{
+	const unsigned int one = 1;
+	return (*((const unsigned char*)&one) == 1 ? "LittleEndian" : "BigEndian");
+}
+
+//-----------------------------------------------------------------------------
+// VTK data array names cannot contain white space
+static std::string vtk_name(const std::string& s)
+{
+	std::string name(s);
+	for (size_t i = 0; i < name.size(); ++i)
+		if (isspace(name[i])) name[i] = '_';
+	return name;
+}
+
+//-----------------------------------------------------------------------------
+// helper class for writing data arrays to the appended data section
+class VTUAppendedData
+{
+public:
+	VTUAppendedData() : m_offset(0) {}
+
+	// register a block and return its offset
+	template <typename T> unsigned long long Add(const std::vector<T>& a)
+	{
+		unsigned long long offset = m_offset;
+		m_block.push_back(Block{ (const void*)a.data(), a.size() * sizeof(T) });
+		m_offset += sizeof(unsigned long long) + a.size() * sizeof(T);
+		return offset;
+	}
+
+	// write all blocks
+	void Write(FILE* fp)
+	{
+		fprintf(fp, "  <AppendedData encoding=\"raw\">\n   _");
+		for (Block& b : m_block)
+		{
+			unsigned long long nbytes = b.nbytes;
+			fwrite(&nbytes, sizeof(unsigned long long), 1, fp);
+			if (nbytes > 0) fwrite(b.pd, 1, b.nbytes, fp);
+		}
+		fprintf(fp, "\n  </AppendedData>\n");
+	}
+
+private:
+	struct Block {
+		const void*	pd;
+		size_t		nbytes;
+	};
+	std::vector<Block>	m_block;
+	unsigned long long	m_offset;
+};
+
+//=============================================================================
+VTUPlotFile::VTUPlotFile(FEModel* fem, bool partitioned) : PlotFile(fem)
+{
+	m_partitioned = partitioned;
+	m_valid = false;
+	m_count = 0;
+	m_nodes = m_elems = m_doms = -1;
+}
+
+//-----------------------------------------------------------------------------
+//! Open the plot database
+bool VTUPlotFile::Open(const char* szfile)
+{
+	m_filename = szfile;
+	size_t n = m_filename.rfind('.');
+	if (n != std::string::npos) m_filename.erase(n, std::string::npos);
+
+	m_steps.clear();
+	m_count = 0;
+
+	BuildDictionary();
+	m_valid = true;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Open for appending
+bool VTUPlotFile::Append(const char* szfile)
+{
+	m_filename = szfile;
+	size_t n = m_filename.rfind('.');
+	if (n != std::string::npos) m_filename.erase(n, std::string::npos);
+
+	BuildDictionary();
+	m_valid = true;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+//! see if the plot file is valid
+bool VTUPlotFile::IsValid() const
+{
+	return m_valid;
+}
+
+//-----------------------------------------------------------------------------
+void VTUPlotFile::Serialize(DumpStream& ar)
+{
+	if (ar.IsShallow()) return;
+	ar & m_count;
+	if (ar.IsSaving())
+	{
+		int n = (int)m_steps.size();
+		ar << n;
+		for (TimeStep& s : m_steps) ar << s.time << s.file;
+	}
+	else
+	{
+		int n = 0;
+		ar >> n;
+		m_steps.resize(n);
+		for (TimeStep& s : m_steps) ar >> s.time >> s.file;
+	}
+}
+
+//-----------------------------------------------------------------------------
+bool VTUPlotFile::MeshChanged()
+{
+	FEMesh& mesh = GetFEModel()->GetMesh();
+	return ((mesh.Nodes() != m_nodes) || (mesh.Elements() != m_elems) || (mesh.Domains() != m_doms));
+}
+
+//-----------------------------------------------------------------------------
+// Build the geometry of all pieces. This only needs to be done once, unless
+// the mesh changes. 
+void VTUPlotFile::BuildGeometry()
+{
+	FEMesh& mesh = GetFEModel()->GetMesh();
+	m_nodes = mesh.Nodes();
+	m_elems = mesh.Elements();
+	m_doms  = mesh.Domains();
+
+	m_piece.clear();
+	if (m_partitioned)
+	{
+		m_piece.resize(m_doms);
+		for (int i = 0; i < m_doms; ++i) m_piece[i].domains.push_back(i);
+	}
+	else
+	{
+		m_piece.resize(1);
+		for (int i = 0; i < m_doms; ++i) m_piece[0].domains.push_back(i);
+	}
+
+	std::vector<int> tag(m_nodes, -1);
+	for (Piece& p : m_piece)
+	{
+		// collect the nodes
+		if (m_partitioned)
+		{
+			FEDomain& dom = mesh.Domain(p.domains[0]);
+			p.nodes.resize(dom.Nodes());
+			for (int j = 0; j < dom.Nodes(); ++j) p.nodes[j] = dom.NodeIndex(j);
+		}
+		else
+		{
+			p.nodes.resize(m_nodes);
+			for (int j = 0; j < m_nodes; ++j) p.nodes[j] = j;
+		}
+		const int NN = (int)p.nodes.size();
+		for (int j = 0; j < NN; ++j) tag[p.nodes[j]] = j;
+
+		// the coordinates
+		p.points.resize(3 * NN);
+		for (int j = 0; j < NN; ++j)
+		{
+			const vec3d& r = mesh.Node(p.nodes[j]).m_r0;
+			p.points[3 * j    ] = (float)r.x;
+			p.points[3 * j + 1] = (float)r.y;
+			p.points[3 * j + 2] = (float)r.z;
+		}
+
+		// the cells
+		p.conn.clear(); p.offsets.clear(); p.types.clear(); p.partId.clear();
+		for (int d : p.domains)
+		{
+			FEDomain& dom = mesh.Domain(d);
+			for (int i = 0; i < dom.Elements(); ++i)
+			{
+				FEElement& el = dom.ElementRef(i);
+
+				// unsupported elements are written as poly vertices, so that 
+				// the cell count (and cell data) remains consistent.
+				int vtk_type = vtk_cell_type(el.Shape());
+				int ne = el.Nodes();
+				if (vtk_type < 0) vtk_type = VTK_POLY_VERTEX;
+				else
+				{
+					int nv = vtk_cell_nodes(vtk_type);
+					if ((nv > 0) && (nv < ne)) ne = nv;
+				}
+
+				for (int k = 0; k < ne; ++k) p.conn.push_back(tag[el.m_node[k]]);
+				p.offsets.push_back((int)p.conn.size());
+				p.types.push_back((unsigned char)vtk_type);
+				p.partId.push_back(d);
+			}
+		}
+
+		for (int j = 0; j < NN; ++j) tag[p.nodes[j]] = -1;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Add a data field to a data array list. Composite types are split in 
+// the same way as the legacy VTK writer does. 
+void VTUPlotFile::AddData(std::vector<Piece::DataArray>& list, const std::string& name, FEPlotData* pd, std::vector<float>& val)
+{
+	switch (pd->DataType())
+	{
+	case PLT_FLOAT : list.push_back({ name, 1, val }); break;
+	case PLT_VEC3F : list.push_back({ name, 3, val }); break;
+	case PLT_MAT3FS: list.push_back({ name, 6, val }); break;	// xx, yy, zz, xy, yz, xz (same as VTK)
+	case PLT_MAT3FD:
+	{
+		// expand to symmetric tensor
+		size_t n = val.size() / 3;
+		std::vector<float> v(6 * n, 0.f);
+		for (size_t i = 0; i < n; ++i)
+		{
+			v[6 * i    ] = val[3 * i    ];
+			v[6 * i + 1] = val[3 * i + 1];
+			v[6 * i + 2] = val[3 * i + 2];
+		}
+		list.push_back({ name, 6, v });
+	}
+	break;
+	case PLT_ARRAY:
+	case PLT_ARRAY_VEC3F:
+	{
+		int arraySize = pd->GetArraysize();
+		int nc = (pd->DataType() == PLT_ARRAY ? 1 : 3);
+		std::vector<string> arrayNames = pd->GetArrayNames();
+		if (arraySize <= 0) break;
+		size_t n = val.size() / (nc * arraySize);
+		for (int j = 0; j < arraySize; ++j)
+		{
+			Piece::DataArray da;
+			da.name = vtk_name(j < (int)arrayNames.size() ? arrayNames[j] : name + std::to_string(j));
+			da.ncomp = nc;
+			da.data.resize(nc * n);
+			for (size_t i = 0; i < n; ++i)
+				for (int k = 0; k < nc; ++k) da.data[nc * i + k] = val[nc * arraySize * i + nc * j + k];
+			list.push_back(da);
+		}
+	}
+	break;
+	default:
+		list.push_back({ name, pd->VarSize(pd->DataType()), val });
+	}
+}
+
+//-----------------------------------------------------------------------------
+void VTUPlotFile::BuildPointData()
+{
+	FEModel& fem = *GetFEModel();
+	FEMesh& mesh = fem.GetMesh();
+	PlotFile::Dictionary& dic = GetDictionary();
+
+	for (Piece& p : m_piece) p.pointData.clear();
+
+	// nodal variables
+	for (DICTIONARY_ITEM& it : dic.NodalVariableList())
+	{
+		FEPlotData* pd = it.m_psave;
+		if (pd == nullptr) continue;
+
+		int ndata = pd->VarSize(pd->DataType());
+		int N = mesh.Nodes();
+		FEDataStream a; a.reserve(ndata * N);
+		if (pd->Save(mesh, a) == false) continue;
+		if (a.size() != N * ndata) a.resize(N * ndata, 0.f);
+		std::vector<float>& va = a.data();
+
+		std::string name = vtk_name(it.m_szname);
+		for (Piece& p : m_piece)
+		{
+			// gather the values of the piece's nodes
+			const int NN = (int)p.nodes.size();
+			std::vector<float> val(ndata * NN);
+			for (int j = 0; j < NN; ++j)
+				for (int k = 0; k < ndata; ++k) val[ndata * j + k] = va[ndata * p.nodes[j] + k];
+			AddData(p.pointData, name, pd, val);
+		}
+	}
+
+	// domain variables that use the NODE format
+	for (DICTIONARY_ITEM& it : dic.DomainVariableList())
+	{
+		FEPlotData* pd = it.m_psave;
+		if ((pd == nullptr) || (pd->StorageFormat() != FMT_NODE)) continue;
+
+		int ndata = pd->VarSize(pd->DataType());
+		std::string name = vtk_name(it.m_szname);
+		for (Piece& p : m_piece)
+		{
+			std::vector<float> val(ndata * p.nodes.size(), 0.f);
+			for (int d : p.domains)
+			{
+				FEDomain& dom = mesh.Domain(d);
+				int NN = dom.Nodes();
+				FEDataStream a; a.reserve(ndata * NN);
+				pd->Save(dom, a);
+				if (a.size() != NN * ndata) a.resize(NN * ndata, 0.f);
+
+				for (int j = 0; j < NN; ++j)
+				{
+					// the nodes of a partitioned piece are in domain order
+					int nj = (m_partitioned ? j : dom.NodeIndex(j));
+					for (int k = 0; k < ndata; ++k) val[nj * ndata + k] = a[ndata * j + k];
+				}
+			}
+			AddData(p.pointData, name, pd, val);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+void VTUPlotFile::BuildCellData()
+{
+	FEModel& fem = *GetFEModel();
+	FEMesh& mesh = fem.GetMesh();
+	PlotFile::Dictionary& dic = GetDictionary();
+
+	for (Piece& p : m_piece) p.cellData.clear();
+
+	// For now, we can only store FE_REGION_DOMAIN/FMT_ITEM
+	for (DICTIONARY_ITEM& it : dic.DomainVariableList())
+	{
+		FEPlotData* pd = it.m_psave;
+		if ((pd == nullptr) || (pd->RegionType() != FE_REGION_DOMAIN) || (pd->StorageFormat() != FMT_ITEM)) continue;
+
+		int ndata = pd->VarSize(pd->DataType());
+		std::string name = vtk_name(it.m_szname);
+		for (Piece& p : m_piece)
+		{
+			std::vector<float> val;
+			val.reserve(ndata * p.types.size());
+			for (int d : p.domains)
+			{
+				FEDomain& dom = mesh.Domain(d);
+				int NE = dom.Elements();
+				FEDataStream a; a.reserve(ndata * NE);
+				pd->Save(dom, a);
+				if (a.size() != NE * ndata) a.resize(NE * ndata, 0.f);
+				val.insert(val.end(), a.data().begin(), a.data().end());
+			}
+			AddData(p.cellData, name, pd, val);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+//! Write current FE state to plot database
+bool VTUPlotFile::Write(float ftime, int flag)
+{
+	// (re)build the geometry if needed
+	if (m_piece.empty() || MeshChanged()) BuildGeometry();
+
+	// evaluate the data (this must be done serially)
+	BuildPointData();
+	BuildCellData();
+
+	// split the base file name in directory and name
+	std::string dir, base = m_filename;
+	size_t n = m_filename.find_last_of("/\\");
+	if (n != std::string::npos)
+	{
+		dir = m_filename.substr(0, n + 1);
+		base = m_filename.substr(n + 1);
+	}
+
+	std::stringstream ss;
+	ss << base << "." << m_count;
+	std::string stateName = ss.str();
+
+	bool bok = true;
+	std::string fileName;
+	if (m_partitioned == false)
+	{
+		fileName = stateName + ".vtu";
+		bok = WritePiece(dir + fileName, m_piece[0], ftime);
+	}
+	else
+	{
+		const int NP = (int)m_piece.size();
+		std::vector<std::string> pieceNames(NP);
+		for (int i = 0; i < NP; ++i)
+		{
+			std::stringstream si;
+			si << stateName << "_" << i << ".vtu";
+			pieceNames[i] = si.str();
+		}
+
+		// write the pieces concurrently
+		int nerr = 0;
+#pragma omp parallel for schedule(dynamic) reduction(+:nerr)
+		for (int i = 0; i < NP; ++i)
+		{
+			if (WritePiece(dir + pieceNames[i], m_piece[i], ftime) == false) nerr++;
+		}
+
+		fileName = stateName + ".pvtu";
+		bok = (nerr == 0) && WritePVTU(dir + fileName, pieceNames, ftime);
+	}
+
+	// the state data is no longer needed
+	for (Piece& p : m_piece) { p.pointData.clear(); p.cellData.clear(); }
+
+	if (bok == false) return false;
+
+	// update the time series
+	m_steps.push_back(TimeStep{ (double)ftime, fileName });
+	m_count++;
+	return WritePVD();
+}
+
+//-----------------------------------------------------------------------------
+bool VTUPlotFile::WritePiece(const std::string& fileName, Piece& p, double time)
+{
+	FILE* fp = fopen(fileName.c_str(), "wb");
+	if (fp == nullptr) return false;
+
+	const int NN = (int)p.nodes.size();
+	const int NE = (int)p.types.size();
+
+	VTUAppendedData app;
+
+	fprintf(fp, "<?xml version=\"1.0\"?>\n");
+	fprintf(fp, "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"%s\" header_type=\"UInt64\">\n", vtk_byte_order());
+	fprintf(fp, " <UnstructuredGrid>\n");
+	fprintf(fp, "  <FieldData>\n");
+	fprintf(fp, "   <DataArray type=\"Float64\" Name=\"TimeValue\" NumberOfTuples=\"1\" format=\"ascii\">%.17g</DataArray>\n", time);
+	fprintf(fp, "  </FieldData>\n");
+	fprintf(fp, "  <Piece NumberOfPoints=\"%d\" NumberOfCells=\"%d\">\n", NN, NE);
+
+	fprintf(fp, "   <PointData>\n");
+	for (Piece::DataArray& da : p.pointData)
+	{
+		fprintf(fp, "    <DataArray type=\"Float32\" Name=\"%s\" NumberOfComponents=\"%d\" format=\"appended\" offset=\"%llu\"/>\n", da.name.c_str(), da.ncomp, app.Add(da.data));
+	}
+	fprintf(fp, "   </PointData>\n");
+
+	fprintf(fp, "   <CellData>\n");
+	fprintf(fp, "    <DataArray type=\"Int32\" Name=\"part_id\" format=\"appended\" offset=\"%llu\"/>\n", app.Add(p.partId));
+	for (Piece::DataArray& da : p.cellData)
+	{
+		fprintf(fp, "    <DataArray type=\"Float32\" Name=\"%s\" NumberOfComponents=\"%d\" format=\"appended\" offset=\"%llu\"/>\n", da.name.c_str(), da.ncomp, app.Add(da.data));
+	}
+	fprintf(fp, "   </CellData>\n");
+
+	fprintf(fp, "   <Points>\n");
+	fprintf(fp, "    <DataArray type=\"Float32\" NumberOfComponents=\"3\" format=\"appended\" offset=\"%llu\"/>\n", app.Add(p.points));
+	fprintf(fp, "   </Points>\n");
+
+	fprintf(fp, "   <Cells>\n");
+	fprintf(fp, "    <DataArray type=\"Int32\" Name=\"connectivity\" format=\"appended\" offset=\"%llu\"/>\n", app.Add(p.conn));
+	fprintf(fp, "    <DataArray type=\"Int32\" Name=\"offsets\" format=\"appended\" offset=\"%llu\"/>\n", app.Add(p.offsets));
+	fprintf(fp, "    <DataArray type=\"UInt8\" Name=\"types\" format=\"appended\" offset=\"%llu\"/>\n", app.Add(p.types));
+	fprintf(fp, "   </Cells>\n");
+
+	fprintf(fp, "  </Piece>\n");
+	fprintf(fp, " </UnstructuredGrid>\n");
+	app.Write(fp);
+	fprintf(fp, "</VTKFile>\n");
+
+	bool bok = (ferror(fp) == 0);
+	fclose(fp);
+	return bok;
+}
+
+//-----------------------------------------------------------------------------
+bool VTUPlotFile::WritePVTU(const std::string& fileName, const std::vector<std::string>& pieces, double time)
+{
+	FILE* fp = fopen(fileName.c_str(), "wt");
+	if (fp == nullptr) return false;
+
+	fprintf(fp, "<?xml version=\"1.0\"?>\n");
+	fprintf(fp, "<VTKFile type=\"PUnstructuredGrid\" version=\"1.0\" byte_order=\"%s\" header_type=\"UInt64\">\n", vtk_byte_order());
+	fprintf(fp, " <PUnstructuredGrid GhostLevel=\"0\">\n");
+
+	// all pieces have the same arrays
+	if (m_piece.empty() == false)
+	{
+		Piece& p = m_piece[0];
+		fprintf(fp, "  <PPointData>\n");
+		for (Piece::DataArray& da : p.pointData)
+			fprintf(fp, "   <PDataArray type=\"Float32\" Name=\"%s\" NumberOfComponents=\"%d\"/>\n", da.name.c_str(), da.ncomp);
+		fprintf(fp, "  </PPointData>\n");
+
+		fprintf(fp, "  <PCellData>\n");
+		fprintf(fp, "   <PDataArray type=\"Int32\" Name=\"part_id\"/>\n");
+		for (Piece::DataArray& da : p.cellData)
+			fprintf(fp, "   <PDataArray type=\"Float32\" Name=\"%s\" NumberOfComponents=\"%d\"/>\n", da.name.c_str(), da.ncomp);
+		fprintf(fp, "  </PCellData>\n");
+	}
+
+	fprintf(fp, "  <PPoints>\n");
+	fprintf(fp, "   <PDataArray type=\"Float32\" NumberOfComponents=\"3\"/>\n");
+	fprintf(fp, "  </PPoints>\n");
+
+	for (const std::string& s : pieces) fprintf(fp, "  <Piece Source=\"%s\"/>\n", s.c_str());
+
+	fprintf(fp, " </PUnstructuredGrid>\n");
+	fprintf(fp, "</VTKFile>\n");
+
+	bool bok = (ferror(fp) == 0);
+	fclose(fp);
+	return bok;
+}
+
+//-----------------------------------------------------------------------------
+// The .pvd file is rewritten after each state so that it is valid even if the run is aborted.
+bool VTUPlotFile::WritePVD()
+{
+	std::string fileName = m_filename + ".pvd";
+	FILE* fp = fopen(fileName.c_str(), "wt");
+	if (fp == nullptr) return false;
+
+	fprintf(fp, "<?xml version=\"1.0\"?>\n");
+	fprintf(fp, "<VTKFile type=\"Collection\" version=\"0.1\" byte_order=\"%s\">\n", vtk_byte_order());
+	fprintf(fp, " <Collection>\n");
+	for (TimeStep& s : m_steps)
+		fprintf(fp, "  <DataSet timestep=\"%.17g\" group=\"\" part=\"0\" file=\"%s\"/>\n", s.time, s.file.c_str());
+	fprintf(fp, " </Collection>\n");
+	fprintf(fp, "</VTKFile>\n");
+
+	bool bok = (ferror(fp) == 0);
+	fclose(fp);
+	return bok;
+}
@@ -0,0 +1,113 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#pragma once
+#include "PlotFile.h"
+#include <stdio.h>
+
+//-----------------------------------------------------------------------------
+//! This class stores the FEBio results in the XML VTK format. Each state is 
+//! written to an unstructured grid file (.vtu) with its arrays stored in binary
+//! form in the appended data section. Optionally, each state is partitioned 
+//! per domain into pieces that are written concurrently and that are collected
+//! by a parallel unstructured grid file (.pvtu). A ParaView data file (.pvd) 
+//! is maintained as the time-series index.
+class VTUPlotFile : public PlotFile
+{
+	// data for one piece (i.e. the whole mesh or one domain)
+	struct Piece
+	{
+		// geometry (rebuilt only when the mesh changes)
+		std::vector<int>			nodes;		// global node indices
+		std::vector<float>			points;		// coordinates
+		std::vector<int>			conn;		// connectivity
+		std::vector<int>			offsets;	// cell offsets
+		std::vector<unsigned char>	types;		// cell types
+		std::vector<int>			partId;		// domain index of cells
+		std::vector<int>			domains;	// domains in this piece
+
+		// state data
+		struct DataArray
+		{
+			std::string			name;
+			int					ncomp;
+			std::vector<float>	data;
+		};
+		std::vector<DataArray>	pointData;
+		std::vector<DataArray>	cellData;
+	};
+
+	// entry in time series index
+	struct TimeStep
+	{
+		double		time;
+		std::string	file;	// file name (relative to .pvd file)
+	};
+
+public:
+	VTUPlotFile(FEModel* fem, bool partitioned = false);
+
+	//! Open the plot database
+	bool Open(const char* szfile) override;
+
+	//! Open for appending
+	bool Append(const char* szfile) override;
+
+	//! Write current FE state to plot database
+	bool Write(float ftime, int flag = 0) override;
+
+	//! see if the plot file is valid
+	bool IsValid() const override;
+
+	void Serialize(DumpStream& ar) override;
+
+private:
+	void BuildGeometry();
+	bool MeshChanged();
+
+	void BuildPointData();
+	void BuildCellData();
+	void AddData(std::vector<Piece::DataArray>& list, const std::string& name, FEPlotData* pd, std::vector<float>& val);
+
+	bool WritePiece(const std::string& fileName, Piece& piece, double time);
+	bool WritePVTU(const std::string& fileName, const std::vector<std::string>& pieces, double time);
+	bool WritePVD();
+
+private:
+	bool	m_partitioned;	//!< write one piece per domain
+	bool	m_valid;
+	int		m_count;
+	std::string	m_filename;	//!< base file name (i.e. without extension)
+
+	std::vector<Piece>		m_piece;
+	std::vector<TimeStep>	m_steps;
+
+	// mesh signature (to detect mesh changes)
+	int		m_nodes;
+	int		m_elems;
+	int		m_doms;
+};
@@ -62,8 +62,7 @@ public:
 	mat3d operator()(const FEMaterialPoint& mp)
 	{
 		FEMaterialPoint& mp_noconst = const_cast<FEMaterialPoint&>(mp);
-		FEMicroMaterialPoint* mmppt = mp_noconst.ExtractData<FEMicroMaterialPoint>();
-		return m_mat->AveragedStressPK1(mmppt->m_rve, mp_noconst);
+		return m_mat->AveragedStressPK1(mp_noconst);
 	}
 
 private:
@@ -32,6 +32,7 @@ SOFTWARE.*/
 #include "FECore/mat3d.h"
 #include "FECore/tens6d.h"
 #include <FECore/log.h>
+#include <algorithm>
 
 //-----------------------------------------------------------------------------
 //! constructor
@@ -53,6 +54,12 @@ bool FEElasticMultiscaleDomain1O::Init()
 	// get the parent RVE
 	FERVEModel& rve = pmat->m_mrve;
 
+	// create the RVE models that are shared by the material points
+	if (pmat->m_bshared && (pmat->m_pool.IsInitialized() == false))
+	{
+		if (pmat->m_pool.Init(rve) == false) return false;
+	}
+
 	// loop over all elements
 	for (size_t i=0; i<m_Elem.size(); ++i)
 	{
@@ -65,14 +72,93 @@ bool FEElasticMultiscaleDomain1O::Init()
 			FEMicroMaterialPoint& mmpt = *mp.ExtractData<FEMicroMaterialPoint>();
 
 			// create the material point RVEs
+			// (Points that are probed already have their own.)
 			mmpt.m_F_prev = pt.m_F;	// TODO: I think I can remove this line
-			mmpt.m_rve.CopyFrom(rve);
-			if (mmpt.m_rve.Init() == false) return false;
-
-			// initialize RCI solve
-			if (mmpt.m_rve.RCI_Init() == false) return false;
+			if ((pmat->m_bshared == false) && (mmpt.m_rve == nullptr)) mmpt.m_rve = new FERVEModel;
+			if (mmpt.m_rve)
+			{
+				mmpt.m_rve->CopyFrom(rve);
+				if (mmpt.m_rve->Init() == false) return false;
+
+				// initialize RCI solve
+				if (mmpt.m_rve->RCI_Init() == false) return false;
+			}
 		}
 	}
 
 	return true;
 }
+
+//-----------------------------------------------------------------------------
+//! The RVE solves dominate the cost of this domain and their cost can vary a lot
+//! between integration points. Therefore, the kinematics are updated first and 
+//! then all the RVE solves are distributed dynamically over the threads, 
+//! starting with the ones that were most expensive in the last iteration. 
+void FEElasticMultiscaleDomain1O::Update(const FETimeInfo& tp)
+{
+	// update the kinematics
+	bool berr = false;
+	int NE = Elements();
+	#pragma omp parallel for shared(NE, berr)
+	for (int i = 0; i < NE; ++i)
+	{
+		try
+		{
+			FESolidElement& el = Element(i);
+			if (el.isActive())
+			{
+				UpdateElementKinematics(i, tp);
+			}
+		}
+		catch (NegativeJacobian e)
+		{
+			#pragma omp critical
+			{
+				berr = true;
+				if (e.DoOutput()) feLogError(e.what());
+			}
+		}
+	}
+	if (berr) throw NegativeJacobianDetected();
+
+	// collect all the integration points
+	m_pt.clear();
+	for (int i = 0; i < NE; ++i)
+	{
+		FESolidElement& el = Element(i);
+		if (el.isActive())
+		{
+			int nint = el.GaussPoints();
+			for (int n = 0; n < nint; ++n)
+			{
+				FEMaterialPoint* mp = el.GetMaterialPoint(n);
+				FEMicroMaterialPoint* mmpt = mp->ExtractData<FEMicroMaterialPoint>();
+				m_pt.push_back({ (mmpt ? mmpt->m_tsolve : 0.0), i, n });
+			}
+		}
+	}
+
+	// sort them so that the most expensive ones go first
+	std::stable_sort(m_pt.begin(), m_pt.end(), [](const RVEPoint& a, const RVEPoint& b) {
+		return a.tsolve > b.tsolve;
+	});
+
+	// solve the RVEs
+	bool bfail = false;
+	int NP = (int)m_pt.size();
+	#pragma omp parallel for schedule(dynamic, 1) shared(NP, bfail)
+	for (int i = 0; i < NP; ++i)
+	{
+		if (bfail) continue;
+		try
+		{
+			UpdatePointStress(m_Elem[m_pt[i].iel], m_pt[i].n, tp);
+		}
+		catch (FEMultiScaleException)
+		{
+			#pragma omp critical
+			bfail = true;
+		}
+	}
+	if (bfail) throw FEMultiScaleException(-1, -1);
+}
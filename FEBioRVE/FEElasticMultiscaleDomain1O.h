@@ -39,4 +39,17 @@ public:
 
 	//! initialize class
 	bool Init();
+
+	//! update the stresses
+	void Update(const FETimeInfo& tp) override;
+
+private:
+	// integration point that needs an RVE solve
+	struct RVEPoint
+	{
+		double	tsolve;	//!< solve time of the last RVE solve
+		int		iel;	//!< element index
+		int		n;		//!< integration point index
+	};
+	std::vector<RVEPoint>	m_pt;	//!< integration points that need an RVE solve
 };
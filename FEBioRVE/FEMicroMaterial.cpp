@@ -34,7 +34,9 @@ SOFTWARE.*/
 #include <FECore/mat6d.h>
 #include "FEBioMech/FEBCPrescribedDeformation.h"
 #include "FERVEProbe.h"
+#include <FECore/sys.h>
 #include <sstream>
+#include <chrono>
 
 //=============================================================================
 FEMicroMaterialPoint::FEMicroMaterialPoint()
@@ -45,6 +47,20 @@ FEMicroMaterialPoint::FEMicroMaterialPoint()
 	
 	m_macro_energy_inc = 0.;
 	m_micro_energy_inc = 0.;
+
+	m_rve = nullptr;
+	m_C.zero();
+	m_PK1.zero();
+	m_bcached = false;
+
+	m_dF.zero();
+	m_tsolve = 0.0;
+}
+
+//-----------------------------------------------------------------------------
+FEMicroMaterialPoint::~FEMicroMaterialPoint()
+{
+	delete m_rve;
 }
 
 //-----------------------------------------------------------------------------
@@ -62,8 +78,23 @@ void FEMicroMaterialPoint::Update(const FETimeInfo& timeInfo)
 	FEElasticMaterialPoint::Update(timeInfo);
 	m_F_prev = m_F;
 
-	// clear rewind stack so the next rewind won't overwrite current state
-	m_rve.RCI_ClearRewindStack();
+	if (m_rve)
+	{
+		// clear rewind stack so the next rewind won't overwrite current state
+		m_rve->RCI_ClearRewindStack();
+	}
+	else
+	{
+		// The RVE of a point whose response came from the cache should have been 
+		// solved when the time step converged (see FEMicroMaterial::UpdateCachedPoints).
+		assert(m_bcached == false);
+		if (m_rveState.IsEmpty() == false)
+		{
+			// the current state becomes the starting point of the next time step
+			m_rveState0.Swap(m_rveState);
+			m_rveState.Clear();
+		}
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -86,6 +117,11 @@ void FEMicroMaterialPoint::Serialize(DumpStream& ar)
 	ar & m_energy_diff;
 	ar & m_macro_energy_inc;
 	ar & m_micro_energy_inc;
+
+	// Points that share the RVE need its state at the last converged time step 
+	// when they are solved again. (This state doesn't change during a time step, 
+	// so it's not needed for shallow copies.)
+	if (ar.IsShallow() == false) m_rveState0.Serialize(ar);
 }
 
 //=============================================================================
@@ -97,6 +133,13 @@ BEGIN_FECORE_CLASS(FEMicroMaterial, FEElasticMaterial)
 	ADD_PARAMETER(m_szbc     , "bc_set"  );
 	ADD_PARAMETER(m_bctype   , "rve_type" );
 	ADD_PARAMETER(m_scale	 , "scale"   ); 
+	ADD_PARAMETER(m_bshared  , "shared_rve");
+	ADD_PARAMETER(m_bwarmStart, "warm_start");
+	ADD_PARAMETER(m_bcache     , "cache");
+	ADD_PARAMETER(m_cacheTol   , FE_RANGE_GREATER(0.0), "cache_tol");
+	ADD_PARAMETER(m_cacheSize  , FE_RANGE_GREATER_OR_EQUAL(0), "cache_size");
+	ADD_PARAMETER(m_cacheVerify, FE_RANGE_GREATER_OR_EQUAL(0), "cache_verify");
+	ADD_PARAMETER(m_cacheMaxErr, FE_RANGE_GREATER(0.0), "cache_max_error");
 
 	ADD_PROPERTY(m_probe, "probe", false);
 
@@ -110,6 +153,16 @@ FEMicroMaterial::FEMicroMaterial(FEModel* pfem) : FEElasticMaterial(pfem)
 	m_szbc[0] = 0;
 	m_bctype = FERVEModel::DISPLACEMENT;	// use displacement BCs by default
 	m_scale = 1.0;
+	m_bshared = true;
+	m_bwarmStart = true;
+	m_maxLoad = 0.0;
+
+	m_bcache = false;
+	m_cacheTol = 1e-4;
+	m_cacheSize = 100000;
+	m_cacheVerify = 20;
+	m_cacheMaxErr = 1e-3;
+	m_cacheOn = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -156,23 +209,298 @@ bool FEMicroMaterial::Init()
 		feLogError("An error occurred preparing RVE model"); return false;
 	}
 
+	// allocate the statistics of the RVE solves and report them after each time step
+	m_stats.assign(omp_get_max_threads(), FERVESolveStats());
+	m_total.clear();
+	m_maxLoad = 0.0;
+	GetFEModel()->AddCallback(report_cb, CB_MAJOR_ITERS | CB_SOLVED, (void*)this);
+
+	// set up the response cache
+	m_cache.SetTolerance(m_cacheTol);
+	m_cache.SetMaxSize(m_cacheSize);
+	m_cacheOn = m_bcache;
+
 	return true;
 }
 
+//-----------------------------------------------------------------------------
+bool FEMicroMaterial::report_cb(FEModel* fem, unsigned int nwhen, void* pd)
+{
+	FEMicroMaterial* mat = (FEMicroMaterial*)pd;
+	bool bret = true;
+	if (nwhen == CB_MAJOR_ITERS) bret = mat->UpdateCachedPoints();
+	mat->ReportStats(nwhen == CB_SOLVED);
+	return bret;
+}
+
+//-----------------------------------------------------------------------------
+bool FEMicroMaterial::UpdateCachedPoints()
+{
+	if (m_bcache == false) return true;
+
+	// find the points whose RVE state is not known
+	std::vector<FEMaterialPoint*> pts;
+	FEMesh& mesh = GetFEModel()->GetMesh();
+	for (int i = 0; i < mesh.Domains(); ++i)
+	{
+		FEDomain& dom = mesh.Domain(i);
+		if (dom.GetMaterial() != this) continue;
+		for (int j = 0; j < dom.Elements(); ++j)
+		{
+			FEElement& el = dom.ElementRef(j);
+			if (el.isActive() == false) continue;
+			for (int n = 0; n < el.GaussPoints(); ++n)
+			{
+				FEMaterialPoint* mp = el.GetMaterialPoint(n);
+				FEMicroMaterialPoint* pt = mp->ExtractData<FEMicroMaterialPoint>();
+				if (pt && pt->m_bcached) pts.push_back(mp);
+			}
+		}
+	}
+
+	// solve their RVEs at the converged deformation
+	bool bfail = false;
+	int NP = (int)pts.size();
+	#pragma omp parallel for schedule(dynamic, 1) shared(NP, bfail)
+	for (int i = 0; i < NP; ++i)
+	{
+		if (bfail) continue;
+		try
+		{
+			FEMaterialPoint& mp = *pts[i];
+			FEElasticMaterialPoint& pt = *mp.ExtractData<FEElasticMaterialPoint>();
+			pt.m_s = SolveRVE(mp, false);
+		}
+		catch (FEMultiScaleException)
+		{
+			#pragma omp critical
+			bfail = true;
+		}
+	}
+
+	if (bfail) feLogError("Failed to solve the RVEs of the cached responses of %s.", GetName().c_str());
+	return (bfail == false);
+}
+
+//-----------------------------------------------------------------------------
+void FEMicroMaterial::ReportStats(bool bfinal)
+{
+	// collect the statistics of all threads
+	FERVESolveStats s;
+	double tmax = 0.0;
+	for (FERVESolveStats& si : m_stats)
+	{
+		s.nsolves += si.nsolves;
+		s.niters += si.niters;
+		s.time += si.time;
+		if (si.maxTime > s.maxTime) s.maxTime = si.maxTime;
+		if (si.time > tmax) tmax = si.time;
+		s.nhits += si.nhits;
+		s.nverify += si.nverify;
+		s.nfail += si.nfail;
+		si.clear();
+	}
+
+	// thread load imbalance (max thread time over average thread time)
+	double load = (s.time > 0.0 ? tmax*m_stats.size() / s.time : 1.0);
+
+	if (s.nsolves > 0)
+	{
+		m_total.nsolves += s.nsolves;
+		m_total.niters += s.niters;
+		m_total.time += s.time;
+		if (s.maxTime > m_total.maxTime) m_total.maxTime = s.maxTime;
+		if (load > m_maxLoad) m_maxLoad = load;
+
+		feLog("RVE solves (%s): %d, avg. iterations = %lg, time = %lg s, max. time = %lg s, load imbalance = %lg\n", GetName().c_str(), s.nsolves, (double)s.niters / s.nsolves, s.time, s.maxTime, load);
+	}
+
+	if (m_bcache)
+	{
+		m_total.nhits += s.nhits;
+		m_total.nverify += s.nverify;
+		m_total.nfail += s.nfail;
+
+		int nq = s.nhits + s.nsolves;
+		if (nq > 0) feLog("RVE cache (%s): hits = %d (%lg%%), size = %d, tolerance = %lg\n", GetName().c_str(), s.nhits, 100.0*s.nhits / nq, m_cache.Size(), m_cache.GetTolerance());
+		if (s.nfail > 0) feLogWarning("%d of %d verified RVE cache hits failed. The cache tolerance was reduced to %lg.", s.nfail, s.nverify, m_cache.GetTolerance());
+		if ((m_cacheOn == false) && (s.nfail > 0)) feLogWarning("The RVE cache of %s was turned off.", GetName().c_str());
+	}
+
+	if (bfinal && (m_total.nsolves > 0))
+	{
+		FERVESolveStats& t = m_total;
+		feLog("\nRVE solve summary (%s):\n", GetName().c_str());
+		feLog("\tnumber of RVE solves ........ : %d\n", t.nsolves);
+		feLog("\taverage nr of iterations .... : %lg\n", (double)t.niters / t.nsolves);
+		feLog("\ttotal RVE solve time ........ : %lg s\n", t.time);
+		feLog("\tmax. time of one solve ...... : %lg s\n", t.maxTime);
+		feLog("\tmax. thread load imbalance .. : %lg\n", m_maxLoad);
+		if (m_bcache)
+		{
+			int nq = t.nhits + t.nsolves;
+			feLog("\tnumber of RVE cache hits .... : %d (%lg%%)\n", t.nhits, (nq > 0 ? 100.0*t.nhits / nq : 0.0));
+			feLog("\tverified cache hits ......... : %d (%d failed)\n", t.nverify, t.nfail);
+		}
+	}
+}
+
 //-----------------------------------------------------------------------------
 // Note that this function is not used in the first-order implemenetation
 mat3ds FEMicroMaterial::Stress(FEMaterialPoint &mp)
+{
+	return SolveRVE(mp, m_bcache);
+}
+
+//-----------------------------------------------------------------------------
+mat3ds FEMicroMaterial::SolveRVE(FEMaterialPoint &mp, bool buseCache)
 {
 	// get the deformation gradient
 	FEMicroMaterialPoint& pt = *mp.ExtractData<FEMicroMaterialPoint>();
 	mat3d F = pt.m_F;
 
+	// statistics of this thread
+	int nthread = omp_get_thread_num();
+	FERVESolveStats dummy;
+	FERVESolveStats& stats = ((nthread >= 0) && (nthread < (int)m_stats.size()) ? m_stats[nthread] : dummy);
+
+	// See if the response cache has a response close to this one. 
+	// (Only points that share the RVE can use it, since they don't need the RVE afterwards.)
+	// Other threads can turn the cache off, so m_cacheOn is only read in the critical sections.
+	bool bcache = (buseCache && (pt.m_rve == nullptr));
+	bool bverify = false;
+	mat3ds sc;
+	if (bcache)
+	{
+		FERVECache::Entry e;
+		bool bfound = false;
+		#pragma omp critical(FERVECache)
+		bfound = (m_cacheOn && m_cache.Find(F, pt.m_F_prev, e));
+		if (bfound)
+		{
+			sc = FERVECache::Stress(e, F);
+
+			// every so often, we check the cached response with an RVE solve
+			stats.ncount++;
+			if ((m_cacheVerify == 0) || (stats.ncount % m_cacheVerify != 0))
+			{
+				stats.nhits++;
+				pt.m_C = e.c;
+				pt.m_micro_energy = e.energy;
+				pt.m_PK1 = (sc*F.transinv())*F.det();
+
+				// The RVE state at this deformation is not known. If this turns out to be
+				// the converged state, the RVE is solved after the time step.
+				pt.m_bcached = true;
+				pt.m_rveState.Clear();
+				return sc;
+			}
+			else bverify = true;
+		}
+	}
+
+	// Get the RVE at the last converged time step. Points that share the RVE 
+	// restore their state into the RVE of the calling thread.
+	FERVEModel* prve = pt.m_rve;
+	if (prve) prve->RCI_Rewind();
+	else prve = &m_pool.Restore(pt.m_rveState0);
+	FERVEModel& rve = *prve;
+
+	// Seed the solve by extrapolating the solution increment of the last solve 
+	// along the deformation path. 
+	mat3d dF = F - pt.m_F_prev;
+	std::vector<double> U0;
+	if (m_bwarmStart)
+	{
+		U0 = rve.GetSolution();
+		double dF2 = pt.m_dF.dotdot(pt.m_dF);
+		if ((pt.m_du.size() == U0.size()) && (dF2 > 0.0))
+		{
+			double a = dF.dotdot(pt.m_dF) / dF2;
+			std::vector<double> du(pt.m_du);
+			for (double& di : du) di *= a;
+			rve.SetInitialGuess(du);
+		}
+	}
+
+	// solve the RVE for the new deformation
+	// (A shared RVE is never rewound, so its state doesn't need to be pushed.)
+	pt.m_bcached = false;
+	auto t0 = std::chrono::steady_clock::now();
+	rve.Advance(F, (pt.m_rve != nullptr));
+	double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+	// update statistics
+	pt.m_tsolve = t;
+	stats.nsolves++;
+	stats.niters += rve.Iterations();
+	stats.time += t;
+	if (t > stats.maxTime) stats.maxTime = t;
+
+	// store the solution increment for the next warm start
+	if (m_bwarmStart)
+	{
+		const std::vector<double>& U = rve.GetSolution();
+		pt.m_du.resize(U.size());
+		for (size_t i = 0; i < U.size(); ++i) pt.m_du[i] = U[i] - U0[i];
+		pt.m_dF = dF;
+	}
+
 	// calculate the averaged Cauchy stress
-	mat3ds sa = pt.m_rve.StressAverage(F, mp);
-	
+	mat3ds sa = rve.StressAverage(mp);
+
 	// calculate the difference between the macro and micro energy for Hill-Mandel condition
-	pt.m_micro_energy = micro_energy(pt.m_rve);	
-	
+	pt.m_micro_energy = micro_energy(rve);
+
+	// The shared RVE will be used by other points, so we 
+	// evaluate everything else we need from it now.
+	if (pt.m_rve == nullptr)
+	{
+		pt.m_C = rve.StiffnessAverage(mp);
+		pt.m_PK1 = AveragedStressPK1(rve, mp);
+		rve.SaveState(pt.m_rveState);
+	}
+
+	if (bcache)
+	{
+		// check the cached response
+		if (bverify)
+		{
+			stats.nverify++;
+			// The error is measured relative to the stress, but near the undeformed state
+			// we use the stress change over one cache cell as the reference instead.
+			double ns = sa.norm();
+			double n0 = pt.m_C.dot(mat3dd(m_cacheTol)).norm();
+			double sref = (ns > n0 ? ns : n0);
+			double err = (sref > 0.0 ? (sa - sc).norm() / sref : 0.0);
+			if (err > m_cacheMaxErr)
+			{
+				// Tighten the tolerance, or turn the cache off if that doesn't help.
+				stats.nfail++;
+				#pragma omp critical(FERVECache)
+				{
+					double tol = 0.5*m_cache.GetTolerance();
+					if (tol < 1e-3*m_cacheTol)
+					{
+						m_cacheOn = false;
+						m_cache.Clear();
+					}
+					else m_cache.SetTolerance(tol);
+				}
+			}
+		}
+
+		// add the response to the cache
+		FERVECache::Entry e;
+		e.F = F;
+		e.Fp = pt.m_F_prev;
+		e.s = sa;
+		e.c = pt.m_C;
+		e.energy = pt.m_micro_energy;
+		#pragma omp critical(FERVECache)
+		if (m_cacheOn) m_cache.Add(e);
+	}
+
 	return sa;
 }
 
@@ -183,7 +511,8 @@ mat3ds FEMicroMaterial::Stress(FEMaterialPoint &mp)
 tens4ds FEMicroMaterial::Tangent(FEMaterialPoint &mp)
 {
 	FEMicroMaterialPoint& mmpt = *mp.ExtractData<FEMicroMaterialPoint>();
-	return mmpt.m_rve.StiffnessAverage(mp);
+	if (mmpt.m_rve) return mmpt.m_rve->StiffnessAverage(mp);
+	return mmpt.m_C;
 }
 
 //-----------------------------------------------------------------------------
@@ -227,6 +556,14 @@ double FEMicroMaterial::micro_energy(FEModel& rve)
 	return E_avg/V0;
 }
 
+//-----------------------------------------------------------------------------
+mat3d FEMicroMaterial::AveragedStressPK1(FEMaterialPoint &mp)
+{
+	FEMicroMaterialPoint& mmpt = *mp.ExtractData<FEMicroMaterialPoint>();
+	if (mmpt.m_rve) return AveragedStressPK1(*mmpt.m_rve, mp);
+	return mmpt.m_PK1;
+}
+
 //-----------------------------------------------------------------------------
 //! Calculate the average stress from the RVE solution.
 mat3d FEMicroMaterial::AveragedStressPK1(FEModel& rve, FEMaterialPoint &mp)
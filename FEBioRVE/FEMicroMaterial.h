@@ -30,6 +30,8 @@ SOFTWARE.*/
 #include "FEPeriodicBoundary1O.h"
 #include "FECore/FECallBack.h"
 #include "FERVEModel.h"
+#include "FERVEPool.h"
+#include "FERVECache.h"
 #include "febiorve_api.h"
 
 class FERVEProbe;
@@ -41,6 +43,7 @@ class FEBIORVE_API FEMicroMaterialPoint : public FEElasticMaterialPoint
 public:
 	//! constructor
 	FEMicroMaterialPoint();
+	~FEMicroMaterialPoint();
 
 	//! Initialize material point data
 	void Init();
@@ -65,7 +68,35 @@ public:
 	double	   m_macro_energy_inc;	// Macroscopic strain energy increment
 	double	   m_micro_energy_inc;	// Microscopic strain energy increment
 
-	FERVEModel	m_rve;				// Local copy of the parent rve
+	FERVEModel*	m_rve;				// Local copy of the parent rve (null when the RVE is shared)
+
+	// data used when the RVE is shared (see FERVEPool)
+	FERVEState	m_rveState0;		// RVE state at the last converged time step
+	FERVEState	m_rveState;			// RVE state at the current iteration
+	tens4ds		m_C;				// averaged tangent
+	mat3d		m_PK1;				// averaged PK1 stress
+	bool		m_bcached;			// response was taken from the cache, so m_rveState is not known
+
+	// data used for warm starts and scheduling of the RVE solves
+	std::vector<double>	m_du;		// solution increment of the last RVE solve
+	mat3d				m_dF;		// increment of deformation gradient of the last RVE solve
+	double				m_tsolve;	// wall time of the last RVE solve
+};
+
+//-----------------------------------------------------------------------------
+//! Statistics of the RVE solves
+struct FERVESolveStats
+{
+	int		nsolves = 0;		// nr of RVE solves
+	int		niters = 0;			// total nr of RVE iterations
+	double	time = 0.0;			// total wall time of the RVE solves
+	double	maxTime = 0.0;		// wall time of slowest RVE solve
+	int		nhits = 0;			// nr of responses taken from the cache
+	int		nverify = 0;		// nr of cache hits that were verified with an RVE solve
+	int		nfail = 0;			// nr of verifications that failed
+	int		ncount = 0;			// counter of cache hits (not reset)
+
+	void clear() { int n = ncount; *this = FERVESolveStats(); ncount = n; }
 };
 
 //-----------------------------------------------------------------------------
@@ -84,12 +115,26 @@ public:
 	std::string	m_szbc;		//!< name of nodeset defining boundary
 	int			m_bctype;		//!< periodic bc flag
 	double		m_scale;		//!< RVE scale factor
+	bool		m_bshared;		//!< share the RVE models between material points
+	bool		m_bwarmStart;	//!< seed the RVE solves with the last solution increment
+
+	// surrogate response cache
+	bool		m_bcache;		//!< use the response cache
+	double		m_cacheTol;		//!< tolerance for cache hits
+	int			m_cacheSize;	//!< max nr of cache entries
+	int			m_cacheVerify;	//!< verify every n-th cache hit with an RVE solve (0 = never)
+	double		m_cacheMaxErr;	//!< max relative error of a verified cache hit
 	FERVEModel	m_mrve;			//!< the parent RVE (Representive Volume Element)
+	FERVEPool	m_pool;			//!< RVE models that are shared by the material points
 
 public:
 	//! calculate stress at material point
 	virtual mat3ds Stress(FEMaterialPoint& pt) override;
 
+	//! Solve the RVEs of the points whose converged response was taken from the cache,
+	//! so that their RVE states are known at the start of the next time step.
+	bool UpdateCachedPoints();
+
 	//! calculate tangent stiffness at material point
 	virtual tens4ds Tangent(FEMaterialPoint& pt) override;
 
@@ -102,6 +147,9 @@ public:
 	// calculate the average PK1 stress
 	mat3d AveragedStressPK1(FEModel& rve, FEMaterialPoint &mp);
 
+	// return the average PK1 stress of the material point's RVE
+	mat3d AveragedStressPK1(FEMaterialPoint &mp);
+
 	// calculate the average PK2 stress
 	mat3ds AveragedStressPK2(FEModel& rve, FEMaterialPoint &mp);
 
@@ -112,9 +160,25 @@ public:
 	int Probes() { return (int) m_probe.size(); }
 	FERVEProbe& Probe(int i) { return *m_probe[i]; }
 
+	// print the RVE solve statistics since the last call and reset them
+	void ReportStats(bool bfinal);
+
 protected:
 	std::vector<FERVEProbe*>	m_probe;
 
+private:
+	static bool report_cb(FEModel* fem, unsigned int nwhen, void* pd);
+
+	// solve the RVE of a material point (looking up the cache first, if bcache is true)
+	mat3ds SolveRVE(FEMaterialPoint& mp, bool bcache);
+
+private:
+	std::vector<FERVESolveStats>	m_stats;	//!< statistics of current time step (for each thread)
+	FERVESolveStats					m_total;	//!< total statistics
+	double							m_maxLoad;	//!< max (over time steps) of the thread load imbalance
+	FERVECache						m_cache;	//!< RVE response cache
+	bool							m_cacheOn;	//!< cache is active (turned off when it fails)
+
 public:
 	// declare the parameter list
 	DECLARE_FECORE_CLASS();
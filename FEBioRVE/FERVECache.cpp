@@ -0,0 +1,142 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#include "stdafx.h"
+#include "FERVECache.h"
+#include <math.h>
+
+//-----------------------------------------------------------------------------
+FERVECache::FERVECache()
+{
+	m_tol = 1e-4;
+	m_maxSize = 100000;
+}
+
+//-----------------------------------------------------------------------------
+void FERVECache::SetTolerance(double tol)
+{
+	// the grid depends on the tolerance, so we need to clear it
+	Clear();
+	m_tol = tol;
+}
+
+//-----------------------------------------------------------------------------
+void FERVECache::Clear()
+{
+	m_data.clear();
+	m_grid.clear();
+}
+
+//-----------------------------------------------------------------------------
+// the grid cell that contains the key
+void FERVECache::cell(const mat3d& F, long long c[3]) const
+{
+	double h = 3.0*m_tol;
+	for (int i = 0; i < 3; ++i)
+	{
+		double q = F(i, 0) + F(i, 1) + F(i, 2);
+		c[i] = (long long)floor(q / h);
+	}
+}
+
+//-----------------------------------------------------------------------------
+size_t FERVECache::hash(const long long c[3]) const
+{
+	size_t h = 14695981039346656037ULL;
+	for (int i = 0; i < 3; ++i) h = (h ^ (size_t)c[i]) * 1099511628211ULL;
+	return h;
+}
+
+//-----------------------------------------------------------------------------
+bool FERVECache::Find(const mat3d& F, const mat3d& Fp, Entry& e) const
+{
+	long long c[3], ci[3];
+	cell(F, c);
+
+	// find the closest entry in this and the neighbouring cells (the cells
+	// also contain keys that are not within the tolerance, and different 
+	// cells can have the same hash, so we need to check the distance)
+	int imin = -1;
+	double dmin = 0.0;
+	for (int i = -1; i <= 1; ++i)
+		for (int j = -1; j <= 1; ++j)
+			for (int k = -1; k <= 1; ++k)
+			{
+				ci[0] = c[0] + i; ci[1] = c[1] + j; ci[2] = c[2] + k;
+				auto it = m_grid.find(hash(ci));
+				if (it == m_grid.end()) continue;
+
+				for (int n : it->second)
+				{
+					const Entry& en = m_data[n];
+					double d = 0.0;
+					for (int a = 0; a < 3; ++a)
+						for (int b = 0; b < 3; ++b)
+						{
+							double dF = fabs(F(a, b) - en.F(a, b));
+							double dFp = fabs(Fp(a, b) - en.Fp(a, b));
+							if (dF > d) d = dF;
+							if (dFp > d) d = dFp;
+						}
+
+					if ((d <= m_tol) && ((imin < 0) || (d < dmin)))
+					{
+						imin = n;
+						dmin = d;
+					}
+				}
+			}
+	if (imin < 0) return false;
+
+	e = m_data[imin];
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+bool FERVECache::Add(const Entry& e)
+{
+	if ((int)m_data.size() >= m_maxSize) return false;
+	long long c[3];
+	cell(e.F, c);
+	m_grid[hash(c)].push_back((int)m_data.size());
+	m_data.push_back(e);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// The stress is extrapolated from the entry with the tangent, using the velocity
+// gradient of the increment of the deformation gradient. The spatial tangent is 
+// the tangent of the Truesdell rate of the Cauchy stress, so the stress increment
+// is ds = c:D + L*s + s*L^T - tr(D)*s.
+mat3ds FERVECache::Stress(const Entry& e, const mat3d& F)
+{
+	mat3d L = (F - e.F)*e.F.inverse();
+	mat3ds D = L.sym();
+	mat3d s = e.s;
+	mat3d ds = L*s + s*L.transpose();
+	return e.s + e.c.dot(D) + ds.sym() - e.s*D.tr();
+}
@@ -0,0 +1,90 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#pragma once
+#include <FECore/mat3d.h>
+#include <FECore/tens4d.h>
+#include "febiorve_api.h"
+#include <unordered_map>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+//! A cache of RVE responses that can be used instead of solving an RVE.
+//! Each entry is keyed by the deformation gradient F and the deformation 
+//! gradient Fp at the last converged time step, which stands in for the 
+//! history of the RVE. The entries are indexed on a uniform grid of the vector
+//! F*(1,1,1). Each component of this vector differs by at most 3*tol for two keys
+//! within the tolerance, so with a cell size of 3*tol, a query only needs to look 
+//! at its own cell and the neighbouring cells.
+class FEBIORVE_API FERVECache
+{
+public:
+	struct Entry
+	{
+		mat3d	F;			//!< deformation gradient
+		mat3d	Fp;			//!< deformation gradient at last converged time step
+		mat3ds	s;			//!< averaged Cauchy stress
+		tens4ds	c;			//!< averaged spatial tangent
+		double	energy;		//!< averaged micro energy
+	};
+
+public:
+	FERVECache();
+
+	//! set the tolerance (max. difference of any component of F and Fp)
+	void SetTolerance(double tol);
+	double GetTolerance() const { return m_tol; }
+
+	//! set the max nr of entries
+	void SetMaxSize(int n) { m_maxSize = n; }
+
+	//! nr of entries
+	int Size() const { return (int)m_data.size(); }
+
+	//! remove all entries
+	void Clear();
+
+	//! Find the closest entry within the tolerance. 
+	//! Returns false if there is none.
+	bool Find(const mat3d& F, const mat3d& Fp, Entry& e) const;
+
+	//! Add an entry. Returns false if the cache is full.
+	bool Add(const Entry& e);
+
+	//! Approximate the response at F from a nearby entry, using the tangent.
+	static mat3ds Stress(const Entry& e, const mat3d& F);
+
+private:
+	void cell(const mat3d& F, long long c[3]) const;
+	size_t hash(const long long c[3]) const;
+
+private:
+	double	m_tol;
+	int		m_maxSize;
+	std::vector<Entry>	m_data;
+	std::unordered_map<size_t, std::vector<int> >	m_grid;
+};
@@ -41,6 +41,8 @@ SOFTWARE.*/
 #include <FECore/FECube.h>
 #include <FECore/FEPointFunction.h>
 #include <FECore/FECoreKernel.h>
+#include <FECore/FENewtonSolver.h>
+#include <FECore/DumpStream.h>
 
 //-----------------------------------------------------------------------------
 FERVEModel::FERVEModel()
@@ -468,6 +470,16 @@ mat3ds FERVEModel::StressAverage(mat3d& F, FEMaterialPoint& mp)
 	// rewind the RCI
 	RCI_Rewind();
 
+	// solve the RVE for the new deformation
+	Advance(F);
+
+	// calculate and return the (Cuachy) stress average
+	return StressAverage(mp);
+}
+
+//-----------------------------------------------------------------------------
+void FERVEModel::Advance(const mat3d& F, bool pushState)
+{
 	// update the BC's
 	Update(F);
 
@@ -477,15 +489,122 @@ mat3ds FERVEModel::StressAverage(mat3d& F, FEMaterialPoint& mp)
 	SetCurrentTimeStep(ti.timeIncrement);
 
 	// advance the RVE solution
-	bool bret = RCI_Advance();
+	bool bret = RCI_Advance(pushState);
 
 	assert(ti.currentTime == GetCurrentTime());
 
 	// make sure it converged
 	if (bret == false) throw FEMultiScaleException(-1, -1);
+}
 
-	// calculate and return the (Cuachy) stress average
-	return StressAverage(mp);
+//-----------------------------------------------------------------------------
+FENewtonSolver* FERVEModel::GetNewtonSolver()
+{
+	FEAnalysis* step = GetCurrentStep();
+	return (step ? dynamic_cast<FENewtonSolver*>(step->GetFESolver()) : nullptr);
+}
+
+//-----------------------------------------------------------------------------
+void FERVEModel::SetInitialGuess(const std::vector<double>& du)
+{
+	FENewtonSolver* ns = GetNewtonSolver();
+	if (ns) ns->SetInitialGuess(du);
+}
+
+//-----------------------------------------------------------------------------
+const std::vector<double>& FERVEModel::GetSolution()
+{
+	FENewtonSolver* ns = GetNewtonSolver();
+	assert(ns);
+	return ns->m_Ut;
+}
+
+//-----------------------------------------------------------------------------
+int FERVEModel::Iterations()
+{
+	FEAnalysis* step = GetCurrentStep();
+	return (step ? step->GetFESolver()->m_niter : 0);
+}
+
+//-----------------------------------------------------------------------------
+// Stream that (de)serializes the RVE state to/from an FERVEState buffer.
+class FERVEStateStream : public DumpStream
+{
+public:
+	FERVEStateStream(FEModel& fem, std::vector<char>& buf) : DumpStream(fem), m_buf(buf), m_pos(0) {}
+
+	size_t write(const void* pd, size_t size, size_t count) override
+	{
+		size_t nsize = size*count;
+		const char* sz = (const char*)pd;
+		m_buf.insert(m_buf.end(), sz, sz + nsize);
+		return nsize;
+	}
+
+	size_t read(void* pd, size_t size, size_t count) override
+	{
+		size_t nsize = size*count;
+		if (m_pos + nsize > m_buf.size()) throw ReadError();
+		memcpy(pd, m_buf.data() + m_pos, nsize);
+		m_pos += nsize;
+		return nsize;
+	}
+
+	void clear() override { m_pos = 0; }
+
+	bool EndOfStream() const override { return (m_pos >= m_buf.size()); }
+
+private:
+	std::vector<char>&	m_buf;
+	size_t				m_pos;
+};
+
+//-----------------------------------------------------------------------------
+void FERVEState::Serialize(DumpStream& ar)
+{
+	if (ar.IsSaving())
+	{
+		int n = (int)m_buf.size();
+		ar << n;
+		if (n > 0) ar.write(m_buf.data(), 1, n);
+	}
+	else
+	{
+		int n = 0;
+		ar >> n;
+		m_buf.resize(n);
+		if (n > 0) ar.read(m_buf.data(), 1, n);
+	}
+}
+
+//-----------------------------------------------------------------------------
+void FERVEModel::SaveState(FERVEState& s)
+{
+	// reserve the size of the last state, which usually doesn't change
+	size_t n = s.m_buf.size();
+	s.m_buf.clear();
+	s.m_buf.reserve(n);
+
+	FERVEStateStream ar(*this, s.m_buf);
+	ar.Open(true, true);
+	Serialize(ar);
+}
+
+//-----------------------------------------------------------------------------
+void FERVEModel::RestoreState(const FERVEState& s)
+{
+	assert(s.IsEmpty() == false);
+	FERVEStateStream ar(*this, const_cast<std::vector<char>&>(s.m_buf));
+	ar.Open(false, true);
+	Serialize(ar);
+
+	// The stiffness matrix and initial guess were set for another state
+	FENewtonSolver* ns = GetNewtonSolver();
+	if (ns)
+	{
+		ns->m_bforceReform = true;
+		ns->SetInitialGuess(std::vector<double>());
+	}
 }
 
 //-----------------------------------------------------------------------------
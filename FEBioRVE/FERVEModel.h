@@ -30,6 +30,40 @@ SOFTWARE.*/
 #include "FECore/FEModel.h"
 #include <FECore/tens4d.h>
 #include "febiorve_api.h"
+#include <vector>
+
+class FENewtonSolver;
+
+//-----------------------------------------------------------------------------
+// The state of an RVE model. This stores the same data as a shallow
+// serialization of the model (nodal values, material point data, solver 
+// vectors and time step data), so that RVEs that share the same model can
+// be restored to their own state. 
+class FEBIORVE_API FERVEState
+{
+public:
+	FERVEState() {}
+
+	//! see if a state was stored
+	bool IsEmpty() const { return m_buf.empty(); }
+
+	//! size of the state (in bytes)
+	size_t size() const { return m_buf.size(); }
+
+	//! release the stored state
+	void Clear() { std::vector<char>().swap(m_buf); }
+
+	//! swap with another state
+	void Swap(FERVEState& s) { m_buf.swap(s.m_buf); }
+
+	//! serialize the state (e.g. for restarts)
+	void Serialize(DumpStream& ar);
+
+private:
+	std::vector<char>	m_buf;
+
+	friend class FERVEModel;
+};
 
 //-----------------------------------------------------------------------------
 // Class describing the RVE model.
@@ -82,6 +116,27 @@ public:
 	//! Calculate the stiffness average
 	tens4ds StiffnessAverage(FEMaterialPoint &mp);
 
+	//! Solve the RVE for the next time step of the parent model.
+	//! Throws an FEMultiScaleException if the RVE fails to converge.
+	//! Set pushState to false if the RVE won't be rewound (i.e. its state is
+	//! stored with SaveState instead).
+	void Advance(const mat3d& F, bool pushState = true);
+
+	//! Set an initial guess for the solution increment of the next Advance
+	void SetInitialGuess(const std::vector<double>& du);
+
+	//! return the total solution vector
+	const std::vector<double>& GetSolution();
+
+	//! return the nr of iterations of the last Advance
+	int Iterations();
+
+	//! store the current state of the RVE
+	void SaveState(FERVEState& s);
+
+	//! restore a state that was stored with SaveState
+	void RestoreState(const FERVEState& s);
+
 protected:
 	//! Calculate the initial volume
 	void EvalInitialVolume();
@@ -96,6 +151,8 @@ protected:
 	bool PrepPeriodicBC(const char* szbc);
 	bool PrepPeriodicLC();
 
+	FENewtonSolver* GetNewtonSolver();
+
 private:
 	// Hide the solve function so we can't call it. 
 	// (We use the RCI solution method)
@@ -0,0 +1,91 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#include "stdafx.h"
+#include "FERVEPool.h"
+#include <FECore/sys.h>
+
+//-----------------------------------------------------------------------------
+FERVEPool::FERVEPool()
+{
+}
+
+//-----------------------------------------------------------------------------
+FERVEPool::~FERVEPool()
+{
+	Clear();
+}
+
+//-----------------------------------------------------------------------------
+void FERVEPool::Clear()
+{
+	for (size_t i = 0; i < m_rve.size(); ++i) delete m_rve[i];
+	m_rve.clear();
+	m_s0.Clear();
+}
+
+//-----------------------------------------------------------------------------
+bool FERVEPool::Init(FERVEModel& rve)
+{
+	Clear();
+
+	int nt = omp_get_max_threads();
+	if (nt < 1) nt = 1;
+	for (int i = 0; i < nt; ++i)
+	{
+		FERVEModel* prve = new FERVEModel;
+		m_rve.push_back(prve);
+
+		prve->CopyFrom(rve);
+		if (prve->Init() == false) return false;
+
+		// initialize RCI solve
+		if (prve->RCI_Init() == false) return false;
+	}
+
+	// store the initial state, which all material points start from
+	m_rve[0]->SaveState(m_s0);
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+FERVEModel& FERVEPool::GetRVE()
+{
+	assert(IsInitialized());
+	int n = omp_get_thread_num();
+	if ((n < 0) || (n >= (int)m_rve.size())) n = 0;
+	return *m_rve[n];
+}
+
+//-----------------------------------------------------------------------------
+FERVEModel& FERVEPool::Restore(const FERVEState& s)
+{
+	FERVEModel& rve = GetRVE();
+	rve.RestoreState(s.IsEmpty() ? m_s0 : s);
+	return rve;
+}
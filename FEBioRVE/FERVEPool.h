@@ -0,0 +1,63 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#pragma once
+#include "FERVEModel.h"
+#include <vector>
+
+//-----------------------------------------------------------------------------
+//! A pool of RVE models that are shared by the material points of a 
+//! micro-material. Each thread gets its own copy of the parent RVE, which owns
+//! the mesh, the solver and the linear system. The material points only store 
+//! the state of their RVE (see FERVEState) and restore it into the model of
+//! the calling thread when they need to solve it.
+class FEBIORVE_API FERVEPool
+{
+public:
+	FERVEPool();
+	~FERVEPool();
+
+	//! create the RVE models from the parent RVE
+	bool Init(FERVEModel& rve);
+
+	//! see if the pool was initialized
+	bool IsInitialized() const { return (m_rve.empty() == false); }
+
+	//! return the RVE model of the calling thread
+	FERVEModel& GetRVE();
+
+	//! restore a state into the RVE of the calling thread. 
+	//! If the state is empty, the initial state is restored.
+	FERVEModel& Restore(const FERVEState& s);
+
+	//! release all models
+	void Clear();
+
+private:
+	std::vector<FERVEModel*>	m_rve;	//!< one model for each thread
+	FERVEState					m_s0;	//!< initial state of the RVE
+};
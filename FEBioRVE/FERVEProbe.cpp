@@ -145,7 +145,10 @@ bool FEMicroProbe::Init()
 		FEMaterialPoint* mp = pel->GetMaterialPoint(m_ngp);
 		FEMicroMaterialPoint* mmp = mp->ExtractData<FEMicroMaterialPoint>();
 		if (mmp == nullptr) return false;
-		SetRVEModel(&mmp->m_rve);
+
+		// the probe needs the RVE of this point, so it cannot be shared
+		if (mmp->m_rve == nullptr) mmp->m_rve = new FERVEModel;
+		SetRVEModel(mmp->m_rve);
 	}
 	else
 	{
@@ -202,8 +202,23 @@ FEBModel::Part::Part(const FEBModel::Part& part)
 	for (size_t i=0; i<part.m_Surf.size(); ++i) AddSurface(new Surface(*part.m_Surf[i]));
 	for (size_t i=0; i<part.m_NSet.size(); ++i) AddNodeSet(new NodeSet(*part.m_NSet[i]));
 	for (size_t i=0; i<part.m_ESet.size(); ++i) AddElementSet(new ElementSet(*part.m_ESet[i]));
+	for (size_t i = 0; i < part.m_LSet.size(); ++i) AddEdgeSet(new EdgeSet(*part.m_LSet[i]));
+	for (size_t i = 0; i < part.m_PList.size(); ++i) AddPartList(new PartList(*part.m_PList[i]));
 	for (size_t i = 0; i < part.m_SurfPair.size(); ++i) AddSurfacePair(new SurfacePair(*part.m_SurfPair[i]));
 	for (size_t i = 0; i < part.m_DiscSet.size(); ++i) AddDiscreteSet(new DiscreteSet(*part.m_DiscSet[i]));
+
+	// surfaces defined by part lists should point to the part lists of this part
+	for (size_t i = 0; i < m_Surf.size(); ++i)
+	{
+		PartList* pl = m_Surf[i]->GetPartList();
+		if (pl)
+		{
+			Surface* surf = new Surface(m_Surf[i]->Name(), FindPartList(pl->Name()));
+			surf->SetFacetList(m_Surf[i]->FacetList());
+			delete m_Surf[i];
+			m_Surf[i] = surf;
+		}
+	}
 }
 
 FEBModel::Part::~Part()
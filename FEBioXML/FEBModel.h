@@ -69,6 +69,19 @@ public:
 		int ntype;
 	};
 
+	// Mesh data that is defined together with the geometry (e.g. in a binary geometry file).
+	// The data maps are created after the mesh is built. 
+	struct MESH_DATA
+	{
+		enum { NODE_DATA, ELEM_DATA };
+
+		int		type;		// NODE_DATA or ELEM_DATA
+		std::string	name;		// name of data map
+		std::string	set;		// name of node set or element set
+		int		dataType;	// data type (FEDataType)
+		std::vector<double>	data;	// values (one value per set item)
+	};
+
 	class Domain
 	{
 	public:
@@ -268,6 +281,7 @@ public:
 		int Domains() const { return (int)m_Dom.size(); }
 		void AddDomain(Domain* dom);
 		const Domain& GetDomain(int i) const { return *m_Dom[i]; }
+		Domain& GetDomain(int i) { return *m_Dom[i]; }
 		Domain* FindDomain(const std::string& name);
 
 		int Surfaces() const { return (int) m_Surf.size(); }
@@ -333,6 +347,11 @@ public:
 
 	bool BuildPart(FEModel& fem, Part& part, bool buildDomains = true, const Transform& T = Transform());
 
+	void AddMeshData(const MESH_DATA& data) { m_Data.push_back(data); }
+	size_t MeshDataMaps() const { return m_Data.size(); }
+	const MESH_DATA& GetMeshData(size_t i) const { return m_Data[i]; }
+
 private:
 	std::vector<Part*>	m_Part;
+	std::vector<MESH_DATA>	m_Data;
 };
@@ -0,0 +1,558 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#include "stdafx.h"
+#include "FEBioBinaryGeometry.h"
+#include "FEModelBuilder.h"
+#include <FECore/fecore_type.h>
+#include <stdio.h>
+#include <stdint.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+//-----------------------------------------------------------------------------
+namespace {
+
+	struct FILE_HEADER
+	{
+		uint32_t	magic;
+		uint32_t	version;
+		uint32_t	flags;
+		uint32_t	checksum;
+		uint64_t	size;
+		uint64_t	storedSize;
+	};
+
+	bool is_little_endian()
+	{
+		const uint32_t n = 1;
+		return (*((const unsigned char*)&n) == 1);
+	}
+
+	// Helper class for reading the payload. All reads are bounds-checked.
+	class DataReader
+	{
+	public:
+		DataReader(const unsigned char* data, size_t size) : m_data(data), m_size(size), m_pos(0) {}
+
+		bool read(void* pd, size_t size)
+		{
+			if (size > m_size - m_pos) return false;
+			memcpy(pd, m_data + m_pos, size);
+			m_pos += size;
+			return true;
+		}
+
+		bool read(uint32_t& n) { return read(&n, sizeof(n)); }
+		bool read(uint64_t& n) { return read(&n, sizeof(n)); }
+
+		bool read(std::string& s)
+		{
+			uint32_t l = 0;
+			if (read(l) == false) return false;
+			if (l > m_size - m_pos) return false;
+			s.assign((const char*)m_data + m_pos, l);
+			m_pos += l;
+			return true;
+		}
+
+		// read an array of n items of size bytes each
+		template <typename T> bool read(std::vector<T>& v, size_t n)
+		{
+			if (n > (m_size - m_pos) / sizeof(T)) return false;
+			v.resize(n);
+			return (n == 0 ? true : read(&v[0], n * sizeof(T)));
+		}
+
+		const unsigned char* current() const { return m_data + m_pos; }
+		bool skip(size_t n) { if (n > m_size - m_pos) return false; m_pos += n; return true; }
+		bool eof() const { return (m_pos >= m_size); }
+
+	private:
+		const unsigned char*	m_data;
+		size_t	m_size;
+		size_t	m_pos;
+	};
+}
+
+//-----------------------------------------------------------------------------
+unsigned int FEBioBinaryGeometry::crc32(const void* data, size_t size, unsigned int crc)
+{
+	struct CRCTable {
+		uint32_t v[256];
+		CRCTable() {
+			for (uint32_t i = 0; i < 256; ++i)
+			{
+				uint32_t c = i;
+				for (int k = 0; k < 8; ++k) c = (c & 1 ? 0xEDB88320u ^ (c >> 1) : (c >> 1));
+				v[i] = c;
+			}
+		}
+	};
+	static const CRCTable table;
+
+	const unsigned char* p = (const unsigned char*)data;
+	uint32_t c = crc ^ 0xFFFFFFFFu;
+	for (size_t i = 0; i < size; ++i) c = table.v[(c ^ p[i]) & 0xFF] ^ (c >> 8);
+	return c ^ 0xFFFFFFFFu;
+}
+
+//=============================================================================
+// FEBioBinaryGeometryReader
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+FEBioBinaryGeometryReader::FEBioBinaryGeometryReader(FEModelBuilder* builder) : m_builder(builder)
+{
+}
+
+//-----------------------------------------------------------------------------
+bool FEBioBinaryGeometryReader::Error(const char* sz)
+{
+	m_err = sz;
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+bool FEBioBinaryGeometryReader::Load(const char* szfile, FEBModel::Part* part)
+{
+	using namespace FEBioBinaryGeometry;
+
+	if (is_little_endian() == false) return Error("Binary geometry files are not supported on this platform");
+
+	FILE* fp = fopen(szfile, "rb");
+	if (fp == nullptr) return Error("Failed opening binary geometry file");
+
+	// read the header
+	FILE_HEADER hdr;
+	if (fread(&hdr, sizeof(hdr), 1, fp) != 1) { fclose(fp); return Error("Failed reading binary geometry file header"); }
+	if (hdr.magic != MAGIC) { fclose(fp); return Error("Invalid binary geometry file"); }
+	if (hdr.version > VERSION) { fclose(fp); return Error("Unsupported binary geometry file version"); }
+
+	// read the payload
+	std::vector<unsigned char> buf;
+	try {
+		buf.resize((size_t)hdr.storedSize);
+	}
+	catch (...)
+	{
+		fclose(fp);
+		return Error("Invalid binary geometry file");
+	}
+	size_t nread = (hdr.storedSize > 0 ? fread(&buf[0], 1, (size_t)hdr.storedSize, fp) : 0);
+	fclose(fp);
+	if (nread != hdr.storedSize) return Error("Unexpected end of binary geometry file");
+
+	// uncompress if necessary
+	if (hdr.flags & COMPRESSED)
+	{
+#ifdef HAVE_ZLIB
+		std::vector<unsigned char> raw;
+		try {
+			raw.resize((size_t)hdr.size);
+		}
+		catch (...) { return Error("Invalid binary geometry file"); }
+		uLongf rawSize = (uLongf)hdr.size;
+		if ((hdr.size > 0) && (uncompress(&raw[0], &rawSize, &buf[0], (uLong)buf.size()) != Z_OK)) return Error("Failed decompressing binary geometry file");
+		if (rawSize != hdr.size) return Error("Failed decompressing binary geometry file");
+		buf.swap(raw);
+#else
+		return Error("Compressed binary geometry files require zlib");
+#endif
+	}
+	else if (hdr.size != hdr.storedSize) return Error("Invalid binary geometry file");
+
+	// verify the checksum
+	if (crc32(buf.data(), buf.size()) != hdr.checksum) return Error("Checksum error in binary geometry file");
+
+	// process all records
+	DataReader ar(buf.data(), buf.size());
+	while (ar.eof() == false)
+	{
+		uint32_t ntype = 0;
+		uint64_t size = 0;
+		if (!ar.read(ntype) || !ar.read(size)) return Error("Invalid record in binary geometry file");
+
+		const unsigned char* data = ar.current();
+		if (ar.skip((size_t)size) == false) return Error("Invalid record in binary geometry file");
+
+		if (ReadRecord(ntype, data, (size_t)size, part) == false) return false;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+bool FEBioBinaryGeometryReader::ReadRecord(int ntype, const unsigned char* data, size_t size, FEBModel::Part* part)
+{
+	using namespace FEBioBinaryGeometry;
+
+	DataReader ar(data, size);
+	switch (ntype)
+	{
+	case REC_NODES:
+	{
+		uint32_t N = 0;
+		std::vector<int> id;
+		std::vector<double> r;
+		if (!ar.read(N) || !ar.read(id, N) || !ar.read(r, 3 * (size_t)N)) return Error("Invalid nodes record");
+
+		// node IDs must be increasing
+		int maxID = (part->Nodes() > 0 ? part->GetNode(part->Nodes() - 1).id : 0);
+		std::vector<FEBModel::NODE> nodes(N);
+		for (uint32_t i = 0; i < N; ++i)
+		{
+			if (id[i] <= maxID) return Error("Node IDs must be increasing");
+			maxID = id[i];
+
+			FEBModel::NODE& nd = nodes[i];
+			nd.id = id[i];
+			nd.r = vec3d(r[3 * i], r[3 * i + 1], r[3 * i + 2]);
+		}
+		part->AddNodes(nodes);
+	}
+	break;
+	case REC_DOMAIN:
+	{
+		std::string name, elemType;
+		uint32_t N = 0, nn = 0;
+		if (!ar.read(name) || !ar.read(elemType) || !ar.read(N) || !ar.read(nn)) return Error("Invalid domain record");
+		if ((nn == 0) || (nn > FEElement::MAX_NODES)) return Error("Invalid number of element nodes");
+
+		std::vector<int> id, node;
+		if (!ar.read(id, N) || !ar.read(node, (size_t)N * nn)) return Error("Invalid domain record");
+
+		FE_Element_Spec espec = m_builder->ElementSpec(elemType.c_str());
+		if (FEElementLibrary::IsValid(espec) == false) return Error("Invalid element type in binary geometry file");
+
+		if (part->FindDomain(name)) return Error("Duplicate domain name in binary geometry file");
+
+		std::vector<FEBModel::ELEMENT> elems(N);
+		std::vector<int> elemList(N);
+		for (uint32_t i = 0; i < N; ++i)
+		{
+			FEBModel::ELEMENT& el = elems[i];
+			el.id = id[i];
+			if ((i > 0) && (el.id <= id[i - 1])) return Error("Element IDs must be increasing");
+			for (uint32_t j = 0; j < nn; ++j) el.node[j] = node[(size_t)i * nn + j];
+			elemList[i] = el.id;
+		}
+
+		FEBModel::Domain* dom = new FEBModel::Domain(espec);
+		dom->SetName(name);
+		dom->SetElementList(elems);
+		part->AddDomain(dom);
+
+		// as in the xml format, we also create an element set
+		FEBModel::ElementSet* pg = new FEBModel::ElementSet(name);
+		pg->SetElementList(elemList);
+		part->AddElementSet(pg);
+	}
+	break;
+	case REC_SURFACE:
+	{
+		std::string name;
+		uint32_t N = 0, nn = 0;
+		if (!ar.read(name) || !ar.read(N) || !ar.read(nn)) return Error("Invalid surface record");
+		if ((nn == 0) || (nn > FEElement::MAX_NODES)) return Error("Invalid number of facet nodes");
+
+		std::vector<int> ftype, node;
+		if (!ar.read(ftype, N) || !ar.read(node, (size_t)N * nn)) return Error("Invalid surface record");
+
+		if (part->FindSurface(name)) return Error("Duplicate surface name in binary geometry file");
+
+		FEBModel::Surface* ps = new FEBModel::Surface(name);
+		part->AddSurface(ps);
+		ps->Create(N);
+		for (uint32_t i = 0; i < N; ++i)
+		{
+			FEBModel::FACET& face = ps->GetFacet(i);
+			face.id = i + 1;
+			face.ntype = ftype[i];
+			switch (face.ntype)
+			{
+			case 3: case 4: case 6: case 7: case 8: case 9: break;
+			default:
+				return Error("Invalid facet type in binary geometry file");
+			}
+			if (face.ntype > (int)nn) return Error("Invalid facet type in binary geometry file");
+			for (uint32_t j = 0; j < nn; ++j) face.node[j] = node[(size_t)i * nn + j];
+		}
+	}
+	break;
+	case REC_NODESET:
+	{
+		std::string name;
+		uint32_t N = 0;
+		std::vector<int> nodeList;
+		if (!ar.read(name) || !ar.read(N) || !ar.read(nodeList, N)) return Error("Invalid node set record");
+
+		if (part->FindNodeSet(name)) return Error("Duplicate node set name in binary geometry file");
+
+		FEBModel::NodeSet* set = new FEBModel::NodeSet(name);
+		set->SetNodeList(nodeList);
+		part->AddNodeSet(set);
+	}
+	break;
+	case REC_ELEMSET:
+	{
+		std::string name;
+		uint32_t N = 0;
+		std::vector<int> elemList;
+		if (!ar.read(name) || !ar.read(N) || !ar.read(elemList, N)) return Error("Invalid element set record");
+
+		if (part->FindElementSet(name)) return Error("Duplicate element set name in binary geometry file");
+
+		FEBModel::ElementSet* set = new FEBModel::ElementSet(name);
+		set->SetElementList(elemList);
+		part->AddElementSet(set);
+	}
+	break;
+	case REC_NODEDATA:
+	case REC_ELEMDATA:
+	{
+		FEBModel::MESH_DATA md;
+		md.type = (ntype == REC_NODEDATA ? FEBModel::MESH_DATA::NODE_DATA : FEBModel::MESH_DATA::ELEM_DATA);
+		uint32_t dataType = 0, N = 0;
+		if (!ar.read(md.name) || !ar.read(md.set) || !ar.read(dataType) || !ar.read(N)) return Error("Invalid mesh data record");
+
+		switch (dataType)
+		{
+		case FE_DOUBLE: case FE_VEC2D: case FE_VEC3D: break;
+		case FE_MAT3D: case FE_MAT3DS:
+			if (md.type == FEBModel::MESH_DATA::ELEM_DATA) break;
+			// fall through
+		default:
+			return Error("Invalid data type in binary geometry file");
+		}
+		md.dataType = (int)dataType;
+
+		if (!ar.read(md.data, (size_t)N * fecore_data_size((FEDataType)dataType))) return Error("Invalid mesh data record");
+
+		m_builder->GetFEBModel().AddMeshData(md);
+	}
+	break;
+	default:
+		// unknown records are skipped
+		break;
+	}
+
+	return true;
+}
+
+//=============================================================================
+// FEBioBinaryGeometryWriter
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+FEBioBinaryGeometryWriter::FEBioBinaryGeometryWriter()
+{
+	m_recordStart = 0;
+}
+
+//-----------------------------------------------------------------------------
+void FEBioBinaryGeometryWriter::write(const void* pd, size_t size)
+{
+	const unsigned char* p = (const unsigned char*)pd;
+	m_buf.insert(m_buf.end(), p, p + size);
+}
+
+//-----------------------------------------------------------------------------
+void FEBioBinaryGeometryWriter::write(const std::string& s)
+{
+	write((unsigned int)s.size());
+	write(s.c_str(), s.size());
+}
+
+//-----------------------------------------------------------------------------
+void FEBioBinaryGeometryWriter::BeginRecord(int ntype)
+{
+	write((unsigned int)ntype);
+	uint64_t size = 0;
+	m_recordStart = m_buf.size();
+	write(&size, sizeof(size));
+}
+
+//-----------------------------------------------------------------------------
+void FEBioBinaryGeometryWriter::EndRecord()
+{
+	uint64_t size = m_buf.size() - m_recordStart - sizeof(uint64_t);
+	memcpy(&m_buf[m_recordStart], &size, sizeof(size));
+}
+
+//-----------------------------------------------------------------------------
+void FEBioBinaryGeometryWriter::AddNodes(const std::vector<FEBModel::NODE>& nodes)
+{
+	size_t N = nodes.size();
+	std::vector<int> id(N);
+	std::vector<double> r(3 * N);
+	for (size_t i = 0; i < N; ++i)
+	{
+		id[i] = nodes[i].id;
+		r[3 * i    ] = nodes[i].r.x;
+		r[3 * i + 1] = nodes[i].r.y;
+		r[3 * i + 2] = nodes[i].r.z;
+	}
+
+	BeginRecord(FEBioBinaryGeometry::REC_NODES);
+	write((unsigned int)N);
+	write(id.data(), N * sizeof(int));
+	write(r.data(), 3 * N * sizeof(double));
+	EndRecord();
+}
+
+//-----------------------------------------------------------------------------
+void FEBioBinaryGeometryWriter::AddDomain(const std::string& name, const std::string& elemType, int nodesPerElem, const std::vector<FEBModel::ELEMENT>& elems)
+{
+	size_t N = elems.size();
+	size_t nn = nodesPerElem;
+	std::vector<int> id(N), node(N * nn);
+	for (size_t i = 0; i < N; ++i)
+	{
+		id[i] = elems[i].id;
+		for (size_t j = 0; j < nn; ++j) node[i * nn + j] = elems[i].node[j];
+	}
+
+	BeginRecord(FEBioBinaryGeometry::REC_DOMAIN);
+	write(name);
+	write(elemType);
+	write((unsigned int)N);
+	write((unsigned int)nn);
+	write(id.data(), N * sizeof(int));
+	write(node.data(), N * nn * sizeof(int));
+	EndRecord();
+}
+
+//-----------------------------------------------------------------------------
+void FEBioBinaryGeometryWriter::AddSurface(const std::string& name, const std::vector<FEBModel::FACET>& faces)
+{
+	size_t N = faces.size();
+	size_t nn = 0;
+	for (size_t i = 0; i < N; ++i) if (faces[i].ntype > (int)nn) nn = faces[i].ntype;
+
+	std::vector<int> ftype(N), node(N * nn, 0);
+	for (size_t i = 0; i < N; ++i)
+	{
+		ftype[i] = faces[i].ntype;
+		for (int j = 0; j < faces[i].ntype; ++j) node[i * nn + j] = faces[i].node[j];
+	}
+
+	BeginRecord(FEBioBinaryGeometry::REC_SURFACE);
+	write(name);
+	write((unsigned int)N);
+	write((unsigned int)nn);
+	write(ftype.data(), N * sizeof(int));
+	write(node.data(), N * nn * sizeof(int));
+	EndRecord();
+}
+
+//-----------------------------------------------------------------------------
+void FEBioBinaryGeometryWriter::AddNodeSet(const std::string& name, const std::vector<int>& nodes)
+{
+	BeginRecord(FEBioBinaryGeometry::REC_NODESET);
+	write(name);
+	write((unsigned int)nodes.size());
+	write(nodes.data(), nodes.size() * sizeof(int));
+	EndRecord();
+}
+
+//-----------------------------------------------------------------------------
+void FEBioBinaryGeometryWriter::AddElementSet(const std::string& name, const std::vector<int>& elems)
+{
+	BeginRecord(FEBioBinaryGeometry::REC_ELEMSET);
+	write(name);
+	write((unsigned int)elems.size());
+	write(elems.data(), elems.size() * sizeof(int));
+	EndRecord();
+}
+
+//-----------------------------------------------------------------------------
+void FEBioBinaryGeometryWriter::AddNodeData(const std::string& name, const std::string& nodeSet, FEDataType dataType, const std::vector<double>& data)
+{
+	int dataSize = fecore_data_size(dataType);
+	BeginRecord(FEBioBinaryGeometry::REC_NODEDATA);
+	write(name);
+	write(nodeSet);
+	write((unsigned int)dataType);
+	write((unsigned int)(data.size() / dataSize));
+	write(data.data(), data.size() * sizeof(double));
+	EndRecord();
+}
+
+//-----------------------------------------------------------------------------
+void FEBioBinaryGeometryWriter::AddElementData(const std::string& name, const std::string& elemSet, FEDataType dataType, const std::vector<double>& data)
+{
+	int dataSize = fecore_data_size(dataType);
+	BeginRecord(FEBioBinaryGeometry::REC_ELEMDATA);
+	write(name);
+	write(elemSet);
+	write((unsigned int)dataType);
+	write((unsigned int)(data.size() / dataSize));
+	write(data.data(), data.size() * sizeof(double));
+	EndRecord();
+}
+
+//-----------------------------------------------------------------------------
+bool FEBioBinaryGeometryWriter::Write(const char* szfile, bool compress)
+{
+	using namespace FEBioBinaryGeometry;
+
+	if (is_little_endian() == false) return false;
+
+	FILE_HEADER hdr;
+	hdr.magic = MAGIC;
+	hdr.version = VERSION;
+	hdr.flags = 0;
+	hdr.checksum = crc32(m_buf.data(), m_buf.size());
+	hdr.size = m_buf.size();
+	hdr.storedSize = m_buf.size();
+
+	const unsigned char* pd = m_buf.data();
+	std::vector<unsigned char> comp;
+	if (compress)
+	{
+#ifdef HAVE_ZLIB
+		uLongf compSize = compressBound((uLong)m_buf.size());
+		comp.resize(compSize);
+		if (compress2(comp.data(), &compSize, m_buf.data(), (uLong)m_buf.size(), Z_BEST_SPEED) != Z_OK) return false;
+		hdr.flags |= COMPRESSED;
+		hdr.storedSize = compSize;
+		pd = comp.data();
+#else
+		return false;
+#endif
+	}
+
+	FILE* fp = fopen(szfile, "wb");
+	if (fp == nullptr) return false;
+	bool bok = (fwrite(&hdr, sizeof(hdr), 1, fp) == 1);
+	if (bok && (hdr.storedSize > 0)) bok = (fwrite(pd, 1, (size_t)hdr.storedSize, fp) == hdr.storedSize);
+	fclose(fp);
+
+	return bok;
+}
@@ -0,0 +1,141 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#pragma once
+#include "FEBModel.h"
+#include "febioxml_api.h"
+#include <FECore/fecore_enum.h>
+
+class FEModelBuilder;
+
+//-----------------------------------------------------------------------------
+// The binary geometry file (.febg) is a compact alternative to defining the mesh
+// as XML text. It is referenced from the Mesh section of a 4.0 feb file:
+//
+//    <Mesh>
+//        <BinaryMesh file="model.febg"/>
+//        ...
+//    </Mesh>
+//
+// The file starts with a fixed header (all values little-endian):
+//
+//    uint32  magic          'FEBG'
+//    uint32  version
+//    uint32  flags          (bit 0: payload is zlib compressed)
+//    uint32  checksum       (CRC-32 of the uncompressed payload)
+//    uint64  payload size   (uncompressed)
+//    uint64  stored size    (size of payload in file)
+//
+// The payload is a sequence of records, each one starting with a uint32 record
+// type and a uint64 record size. Unknown record types are skipped. Strings are 
+// stored as a uint32 length followed by the characters. 
+//
+//    NODES    : uint32 N, int32 id[N], double r[3N]
+//    DOMAIN   : string name, string elem_type, uint32 N, uint32 nodes, int32 id[N], int32 node[N*nodes]
+//    SURFACE  : string name, uint32 N, uint32 nodes, int32 ntype[N], int32 node[N*nodes]
+//    NODESET  : string name, uint32 N, int32 node[N]
+//    ELEMSET  : string name, uint32 N, int32 elem[N]
+//    NODEDATA : string name, string node_set, uint32 data_type, uint32 N, double v[N*size]
+//    ELEMDATA : string name, string elem_set, uint32 data_type, uint32 N, double v[N*size]
+//
+// Domains also define an element set with the same name, as in the XML format. 
+// Node and element IDs must be increasing. The data maps are created after the
+// mesh is built, i.e. after the MeshDomains section was read.
+namespace FEBioBinaryGeometry {
+
+	enum { MAGIC = 0x47424546, VERSION = 1 };
+
+	enum Flags { COMPRESSED = 1 };
+
+	enum RecordType {
+		REC_NODES    = 1,
+		REC_DOMAIN   = 2,
+		REC_SURFACE  = 3,
+		REC_NODESET  = 4,
+		REC_ELEMSET  = 5,
+		REC_NODEDATA = 6,
+		REC_ELEMDATA = 7
+	};
+
+	// calculate the CRC-32 checksum of a buffer
+	FEBIOXML_API unsigned int crc32(const void* data, size_t size, unsigned int crc = 0);
+}
+
+//-----------------------------------------------------------------------------
+// Reads a binary geometry file into the FEBModel
+class FEBIOXML_API FEBioBinaryGeometryReader
+{
+public:
+	FEBioBinaryGeometryReader(FEModelBuilder* builder);
+
+	// Read the file and add its content to the part. 
+	bool Load(const char* szfile, FEBModel::Part* part);
+
+	// get the last error
+	const std::string& GetErrorString() const { return m_err; }
+
+private:
+	bool Error(const char* sz);
+
+	bool ReadRecord(int ntype, const unsigned char* data, size_t size, FEBModel::Part* part);
+
+private:
+	FEModelBuilder*	m_builder;
+	std::string		m_err;
+};
+
+//-----------------------------------------------------------------------------
+// Writes a binary geometry file. This is meant for tools that generate models
+// programmatically. Add all the mesh components and then call Write.
+class FEBIOXML_API FEBioBinaryGeometryWriter
+{
+public:
+	FEBioBinaryGeometryWriter();
+
+	void AddNodes(const std::vector<FEBModel::NODE>& nodes);
+	void AddDomain(const std::string& name, const std::string& elemType, int nodesPerElem, const std::vector<FEBModel::ELEMENT>& elems);
+	void AddSurface(const std::string& name, const std::vector<FEBModel::FACET>& faces);
+	void AddNodeSet(const std::string& name, const std::vector<int>& nodes);
+	void AddElementSet(const std::string& name, const std::vector<int>& elems);
+	void AddNodeData(const std::string& name, const std::string& nodeSet, FEDataType dataType, const std::vector<double>& data);
+	void AddElementData(const std::string& name, const std::string& elemSet, FEDataType dataType, const std::vector<double>& data);
+
+	// Write the file. Compression requires zlib. 
+	bool Write(const char* szfile, bool compress = false);
+
+private:
+	void BeginRecord(int ntype);
+	void EndRecord();
+
+	void write(const void* pd, size_t size);
+	void write(unsigned int n) { write(&n, sizeof(n)); }
+	void write(const std::string& s);
+
+private:
+	std::vector<unsigned char>	m_buf;	// payload
+	size_t	m_recordStart;
+};
@@ -32,6 +32,9 @@ SOFTWARE.*/
 #include <FECore/FEModel.h>
 #include <FECore/FEMaterial.h>
 #include <FECore/FECoreKernel.h>
+#include <FECore/FENodeDataMap.h>
+#include <FECore/FEDomainMap.h>
+#include <FECore/fecore_type.h>
 #include <sstream>
 
 FEBioMeshDomainsSection4::FEBioMeshDomainsSection4(FEBioImport* pim) : FEBioFileSection(pim) 
@@ -69,6 +72,9 @@ void FEBioMeshDomainsSection4::Parse(XMLTag& tag)
 	// tell the file reader to rebuild the node ID table
 	GetBuilder()->BuildNodeList();
 
+	// create the data maps that were defined with the geometry
+	BuildMeshData();
+
 	// At this point the mesh is completely read in.
 	// allocate material point data
 	FEModel& fem = *GetFEModel();
@@ -84,6 +90,70 @@ void FEBioMeshDomainsSection4::Parse(XMLTag& tag)
 	fem.GetMesh().SetDOFS(MAX_DOFS);
 }
 
+//-----------------------------------------------------------------------------
+// set the values of a data map from an array with one value per item
+static void set_map_values(FEDataMap& map, FEDataType dataType, const std::vector<double>& data)
+{
+	int dataSize = fecore_data_size(dataType);
+	int N = (int)data.size() / dataSize;
+	for (int i = 0; i < N; ++i)
+	{
+		const double* v = &data[i * dataSize];
+		switch (dataType)
+		{
+		case FE_DOUBLE: map.setValue(i, v[0]); break;
+		case FE_VEC2D : map.setValue(i, vec2d(v[0], v[1])); break;
+		case FE_VEC3D : map.setValue(i, vec3d(v[0], v[1], v[2])); break;
+		case FE_MAT3D : map.setValue(i, mat3d(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8])); break;
+		case FE_MAT3DS: map.setValue(i, mat3ds(v[0], v[1], v[2], v[3], v[4], v[5])); break;
+		default:
+			assert(false);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Mesh data can be defined together with the geometry (e.g. in binary geometry files).
+// These data maps can only be created after the mesh was built.
+void FEBioMeshDomainsSection4::BuildMeshData()
+{
+	FEBModel& feb = GetBuilder()->GetFEBModel();
+	FEMesh& mesh = GetFEModel()->GetMesh();
+	for (size_t i = 0; i < feb.MeshDataMaps(); ++i)
+	{
+		const FEBModel::MESH_DATA& md = feb.GetMeshData(i);
+		FEDataType dataType = (FEDataType)md.dataType;
+		int N = (int)md.data.size() / fecore_data_size(dataType);
+
+		if (md.type == FEBModel::MESH_DATA::NODE_DATA)
+		{
+			FENodeSet* nset = GetBuilder()->FindNodeSet(md.set);
+			if (nset == nullptr) throw XMLReader::Error("Invalid node set for node data " + md.name);
+			if (nset->Size() != N) throw FEBioImport::MeshDataError();
+
+			FENodeDataMap* map = new FENodeDataMap(dataType);
+			map->Create(nset);
+			map->SetName(md.name);
+			set_map_values(*map, dataType, md.data);
+			mesh.AddDataMap(map);
+		}
+		else
+		{
+			FEElementSet* elset = mesh.FindElementSet(md.set);
+			if (elset == nullptr) throw XMLReader::Error("Invalid element set for element data " + md.name);
+			if (elset->Elements() != N) throw FEBioImport::MeshDataError();
+
+			Storage_Fmt fmt = (((dataType == FE_MAT3D) || (dataType == FE_MAT3DS)) ? Storage_Fmt::FMT_ITEM : Storage_Fmt::FMT_MULT);
+			FEDomainMap* map = new FEDomainMap(dataType, fmt);
+			map->Create(elset);
+			map->SetName(md.name);
+			set_map_values(*map, dataType, md.data);
+			mesh.AddDataMap(map);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
 void FEBioMeshDomainsSection4::BuildNLT()
 {
 	FEModel& fem = *GetFEModel();
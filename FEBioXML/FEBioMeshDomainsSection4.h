@@ -43,6 +43,7 @@ protected:
 
 private:
 	void BuildNLT();
+	void BuildMeshData();
 
 private:
 	std::vector<int>	m_NLT;
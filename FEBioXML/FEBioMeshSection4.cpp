@@ -28,8 +28,189 @@ SOFTWARE.*/
 
 #include "stdafx.h"
 #include "FEBioMeshSection4.h"
+#include "FEBioBinaryGeometry.h"
 #include <FECore/FEModel.h>
+#include <FECore/FEModelCache.h>
 #include <sstream>
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+// Helper functions for the fast import of the Nodes and Elements sections. These 
+// parse the raw content of a memory-mapped input file directly and in parallel. 
+// Only the common layout <node id="n">x,y,z</node> (and the equivalent for elements)
+// is handled. If anything else is encountered (e.g. comments, entity references or 
+// additional attributes), the functions return false and the regular parser is used.
+namespace {
+
+// size of the chunks that are processed in parallel
+const ptrdiff_t FAST_IMPORT_CHUNK_SIZE = 1 << 18;
+
+inline const char* skip_space(const char* sz, const char* szend)
+{
+	while ((sz < szend) && isspace((unsigned char)*sz)) sz++;
+	return sz;
+}
+
+// find the next start tag with the given name
+const char* find_start_tag(const char* sz, const char* szend, const char* szname, size_t l)
+{
+	while (sz < szend)
+	{
+		sz = (const char*)memchr(sz, '<', szend - sz);
+		if (sz == nullptr) return szend;
+		if ((szend - sz > (ptrdiff_t)l + 1) && (strncmp(sz + 1, szname, l) == 0) && isspace((unsigned char)sz[l + 1])) return sz;
+		sz++;
+	}
+	return szend;
+}
+
+// Read a record of the form <name id="n">value</name>. Returns a pointer past the 
+// record, or null if the record does not have this form. 
+const char* read_record(const char* sz, const char* szend, const char* szname, size_t l, int& id, const char*& szval, const char*& szvalend)
+{
+	// start tag
+	if ((szend - sz < (ptrdiff_t)l + 2) || (*sz != '<') || (strncmp(sz + 1, szname, l) != 0)) return nullptr;
+	sz += l + 1;
+	if (!isspace((unsigned char)*sz)) return nullptr;
+	sz = skip_space(sz, szend);
+
+	// id attribute
+	if ((szend - sz < 2) || (sz[0] != 'i') || (sz[1] != 'd')) return nullptr;
+	sz = skip_space(sz + 2, szend);
+	if ((sz >= szend) || (*sz != '=')) return nullptr;
+	sz = skip_space(sz + 1, szend);
+	if ((sz >= szend) || ((*sz != '"') && (*sz != '\''))) return nullptr;
+	char quot = *sz++;
+	const char* szq = (const char*)memchr(sz, quot, szend - sz);
+	if ((szq == nullptr) || memchr(sz, '&', szq - sz)) return nullptr;
+	id = atoi(sz);
+	sz = skip_space(szq + 1, szend);
+	if ((sz >= szend) || (*sz != '>')) return nullptr;
+	sz++;
+
+	// value
+	szval = sz;
+	szvalend = (const char*)memchr(sz, '<', szend - sz);
+	if ((szvalend == nullptr) || memchr(szval, '&', szvalend - szval)) return nullptr;
+
+	// end tag
+	sz = szvalend;
+	if ((szend - sz < (ptrdiff_t)l + 3) || (sz[1] != '/') || (strncmp(sz + 2, szname, l) != 0)) return nullptr;
+	sz = skip_space(sz + l + 2, szend);
+	if ((sz >= szend) || (*sz != '>')) return nullptr;
+	return sz + 1;
+}
+
+// Split the content in chunks at record boundaries and parse the chunks in parallel.
+// The parse function has the signature bool(int id, const char* szval, const char* szvalend, T& item).
+template <class T, class F> bool parse_records(const char* szbeg, const char* szend, const char* szname, F parse, std::vector<T>& items)
+{
+	size_t l = strlen(szname);
+
+	// find the chunk boundaries
+	std::vector<const char*> chunk;
+	chunk.push_back(find_start_tag(szbeg, szend, szname, l));
+	while (chunk.back() < szend)
+	{
+		const char* sz = chunk.back();
+		chunk.push_back(szend - sz > FAST_IMPORT_CHUNK_SIZE ? find_start_tag(sz + FAST_IMPORT_CHUNK_SIZE, szend, szname, l) : szend);
+	}
+
+	// the content before the first record should only contain whitespace
+	if (skip_space(szbeg, chunk[0]) != chunk[0]) return false;
+
+	int chunks = (int)chunk.size() - 1;
+	std::vector< std::vector<T> > data(chunks);
+	std::vector<char> ok(chunks, 1);
+
+#pragma omp parallel for schedule(dynamic)
+	for (int n = 0; n < chunks; ++n)
+	{
+		std::vector<T>& d = data[n];
+		d.reserve((chunk[n + 1] - chunk[n]) / 32);
+		const char* sz = chunk[n];
+		const char* sze = chunk[n + 1];
+		while (sz < sze)
+		{
+			int id = 0;
+			const char* szval = nullptr, *szvalend = nullptr;
+			sz = read_record(sz, sze, szname, l, id, szval, szvalend);
+			T item;
+			if ((sz == nullptr) || (parse(id, szval, szvalend, item) == false)) { ok[n] = 0; break; }
+			d.push_back(item);
+			sz = skip_space(sz, sze);
+		}
+	}
+
+	// collect the results
+	size_t N = 0;
+	for (int n = 0; n < chunks; ++n)
+	{
+		if (ok[n] == 0) return false;
+		N += data[n].size();
+	}
+	items.resize(N);
+	size_t m = 0;
+	for (int n = 0; n < chunks; ++n)
+	{
+		std::copy(data[n].begin(), data[n].end(), items.begin() + m);
+		m += data[n].size();
+	}
+
+	return true;
+}
+
+// Parse the nodes. The value is parsed as in FEFileSection::value(XMLTag&, vec3d&).
+bool parse_nodes(const char* szbeg, const char* szend, std::vector<FEBModel::NODE>& nodes)
+{
+	return parse_records(szbeg, szend, "node", [](int id, const char* sz, const char* szend, FEBModel::NODE& nd) {
+		nd.id = id;
+		double* v[3] = { &nd.r.x, &nd.r.y, &nd.r.z };
+		for (int i = 0; i < 3; ++i)
+		{
+			char* ch = nullptr;
+			*v[i] = strtod(sz, &ch);
+			if ((ch == sz) || (ch > szend)) return false;
+			sz = ch;
+			if (i < 2)
+			{
+				if (*sz != ',') return false;
+				sz++;
+			}
+		}
+		return true;
+	}, nodes);
+}
+
+// Parse the elements. The value is parsed as in XMLTag::value(int*, int).
+bool parse_elements(const char* szbeg, const char* szend, std::vector<FEBModel::ELEMENT>& elems)
+{
+	return parse_records(szbeg, szend, "elem", [](int id, const char* sz, const char* szend, FEBModel::ELEMENT& el) {
+		el.id = id;
+		for (int i = 0; i < FEElement::MAX_NODES; ++i)
+		{
+			el.node[i] = atoi(sz);
+			const char* sze = (const char*)memchr(sz, ',', szend - sz);
+			if (sze) sz = sze + 1;
+			else break;
+		}
+		return true;
+	}, elems);
+}
+
+// The parsed mesh stored in the model cache
+class FEBioMeshCacheItem : public FEModelCache::Item
+{
+public:
+	FEBioMeshCacheItem(const std::string& text, const FEBModel::Part& part, int maxNodeId, const std::vector<std::string>& elemType) : m_text(text), m_part(part), m_maxNodeId(maxNodeId), m_elemType(elemType) {}
+
+	std::string					m_text;		// text of the Mesh section
+	FEBModel::Part				m_part;
+	int							m_maxNodeId;
+	std::vector<std::string>	m_elemType;	// element type of each domain
+};
+
+} // namespace
 
 //-----------------------------------------------------------------------------
 FEBioMeshSection4::FEBioMeshSection4(FEBioImport* pim) : FEBioFileSection(pim) 
@@ -43,12 +224,58 @@ void FEBioMeshSection4::Parse(XMLTag& tag)
 	FEModelBuilder* builder = GetBuilder();
 	builder->m_maxid = 0;
 	m_maxNodeId = 0;
+	m_elemType.clear();
 
 	// create a default part
 	// NOTE: Do not specify a name for the part, otherwise
 	//       all lists will be given the name: partname.listname
 	FEBModel& feb = builder->GetFEBModel();
 	assert(feb.Parts() == 0);
+
+	// When the model cache is enabled, see if this mesh was read before. The key is 
+	// calculated from the text of the Mesh section, so this requires a mapped file. 
+	// The text is also compared on a hit, since different meshes can have the same key.
+	// Meshes that reference external files are not cached.
+	FEModelCache& cache = FEModelCache::GetInstance();
+	XMLReader& xml = *tag.m_preader;
+	const char* szbeg = nullptr, *szend = nullptr;
+	bool bcache = false;
+	uint64_t key = 0;
+	if (cache.IsEnabled() && xml.GetRawContent(tag, szbeg, szend))
+	{
+		const char* szbin = "<BinaryMesh";
+		if (std::search(szbeg, szend, szbin, szbin + strlen(szbin)) == szend)
+		{
+			FEModelCache::Hash hash;
+			hash.add(szbeg, szend - szbeg);
+			key = hash.value();
+			bcache = true;
+
+			std::shared_ptr<FEBioMeshCacheItem> item = std::dynamic_pointer_cast<FEBioMeshCacheItem>(cache.Find("febio_mesh", key));
+			if (item && (item->m_text.compare(0, std::string::npos, szbeg, szend - szbeg) != 0)) item = nullptr;
+			if (item)
+			{
+				FEBModel::Part* part = new FEBModel::Part(item->m_part);
+				feb.AddPart(part);
+				m_maxNodeId = item->m_maxNodeId;
+
+				// The element specs depend on the module and control settings, and evaluating 
+				// them also sets the builder's integration rules and shell options. So, 
+				// evaluate them again, as if the Elements sections were read.
+				assert(part->Domains() == (int)item->m_elemType.size());
+				for (int i = 0; i < part->Domains(); ++i)
+				{
+					FE_Element_Spec espec = builder->ElementSpec(item->m_elemType[i].c_str());
+					if (FEElementLibrary::IsValid(espec) == false) throw FEBioImport::InvalidElementType();
+					part->GetDomain(i).SetElementSpec(espec);
+				}
+
+				xml.SkipRawContent(tag, szend);
+				return;
+			}
+		}
+	}
+
 	FEBModel::Part* part = feb.AddPart("");
 
 	// read all sections
@@ -64,10 +291,13 @@ void FEBioMeshSection4::Parse(XMLTag& tag)
 		else if (tag == "PartList"   ) ParsePartListSection   (tag, part);
 		else if (tag == "SurfacePair") ParseSurfacePairSection(tag, part);
 		else if (tag == "DiscreteSet") ParseDiscreteSetSection(tag, part);
+		else if (tag == "BinaryMesh" ) ParseBinaryMeshSection (tag, part);
 		else throw XMLReader::InvalidTag(tag);
 		++tag;
 	}
 	while (!tag.isend());
+
+	if (bcache) cache.Store("febio_mesh", key, std::make_shared<FEBioMeshCacheItem>(std::string(szbeg, szend), *part, m_maxNodeId, m_elemType));
 }
 
 //-----------------------------------------------------------------------------
@@ -89,8 +319,42 @@ void FEBioMeshSection4::ParseNodeSection(XMLTag& tag, FEBModel::Part* part)
 
 	// allocate node
 
-	vector<FEBModel::NODE> node; node.reserve(10000);
-	vector<int> nodeList; nodeList.reserve(10000);
+	vector<FEBModel::NODE> node;
+	vector<int> nodeList;
+
+	// For memory-mapped files, we try to process the nodes in bulk first. 
+	XMLReader& xml = *tag.m_preader;
+	const char* szbeg = nullptr, *szend = nullptr;
+	if (xml.GetRawContent(tag, szbeg, szend) && parse_nodes(szbeg, szend, node))
+	{
+		// make sure node IDs are incrementing
+		bool bok = true;
+		int maxNodeId = m_maxNodeId;
+		for (size_t i = 0; i < node.size(); ++i)
+		{
+			if (node[i].id <= maxNodeId) { bok = false; break; }
+			maxNodeId = node[i].id;
+		}
+
+		if (bok)
+		{
+			m_maxNodeId = maxNodeId;
+			nodeList.resize(node.size());
+			for (size_t i = 0; i < node.size(); ++i) nodeList[i] = node[i].id;
+
+			xml.SkipRawContent(tag, szend);
+
+			part->AddNodes(node);
+			if (ps) ps->SetNodeList(nodeList);
+			return;
+		}
+
+		// let the regular parser report the error
+		node.clear();
+	}
+
+	node.reserve(10000);
+	nodeList.reserve(10000);
 
 	// read nodal coordinates
 	++tag;
@@ -139,6 +403,7 @@ void FEBioMeshSection4::ParseElementSection(XMLTag& tag, FEBModel::Part* part)
 	const char* sztype = tag.AttributeValue("type");
 	FE_Element_Spec espec = GetBuilder()->ElementSpec(sztype);
 	if (FEElementLibrary::IsValid(espec) == false) throw FEBioImport::InvalidElementType();
+	m_elemType.push_back(sztype);
 
 	// make sure the domain does not exist yet
 	FEBModel::Domain* dom = part->FindDomain(szname);
@@ -164,8 +429,38 @@ void FEBioMeshSection4::ParseElementSection(XMLTag& tag, FEBModel::Part* part)
 		part->AddElementSet(pg);
 	}
 
+	vector<int> elemList;
+
+	// For memory-mapped files, we try to process the elements in bulk first. 
+	XMLReader& xml = *tag.m_preader;
+	const char* szbeg = nullptr, *szend = nullptr;
+	vector<FEBModel::ELEMENT> elem;
+	if (xml.GetRawContent(tag, szbeg, szend) && parse_elements(szbeg, szend, elem))
+	{
+		// make sure the element IDs are increasing
+		bool bok = true;
+		for (size_t i = 1; i < elem.size(); ++i)
+		{
+			if (elem[i].id <= elem[i - 1].id) { bok = false; break; }
+		}
+
+		if (bok)
+		{
+			elemList.resize(elem.size());
+			for (size_t i = 0; i < elem.size(); ++i) elemList[i] = elem[i].id;
+
+			xml.SkipRawContent(tag, szend);
+
+			dom->SetElementList(elem);
+			if (pg) pg->SetElementList(elemList);
+			return;
+		}
+
+		// let the regular parser report the error
+	}
+
 	dom->Reserve(10000);
-	vector<int> elemList; elemList.reserve(10000);
+	elemList.reserve(10000);
 
 	// keep track of largest ID
 	// we need to enforce that element IDs are increasing
@@ -438,3 +733,33 @@ void FEBioMeshSection4::ParseDiscreteSetSection(XMLTag& tag, FEBModel::Part* par
 		++tag;
 	} while (!tag.isend());
 }
+
+//-----------------------------------------------------------------------------
+//! Reads the geometry from a binary geometry file (see FEBioBinaryGeometry.h)
+void FEBioMeshSection4::ParseBinaryMeshSection(XMLTag& tag, FEBModel::Part* part)
+{
+	const char* szfile = tag.AttributeValue("file");
+
+	// see if we need to pre-pend a path
+	string fileName = szfile;
+	if ((strchr(szfile, '/') == nullptr) && (strchr(szfile, '\\') == nullptr))
+	{
+		fileName = string(GetFileReader()->GetFilePath()) + fileName;
+	}
+
+	// node IDs must be larger than the ones defined so far
+	int N0 = part->Nodes();
+
+	FEBioBinaryGeometryReader reader(GetBuilder());
+	if (reader.Load(fileName.c_str(), part) == false)
+	{
+		throw XMLReader::Error(tag, reader.GetErrorString() + string(" : ") + fileName);
+	}
+
+	int NN = part->Nodes();
+	if (NN > N0)
+	{
+		if (part->GetNode(N0).id <= m_maxNodeId) throw XMLReader::InvalidAttributeValue(tag, "file", szfile);
+		m_maxNodeId = part->GetNode(NN - 1).id;
+	}
+}
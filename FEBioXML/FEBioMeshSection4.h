@@ -49,7 +49,9 @@ protected:
 	void ParseEdgeSection       (XMLTag& tag, FEBModel::Part* part);
 	void ParseSurfacePairSection(XMLTag& tag, FEBModel::Part* part);
 	void ParseDiscreteSetSection(XMLTag& tag, FEBModel::Part* part);
+	void ParseBinaryMeshSection (XMLTag& tag, FEBModel::Part* part);
 
 private:
 	int m_maxNodeId;
+	std::vector<std::string>	m_elemType;	// element type of each domain (stored in the model cache)
 };
@@ -144,6 +144,15 @@ void FEBioOutputSection::ParseLogfile(XMLTag &tag)
 			else if (strcmp(szcomment, "off") == 0) bcomment = false;
 		}
 
+		// optional binary (columnar) file format
+		bool bbinary = false;
+		const char* szfileformat = tag.AttributeValue("file_format", true);
+		if (szfileformat)
+		{
+			if (strcmp(szfileformat, "binary") == 0) bbinary = true;
+			else if (strcmp(szfileformat, "text") != 0) throw XMLReader::InvalidAttributeValue(tag, "file_format", szfileformat);
+		}
+
 		// get the data attribute
 		const char* szdata = tag.AttributeValue("data");
 
@@ -275,6 +284,7 @@ void FEBioOutputSection::ParseLogfile(XMLTag &tag)
 		{
 			pdr->SetData(szdata);
 			if (szname != 0) pdr->SetName(szname); else pdr->SetName(szdata);
+			pdr->SetBinary(bbinary);
 			if (szfile) pdr->SetFileName(szfile);
 			if (szdelim != 0) pdr->SetDelim(szdelim);
 			if (szformat != 0) pdr->SetFormat(szformat);
@@ -287,6 +297,52 @@ void FEBioOutputSection::ParseLogfile(XMLTag &tag)
 	while (!tag.isend());
 }
 
+//-----------------------------------------------------------------------------
+// Parses the optional encoding attributes of a plot variable, e.g.
+// <var type="fluid pressure" encoding="delta,shuffle" abs_tol="1e-6" key_frame="20"/>
+// Specifying a tolerance implies quantization. 
+static FEPlotEncoding ParsePlotEncoding(XMLTag& tag)
+{
+	FEPlotEncoding enc;
+
+	const char* szenc = tag.AttributeValue("encoding", true);
+	if (szenc)
+	{
+		std::string s(szenc);
+		size_t pos = 0;
+		while (pos <= s.size())
+		{
+			size_t end = s.find(',', pos);
+			if (end == std::string::npos) end = s.size();
+			std::string w = s.substr(pos, end - pos);
+			w.erase(0, w.find_first_not_of(' '));
+			w.erase(w.find_last_not_of(' ') + 1);
+
+			if      (w == "delta"   ) enc.m_flags |= PLOT_ENCODE_DELTA;
+			else if (w == "shuffle" ) enc.m_flags |= PLOT_ENCODE_SHUFFLE;
+			else if (w == "quantize") enc.m_flags |= PLOT_ENCODE_QUANTIZE;
+			else if ((w == "none") || w.empty()) {}
+			else throw XMLReader::InvalidAttributeValue(tag, "encoding", szenc);
+
+			pos = end + 1;
+		}
+	}
+
+	const char* sztol = tag.AttributeValue("abs_tol", true);
+	if (sztol) { enc.m_abstol = atof(sztol); enc.m_flags |= PLOT_ENCODE_QUANTIZE; }
+
+	sztol = tag.AttributeValue("rel_tol", true);
+	if (sztol) { enc.m_reltol = atof(sztol); enc.m_flags |= PLOT_ENCODE_QUANTIZE; }
+
+	const char* szkey = tag.AttributeValue("key_frame", true);
+	if (szkey) enc.m_keyFrame = atoi(szkey);
+
+	if ((enc.m_flags & PLOT_ENCODE_QUANTIZE) && (enc.m_abstol <= 0.0) && (enc.m_reltol <= 0.0))
+		throw XMLReader::InvalidAttributeValue(tag, "encoding", "quantize (requires abs_tol or rel_tol)");
+
+	return enc;
+}
+
 //-----------------------------------------------------------------------------
 void FEBioOutputSection::ParsePlotfile(XMLTag &tag)
 {
@@ -299,7 +355,9 @@ void FEBioOutputSection::ParsePlotfile(XMLTag &tag)
 	if (sz)
 	{
 		if ((strcmp(sz, "febio" ) != 0) && 
-			(strcmp(sz, "vtk"   ) != 0)) throw XMLReader::InvalidAttributeValue(tag, "type", sz);
+			(strcmp(sz, "vtk"   ) != 0) &&
+			(strcmp(sz, "vtu"   ) != 0) &&
+			(strcmp(sz, "pvtu"  ) != 0)) throw XMLReader::InvalidAttributeValue(tag, "type", sz);
 	}
 	else sz = "febio";
 	plotData.SetPlotFileType(sz);
@@ -342,6 +400,9 @@ void FEBioOutputSection::ParsePlotfile(XMLTag &tag)
 				vector<int> item;
 				if (tag.isempty() == false) tag.value(item);
 
+				// get the (optional) encoding
+				FEPlotEncoding enc = ParsePlotEncoding(tag);
+
                 // see if a surface is referenced
                 const char* szsurf = tag.AttributeValue("surface", true);
                 const char* szeset = tag.AttributeValue("elem_set", true);
@@ -364,7 +425,7 @@ void FEBioOutputSection::ParsePlotfile(XMLTag &tag)
 
                         // Add the plot variable
                         const std::string& surfName = psurf->GetName();
-						plotData.AddPlotVariable(szt, item, surfName.c_str());
+						plotData.AddPlotVariable(szt, item, surfName.c_str()).m_enc = enc;
                     }
                     else throw XMLReader::InvalidAttributeValue(tag, "surface", szsurf);
                 }
@@ -381,14 +442,14 @@ void FEBioOutputSection::ParsePlotfile(XMLTag &tag)
 					if (ps)
 					{
 						// Add the plot variable
-						plotData.AddPlotVariable(szt, item, szeset);
+						plotData.AddPlotVariable(szt, item, szeset).m_enc = enc;
 					}
 					else throw XMLReader::InvalidAttributeValue(tag, "elem_set", szeset);
 				}
                 else
                 {
                     // Add the plot variable
-					plotData.AddPlotVariable(szt, item);
+					plotData.AddPlotVariable(szt, item).m_enc = enc;
                 }
 			}
 			else if (tag=="compression")
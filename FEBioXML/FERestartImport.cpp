@@ -32,6 +32,7 @@ SOFTWARE.*/
 #include "FECore/FEAnalysis.h"
 #include "FECore/FEModel.h"
 #include "FECore/DumpFile.h"
+#include "FECore/DumpArchive.h"
 #include <FECore/FETimeStepController.h>
 #include "FEBioLoadDataSection.h"
 #include "FEBioStepSection.h"
@@ -211,12 +212,19 @@ bool FERestartImport::Load(FEModel& fem, const char* szfile)
 		char szar[256];
 		tag.value(szar);
 
-		// open the archive
-		DumpFile ar(fem);
-		if (ar.Open(szar) == false) return errf("FATAL ERROR: failed opening restart archive\n");
+		// open the archive (older archives are not compressed)
+		DumpArchive car(fem);
+		DumpFile dar(fem);
+		DumpStream* par = nullptr;
+		if (DumpArchive::IsValidFile(szar))
+		{
+			if (car.Open(szar)) par = &car;
+		}
+		else if (dar.Open(szar)) par = &dar;
+		if (par == nullptr) return errf("FATAL ERROR: failed opening restart archive\n");
 
 		// read the archive
-		fem.Serialize(ar);
+		fem.Serialize(*par);
 
 		// set the module name
 		GetBuilder()->SetActiveModule(fem.GetModuleName());
@@ -0,0 +1,413 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#include "stdafx.h"
+#include "AsyncFileWriter.h"
+#include <vector>
+#include <deque>
+#include <set>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <signal.h>
+
+//-----------------------------------------------------------------------------
+class AsyncFileWriter::Imp
+{
+public:
+	typedef std::vector<char> Buffer;
+
+public:
+	Imp() : fp(nullptr), npending(0) {}
+
+	// hands the current buffer over to the writer thread
+	void submit();
+
+	// wait until the writer thread has written all pending buffers
+	void wait();
+
+public:
+	FILE*	fp;
+	Buffer	cur;		// buffer currently being filled
+	std::vector<Buffer>	spare;		// recycled buffers (guarded by the writer thread's mutex)
+	int		npending;	// nr of submitted buffers that are not written yet (idem)
+};
+
+//-----------------------------------------------------------------------------
+// The writer thread. This is shared by all writers, so that a model with many
+// output files doesn't start a thread per file. Buffers are written in the order
+// they were submitted, which keeps the output of each file in order.
+namespace {
+
+	class WriterThread
+	{
+	public:
+		typedef AsyncFileWriter::Imp::Buffer Buffer;
+
+		struct Job
+		{
+			AsyncFileWriter::Imp*	imp;
+			Buffer					buf;
+		};
+
+	public:
+		WriterThread() : users(0), stop(false), busy(false) {}
+
+		// register a writer; the thread is started for the first one
+		void attach()
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			if (users++ == 0)
+			{
+				stop = false;
+				thread = std::thread(&WriterThread::run, this);
+			}
+		}
+
+		// unregister a writer (after it was flushed); the thread stops with the last one
+		void detach()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mtx);
+				if (--users > 0) return;
+				stop = true;
+				work.notify_one();
+			}
+			thread.join();
+		}
+
+		void run()
+		{
+			std::unique_lock<std::mutex> lock(mtx);
+			while (true)
+			{
+				work.wait(lock, [this]() { return (stop || (queue.empty() == false)); });
+				if (queue.empty()) break;
+
+				Job job;
+				job.imp = queue.front().imp;
+				job.buf.swap(queue.front().buf);
+				queue.pop_front();
+				busy = true;
+
+				lock.unlock();
+				fwrite(job.buf.data(), 1, job.buf.size(), job.imp->fp);
+				lock.lock();
+
+				busy = false;
+				AsyncFileWriter::Imp* imp = job.imp;
+				imp->npending--;
+				job.buf.clear();
+				if (imp->spare.size() < AsyncFileWriter::MAX_PENDING)
+				{
+					imp->spare.push_back(Buffer());
+					imp->spare.back().swap(job.buf);
+				}
+				idle.notify_all();
+			}
+		}
+
+		// Called from a signal handler: write what we can directly, without
+		// blocking. This is best effort; the process is about to terminate.
+		void emergencyFlush()
+		{
+			// give the writer thread a moment to finish the buffer it is on
+			for (int i = 0; (i < 100000) && busy; ++i) std::this_thread::yield();
+			if (busy) return;
+
+			if (mtx.try_lock())
+			{
+				for (size_t i = 0; i < queue.size(); ++i)
+				{
+					Job& job = queue[i];
+					fwrite(job.buf.data(), 1, job.buf.size(), job.imp->fp);
+				}
+				queue.clear();
+				mtx.unlock();
+			}
+		}
+
+	public:
+		std::mutex	mtx;
+		std::condition_variable	work;	// signals the writer thread
+		std::condition_variable	idle;	// signals that a buffer was written
+		std::deque<Job>	queue;		// buffers waiting to be written
+
+	private:
+		std::thread	thread;
+		int		users;
+		bool	stop;
+		std::atomic<bool>	busy;
+	};
+
+	// This is never deleted, so that the thread can't be destroyed while it is
+	// still running (e.g. when a writer is still open at exit).
+	WriterThread& writer_thread()
+	{
+		static WriterThread* w = new WriterThread;
+		return *w;
+	}
+}
+
+//-----------------------------------------------------------------------------
+void AsyncFileWriter::Imp::submit()
+{
+	if (cur.empty()) return;
+
+	WriterThread& w = writer_thread();
+	std::unique_lock<std::mutex> lock(w.mtx);
+
+	// don't let the queue grow without bounds if the disk can't keep up
+	w.idle.wait(lock, [this]() { return (npending < MAX_PENDING); });
+
+	w.queue.push_back(WriterThread::Job());
+	w.queue.back().imp = this;
+	w.queue.back().buf.swap(cur);
+	npending++;
+	if (spare.empty() == false)
+	{
+		cur.swap(spare.back());
+		spare.pop_back();
+	}
+	else cur.reserve(BUFFER_SIZE);
+
+	w.work.notify_one();
+}
+
+//-----------------------------------------------------------------------------
+void AsyncFileWriter::Imp::wait()
+{
+	WriterThread& w = writer_thread();
+	std::unique_lock<std::mutex> lock(w.mtx);
+	w.idle.wait(lock, [this]() { return (npending == 0); });
+}
+
+//-----------------------------------------------------------------------------
+// Registry of all open writers, so they can be flushed on exit or crash.
+namespace {
+
+	// set in forked worker processes
+	bool discard_output = false;
+
+	std::mutex& registry_mutex()
+	{
+		static std::mutex m;
+		return m;
+	}
+
+	std::set<AsyncFileWriter::Imp*>& registry()
+	{
+		static std::set<AsyncFileWriter::Imp*> r;
+		return r;
+	}
+
+	void flush_all_at_exit()
+	{
+		AsyncFileWriter::FlushAll();
+	}
+
+	const int crash_signals[] = { SIGSEGV, SIGABRT, SIGFPE, SIGILL, SIGTERM };
+	const int crash_signal_count = sizeof(crash_signals) / sizeof(int);
+	void (*prev_handler[crash_signal_count])(int) = { nullptr };
+
+	void crash_handler(int sig)
+	{
+		if (discard_output == false && registry_mutex().try_lock())
+		{
+			// write the submitted buffers first, then the ones that are being filled
+			writer_thread().emergencyFlush();
+			for (AsyncFileWriter::Imp* imp : registry())
+			{
+				if (imp->cur.empty() == false) fwrite(imp->cur.data(), 1, imp->cur.size(), imp->fp);
+				imp->cur.clear();
+				fflush(imp->fp);
+			}
+			registry_mutex().unlock();
+		}
+
+		// restore the previous handler and raise the signal again
+		for (int i = 0; i < crash_signal_count; ++i)
+		{
+			if (crash_signals[i] == sig)
+			{
+				signal(sig, (prev_handler[i] ? prev_handler[i] : SIG_DFL));
+				break;
+			}
+		}
+		raise(sig);
+	}
+
+	void install_handlers()
+	{
+		static std::once_flag flag;
+		std::call_once(flag, []() {
+			registry();
+			atexit(flush_all_at_exit);
+			for (int i = 0; i < crash_signal_count; ++i)
+			{
+				void (*prev)(int) = signal(crash_signals[i], crash_handler);
+				prev_handler[i] = (prev == SIG_ERR ? nullptr : prev);
+			}
+		});
+	}
+}
+
+//-----------------------------------------------------------------------------
+AsyncFileWriter::AsyncFileWriter() : m(new Imp)
+{
+}
+
+//-----------------------------------------------------------------------------
+AsyncFileWriter::~AsyncFileWriter()
+{
+	close();
+	delete m;
+}
+
+//-----------------------------------------------------------------------------
+bool AsyncFileWriter::open(const char* szfile, const char* szmode)
+{
+	close();
+
+	m->fp = fopen(szfile, szmode);
+	if (m->fp == nullptr) return false;
+
+	// we do our own buffering
+	setvbuf(m->fp, nullptr, _IONBF, 0);
+
+	m->cur.reserve(BUFFER_SIZE);
+	writer_thread().attach();
+
+	install_handlers();
+	std::lock_guard<std::mutex> lock(registry_mutex());
+	registry().insert(m);
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+void AsyncFileWriter::close()
+{
+	if (m->fp == nullptr) return;
+
+	{
+		std::lock_guard<std::mutex> lock(registry_mutex());
+		registry().erase(m);
+	}
+
+	m->submit();
+	m->wait();
+	writer_thread().detach();
+
+	fclose(m->fp);
+	m->fp = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+bool AsyncFileWriter::isOpen() const
+{
+	return (m->fp != nullptr);
+}
+
+//-----------------------------------------------------------------------------
+void AsyncFileWriter::write(const void* pd, size_t nsize)
+{
+	if ((m->fp == nullptr) || (nsize == 0) || discard_output) return;
+
+	const char* sz = (const char*)pd;
+	m->cur.insert(m->cur.end(), sz, sz + nsize);
+	if (m->cur.size() >= BUFFER_SIZE) m->submit();
+}
+
+//-----------------------------------------------------------------------------
+void AsyncFileWriter::print(const char* sz)
+{
+	if (sz) write(sz, strlen(sz));
+}
+
+//-----------------------------------------------------------------------------
+void AsyncFileWriter::printf(const char* szfmt, ...)
+{
+	if (m->fp == nullptr) return;
+
+	char szbuf[2048];
+	va_list args;
+	va_start(args, szfmt);
+	int l = vsnprintf(szbuf, sizeof(szbuf), szfmt, args);
+	va_end(args);
+	if (l < 0) return;
+
+	if (l < (int)sizeof(szbuf)) write(szbuf, l);
+	else
+	{
+		std::vector<char> tmp(l + 1);
+		va_start(args, szfmt);
+		vsnprintf(tmp.data(), tmp.size(), szfmt, args);
+		va_end(args);
+		write(tmp.data(), l);
+	}
+}
+
+//-----------------------------------------------------------------------------
+void AsyncFileWriter::flush()
+{
+	if ((m->fp == nullptr) || discard_output) return;
+	m->submit();
+	m->wait();
+	fflush(m->fp);
+}
+
+//-----------------------------------------------------------------------------
+FILE* AsyncFileWriter::GetFileHandle()
+{
+	flush();
+	return m->fp;
+}
+
+//-----------------------------------------------------------------------------
+// This must be called from the thread that writes to the files.
+void AsyncFileWriter::FlushAll()
+{
+	if (discard_output) return;
+
+	std::lock_guard<std::mutex> lock(registry_mutex());
+	for (Imp* imp : registry())
+	{
+		imp->submit();
+		imp->wait();
+		fflush(imp->fp);
+	}
+}
+
+//-----------------------------------------------------------------------------
+void AsyncFileWriter::DiscardOutput()
+{
+	discard_output = true;
+}
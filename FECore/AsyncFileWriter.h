@@ -0,0 +1,90 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#pragma once
+#include "fecore_api.h"
+#include <stdio.h>
+#include <stddef.h>
+
+//-----------------------------------------------------------------------------
+// A buffered file writer that hands full buffers to a background thread, so
+// that the caller does not block on disk I/O. All writers share one thread.
+// Output is written in the order it was submitted. Call flush() to wait until
+// all submitted data is on disk. All open writers are flushed (best effort)
+// when the program exits or is terminated by a fatal signal.
+class FECORE_API AsyncFileWriter
+{
+public:
+	class Imp;
+
+	enum { BUFFER_SIZE = 1 << 20 };	// size of a single buffer (1MB)
+	enum { MAX_PENDING = 4 };		// max nr of buffers waiting to be written
+
+public:
+	AsyncFileWriter();
+	~AsyncFileWriter();
+
+	// open a file (szmode as in fopen)
+	bool open(const char* szfile, const char* szmode);
+
+	// flush and close the file
+	void close();
+
+	// see if a file is open
+	bool isOpen() const;
+
+	// write raw bytes
+	void write(const void* pd, size_t nsize);
+
+	// write a null-terminated string
+	void print(const char* sz);
+
+	// write formatted text
+	void printf(const char* szfmt, ...);
+
+	// wait until all data is written and flush the file
+	void flush();
+
+	// returns the file handle (flushes first). Don't write to it while
+	// data is still being added through this writer.
+	FILE* GetFileHandle();
+
+public:
+	// flush all open writers
+	static void FlushAll();
+
+	// Discard all further output of all writers. This is meant for forked
+	// worker processes, which don't have the writer thread of their parent.
+	static void DiscardOutput();
+
+private:
+	AsyncFileWriter(const AsyncFileWriter&) {}
+	void operator = (const AsyncFileWriter&) {}
+
+private:
+	Imp*	m;
+};
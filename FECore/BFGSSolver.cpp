@@ -65,6 +65,8 @@ bool BFGSSolver::Init()
 	// allocate storage for BFGS update vectors
 	m_V.resize(m_max_buf_size, neq);
 	m_W.resize(m_max_buf_size, neq);
+	m_WV.resize(m_max_buf_size, m_max_buf_size);
+	m_WV.zero();
 
 	m_D.resize(neq);
 	m_G.resize(neq);
@@ -75,6 +77,10 @@ bool BFGSSolver::Init()
 
 	m_plinsolve = m_pns->GetLinearSolver();
 
+	// report the memory used by the update vectors
+	double mem = 2.0*m_max_buf_size*(double)neq*sizeof(double) / (1024.0*1024.0);
+	feLogInfo("BFGS update buffer: %d vectors (%.1lf MB)", 2 * m_max_buf_size, mem);
+
 	return true;
 }
 
@@ -137,11 +143,23 @@ bool BFGSSolver::Update(double s, vector<double>& ui, vector<double>& R0, vector
 		double* vn = m_V[n];
 		double* wn = m_W[n];
 
+#pragma omp parallel for
 		for (int i=0; i<neq; ++i)	
 		{
 			vn[i] = -m_H[i]*c - m_G[i];
 			wn[i] = m_D[i]*dgi;
 		}
+
+		// update the inner products with the new vectors
+		int nvec = (m_nups < m_max_buf_size ? m_nups + 1 : m_max_buf_size);
+		vector<double> wv(nvec), vw(nvec);
+		vmdot(neq, nvec, m_V, wn, &wv[0]);
+		vmdot(neq, nvec, m_W, vn, &vw[0]);
+		for (int j = 0; j < nvec; ++j)
+		{
+			m_WV[n][j] = wv[j];
+			m_WV[j][n] = vw[j];
+		}
 	}
 
 	// increment update counter
@@ -150,6 +168,46 @@ bool BFGSSolver::Update(double s, vector<double>& ui, vector<double>& R0, vector
 	return true;
 }
 
+//-----------------------------------------------------------------------------
+// This function applies a sequence of rank-one updates x = (I + a_k*b_k^T)...(I + a_1*b_1^T)*x,
+// where (a,b) = (V,W), or (W,V) if transpose is true. Instead of applying the 
+// updates one by one, which requires two passes over x for each update, we use 
+// the fact that the coefficients y of x = x0 + sum a_i*y_i satisfy the triangular 
+// system y_i = b_i*x0 + sum_{j<i} (b_i*a_j)*y_j. The inner products b_i*a_j are 
+// stored in m_WV, so the whole sequence only requires two passes.
+void BFGSSolver::ApplyUpdates(double* x, const vector<int>& seq, bool transpose)
+{
+	int m = (int) seq.size();
+	if (m == 0) return;
+
+	vector<const double*> a(m), b(m);
+	for (int i = 0; i < m; ++i)
+	{
+		int n = seq[i];
+		a[i] = (transpose ? m_W[n] : m_V[n]);
+		b[i] = (transpose ? m_V[n] : m_W[n]);
+	}
+
+	// y = B^T*x0
+	vector<double> y(m);
+	vmdot(m_neq, m, &b[0], x, &y[0]);
+
+	// solve the triangular system
+	for (int i = 1; i < m; ++i)
+	{
+		int ni = seq[i];
+		for (int j = 0; j < i; ++j)
+		{
+			int nj = seq[j];
+			double bij = (transpose ? m_WV[nj][ni] : m_WV[ni][nj]);
+			y[i] += bij*y[j];
+		}
+	}
+
+	// x = x0 + A*y
+	vmadds(m_neq, m, &a[0], &y[0], x);
+}
+
 //-----------------------------------------------------------------------------
 // This function solves a system of equations using the BFGS update vectors
 // The variable m_nups keeps track of how many updates have been made so far.
@@ -173,19 +231,10 @@ void BFGSSolver::SolveEquations(vector<double>& x, vector<double>& b)
 		n0 = m_nups % m_max_buf_size;
 	}
 
-	// loop over all update vectors
-	for (int i=nups-1; i>=0; --i)
-	{
-		int n = (n0 + i) % m_max_buf_size;
-
-		double* vi = m_V[n];
-		double* wi = m_W[n];
-
-		double wr = 0;
-		for (int j = 0; j<m_neq; j++) wr += wi[j] * tmp[j];
-
-		for (int j = 0; j<m_neq; j++) tmp[j] += vi[j] * wr;
-	}
+	// apply all update vectors, starting with the last one
+	vector<int> seq(nups);
+	for (int i = 0; i < nups; ++i) seq[i] = (n0 + nups - 1 - i) % m_max_buf_size;
+	ApplyUpdates(&tmp[0], seq, false);
 
 	// perform a backsubstitution
 	if (m_plinsolve->BackSolve(x, tmp) == false)
@@ -193,17 +242,7 @@ void BFGSSolver::SolveEquations(vector<double>& x, vector<double>& b)
 		throw LinearSolverFailed();
 	}
 
-	// loop again over all update vectors
-	for (int i = 0; i<nups; ++i)
-	{
-		int n = (n0 + i) % m_max_buf_size;
-
-		double* vi = m_V[n];
-		double* wi = m_W[n];
-
-		double vr = 0;
-		for (int j = 0; j<m_neq; ++j) vr += vi[j] * x[j];
-
-		for (int j = 0; j<m_neq; ++j) x[j] += wi[j] * vr;
-	}
+	// apply the transposed updates, starting with the first one
+	for (int i = 0; i < nups; ++i) seq[i] = (n0 + i) % m_max_buf_size;
+	ApplyUpdates(&x[0], seq, true);
 }
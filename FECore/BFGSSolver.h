@@ -57,9 +57,15 @@ public:
 	LinearSolver*	m_plinsolve;	//!< pointer to linear solver
 	int				m_neq;		//!< number of equations
 
+private:
+	// apply a sequence of rank-one updates (I + a*b^T) in compact form
+	void ApplyUpdates(double* x, const vector<int>& seq, bool transpose);
+
+public:
 	// BFGS update vectors
 	matrix			m_V;		//!< BFGS update vector
 	matrix			m_W;		//!< BFGS update vector
+	matrix			m_WV;		//!< inner products of update vectors, m_WV[i][j] = W[i]*V[j]
 	vector<double>	m_D, m_G, m_H;	//!< temp vectors for calculating BFGS update vectors
 
 	vector<double>	tmp;
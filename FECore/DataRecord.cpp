@@ -33,6 +33,8 @@ SOFTWARE.*/
 #include "FEAnalysis.h"
 #include "log.h"
 #include <sstream>
+#include <math.h>
+#include <stdint.h>
 
 //-----------------------------------------------------------------------------
 UnknownDataField::UnknownDataField(const char* sz) : std::runtime_error(sz)
@@ -51,9 +53,9 @@ DataRecord::DataRecord(FEModel* pfem, int ntype) : FECoreBase(pfem), m_type(ntyp
 	
 	m_bcomm = true;
 
-	m_fp = 0;
 	m_szfile[0] = 0;
-
+	m_bbin = false;
+	m_bhead = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -62,8 +64,8 @@ bool DataRecord::SetFileName(const char* szfile)
 	if (szfile == nullptr) return false;
 
 	strcpy(m_szfile, szfile);
-	m_fp = fopen(szfile, "wt");
-	if (m_fp == 0)
+	m_bhead = false;
+	if (m_file.open(szfile, (m_bbin ? "wb" : "wt")) == false)
 	{
 		feLogError("FAILED CREATING DATA FILE %s\n\n", szfile);
 		return false;
@@ -75,11 +77,7 @@ bool DataRecord::SetFileName(const char* szfile)
 //-----------------------------------------------------------------------------
 DataRecord::~DataRecord()
 {
-	if (m_fp)
-	{
-		fclose(m_fp);
-		m_fp = 0;
-	}
+	m_file.close();
 }
 
 //-----------------------------------------------------------------------------
@@ -108,22 +106,40 @@ bool DataRecord::Initialize()
 }
 
 //-----------------------------------------------------------------------------
-std::string DataRecord::printToString(int i)
+// formats a value the same way as an ostream with precision 12 would, i.e. %.12g.
+// Zero and (small) integer values, which are common in data records, skip snprintf.
+static int format_value(char* sz, size_t n, double val)
 {
-	std::stringstream ss;
-	ss.precision(12);
+	// (negative zero is printed by snprintf, so it keeps its sign)
+	if (val == 0.0)
+	{
+		if (signbit(val)) return snprintf(sz, n, "%.12g", val);
+		sz[0] = '0'; sz[1] = 0; return 1;
+	}
+	if ((fabs(val) < 1e12) && (val == (double)(int64_t)val))
+	{
+		return snprintf(sz, n, "%lld", (long long)val);
+	}
+	return snprintf(sz, n, "%.12g", val);
+}
+
+//-----------------------------------------------------------------------------
+void DataRecord::printToString(int i, std::string& out)
+{
+	char sz[64];
+	int l = snprintf(sz, sizeof(sz), "%d", m_item[i]);
+	out.append(sz, l);
+	out.append(m_szdelim);
 
-	ss << m_item[i] << m_szdelim;
 	int nd = Size();
 	for (int j = 0; j<nd; ++j)
 	{
 		double val = Evaluate(m_item[i], j);
-		ss << val;
-		if (j != nd - 1) ss << m_szdelim;
-		else ss << "\n";
+		l = format_value(sz, sizeof(sz), val);
+		out.append(sz, l);
+		if (j != nd - 1) out.append(m_szdelim);
+		else out.push_back('\n');
 	}
-
-	return ss.str();
 }
 
 //-----------------------------------------------------------------------------
@@ -210,17 +226,25 @@ bool DataRecord::Write()
 	feLog("Time = %.9lg\n", ftime);
 	feLog("Data = %s\n", m_szname);
 
+	// binary files only store the data
+	bool bfile = m_file.isOpen();
+	if (bfile && m_bbin)
+	{
+		feLog("File = %s\n", m_szfile);
+		writeBinary(nstep, ftime);
+		return true;
+	}
+
 	// write some comments
-	FILE* fp = m_fp;
-	if (fp && m_bcomm)
+	if (bfile && m_bcomm)
 	{
 		// we save the data in a seperate file
 		feLog("File = %s\n", m_szfile);
 
 		// make a note in the data file
-		fprintf(fp,"*Step  = %d\n", nstep);
-		fprintf(fp,"*Time  = %.9lg\n", ftime);
-		fprintf(fp,"*Data  = %s\n", m_szname);
+		m_file.printf("*Step  = %d\n", nstep);
+		m_file.printf("*Time  = %.9lg\n", ftime);
+		m_file.printf("*Data  = %s\n", m_szname);
 	}
 
 	// save the data
@@ -228,10 +252,11 @@ bool DataRecord::Write()
 	{
 		for (size_t i=0; i<m_item.size(); ++i)
 		{
-			std::string out = printToString((int)i);
+			m_buf.clear();
+			printToString((int)i, m_buf);
 
-			if (fp) fprintf(fp, "%s", out.c_str());
-			else feLog(out.c_str(),"");
+			if (bfile) m_file.write(m_buf.data(), m_buf.size());
+			else feLog(m_buf.c_str(),"");
 		}
 	}
 	else
@@ -241,16 +266,52 @@ bool DataRecord::Write()
 		{
 			std::string out = printToFormatString((int)i);
 
-			if (fp) fprintf(fp, "%s", out.c_str());
+			if (bfile) m_file.print(out.c_str());
 			else feLog(out.c_str(),"");
 		}
 	}
 
-	if (fp) fflush(fp);
+	// Note that the file is not flushed here. The data is written on a background 
+	// thread and all data is flushed when the file is closed (or the run terminates).
 
 	return true;
 }
 
+//-----------------------------------------------------------------------------
+// Binary data files have the following layout:
+//   header: "FEDR", int32 version, int32 ndata, int32 name length, name
+//   record: int32 step, double time, int32 nitems, nitems x int32 item IDs, 
+//           ndata x nitems doubles (column-major, i.e. all items of data field 0 first)
+void DataRecord::writeBinary(int nstep, double ftime)
+{
+	int32_t nd = Size();
+	if (m_bhead == false)
+	{
+		const int32_t version = 1;
+		int32_t l = (int32_t)strlen(m_szdata);
+		m_file.write("FEDR", 4);
+		m_file.write(&version, sizeof(version));
+		m_file.write(&nd, sizeof(nd));
+		m_file.write(&l, sizeof(l));
+		m_file.write(m_szdata, l);
+		m_bhead = true;
+	}
+
+	int32_t n = (int32_t)nstep;
+	int32_t ni = (int32_t)m_item.size();
+	m_file.write(&n, sizeof(n));
+	m_file.write(&ftime, sizeof(ftime));
+	m_file.write(&ni, sizeof(ni));
+	if (ni > 0) m_file.write(&m_item[0], ni*sizeof(int32_t));
+
+	std::vector<double> col(ni);
+	for (int j = 0; j < nd; ++j)
+	{
+		for (int i = 0; i < ni; ++i) col[i] = Evaluate(m_item[i], j);
+		if (ni > 0) m_file.write(&col[0], ni*sizeof(double));
+	}
+}
+
 //-----------------------------------------------------------------------------
 
 void DataRecord::SetItemList(const std::vector<int>& items)
@@ -277,6 +338,7 @@ void DataRecord::Serialize(DumpStream &ar)
 	ar & m_szdelim;
 	ar & m_szfile;
 	ar & m_bcomm;
+	ar & m_bbin;
 	ar & m_item;
 	ar & m_szdata;
 
@@ -285,12 +347,12 @@ void DataRecord::Serialize(DumpStream &ar)
 	{
 		SetData(m_szdata);
 
-		if (m_fp) fclose(m_fp);
-		m_fp = 0;
+		m_file.close();
 		if (m_szfile[0] != 0)
 		{
 			// reopen data file for appending
-			m_fp = fopen(m_szfile, "a+");
+			m_file.open(m_szfile, (m_bbin ? "ab" : "a+"));
+			m_bhead = true;
 		}
 	}
 }
@@ -33,6 +33,7 @@ SOFTWARE.*/
 #include <stdexcept>
 #include "FECoreBase.h"
 #include "fecore_api.h"
+#include "AsyncFileWriter.h"
 
 //-----------------------------------------------------------------------------
 // forward declaration
@@ -75,6 +76,9 @@ public:
 
 	bool SetFileName(const char* szfile);
 
+	// Write the data in binary, columnar format. Must be called before SetFileName.
+	void SetBinary(bool b) { m_bbin = b; }
+
 	bool Write();
 
 	void SetItemList(const std::vector<int>& items);
@@ -94,8 +98,9 @@ public:
 	virtual int Size() const = 0;
 
 private:
-	std::string printToString(int i);
+	void printToString(int i, std::string& out);
 	std::string printToFormatString(int i);
+	void writeBinary(int nstep, double ftime);
 
 public:
 	int					m_nid;		//!< ID of data record
@@ -111,7 +116,10 @@ protected:
 
 protected:
 	char	m_szfile[MAX_STRING];	//!< file name of data record
-	FILE*		m_fp;
+	bool	m_bbin;					//!< write binary data file
+	bool	m_bhead;				//!< binary header was written
+	AsyncFileWriter	m_file;			//!< data file
+	std::string		m_buf;			//!< formatting buffer
 };
 
 //=========================================================================
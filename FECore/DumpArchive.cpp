@@ -0,0 +1,303 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#include "stdafx.h"
+#include "DumpArchive.h"
+#include <stdio.h>
+#include <stdint.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// File layout:
+//  header : uint32 magic, uint32 version, uint32 sections, uint32 (reserved), uint64 total size
+//  table  : for each section: uint64 raw size, uint64 stored size, uint32 flags, uint32 crc
+//  data   : the (compressed) data of each section
+namespace {
+	const uint32_t DUMP_MAGIC = 0x44424546;	// "FEBD"
+	const uint32_t DUMP_VERSION = 1;
+
+	enum { SECTION_COMPRESSED = 1, SECTION_CRC = 2 };
+
+	struct SECTION
+	{
+		uint64_t	rawSize;
+		uint64_t	storedSize;
+		uint32_t	flags;
+		uint32_t	crc;
+	};
+
+	struct HEADER
+	{
+		uint32_t	magic;
+		uint32_t	version;
+		uint32_t	sections;
+		uint32_t	reserved;
+		uint64_t	totalSize;
+	};
+
+	bool read_header(FILE* fp, HEADER& hdr)
+	{
+		if (fread(&hdr.magic, sizeof(uint32_t), 1, fp) != 1) return false;
+		if (hdr.magic != DUMP_MAGIC) return false;
+		if (fread(&hdr.version, sizeof(uint32_t), 1, fp) != 1) return false;
+		if (hdr.version != DUMP_VERSION) return false;
+		if (fread(&hdr.sections, sizeof(uint32_t), 1, fp) != 1) return false;
+		if (fread(&hdr.reserved, sizeof(uint32_t), 1, fp) != 1) return false;
+		if (fread(&hdr.totalSize, sizeof(uint64_t), 1, fp) != 1) return false;
+		return true;
+	}
+}
+
+//-----------------------------------------------------------------------------
+DumpArchive::DumpArchive(FEModel& fem) : DumpStream(fem)
+{
+	m_pos = 0;
+}
+
+//-----------------------------------------------------------------------------
+DumpArchive::~DumpArchive()
+{
+	Close();
+}
+
+//-----------------------------------------------------------------------------
+bool DumpArchive::IsValidFile(const char* szfile)
+{
+	FILE* fp = fopen(szfile, "rb");
+	if (fp == nullptr) return false;
+	HEADER hdr;
+	bool ret = read_header(fp, hdr);
+	fclose(fp);
+	return ret;
+}
+
+//-----------------------------------------------------------------------------
+bool DumpArchive::Create(const char* szfile)
+{
+	// make sure we can create the file
+	FILE* fp = fopen(szfile, "wb");
+	if (fp == nullptr) return false;
+	fclose(fp);
+
+	m_fileName = szfile;
+	m_buf.clear();
+	m_pos = 0;
+	DumpStream::Open(true, false);
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+bool DumpArchive::Open(const char* szfile)
+{
+	m_fileName.clear();
+	m_buf.clear();
+	m_pos = 0;
+
+	FILE* fp = fopen(szfile, "rb");
+	if (fp == nullptr) return false;
+
+	// read the header and section table
+	HEADER hdr;
+	if (read_header(fp, hdr) == false) { fclose(fp); return false; }
+
+	int nsec = (int)hdr.sections;
+	std::vector<SECTION> sec(nsec);
+	std::vector<size_t> rawOffset(nsec + 1, 0), storedOffset(nsec + 1, 0);
+	for (int i = 0; i < nsec; ++i)
+	{
+		SECTION& s = sec[i];
+		bool bok = true;
+		bok &= (fread(&s.rawSize, sizeof(uint64_t), 1, fp) == 1);
+		bok &= (fread(&s.storedSize, sizeof(uint64_t), 1, fp) == 1);
+		bok &= (fread(&s.flags, sizeof(uint32_t), 1, fp) == 1);
+		bok &= (fread(&s.crc, sizeof(uint32_t), 1, fp) == 1);
+		if (bok == false) { fclose(fp); return false; }
+
+		rawOffset[i + 1] = rawOffset[i] + (size_t)s.rawSize;
+		storedOffset[i + 1] = storedOffset[i] + (size_t)s.storedSize;
+	}
+	if (rawOffset[nsec] != (size_t)hdr.totalSize) { fclose(fp); return false; }
+
+	// read all the data at once
+	std::vector<char> stored(storedOffset[nsec]);
+	size_t nread = (stored.empty() ? 0 : fread(&stored[0], 1, stored.size(), fp));
+	fclose(fp);
+	if (nread != stored.size()) return false;
+
+	// decompress the sections in parallel
+	m_buf.resize((size_t)hdr.totalSize);
+	int nerr = 0;
+#pragma omp parallel for schedule(dynamic) reduction(+:nerr)
+	for (int i = 0; i < nsec; ++i)
+	{
+		const SECTION& s = sec[i];
+		const char* src = stored.data() + storedOffset[i];
+		char* dst = m_buf.data() + rawOffset[i];
+
+		if (s.flags & SECTION_COMPRESSED)
+		{
+#ifdef HAVE_ZLIB
+			uLongf destLen = (uLongf)s.rawSize;
+			if ((uncompress((Bytef*)dst, &destLen, (const Bytef*)src, (uLong)s.storedSize) != Z_OK) || (destLen != s.rawSize)) nerr++;
+#else
+			// we can't read compressed archives without zlib
+			nerr++;
+#endif
+		}
+		else
+		{
+			if (s.storedSize != s.rawSize) nerr++;
+			else memcpy(dst, src, (size_t)s.rawSize);
+		}
+
+#ifdef HAVE_ZLIB
+		if ((nerr == 0) && (s.flags & SECTION_CRC))
+		{
+			uLong crc = crc32(0L, (const Bytef*)dst, (uInt)s.rawSize);
+			if ((uint32_t)crc != s.crc) nerr++;
+		}
+#endif
+	}
+	if (nerr != 0) { m_buf.clear(); return false; }
+
+	DumpStream::Open(false, false);
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+bool DumpArchive::Close()
+{
+	if (m_fileName.empty() || !IsSaving()) { m_fileName.clear(); m_buf.clear(); return true; }
+
+	// split the buffer in sections
+	size_t totalSize = m_buf.size();
+	int nsec = (int)((totalSize + SECTION_SIZE - 1) / SECTION_SIZE);
+	std::vector<SECTION> sec(nsec);
+	std::vector< std::vector<char> > out(nsec);
+
+	// compress all sections in parallel
+#pragma omp parallel for schedule(dynamic)
+	for (int i = 0; i < nsec; ++i)
+	{
+		SECTION& s = sec[i];
+		size_t offset = (size_t)i*SECTION_SIZE;
+		size_t rawSize = totalSize - offset;
+		if (rawSize > SECTION_SIZE) rawSize = SECTION_SIZE;
+		const char* src = m_buf.data() + offset;
+
+		s.rawSize = rawSize;
+		s.storedSize = rawSize;
+		s.flags = 0;
+		s.crc = 0;
+
+#ifdef HAVE_ZLIB
+		s.flags |= SECTION_CRC;
+		s.crc = (uint32_t)crc32(0L, (const Bytef*)src, (uInt)rawSize);
+
+		uLongf destLen = compressBound((uLong)rawSize);
+		out[i].resize(destLen);
+		if ((compress2((Bytef*)out[i].data(), &destLen, (const Bytef*)src, (uLong)rawSize, Z_BEST_SPEED) == Z_OK) && (destLen < rawSize))
+		{
+			out[i].resize(destLen);
+			s.storedSize = destLen;
+			s.flags |= SECTION_COMPRESSED;
+		}
+		else out[i].clear();
+#endif
+	}
+
+	// write the file
+	bool bok = false;
+	FILE* fp = fopen(m_fileName.c_str(), "wb");
+	if (fp)
+	{
+		HEADER hdr = { DUMP_MAGIC, DUMP_VERSION, (uint32_t)nsec, 0, (uint64_t)totalSize };
+		bok = true;
+		bok &= (fwrite(&hdr.magic, sizeof(uint32_t), 1, fp) == 1);
+		bok &= (fwrite(&hdr.version, sizeof(uint32_t), 1, fp) == 1);
+		bok &= (fwrite(&hdr.sections, sizeof(uint32_t), 1, fp) == 1);
+		bok &= (fwrite(&hdr.reserved, sizeof(uint32_t), 1, fp) == 1);
+		bok &= (fwrite(&hdr.totalSize, sizeof(uint64_t), 1, fp) == 1);
+		for (int i = 0; i < nsec; ++i)
+		{
+			SECTION& s = sec[i];
+			bok &= (fwrite(&s.rawSize, sizeof(uint64_t), 1, fp) == 1);
+			bok &= (fwrite(&s.storedSize, sizeof(uint64_t), 1, fp) == 1);
+			bok &= (fwrite(&s.flags, sizeof(uint32_t), 1, fp) == 1);
+			bok &= (fwrite(&s.crc, sizeof(uint32_t), 1, fp) == 1);
+		}
+		for (int i = 0; i < nsec; ++i)
+		{
+			const SECTION& s = sec[i];
+			const char* pd = (s.flags & SECTION_COMPRESSED ? out[i].data() : m_buf.data() + (size_t)i*SECTION_SIZE);
+			if (s.storedSize > 0) bok &= (fwrite(pd, 1, (size_t)s.storedSize, fp) == (size_t)s.storedSize);
+		}
+		fclose(fp);
+	}
+
+	m_fileName.clear();
+	m_buf.clear();
+	m_pos = 0;
+
+	return bok;
+}
+
+//-----------------------------------------------------------------------------
+size_t DumpArchive::write(const void* pd, size_t size, size_t count)
+{
+	assert(IsSaving());
+	size_t nsize = size*count;
+	const char* sz = (const char*)pd;
+	m_buf.insert(m_buf.end(), sz, sz + nsize);
+	return nsize;
+}
+
+//-----------------------------------------------------------------------------
+size_t DumpArchive::read(void* pd, size_t size, size_t count)
+{
+	assert(IsLoading());
+	size_t nsize = size*count;
+	if (m_pos + nsize > m_buf.size()) throw ReadError();
+	memcpy(pd, m_buf.data() + m_pos, nsize);
+	m_pos += nsize;
+	return nsize;
+}
+
+//-----------------------------------------------------------------------------
+void DumpArchive::clear()
+{
+}
+
+//-----------------------------------------------------------------------------
+bool DumpArchive::EndOfStream() const
+{
+	return (m_pos >= m_buf.size());
+}
@@ -0,0 +1,70 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#pragma once
+#include "DumpStream.h"
+#include "fecore_api.h"
+#include <vector>
+
+//-----------------------------------------------------------------------------
+//! Dump stream for restart archives. 
+//! The model is serialized to memory first. When the archive is closed the
+//! data is split into sections that are compressed in parallel (if zlib is 
+//! available) and written with a section table. When opened for reading, all
+//! sections are read and decompressed in parallel before deserialization starts.
+class FECORE_API DumpArchive : public DumpStream
+{
+public:
+	enum { SECTION_SIZE = 4 << 20 };	// uncompressed size of a section (4MB)
+
+public:
+	DumpArchive(FEModel& fem);
+	~DumpArchive();
+
+	//! Open archive for reading. Returns false if the file is not a (valid) compressed archive.
+	bool Open(const char* szfile);
+
+	//! Open archive for writing
+	bool Create(const char* szfile);
+
+	//! Write the archive to file (when saving) and release the buffer.
+	bool Close();
+
+	//! see if the file is a compressed restart archive
+	static bool IsValidFile(const char* szfile);
+
+public: // overloaded from DumpStream
+	size_t write(const void* pd, size_t size, size_t count) override;
+	size_t read(void* pd, size_t size, size_t count) override;
+	void clear() override;
+	bool EndOfStream() const override;
+
+private:
+	std::string			m_fileName;
+	std::vector<char>	m_buf;	//!< uncompressed data
+	size_t				m_pos;	//!< read position
+};
@@ -36,6 +36,7 @@ DumpStream::DumpStream(FEModel& fem) : m_fem(fem)
 	m_bshallow = false;
 	m_bytes_serialized = 0;
 	m_ptr_lock = false;
+	m_bnoMeshState = false;
 
 #ifndef NDEBUG
 	m_btypeInfo = false;
@@ -78,6 +79,18 @@ bool DumpStream::HasTypeInfo() const
 	return m_btypeInfo;
 }
 
+//-----------------------------------------------------------------------------
+void DumpStream::ExcludeMeshState(bool b)
+{
+	m_bnoMeshState = b;
+}
+
+//-----------------------------------------------------------------------------
+bool DumpStream::MeshStateExcluded() const
+{
+	return (m_bshallow && m_bnoMeshState);
+}
+
 //-----------------------------------------------------------------------------
 void DumpStream::Open(bool bsave, bool bshallow)
 {
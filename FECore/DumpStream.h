@@ -146,6 +146,13 @@ public:
 	// see if the stream has type info
 	bool HasTypeInfo() const;
 
+	// Exclude the nodal and material point data from a shallow stream.
+	// This is used when that data is stored separately (see FEStateSnapshot)
+	void ExcludeMeshState(bool b);
+
+	// see if the nodal and material point data is excluded
+	bool MeshStateExcluded() const;
+
 	// return total nr of bytes that was serialized
 	size_t bytesSerialized() const { return m_bytes_serialized; }
 
@@ -233,6 +240,7 @@ private:
 	bool		m_bsave;	//!< true if output stream, false for input stream
 	bool		m_bshallow;	//!< if true only shallow data needs to be serialized
 	bool		m_btypeInfo;	//!< write/read type info
+	bool		m_bnoMeshState;	//!< don't serialize nodal and material point data in shallow mode
 	FEModel&	m_fem;		//!< the FE Model that is being serialized
 
 	size_t	m_bytes_serialized;	//!< number or bytes serialized
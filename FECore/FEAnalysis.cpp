@@ -34,7 +34,7 @@ SOFTWARE.*/
 #include "DOFS.h"
 #include "MatrixProfile.h"
 #include "FEBoundaryCondition.h"
-#include "DumpMemStream.h"
+#include "FEStateSnapshot.h"
 #include "FELinearConstraintManager.h"
 #include "FEShellDomain.h"
 #include "FEMeshAdaptor.h"
@@ -410,8 +410,8 @@ bool FEAnalysis::Solve()
 		if (m_timeController) m_timeController->AutoTimeStep(0);
 	}
 
-	// dump stream for running restarts
-	DumpMemStream dmp(fem);
+	// snapshot of the model state for running restarts
+	FEStateSnapshot snapshot(fem);
 
 	// repeat for all timesteps
 	if (m_timeController) m_timeController->m_nretries = 0;
@@ -421,8 +421,7 @@ bool FEAnalysis::Solve()
 		// we need to retry this time step
 		if (m_timeController && (m_timeController->m_maxretries > 0))
 		{ 
-			dmp.clear();
-			fem.Serialize(dmp); 
+			snapshot.Save();
 		}
 
 		// Inform that the time is about to change. (Plugins can use 
@@ -510,8 +509,7 @@ bool FEAnalysis::Solve()
 			if (m_timeController && (m_timeController->m_nretries < m_timeController->m_maxretries))
 			{
 				// restore the previous state
-				dmp.Open(false, true);
-				fem.Serialize(dmp);
+				snapshot.Restore();
 				
 				// let's try again
 				m_timeController->Retry();
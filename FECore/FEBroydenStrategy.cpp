@@ -29,6 +29,7 @@ SOFTWARE.*/
 #include "FEException.h"
 #include "FENewtonSolver.h"
 #include "log.h"
+#include "vector.h"
 
 //-----------------------------------------------------------------------------
 BEGIN_FECORE_CLASS(FEBroydenStrategy, FENewtonStrategy)
@@ -59,6 +60,8 @@ bool FEBroydenStrategy::Init()
 	// allocate storage for Broyden update vectors
 	m_R.resize(m_max_buf_size, neq);
 	m_D.resize(m_max_buf_size, neq);
+	m_DA.resize(m_max_buf_size, m_max_buf_size);
+	m_DA.zero();
 	m_rho.resize(m_max_buf_size);
 	m_q.resize(neq, 0.0);
 
@@ -69,9 +72,50 @@ bool FEBroydenStrategy::Init()
 
 	m_bnewStep = true;
 
+	// report the memory used by the update vectors
+	double mem = 2.0*m_max_buf_size*(double)neq*sizeof(double) / (1024.0*1024.0);
+	feLogInfo("Broyden update buffer: %d vectors (%.1lf MB)", 2 * m_max_buf_size, mem);
+
 	return true;
 }
 
+//-----------------------------------------------------------------------------
+// Applies the updates q = (I + rho_k*a_k*d_k^T)...(I + rho_1*a_1*d_1^T)*q, with a = d - r.
+// Writing the result as q = q0 + sum a_i*y_i, the coefficients follow from the 
+// triangular system y_i = rho_i*(d_i*q0 + sum_{j<i} (d_i*a_j)*y_j), where the 
+// inner products d_i*a_j are stored in m_DA. This way, only two passes over the 
+// update vectors are needed, instead of two passes for each update.
+void FEBroydenStrategy::ApplyUpdates(vector<double>& q, int n0, int nups)
+{
+	if (nups <= 0) return;
+
+	vector<int> seq(nups);
+	vector<const double*> v(2 * nups);
+	for (int i = 0; i < nups; ++i)
+	{
+		int n = (n0 + i) % m_max_buf_size;
+		seq[i] = n;
+		v[i] = m_D[n];
+		v[nups + i] = m_R[n];
+	}
+
+	// y = D^T*q0
+	vector<double> y(2 * nups);
+	vmdot(m_neq, nups, &v[0], &q[0], &y[0]);
+
+	// solve the triangular system
+	for (int i = 0; i < nups; ++i)
+	{
+		int ni = seq[i];
+		for (int j = 0; j < i; ++j) y[i] += m_DA[ni][seq[j]] * y[j];
+		y[i] *= m_rho[ni];
+	}
+
+	// q = q0 + (D - R)*y
+	for (int i = 0; i < nups; ++i) y[nups + i] = -y[i];
+	vmadds(m_neq, 2 * nups, &v[0], &y[0], &q[0]);
+}
+
 //! Presolve update
 void FEBroydenStrategy::PreSolveUpdate()
 {
@@ -107,30 +151,37 @@ bool FEBroydenStrategy::Update(double s, vector<double>& ui, vector<double>& R0,
 		int n0 = (m_nups >= m_max_buf_size ? (m_nups + 1) % m_max_buf_size : 0);
 		int n1 = (m_nups >= m_max_buf_size ? (m_nups) % m_max_buf_size : m_nups);
 
-		// loop over update vectors
-		for (int j = 0; j<nups; ++j)
-		{
-			int n = (n0 + j) % m_max_buf_size;
-
-			double w = 0.0;
-			for (int i = 0; i<m_neq; ++i) w += (m_D[n][i] * m_q[i]);
-
-			double g = m_rho[n] * w;
-			for (int i = 0; i<m_neq; ++i) m_q[i] += g*(m_D[n][i] - m_R[n][i]);
-		}
+		// apply the update vectors
+		ApplyUpdates(m_q, n0, nups);
 
 		// form and store the next update vector
+		double* rn = m_R[n1];
+		double* dn = m_D[n1];
 		double rhoi = 0.0;
+#pragma omp parallel for reduction(+:rhoi)
 		for (int i = 0; i<m_neq; ++i)
 		{
 			double ri = m_q[i] - ui[i];
 			double di = -s*ui[i];
-			m_R[n1][i] = ri;
-			m_D[n1][i] = di;
+			rn[i] = ri;
+			dn[i] = di;
 
 			rhoi += di*ri;
 		}
 		m_rho[n1] = 1.0 / (rhoi);
+
+		// update the inner products with the new vectors
+		int nvec = (m_nups < m_max_buf_size ? m_nups + 1 : m_max_buf_size);
+		vector<const double*> v(2 * nvec);
+		for (int j = 0; j < nvec; ++j) { v[j] = m_D[j]; v[nvec + j] = m_R[j]; }
+		vector<double> dd(2 * nvec), dr(nvec);
+		vmdot(m_neq, 2 * nvec, &v[0], dn, &dd[0]);
+		vmdot(m_neq, nvec, &v[0], rn, &dr[0]);
+		for (int j = 0; j < nvec; ++j)
+		{
+			m_DA[n1][j] = dd[j] - dd[nvec + j];
+			m_DA[j][n1] = dd[j] - dr[j];
+		}
 	}
 
 	m_nups++;
@@ -170,28 +221,22 @@ void FEBroydenStrategy::SolveEquations(vector<double>& x, vector<double>& b)
 			if (m_plinsolve->BackSolve(m_q, b) == false)
 				throw LinearSolverFailed();
 
-			for (int j = 0; j<nups - 1; ++j)
-			{
-				int n = (n0 + j) % m_max_buf_size;
-
-				double w = 0.0;
-				for (int i = 0; i<m_neq; ++i) w += (m_D[n][i] * m_q[i]);
-
-				double g = m_rho[n] * w;
-				for (int i = 0; i<m_neq; ++i) m_q[i] += g*(m_D[n][i] - m_R[n][i]);
-			}
+			ApplyUpdates(m_q, n0, nups - 1);
 
 			m_bnewStep = false;
 		}
 
 		// calculate solution
+		const double* dn = m_D[n1];
+		const double* rn = m_R[n1];
 		double rho = 0.0;
-		for (int i = 0; i<m_neq; ++i) rho += m_D[n1][i] * m_q[i];
+		vmdot(m_neq, 1, &dn, &m_q[0], &rho);
 		rho *= m_rho[n1];
 
+#pragma omp parallel for
 		for (int i = 0; i<m_neq; ++i)
 		{
-			x[i] = m_q[i] + rho*(m_D[n1][i] - m_R[n1][i]);
+			x[i] = m_q[i] + rho*(dn[i] - rn[i]);
 		}
 	}
 }
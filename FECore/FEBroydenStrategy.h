@@ -50,6 +50,10 @@ public:
 	//! Presolve update
 	virtual void PreSolveUpdate() override;
 
+private:
+	// apply the updates (I + rho*(d - r)*d^T) in compact form
+	void ApplyUpdates(vector<double>& q, int n0, int nups);
+
 private:
 	// keep a pointer to the linear solver
 	LinearSolver*	m_plinsolve;	//!< pointer to linear solver
@@ -60,6 +64,7 @@ private:
 	// Broyden update vectors
 	matrix			m_R;		//!< Broyden update vector "r"
 	matrix			m_D;		//!< Broydeb update vector "delta"
+	matrix			m_DA;		//!< inner products m_DA[i][j] = D[i]*(D[j] - R[j])
 	vector<double>	m_rho;		//!< temp vectors for calculating Broyden update vectors
 	vector<double>	m_q;		//!< temp storage for q
 
@@ -85,13 +85,17 @@ FEDataMap* FEDataMathGenerator::Generate()
 	FENodeDataMap* map = new FENodeDataMap(FE_DOUBLE);
 	map->Create(m_nodeSet);
 	int N = m_nodeSet->Size();
+
+	// evaluate all nodes at once
+	vector<double> x(N), y(N), z(N), v(N);
 	for (int i=0; i<N; ++i)
 	{
-		FENode* node = m_nodeSet->Node(i);
-		vec3d r = node->m_r0;
-		vector<double> p{ r.x, r.y, r.z };
-		double v = m_val[0].value_s(p);
-		map->setValue(i, v);
+		vec3d r = m_nodeSet->Node(i)->m_r0;
+		x[i] = r.x; y[i] = r.y; z[i] = r.z;
 	}
+	const double* p[3] = { x.data(), y.data(), z.data() };
+	m_val[0].value_s(p, v.data(), N);
+
+	for (int i = 0; i < N; ++i) map->setValue(i, v[i]);
 	return map;
 }
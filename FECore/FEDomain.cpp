@@ -59,24 +59,40 @@ void FEDomain::CreateMaterialPointData()
 	// initialization of the mat_axis here.
 	if (m_matAxis) m_matAxis->Init();
 
+	if (GetMaterial()) ForEachElement([=](FEElement& el) {
+		CreateMaterialPointData(el);
+	});
+}
+
+//-----------------------------------------------------------------------------
+void FEDomain::CreateMaterialPointData(FEElement& el)
+{
 	FEMaterial* pmat = GetMaterial();
 	FEMesh* mesh = GetMesh();
-	if (pmat) ForEachElement([=](FEElement& el) {
 
-		vec3d r[FEElement::MAX_NODES];
-		int ne = el.Nodes();
-		for (int i = 0; i < ne; ++i) r[i] = mesh->Node(el.m_node[i]).m_r0;
+	vec3d r[FEElement::MAX_NODES];
+	int ne = el.Nodes();
+	for (int i = 0; i < ne; ++i) r[i] = mesh->Node(el.m_node[i]).m_r0;
 
-		for (int k = 0; k < el.GaussPoints(); ++k)
-		{
-			FEMaterialPoint* mp = new FEMaterialPoint(pmat->CreateMaterialPointData());
-			mp->m_Q = (m_matAxis ? m_matAxis->operator()(*mp) : mat3d::identity());
-			mp->m_r0 = el.Evaluate(r, k);
-			mp->m_rt = mp->m_r0;
-			mp->m_index = k;
-			el.SetMaterialPointData(mp, k);
-		}
-	});
+	for (int k = 0; k < el.GaussPoints(); ++k)
+	{
+		FEMaterialPoint* mp = new FEMaterialPoint(pmat->CreateMaterialPointData());
+		mp->m_Q = (m_matAxis ? m_matAxis->operator()(*mp) : mat3d::identity());
+		mp->m_r0 = el.Evaluate(r, k);
+		mp->m_rt = mp->m_r0;
+		mp->m_index = k;
+		el.SetMaterialPointData(mp, k);
+	}
+}
+
+//-----------------------------------------------------------------------------
+void FEDomain::RestoreMaterialPointData(FEElement& el)
+{
+	if (el.IsDataCompact() == false) return;
+
+	el.ClearData();
+	CreateMaterialPointData(el);
+	for (int k = 0; k < el.GaussPoints(); ++k) el.GetMaterialPoint(k)->Init();
 }
 
 //-----------------------------------------------------------------------------
@@ -87,6 +103,9 @@ void FEDomain::Serialize(DumpStream& ar)
 
 	if (ar.IsShallow())
 	{
+		// the material point data might be stored elsewhere
+		if (ar.MeshStateExcluded()) return;
+
 		int NEL = Elements();
 		for (int i = 0; i < NEL; ++i)
 		{
@@ -54,6 +54,14 @@ public:
 	//! \todo Perhaps I can make this part of the "creation" routine
 	void CreateMaterialPointData();
 
+	//! Allocate the material point data of one element
+	void CreateMaterialPointData(FEElement& el);
+
+	//! Create new material point data for an element whose data was compacted
+	//! (see FEElement::CompactData), e.g. when an eroded element is activated again.
+	//! The history of the element's material points is lost.
+	virtual void RestoreMaterialPointData(FEElement& el);
+
 	// serialization
 	void Serialize(DumpStream& ar) override;
 
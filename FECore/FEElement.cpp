@@ -32,13 +32,9 @@ SOFTWARE.*/
 #include <math.h>
 
 //-----------------------------------------------------------------------------
-FEElementState::FEElementState(const FEElementState& s)
+FEElementState::FEElementState(const FEElementState& s) : m_compact(false)
 {
-	m_data.resize( s.m_data.size() );
-	for (size_t i=0; i<m_data.size(); ++i) 
-	{
-		if (s.m_data[i]) m_data[i] = s.m_data[i]->Copy(); else m_data[i] = 0;
-	}
+	*this = s;
 }
 
 FEElementState& FEElementState::operator = (const FEElementState& s)
@@ -47,16 +43,48 @@ FEElementState& FEElementState::operator = (const FEElementState& s)
 	m_data.resize( s.m_data.size() );
 	for (size_t i=0; i<m_data.size(); ++i) 
 	{
-		if (s.m_data[i]) m_data[i] = s.m_data[i]->Copy(); else m_data[i] = 0;
+		if ((i > 0) && s.m_compact) m_data[i] = m_data[0];
+		else if (s.m_data[i]) m_data[i] = s.m_data[i]->Copy(); else m_data[i] = 0;
 	}
+	m_compact = s.m_compact;
 	return (*this);
 }
 
+//-----------------------------------------------------------------------------
+void FEElementState::Clear()
+{
+	if (m_compact)
+	{
+		if (m_data.empty() == false) delete m_data[0];
+	}
+	else for (size_t i=0; i<m_data.size(); ++i) delete m_data[i];
+	m_data.clear();
+	m_compact = false;
+}
+
+//-----------------------------------------------------------------------------
+void FEElementState::Compact()
+{
+	if (m_compact || (m_data.size() < 2)) return;
+	for (size_t i = 1; i < m_data.size(); ++i)
+	{
+		delete m_data[i];
+		m_data[i] = m_data[0];
+	}
+	m_compact = true;
+}
+
 //-----------------------------------------------------------------------------
 //! clear material point data
 void FEElement::ClearData()
 {
 	int nint = GaussPoints();
+	if (m_State.IsCompact())
+	{
+		m_State.Create(nint);
+		return;
+	}
+
 	for (int i=0; i<nint; ++i)
 	{
 		FEMaterialPoint* mp = GetMaterialPoint(i);
@@ -42,7 +42,7 @@ class FECORE_API FEElementState
 {
 public:
 	//! default constructor
-	FEElementState() {}
+	FEElementState() : m_compact(false) {}
 
 	//! destructor
 	~FEElementState() { Clear(); }
@@ -54,7 +54,7 @@ public:
 	FEElementState& operator = (const FEElementState& s);
 
 	//! clear state data
-	void Clear() { for (size_t i=0; i<m_data.size(); ++i) delete m_data[i]; m_data.clear(); }
+	void Clear();
 
 	//! create 
 	void Create(int n) { Clear(); m_data.assign(n, static_cast<FEMaterialPoint*>(0)); }
@@ -62,8 +62,16 @@ public:
 	//! operator for easy access to element data
 	FEMaterialPoint*& operator [] (int n) { return m_data[n]; }
 
+	//! Release the data of all but the first point. All points will then share
+	//! the data of the first point. 
+	void Compact();
+
+	//! see if the data was compacted
+	bool IsCompact() const { return m_compact; }
+
 private:
 	std::vector<FEMaterialPoint*>	m_data;
+	bool	m_compact;	//!< all entries point to m_data[0]
 };
 
 //-----------------------------------------------------------------------------
@@ -116,6 +124,14 @@ public:
 	//! clear material point data
 	void ClearData();
 
+	//! Release the material point data of all but the first integration point.
+	//! This is meant for elements that are permanently deactivated (e.g. eroded), 
+	//! since all integration points will share the same data afterwards.
+	void CompactData() { m_State.Compact(); }
+
+	//! see if the material point data was compacted
+	bool IsDataCompact() const { return m_State.IsCompact(); }
+
 public:
 	//! Set the type of the element
 	void SetType(int ntype) { FEElementLibrary::SetElementTraits(*this, ntype); }
@@ -158,6 +174,7 @@ public:
 	//! set the material point data
 	void SetMaterialPointData(FEMaterialPoint* pmp, int n)
 	{ 
+		assert(m_State.IsCompact() == false);
 		pmp->m_elem = this;
 		pmp->m_index = n;
 		if (m_State[n] != nullptr) delete m_State[n];
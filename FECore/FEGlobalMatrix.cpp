@@ -31,6 +31,17 @@ SOFTWARE.*/
 #include "FEModel.h"
 #include "FEDomain.h"
 #include "FESurface.h"
+#include "FEModelCache.h"
+
+//-----------------------------------------------------------------------------
+// The static profile stored in the model cache.
+class FEStaticProfileItem : public FEModelCache::Item
+{
+public:
+	FEStaticProfileItem(const SparseMatrixProfile& mp, std::vector<int>& lm) : m_MP(mp) { m_LM.swap(lm); }
+	SparseMatrixProfile	m_MP;
+	std::vector<int>	m_LM;	// the data the profile was built from (see StaticProfileKey)
+};
 
 //-----------------------------------------------------------------------------
 FEElementMatrix::FEElementMatrix(const FEElement& el)
@@ -86,10 +97,12 @@ void FEElementMatrix::operator = (const matrix& ke)
 FEGlobalMatrix::FEGlobalMatrix(SparseMatrix* pK, bool del)
 {
 	m_pA = pK;
-	m_LM.resize(MAX_LM_SIZE);
+	m_LMpos.reserve(MAX_LM_SIZE + 1);
+	m_LMpos.push_back(0);
 	m_pMP = 0;
 	m_nlm = 0;
 	m_delA = del;
+	m_keyLM = nullptr;
 }
 
 //-----------------------------------------------------------------------------
@@ -119,6 +132,8 @@ void FEGlobalMatrix::build_begin(int neq)
 	// TODO: Is this necessary?
 	m_pMP->CreateDiagonal();
 
+	m_LM.clear();
+	m_LMpos.assign(1, 0);
 	m_nlm = 0;
 }
 
@@ -127,14 +142,24 @@ void FEGlobalMatrix::build_begin(int neq)
 //! general at this point. Any two or more degrees of freedom that are connected 
 //! somehow are considered an element. This function takes one argument, namely a
 //! list of degrees of freedom that are part of such an "element". Elements are 
-//! first copied into a local LM array.  When this array is full it is flushed and
-//! all elements in this array are added to the matrix profile.
+//! first appended to a local LM buffer that stores the equation numbers of all
+//! elements in a compressed format. When this buffer is full it is flushed and
+//! all elements in this buffer are added to the matrix profile.
 void FEGlobalMatrix::build_add(vector<int>& lm)
 {
+	if (m_keyLM)
+	{
+		m_keyLM->push_back((int)lm.size());
+		m_keyLM->insert(m_keyLM->end(), lm.begin(), lm.end());
+		return;
+	}
+
 	if (lm.empty() == false)
 	{
-		m_LM[m_nlm++] = lm;
-		if (m_nlm >= MAX_LM_SIZE) build_flush();
+		m_LM.insert(m_LM.end(), lm.begin(), lm.end());
+		m_LMpos.push_back((int)m_LM.size());
+		m_nlm++;
+		if ((m_nlm >= MAX_LM_SIZE) || (m_LM.size() >= MAX_LM_ENTRIES)) build_flush();
 	}
 }
 
@@ -144,21 +169,22 @@ void FEGlobalMatrix::build_add(vector<int>& lm)
 //! flushin operation causes the actual update of the matrix profile.
 void FEGlobalMatrix::build_flush()
 {
-	int i, j, n, *lm;
+	if (m_nlm == 0) return;
 
 	// Since prescribed dofs have an equation number of < -1 we need to modify that
 	// otherwise no storage will be allocated for these dofs (even not diagonal elements!).
-	for (i=0; i<m_nlm; ++i)
+	const int N = (int)m_LM.size();
+	int* lm = &m_LM[0];
+#pragma omp parallel for
+	for (int i=0; i<N; ++i)
 	{
-		n = (int)m_LM[i].size();
-		if (n > 0)
-		{
-			lm = &(m_LM[i])[0];
-			for (j=0; j<n; ++j) if (lm[j] < -1) lm[j] = -lm[j]-2;
-		}
+		if (lm[i] < -1) lm[i] = -lm[i]-2;
 	}
 
-	m_pMP->UpdateProfile(m_LM, m_nlm);
+	m_pMP->UpdateProfile(lm, &m_LMpos[0], m_nlm);
+
+	m_LM.clear();
+	m_LMpos.assign(1, 0);
 	m_nlm = 0;
 }
 
@@ -196,12 +222,49 @@ bool FEGlobalMatrix::Create(FEModel* pfem, int neq, bool breset)
 		{
 			m_MPs.Clear();
 
-			// build the matrix profile
-			pfem->BuildMatrixProfile(*this, true);
+			// When the model cache is enabled, see if this static profile was built before
+			// (e.g. in a previous run of a parameter sweep). 
+			FEModelCache& cache = FEModelCache::GetInstance();
+			std::shared_ptr<FEStaticProfileItem> item;
+			uint64_t key = 0;
+			std::vector<int> LM;
+			if (cache.IsEnabled())
+			{
+				key = StaticProfileKey(pfem, neq, LM);
+				item = std::dynamic_pointer_cast<FEStaticProfileItem>(cache.Find("static_profile", key));
+
+				// the key is a hash, so make sure this is really the same profile
+				if (item && (item->m_LM != LM)) item = nullptr;
+			}
+
+			if (item)
+			{
+				*m_pMP = item->m_MP;
+			}
+			else
+			{
+				// build the matrix profile
+				// (The equation numbers were already collected for the key,
+				// so in that case we don't need to visit the model again.)
+				if (LM.empty()) pfem->BuildMatrixProfile(*this, true);
+				else
+				{
+					std::vector<int> lm;
+					for (size_t i = 1; i < LM.size(); i += lm.size())
+					{
+						int n = LM[i++];
+						lm.assign(LM.begin() + i, LM.begin() + i + n);
+						build_add(lm);
+					}
+				}
+
+				// Make sure the LM buffer is flushed
+				build_flush();
+
+				if (cache.IsEnabled()) cache.Store("static_profile", key, std::make_shared<FEStaticProfileItem>(*m_pMP, LM));
+			}
 
 			// copy the static profile to the MP object
-			// Make sure the LM buffer is flushed first.
-			build_flush();
 			m_MPs = *m_pMP;
 		}
 		else
@@ -220,6 +283,24 @@ bool FEGlobalMatrix::Create(FEModel* pfem, int neq, bool breset)
 	return true;
 }
 
+//-----------------------------------------------------------------------------
+//! The static profile is completely determined by neq and the equation numbers that
+//! are passed to build_add, so we collect those in LM and use their hash as the key.
+//! This is much cheaper than building the profile itself. When the profile is not
+//! in the cache, it is built from LM.
+uint64_t FEGlobalMatrix::StaticProfileKey(FEModel* pfem, int neq, std::vector<int>& LM)
+{
+	LM.clear();
+	LM.push_back(neq);
+	m_keyLM = &LM;
+	pfem->BuildMatrixProfile(*this, true);
+	m_keyLM = nullptr;
+
+	FEModelCache::Hash hash;
+	hash.add(&LM[0], LM.size());
+	return hash.value();
+}
+
 //-----------------------------------------------------------------------------
 //! Constructs the stiffness matrix from a FEMesh object. 
 bool FEGlobalMatrix::Create(FEMesh& mesh, int neq)
@@ -104,7 +104,8 @@ private:
 class FECORE_API FEGlobalMatrix
 {
 protected:
-	enum { MAX_LM_SIZE = 64000 };
+	enum { MAX_LM_SIZE = 64000 };		//!< max nr of elements in the LM buffer
+	enum { MAX_LM_ENTRIES = 8000000 };	//!< max nr of equation numbers in the LM buffer
 
 public:
 	//! constructor
@@ -159,6 +160,10 @@ public:
 	void build_end();
 	void build_flush();
 
+protected:
+	//! calculate the key of the static profile for the model cache
+	uint64_t StaticProfileKey(FEModel* pfem, int neq, std::vector<int>& LM);
+
 protected:
 	SparseMatrix*	m_pA;	//!< the actual global stiffness matrix
 	bool			m_delA;	//!< delete A in destructor
@@ -168,6 +173,9 @@ protected:
 
 	SparseMatrixProfile*	m_pMP;		//!< profile of sparse matrix
 	SparseMatrixProfile		m_MPs;		//!< the "static" part of the matrix profile
-	vector< vector<int> >	m_LM;		//!< used for building the stiffness matrix
+	vector<int>		m_LM;		//!< equation numbers of buffered elements (compressed format)
+	vector<int>		m_LMpos;	//!< offset of each buffered element into m_LM
 	int	m_nlm;				//!< nr of elements in m_LM array
+
+	std::vector<int>*	m_keyLM;	//!< when set, build_add only collects the equation numbers
 };
@@ -70,6 +70,10 @@ public:
 	//! performs initialization
 	bool Init() override;
 
+	//! Returns true if the response depends on the deformation history and not
+	//! only on the current deformation (e.g. viscoelastic, damage or plastic materials).
+	virtual bool IsPathDependent() const { return false; }
+
 	//! get a domain parameter
 	FEDomainParameter* FindDomainParameter(const std::string& paramName);
 
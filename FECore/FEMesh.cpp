@@ -93,6 +93,7 @@ void FEMesh::Serialize(DumpStream& ar)
 	// we don't want to store pointers to all the nodes
 	// mostly for efficiency, so we tell the archive not to store the pointers
 	ar.LockPointerTable();
+	if (ar.MeshStateExcluded() == false)
 	{
 		// store the node list
 		ar & m_Node;
@@ -1304,7 +1304,10 @@ bool FEModel::RCI_Restart()
 	return step->InitSolver();
 }
 
-bool FEModel::RCI_Advance()
+// If pushState is false, the current state is not stored for RCI_Rewind. This is for
+// callers that keep track of the model state themselves. The rewind stack is cleared
+// in that case, so that it can't be rewound to an older state by mistake.
+bool FEModel::RCI_Advance(bool pushState)
 {
 	// get the current step
 	FEAnalysis* step = m_imp->m_pStep;
@@ -1341,7 +1344,8 @@ bool FEModel::RCI_Advance()
 	}
 
 	// store current state in case we need to rewind
-	m_imp->PushState();
+	if (pushState) m_imp->PushState();
+	else m_imp->m_dmp.clear();
 
 	// Inform that the time is about to change. (Plugins can use 
 	// this callback to modify time step)
@@ -120,7 +120,7 @@ public: // reverse control solver interface
 	bool RCI_Init();
 	bool RCI_Restart();
 	bool RCI_Rewind();
-	bool RCI_Advance();
+	bool RCI_Advance(bool pushState = true);	// pushState = false skips storing the state for RCI_Rewind
 	bool RCI_Finish();
 	bool RCI_ClearRewindStack();
 
@@ -0,0 +1,136 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#include "stdafx.h"
+#include "FEModelCache.h"
+
+//-----------------------------------------------------------------------------
+FEModelCache::Hash::Hash(uint64_t seed)
+{
+	m_h = 14695981039346656037ULL ^ seed;
+}
+
+//-----------------------------------------------------------------------------
+void FEModelCache::Hash::add(const void* data, size_t size)
+{
+	const unsigned char* p = (const unsigned char*)data;
+	uint64_t h = m_h;
+	for (size_t i = 0; i < size; ++i)
+	{
+		h ^= p[i];
+		h *= 1099511628211ULL;
+	}
+	m_h = h;
+}
+
+//-----------------------------------------------------------------------------
+FEModelCache& FEModelCache::GetInstance()
+{
+	static FEModelCache cache;
+	return cache;
+}
+
+//-----------------------------------------------------------------------------
+FEModelCache::FEModelCache()
+{
+	m_benabled = false;
+	m_capacity = 16;
+	m_hits = 0;
+	m_misses = 0;
+}
+
+//-----------------------------------------------------------------------------
+void FEModelCache::Enable(bool b)
+{
+	m_benabled = b;
+	if (b == false) Clear();
+}
+
+//-----------------------------------------------------------------------------
+void FEModelCache::SetCapacity(size_t n)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_capacity = n;
+	Trim();
+}
+
+//-----------------------------------------------------------------------------
+void FEModelCache::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_items.clear();
+	m_lru.clear();
+}
+
+//-----------------------------------------------------------------------------
+std::shared_ptr<FEModelCache::Item> FEModelCache::Find(const std::string& category, uint64_t key)
+{
+	if (m_benabled == false) return nullptr;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto it = m_items.find(Key(category, key));
+	if (it == m_items.end()) { m_misses++; return nullptr; }
+
+	// move it to the front of the list
+	m_lru.splice(m_lru.begin(), m_lru, it->second.second);
+
+	m_hits++;
+	return it->second.first;
+}
+
+//-----------------------------------------------------------------------------
+void FEModelCache::Store(const std::string& category, uint64_t key, std::shared_ptr<Item> item)
+{
+	if ((m_benabled == false) || (item == nullptr)) return;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	Key k(category, key);
+	auto it = m_items.find(k);
+	if (it != m_items.end())
+	{
+		it->second.first = item;
+		m_lru.splice(m_lru.begin(), m_lru, it->second.second);
+	}
+	else
+	{
+		m_lru.push_front(k);
+		m_items[k] = std::make_pair(item, m_lru.begin());
+		Trim();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// remove the least recently used items until the cache is within capacity
+// (assumes the mutex is locked)
+void FEModelCache::Trim()
+{
+	while (m_items.size() > m_capacity)
+	{
+		m_items.erase(m_lru.back());
+		m_lru.pop_back();
+	}
+}
@@ -0,0 +1,127 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#pragma once
+#include "fecore_api.h"
+#include <stdint.h>
+#include <string>
+#include <map>
+#include <list>
+#include <memory>
+#include <mutex>
+
+//-----------------------------------------------------------------------------
+// The model cache stores data that is expensive to construct, but that only depends
+// on the geometry of the model (e.g. the parsed mesh or the static matrix profile). 
+// When the same geometry is processed again, as in parameter sweeps, optimizations
+// or batch runs of similar models, this data can be copied from the cache instead. 
+// Items are identified by a category and a 64-bit key that is calculated from the 
+// data the item was built from. The cache is disabled by default. 
+class FECORE_API FEModelCache
+{
+public:
+	// base class for cached items
+	class Item
+	{
+	public:
+		virtual ~Item() {}
+	};
+
+	// helper class for calculating keys (64-bit FNV-1a hash)
+	class Hash
+	{
+	public:
+		Hash(uint64_t seed = 0);
+
+		void add(const void* data, size_t size);
+		void add(const std::string& s) { add(s.c_str(), s.size()); }
+
+		// integers are hashed as a whole instead of per byte
+		void add(int n) { m_h ^= (uint32_t)n; m_h *= 1099511628211ULL; }
+		void add(const int* pn, size_t n) { for (size_t i = 0; i < n; ++i) add(pn[i]); }
+
+		uint64_t value() const { return m_h; }
+
+	private:
+		uint64_t	m_h;
+	};
+
+	// Enables or disables the cache while in scope. The previous setting is restored 
+	// afterwards, so that models that are processed later are not affected.
+	class Scope
+	{
+	public:
+		Scope(bool b) : m_bprev(GetInstance().IsEnabled()) { GetInstance().Enable(b); }
+		~Scope() { if (GetInstance().IsEnabled() != m_bprev) GetInstance().Enable(m_bprev); }
+
+	private:
+		bool	m_bprev;
+	};
+
+public:
+	static FEModelCache& GetInstance();
+
+	// enable or disable the cache
+	void Enable(bool b);
+	bool IsEnabled() const { return m_benabled; }
+
+	// set the max nr of items that are kept in the cache. When more items
+	// are stored, the least recently used items are removed first. 
+	void SetCapacity(size_t n);
+
+	// remove all items
+	void Clear();
+
+	// find an item (returns null if not found)
+	std::shared_ptr<Item> Find(const std::string& category, uint64_t key);
+
+	// store an item in the cache
+	void Store(const std::string& category, uint64_t key, std::shared_ptr<Item> item);
+
+	// cache statistics
+	size_t Hits() const { return m_hits; }
+	size_t Misses() const { return m_misses; }
+
+private:
+	FEModelCache();
+	FEModelCache(const FEModelCache&) = delete;
+	void operator = (const FEModelCache&) = delete;
+
+	void Trim();
+
+private:
+	typedef std::pair<std::string, uint64_t> Key;
+
+	bool	m_benabled;
+	size_t	m_capacity;
+	size_t	m_hits;
+	size_t	m_misses;
+
+	std::list<Key>	m_lru;	// least recently used items are at the back
+	std::map<Key, std::pair<std::shared_ptr<Item>, std::list<Key>::iterator> >	m_items;
+	std::mutex	m_mutex;
+};
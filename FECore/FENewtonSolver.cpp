@@ -250,6 +250,50 @@ bool FENewtonSolver::ReformStiffness()
     return bret;
 }
 
+//-----------------------------------------------------------------------------
+//! Evaluate and factor the stiffness matrix at the current state. Unlike ReformStiffness,
+//! this does not count as a reformation of the current time step. 
+bool FENewtonSolver::FactorStiffness()
+{
+	// the matrix may have been cleared at the end of the time step
+	if (m_breshape)
+	{
+		if (!CreateStiffness(true)) return false;
+	}
+
+	{
+		TRACK_TIME(TimerID::Timer_Stiffness);
+		m_pK->Zero();
+		zero(m_Fd);
+		if (StiffnessMatrix() == false) return false;
+	}
+
+	{
+		TRACK_TIME(TimerID::Timer_LinSol_Factor);
+		if (m_plinsolve->Factor() == false) return false;
+	}
+
+	// any quasi-Newton updates were for the previous matrix
+	m_qnstrategy->m_nups = 0;
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Update the model to the last converged solution plus the increment du.
+//! The converged solution is already stored in m_Ut, so the current increment 
+//! must be ignored.
+void FENewtonSolver::UpdateConverged(const std::vector<double>& du)
+{
+	vector<double> Ui(m_Ui);
+	zero(m_Ui);
+
+	vector<double> ui(du);
+	Update(ui);
+
+	m_Ui = Ui;
+}
+
 //-----------------------------------------------------------------------------
 //! get the RHS
 std::vector<double> FENewtonSolver::GetLoadVector()
@@ -769,6 +813,12 @@ void FENewtonSolver::PrepStep()
 	fem.Update();
 }
 
+//-----------------------------------------------------------------------------
+void FENewtonSolver::SetInitialGuess(const std::vector<double>& u)
+{
+	m_ug = u;
+}
+
 //-----------------------------------------------------------------------------
 //! call this at the start of the quasi-newton loop (after PrepStep)
 bool FENewtonSolver::QNInit()
@@ -787,6 +837,32 @@ bool FENewtonSolver::QNInit()
 
 	m_qnstrategy->PreSolveUpdate();
 
+	// apply the initial guess (if one was set)
+	if (m_ug.empty() == false)
+	{
+		if ((int)m_ug.size() == m_neq)
+		{
+			// The increments of the prescribed dofs are stored in m_ui. We apply
+			// those together with the guess, so they should not be added to the
+			// residual again when the stiffness matrix is formed.
+			FEMesh& mesh = GetFEModel()->GetMesh();
+			for (int i = 0; i < mesh.Nodes(); ++i)
+			{
+				FENode& node = mesh.Node(i);
+				for (int id : node.m_ID)
+				{
+					int J = -id - 2;
+					if ((J >= 0) && (J < m_neq)) m_ug[J] = m_ui[J];
+				}
+			}
+
+			Update(m_ug);
+			for (int i = 0; i < m_neq; ++i) m_Ui[i] += m_ug[i];
+			zero(m_ui);
+		}
+		m_ug.clear();
+	}
+
 	// do the reform
 	// NOTE: It is important for JFNK that the matrix is reformed before the 
 	//       residual is evaluated, so do not switch these two calculations!
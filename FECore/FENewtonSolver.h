@@ -209,6 +209,20 @@ public:
 	//! Update the model
 	virtual void UpdateModel();
 
+public: // sensitivity analysis
+	//! Evaluate and factor the stiffness matrix at the current state (e.g. a converged solution).
+	//! Afterwards, SolveLinearSystem can be used to solve with this matrix.
+	bool FactorStiffness();
+
+	//! Update the model to the last converged solution plus the increment du. 
+	//! Calling this with a zero vector restores the converged state.
+	void UpdateConverged(const std::vector<double>& du);
+
+public:
+	//! Set an initial guess for the solution increment of the next time step. 
+	//! It is applied once, after the prescribed values of the step are set.
+	void SetInitialGuess(const std::vector<double>& u);
+
 public:
 	ConvergenceInfo GetResidualConvergence() { return m_residuNorm; }
 	ConvergenceInfo GetEnergyConvergence() { return m_energyNorm; }
@@ -258,6 +272,7 @@ public:
 	vector<double> m_Ui;	//!< total solution increments of current time step
 	vector<double> m_up;	//!< solution increment of previous iteration
 	vector<double> m_Fd;	//!< residual correction due to prescribed degrees of freedom
+	vector<double> m_ug;	//!< initial guess of the solution increment of the next time step
 
 private:
 	double	m_ls;	//!< line search factor calculated in last call to QNSolve
@@ -28,6 +28,7 @@ SOFTWARE.*/
 
 #include "stdafx.h"
 #include "FENode.h"
+#include <string.h>
 #include "DumpStream.h"
 
 //=============================================================================
@@ -128,6 +129,69 @@ void FENode::Serialize(DumpStream& ar)
 	}
 }
 
+//-----------------------------------------------------------------------------
+static inline double* copyVec3d(double* pd, const vec3d& r)
+{
+	pd[0] = r.x; pd[1] = r.y; pd[2] = r.z;
+	return pd + 3;
+}
+
+static inline const double* readVec3d(const double* pd, vec3d& r)
+{
+	r.x = pd[0]; r.y = pd[1]; r.z = pd[2];
+	return pd + 3;
+}
+
+static inline double* copyArray(double* pd, const std::vector<double>& v)
+{
+	if (v.empty() == false) memcpy(pd, &v[0], v.size() * sizeof(double));
+	return pd + v.size();
+}
+
+static inline const double* readArray(const double* pd, std::vector<double>& v)
+{
+	if (v.empty() == false) memcpy(&v[0], pd, v.size() * sizeof(double));
+	return pd + v.size();
+}
+
+//-----------------------------------------------------------------------------
+size_t FENode::StateSize() const
+{
+	return 21 + m_val_t.size() + m_val_p.size() + m_Fr.size();
+}
+
+//-----------------------------------------------------------------------------
+double* FENode::CopyState(double* pd) const
+{
+	pd = copyVec3d(pd, m_rt);
+	pd = copyVec3d(pd, m_at);
+	pd = copyVec3d(pd, m_rp);
+	pd = copyVec3d(pd, m_vp);
+	pd = copyVec3d(pd, m_ap);
+	pd = copyVec3d(pd, m_dt);
+	pd = copyVec3d(pd, m_dp);
+	pd = copyArray(pd, m_val_t);
+	pd = copyArray(pd, m_val_p);
+	pd = copyArray(pd, m_Fr);
+	return pd;
+}
+
+//-----------------------------------------------------------------------------
+const double* FENode::RestoreState(const double* pd)
+{
+	pd = readVec3d(pd, m_rt);
+	pd = readVec3d(pd, m_at);
+	pd = readVec3d(pd, m_rp);
+	pd = readVec3d(pd, m_vp);
+	pd = readVec3d(pd, m_ap);
+	pd = readVec3d(pd, m_dt);
+	pd = readVec3d(pd, m_dp);
+	pd = readArray(pd, m_val_t);
+	pd = readArray(pd, m_val_p);
+	pd = readArray(pd, m_Fr);
+	return pd;
+}
+
 //-----------------------------------------------------------------------------
 //! Update nodal values, which copies the current values to the previous array
 void FENode::UpdateValues()
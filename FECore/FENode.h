@@ -93,6 +93,15 @@ public:
 	// Serialize
 	void Serialize(DumpStream& ar);
 
+	//! number of values of the state data (i.e. the data that is serialized in a shallow stream)
+	size_t StateSize() const;
+
+	//! copy the state data to a buffer, returns a pointer past the last value written
+	double* CopyState(double* pd) const;
+
+	//! restore the state data from a buffer, returns a pointer past the last value read
+	const double* RestoreState(const double* pd);
+
 	//! Update nodal values, which copies the current values to the previous array
 	void UpdateValues();
 
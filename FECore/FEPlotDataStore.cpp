@@ -27,6 +27,21 @@ SOFTWARE.*/
 #include "FEPlotDataStore.h"
 #include "DumpStream.h"
 
+//-----------------------------------------------------------------------------
+FEPlotEncoding::FEPlotEncoding()
+{
+	m_flags = PLOT_ENCODE_NONE;
+	m_abstol = 0.0;
+	m_reltol = 0.0;
+	m_keyFrame = 10;
+}
+
+//-----------------------------------------------------------------------------
+void FEPlotEncoding::Serialize(DumpStream& ar)
+{
+	ar & m_flags & m_abstol & m_reltol & m_keyFrame;
+}
+
 //-----------------------------------------------------------------------------
 FEPlotVariable::FEPlotVariable() {}
 
@@ -36,6 +51,7 @@ FEPlotVariable::FEPlotVariable(const FEPlotVariable& pv)
     m_svar = pv.m_svar;
     m_sdom = pv.m_sdom;
     m_item = pv.m_item;
+    m_enc = pv.m_enc;
 }
 
 //-----------------------------------------------------------------------------
@@ -44,6 +60,7 @@ void FEPlotVariable::operator = (const FEPlotVariable& pv)
     m_svar = pv.m_svar;
     m_sdom = pv.m_sdom;
     m_item = pv.m_item;
+    m_enc = pv.m_enc;
 }
 
 FEPlotVariable::FEPlotVariable(const std::string& var, std::vector<int>& item, const char* szdom)
@@ -58,6 +75,7 @@ void FEPlotVariable::Serialize(DumpStream& ar)
     ar & m_svar;
     ar & m_sdom;
     ar & m_item;
+    m_enc.Serialize(ar);
 }
 
 //=======================================================================================
@@ -85,10 +103,11 @@ void FEPlotDataStore::operator = (const FEPlotDataStore& plt)
 }
 
 //-----------------------------------------------------------------------------
-void FEPlotDataStore::AddPlotVariable(const char* szvar, std::vector<int>& item, const char* szdom)
+FEPlotVariable& FEPlotDataStore::AddPlotVariable(const char* szvar, std::vector<int>& item, const char* szdom)
 {
     FEPlotVariable var(szvar, item, szdom);
     m_plot.push_back(var);
+    return m_plot.back();
 }
 
 //-----------------------------------------------------------------------------
@@ -30,6 +30,32 @@ SOFTWARE.*/
 
 class DumpStream;
 
+//-----------------------------------------------------------------------------
+// Optional encoding of plot variable data. This is used by plot files that 
+// support it (currently the FEBio plot file) to reduce the size of the state data.
+enum FEPlotEncodingFlags {
+	PLOT_ENCODE_NONE     = 0,
+	PLOT_ENCODE_DELTA    = 1,	// temporal delta with respect to the previous state
+	PLOT_ENCODE_SHUFFLE  = 2,	// byte-plane shuffle (improves compression)
+	PLOT_ENCODE_QUANTIZE = 4	// quantization with bounded (absolute) error
+};
+
+class FECORE_API FEPlotEncoding
+{
+public:
+	FEPlotEncoding();
+
+	bool IsEncoded() const { return (m_flags != PLOT_ENCODE_NONE); }
+
+	void Serialize(DumpStream& ar);
+
+public:
+	int		m_flags;		//!< combination of FEPlotEncodingFlags
+	double	m_abstol;		//!< absolute error tolerance for quantization
+	double	m_reltol;		//!< relative error tolerance for quantization (relative to max abs value of state)
+	int		m_keyFrame;		//!< interval (in states) at which a full (non-delta) state is written (0 = only first state)
+};
+
 class FECORE_API FEPlotVariable
 {
 public:
@@ -48,6 +74,7 @@ public:
 	std::string			m_svar;		//!< name of output variable
 	std::string			m_sdom;		//!< (optional) name of domain
 	std::vector<int>	m_item;		//!< (optional) list of items
+	FEPlotEncoding		m_enc;		//!< (optional) encoding of data
 };
 
 class FECORE_API FEPlotDataStore
@@ -57,7 +84,7 @@ public:
 	FEPlotDataStore(const FEPlotDataStore&);
 	void operator = (const FEPlotDataStore&);
 
-	void AddPlotVariable(const char* szvar, std::vector<int>& item, const char* szdom = "");
+	FEPlotVariable& AddPlotVariable(const char* szvar, std::vector<int>& item, const char* szdom = "");
 
 	int GetPlotCompression() const;
 	void SetPlotCompression(int n);
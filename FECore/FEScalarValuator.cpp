@@ -33,6 +33,7 @@ SOFTWARE.*/
 #include "FEModel.h"
 #include "DumpStream.h"
 #include "log.h"
+#include "ScratchArena.h"
 
 //=============================================================================
 bool FEMathExpression::Init(const std::string& expr, FECoreBase* pc)
@@ -117,7 +118,8 @@ void FEMathExpression::operator = (const FEMathExpression& me)
 
 double FEMathExpression::value(FEModel* fem, const FEMaterialPoint& pt)
 {
-	std::vector<double> var(4 + m_vars.size());
+	ScratchScope scope;
+	ScratchArray<double> var(4 + m_vars.size());
 	var[0] = pt.m_r0.x;
 	var[1] = pt.m_r0.y;
 	var[2] = pt.m_r0.z;
@@ -144,7 +146,7 @@ double FEMathExpression::value(FEModel* fem, const FEMaterialPoint& pt)
 			}
 		}
 	}
-	return value_s(var);
+	return value_s(var.data());
 }
 
 //=============================================================================
@@ -44,8 +44,12 @@ FEShellDomain::FEShellDomain(FEModel* fem) : FEDomain(FE_DOMAIN_SHELL, fem)
 //-----------------------------------------------------------------------------
 void FEShellDomain::PreSolveUpdate(const FETimeInfo& timeInfo)
 {
-	ForEachMaterialPoint([&](FEMaterialPoint& mp) {
-		mp.Update(timeInfo);
+	ForEachElement([&](FEElement& el) {
+		if (el.isActive())
+		{
+			int ni = el.GaussPoints();
+			for (int j = 0; j < ni; ++j) el.GetMaterialPoint(j)->Update(timeInfo);
+		}
 	});
 }
 
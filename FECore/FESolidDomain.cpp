@@ -158,38 +158,54 @@ void FESolidDomain::Reset()
 {
 	// re-evaluate the material points initial position and jacobian
 	ForEachSolidElement([=](FESolidElement& el) {
+		InitMaterialPointGeometry(el);
+	});
 
-		// evaluate nodal coordinates
-		const int NELN = FEElement::MAX_NODES;
-		vec3d r0[NELN], r[NELN], v[NELN], a[NELN];
-		int neln = el.Nodes();
-		for (int j = 0; j < neln; ++j)
-		{
-			FENode& node = m_pMesh->Node(el.m_node[j]);
-			r0[j] = node.m_r0;
-		}
+	ForEachMaterialPoint([](FEMaterialPoint& mp) {
+		mp.Init();
+	});
+}
 
-		// initialize reference Jacobians
-		double Ji[3][3];
+//-----------------------------------------------------------------------------
+void FESolidDomain::InitMaterialPointGeometry(FESolidElement& el)
+{
+	// evaluate nodal coordinates
+	const int NELN = FEElement::MAX_NODES;
+	vec3d r0[NELN];
+	int neln = el.Nodes();
+	for (int j = 0; j < neln; ++j)
+	{
+		FENode& node = m_pMesh->Node(el.m_node[j]);
+		r0[j] = node.m_r0;
+	}
 
-		// loop over the integration points
-		int nint = el.GaussPoints();
-		for (int n = 0; n < nint; ++n)
-		{
-			FEMaterialPoint& mp = *el.GetMaterialPoint(n);
+	// initialize reference Jacobians
+	double Ji[3][3];
 
-			// initial Jacobian
-			mp.m_J0 = invjac0(el, Ji, n);
-			el.m_J0i[n] = mat3d(Ji);
+	// loop over the integration points
+	int nint = el.GaussPoints();
+	for (int n = 0; n < nint; ++n)
+	{
+		FEMaterialPoint& mp = *el.GetMaterialPoint(n);
 
-			// material point coordinates
-			mp.m_r0 = el.Evaluate(r0, n);
-		}
-	});
+		// initial Jacobian
+		mp.m_J0 = invjac0(el, Ji, n);
+		el.m_J0i[n] = mat3d(Ji);
 
-	ForEachMaterialPoint([](FEMaterialPoint& mp) {
-		mp.Init();
-	});
+		// material point coordinates
+		mp.m_r0 = el.Evaluate(r0, n);
+	}
+}
+
+//-----------------------------------------------------------------------------
+void FESolidDomain::RestoreMaterialPointData(FEElement& el)
+{
+	if (el.IsDataCompact() == false) return;
+
+	el.ClearData();
+	CreateMaterialPointData(el);
+	InitMaterialPointGeometry(static_cast<FESolidElement&>(el));
+	for (int n = 0; n < el.GaussPoints(); ++n) el.GetMaterialPoint(n)->Init();
 }
 
 //-----------------------------------------------------------------------------
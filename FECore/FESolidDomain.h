@@ -64,6 +64,9 @@ public:
     
     //! reset data (overridden from FEDomain)
     void Reset() override;
+
+	//! create new material point data for a compacted element (overridden from FEDomain)
+	void RestoreMaterialPointData(FEElement& el) override;
     
     //! copy data from another domain (overridden from FEDomain)
     void CopyFrom(FEMeshPartition* pd) override;
@@ -284,6 +287,10 @@ public:
 		FEVolumeMatrixIntegrand f	// the matrix function to evaluate
 	);
 
+protected:
+	//! evaluate the initial position and Jacobian of the element's material points
+	void InitMaterialPointGeometry(FESolidElement& el);
+
 protected:
     vector<FESolidElement>	m_Elem;		//!< array of elements
 	FE_Element_Spec			m_elemSpec;	//!< the element spec
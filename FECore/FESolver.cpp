@@ -37,6 +37,8 @@ SOFTWARE.*/
 #include "FELinearConstraintManager.h"
 #include "FENodalLoad.h"
 #include "LinearSolver.h"
+#include "SkylineSolver.h"
+#include "FECoreKernel.h"
 #include "log.h"
 
 BEGIN_FECORE_CLASS(FESolver, FECoreBase)
@@ -128,6 +130,22 @@ LinearSolver* FESolver::GetLinearSolver()
 	return nullptr;
 }
 
+//-----------------------------------------------------------------------------
+// The bandwidth is optimized when requested by the user, or when a profile solver
+// (i.e. skyline) is used, since the cost of that solver is determined by the profile.
+bool FESolver::OptimizeBandwidth()
+{
+	if (m_bwopt) return true;
+
+	// Note that the linear solver is usually not allocated yet when the equations 
+	// are initialized, in which case the default linear solver will be used.
+	LinearSolver* ls = GetLinearSolver();
+	if (ls) return (dynamic_cast<SkylineSolver*>(ls) != nullptr);
+
+	const char* sztype = FECoreKernel::GetInstance().GetLinearSolverType();
+	return ((sztype != nullptr) && (strcmp(sztype, "skyline") == 0));
+}
+
 //-----------------------------------------------------------------------------
 //! get matrix type
 Matrix_Type FESolver::MatrixType() const
@@ -397,7 +415,7 @@ bool FESolver::InitEquations()
 	vector<int> P(NN);
     
     // see if we need to optimize the bandwidth
-	if (m_bwopt)
+	if (OptimizeBandwidth())
 	{
 		FENodeReorder mod;
 		mod.Apply(mesh, P);
@@ -598,7 +616,7 @@ bool FESolver::InitEquations2()
 	vector<int> P(NN);
 
 	// see if we need to optimize the bandwidth
-	if (m_bwopt)
+	if (OptimizeBandwidth())
 	{
 		FENodeReorder mod;
 		mod.Apply(mesh, P);
@@ -186,6 +186,9 @@ public:
 protected:
 	virtual Matrix_Type PreferredMatrixType() const;
 
+	// see if the node numbering should be optimized for a small matrix profile
+	bool OptimizeBandwidth();
+
 public: //TODO Move these parameters elsewhere
 	bool				m_bwopt;	    //!< bandwidth optimization flag
 	int					m_msymm;		//!< matrix symmetry flag for linear solver allocation
@@ -0,0 +1,185 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#include "stdafx.h"
+#include "FEStateSnapshot.h"
+#include "FEModel.h"
+#include "FEMesh.h"
+#include "FEDomain.h"
+#include <assert.h>
+
+// number of elements per block of material point data
+#define SNAPSHOT_BLOCK_SIZE	1024
+
+//-----------------------------------------------------------------------------
+FEStateSnapshot::FEStateSnapshot(FEModel& fem) : m_fem(fem), m_dmp(fem)
+{
+	// the nodal and material point data are stored separately
+	m_dmp.ExcludeMeshState(true);
+}
+
+//-----------------------------------------------------------------------------
+FEStateSnapshot::~FEStateSnapshot()
+{
+	for (size_t i = 0; i < m_block.size(); ++i) delete m_block[i].ar;
+	m_block.clear();
+}
+
+//-----------------------------------------------------------------------------
+size_t FEStateSnapshot::size() const
+{
+	size_t nsize = m_nodeData.size() * sizeof(double) + m_dmp.size();
+	for (size_t i = 0; i < m_block.size(); ++i) nsize += m_block[i].ar->size();
+	return nsize;
+}
+
+//-----------------------------------------------------------------------------
+void FEStateSnapshot::Save()
+{
+	SaveNodes();
+	SaveMaterialPoints();
+
+	// serialize everything else
+	m_dmp.clear();
+	m_fem.Serialize(m_dmp);
+}
+
+//-----------------------------------------------------------------------------
+void FEStateSnapshot::Restore()
+{
+	// The mesh state is restored first, since other components 
+	// may depend on it when they are restored.
+	RestoreNodes();
+	RestoreMaterialPoints();
+
+	m_dmp.Open(false, true);
+	m_fem.Serialize(m_dmp);
+}
+
+//-----------------------------------------------------------------------------
+void FEStateSnapshot::SaveNodes()
+{
+	FEMesh& mesh = m_fem.GetMesh();
+	int NN = mesh.Nodes();
+
+	// the number of dofs can change between steps, so we recalculate the offsets
+	m_nodeOffset.resize(NN + 1);
+	m_nodeOffset[0] = 0;
+	for (int i = 0; i < NN; ++i) m_nodeOffset[i + 1] = m_nodeOffset[i] + mesh.Node(i).StateSize();
+	m_nodeData.resize(m_nodeOffset[NN]);
+
+#pragma omp parallel for schedule(static)
+	for (int i = 0; i < NN; ++i)
+	{
+		const FENode& node = mesh.Node(i);
+		node.CopyState(m_nodeData.data() + m_nodeOffset[i]);
+	}
+}
+
+//-----------------------------------------------------------------------------
+void FEStateSnapshot::RestoreNodes()
+{
+	FEMesh& mesh = m_fem.GetMesh();
+	int NN = mesh.Nodes();
+	assert((int)m_nodeOffset.size() == NN + 1);
+
+#pragma omp parallel for schedule(static)
+	for (int i = 0; i < NN; ++i)
+	{
+		FENode& node = mesh.Node(i);
+		assert(node.StateSize() == m_nodeOffset[i + 1] - m_nodeOffset[i]);
+		node.RestoreState(m_nodeData.data() + m_nodeOffset[i]);
+	}
+}
+
+//-----------------------------------------------------------------------------
+void FEStateSnapshot::SaveMaterialPoints()
+{
+	FEMesh& mesh = m_fem.GetMesh();
+
+	// build the element blocks, reusing the streams of the previous snapshot
+	int nblocks = 0;
+	for (int i = 0; i < mesh.Domains(); ++i)
+	{
+		int NE = mesh.Domain(i).Elements();
+		for (int n0 = 0; n0 < NE; n0 += SNAPSHOT_BLOCK_SIZE, ++nblocks)
+		{
+			if (nblocks == (int)m_block.size())
+			{
+				ElementBlock b;
+				b.ar = new DumpMemStream(m_fem);
+				m_block.push_back(b);
+			}
+			ElementBlock& b = m_block[nblocks];
+			b.dom = i;
+			b.n0 = n0;
+			b.n1 = (n0 + SNAPSHOT_BLOCK_SIZE < NE ? n0 + SNAPSHOT_BLOCK_SIZE : NE);
+		}
+	}
+	for (size_t i = nblocks; i < m_block.size(); ++i) delete m_block[i].ar;
+	m_block.resize(nblocks);
+
+	// serialize the element and material point data
+#pragma omp parallel for schedule(dynamic)
+	for (int n = 0; n < nblocks; ++n)
+	{
+		ElementBlock& b = m_block[n];
+		FEDomain& dom = mesh.Domain(b.dom);
+		DumpMemStream& ar = *b.ar;
+		ar.clear();
+		for (int i = b.n0; i < b.n1; ++i)
+		{
+			FEElement& el = dom.ElementRef(i);
+			el.Serialize(ar);
+			int nint = el.GaussPoints();
+			for (int j = 0; j < nint; ++j) el.GetMaterialPoint(j)->Serialize(ar);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+void FEStateSnapshot::RestoreMaterialPoints()
+{
+	FEMesh& mesh = m_fem.GetMesh();
+	int nblocks = (int)m_block.size();
+
+#pragma omp parallel for schedule(dynamic)
+	for (int n = 0; n < nblocks; ++n)
+	{
+		ElementBlock& b = m_block[n];
+		FEDomain& dom = mesh.Domain(b.dom);
+		DumpMemStream& ar = *b.ar;
+		ar.Open(false, true);
+		for (int i = b.n0; i < b.n1; ++i)
+		{
+			FEElement& el = dom.ElementRef(i);
+			el.Serialize(ar);
+			int nint = el.GaussPoints();
+			for (int j = 0; j < nint; ++j) el.GetMaterialPoint(j)->Serialize(ar);
+		}
+	}
+}
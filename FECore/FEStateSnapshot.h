@@ -0,0 +1,80 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#pragma once
+#include "DumpMemStream.h"
+#include <vector>
+
+class FEModel;
+
+//-----------------------------------------------------------------------------
+//! This class stores a snapshot of the state of a model, so that it can be 
+//! restored later. This is used by the analysis to retry a time step. 
+//! It stores the same data as a shallow serialization of the model, but the
+//! nodal state is copied in bulk into a contiguous buffer and the material 
+//! point data is stored in separate streams per block of elements, so that 
+//! both can be processed in parallel. All other model components are 
+//! serialized as usual.
+class FECORE_API FEStateSnapshot
+{
+public:
+	FEStateSnapshot(FEModel& fem);
+	~FEStateSnapshot();
+
+	//! store the current state of the model
+	void Save();
+
+	//! restore the model to the last saved state
+	void Restore();
+
+	//! return the memory used by the snapshot (in bytes)
+	size_t size() const;
+
+private:
+	void SaveNodes();
+	void RestoreNodes();
+	void SaveMaterialPoints();
+	void RestoreMaterialPoints();
+
+private:
+	// a block of elements whose element and material point data is stored in its own stream
+	struct ElementBlock
+	{
+		int				dom;	//!< domain index
+		int				n0;		//!< first element
+		int				n1;		//!< one past the last element
+		DumpMemStream*	ar;		//!< stream for the element and material point data
+	};
+
+private:
+	FEModel&	m_fem;
+
+	std::vector<double>			m_nodeData;		//!< nodal state
+	std::vector<size_t>			m_nodeOffset;	//!< offset of each node in nodal state buffer
+	std::vector<ElementBlock>	m_block;		//!< material point data
+	DumpMemStream				m_dmp;			//!< all other model data
+};
@@ -0,0 +1,483 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+
+
+
+#include "stdafx.h"
+#include "MProgram.h"
+#include "ScratchArena.h"
+#include <map>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+using namespace std;
+
+//-----------------------------------------------------------------------------
+// Helper class for compiling an MItem tree into an MProgram. Registers are first
+// assigned provisional ids, since the number of variables and constants is only
+// known after the whole tree was processed.
+class MCompiler
+{
+	enum RegType { REG_VAR, REG_CONST, REG_TEMP };
+
+	struct Reg
+	{
+		int		type;
+		int		index;	// variable index, index into m_const, or index into m_code
+	};
+
+public:
+	MCompiler(MProgram& prg) : m_prg(prg) {}
+
+	bool Compile(const MItem* pi);
+
+private:
+	int Emit(const MItem* pi);
+
+	int Variable(int index);
+	int Constant(double v);
+	int Instruction(const MProgram::Instr& ins, uintptr_t fnc, const int* ops, int nops);
+
+	bool IsConstant(int id) const { return (m_reg[id].type == REG_CONST); }
+	double ConstValue(int id) const { return m_const[m_reg[id].index]; }
+
+private:
+	MProgram&	m_prg;
+
+	vector<Reg>					m_reg;
+	vector<double>				m_const;
+	vector<MProgram::Instr>		m_code;
+	vector<int>					m_args;
+	map<int, int>				m_varMap;	// variable index to register
+	map<uint64_t, int>			m_constMap;	// bit pattern of constant to register
+	map<vector<uintptr_t>, int>	m_cseMap;	// instruction signature to register
+};
+
+//-----------------------------------------------------------------------------
+int MCompiler::Variable(int index)
+{
+	map<int, int>::iterator it = m_varMap.find(index);
+	if (it != m_varMap.end()) return it->second;
+
+	int id = (int)m_reg.size();
+	m_reg.push_back({ REG_VAR, index });
+	m_varMap[index] = id;
+	return id;
+}
+
+//-----------------------------------------------------------------------------
+int MCompiler::Constant(double v)
+{
+	uint64_t bits;
+	memcpy(&bits, &v, sizeof(double));
+	map<uint64_t, int>::iterator it = m_constMap.find(bits);
+	if (it != m_constMap.end()) return it->second;
+
+	int id = (int)m_reg.size();
+	m_reg.push_back({ REG_CONST, (int)m_const.size() });
+	m_const.push_back(v);
+	m_constMap[bits] = id;
+	return id;
+}
+
+//-----------------------------------------------------------------------------
+// Add an instruction, unless an identical one was already emitted.
+int MCompiler::Instruction(const MProgram::Instr& ins, uintptr_t fnc, const int* ops, int nops)
+{
+	vector<uintptr_t> key;
+	key.reserve(nops + 2);
+	key.push_back((uintptr_t)ins.op);
+	key.push_back(fnc);
+	for (int i = 0; i < nops; ++i) key.push_back((uintptr_t)ops[i]);
+
+	map<vector<uintptr_t>, int>::iterator it = m_cseMap.find(key);
+	if (it != m_cseMap.end()) return it->second;
+
+	int id = (int)m_reg.size();
+	m_reg.push_back({ REG_TEMP, (int)m_code.size() });
+	m_code.push_back(ins);
+	m_cseMap[key] = id;
+	return id;
+}
+
+//-----------------------------------------------------------------------------
+// Returns the (provisional) register that holds the value of the item, or -1 if 
+// the item cannot be compiled.
+int MCompiler::Emit(const MItem* pi)
+{
+	MProgram::Instr ins = { 0, -1, -1, nullptr, nullptr, nullptr };
+	switch (pi->Type())
+	{
+	case MCONST:
+	case MFRAC:
+	case MNAMED:
+		return Constant(mnumber(pi)->value());
+	case MVAR:
+	{
+		int index = mvar(pi)->index();
+		return (index >= 0 ? Variable(index) : -1);
+	}
+	case MNEG:
+	case MF1D:
+	{
+		int a = Emit(munary(pi)->Item());
+		if (a < 0) return -1;
+		if (pi->Type() == MNEG)
+		{
+			if (IsConstant(a)) return Constant(-ConstValue(a));
+			ins.op = MProgram::OP_NEG;
+		}
+		else
+		{
+			FUNCPTR f = mfnc1d(pi)->funcptr();
+			if (IsConstant(a)) return Constant(f(ConstValue(a)));
+			ins.op = MProgram::OP_F1D;
+			ins.f1 = f;
+		}
+		ins.a = a;
+		return Instruction(ins, (ins.f1 ? (uintptr_t)ins.f1 : 0), &a, 1);
+	}
+	case MADD:
+	case MSUB:
+	case MMUL:
+	case MDIV:
+	case MPOW:
+	case MF2D:
+	{
+		int a = Emit(mbinary(pi)->LeftItem()); if (a < 0) return -1;
+		int b = Emit(mbinary(pi)->RightItem()); if (b < 0) return -1;
+		bool bconst = (IsConstant(a) && IsConstant(b));
+		double va = (bconst ? ConstValue(a) : 0.0);
+		double vb = (bconst ? ConstValue(b) : 0.0);
+		uintptr_t fnc = 0;
+		switch (pi->Type())
+		{
+		case MADD: if (bconst) return Constant(va + vb); ins.op = MProgram::OP_ADD; break;
+		case MSUB: if (bconst) return Constant(va - vb); ins.op = MProgram::OP_SUB; break;
+		case MMUL: if (bconst) return Constant(va * vb); ins.op = MProgram::OP_MUL; break;
+		case MDIV: if (bconst) return Constant(va / vb); ins.op = MProgram::OP_DIV; break;
+		case MPOW: if (bconst) return Constant(pow(va, vb)); ins.op = MProgram::OP_POW; break;
+		case MF2D:
+		{
+			FUNC2PTR f = mfnc2d(pi)->funcptr();
+			if (bconst) return Constant(f(va, vb));
+			ins.op = MProgram::OP_F2D;
+			ins.f2 = f;
+			fnc = (uintptr_t)f;
+		}
+		break;
+		default:
+			break;
+		}
+
+		// addition and multiplication are commutative, so a+b and b+a are the same subexpression
+		if (((ins.op == MProgram::OP_ADD) || (ins.op == MProgram::OP_MUL)) && (a > b)) { int t = a; a = b; b = t; }
+
+		ins.a = a;
+		ins.b = b;
+		int ops[2] = { a, b };
+		return Instruction(ins, fnc, ops, 2);
+	}
+	case MFND:
+	{
+		const MFuncND* f = mfncnd(pi);
+		int n = f->Params();
+		vector<int> ops(n);
+		bool bconst = true;
+		for (int i = 0; i < n; ++i)
+		{
+			ops[i] = Emit(f->Param(i));
+			if (ops[i] < 0) return -1;
+			if (IsConstant(ops[i]) == false) bconst = false;
+		}
+
+		if (bconst)
+		{
+			vector<double> d(n);
+			for (int i = 0; i < n; ++i) d[i] = ConstValue(ops[i]);
+			return Constant((f->funcptr())(d.data(), n));
+		}
+
+		// the arguments are stored in m_args when the instruction is emitted
+		ins.op = MProgram::OP_FND;
+		ins.fn = f->funcptr();
+		ins.b = n;
+		size_t ncode = m_code.size();
+		int id = Instruction(ins, (uintptr_t)ins.fn, ops.data(), n);
+		if (m_code.size() != ncode)
+		{
+			m_code.back().a = (int)m_args.size();
+			m_args.insert(m_args.end(), ops.begin(), ops.end());
+		}
+		return id;
+	}
+	case MSFNC:
+		return Emit(msfncnd(pi)->Value());
+	default:
+		return -1;
+	}
+}
+
+//-----------------------------------------------------------------------------
+bool MCompiler::Compile(const MItem* pi)
+{
+	m_prg.Clear();
+	if (pi == nullptr) return false;
+
+	int out = Emit(pi);
+	if (out < 0) return false;
+
+	// Assign the final registers. Constants that were only used to fold other 
+	// constants are dropped.
+	vector<bool> used(m_reg.size(), false);
+	used[out] = true;
+	for (const MProgram::Instr& ins : m_code)
+	{
+		switch (ins.op)
+		{
+		case MProgram::OP_FND: for (int i = 0; i < ins.b; ++i) used[m_args[ins.a + i]] = true; break;
+		case MProgram::OP_NEG:
+		case MProgram::OP_F1D: used[ins.a] = true; break;
+		default:
+			used[ins.a] = used[ins.b] = true;
+		}
+	}
+
+	int nvar = 0;
+	for (const Reg& r : m_reg) if (r.type == REG_VAR) nvar = (r.index + 1 > nvar ? r.index + 1 : nvar);
+
+	vector<int> reg(m_reg.size(), -1);
+	vector<double>& cv = m_prg.m_const;
+	for (size_t i = 0; i < m_reg.size(); ++i)
+	{
+		const Reg& r = m_reg[i];
+		if (r.type == REG_VAR) reg[i] = r.index;
+		else if ((r.type == REG_CONST) && used[i])
+		{
+			reg[i] = nvar + (int)cv.size();
+			cv.push_back(m_const[r.index]);
+		}
+	}
+	int base = nvar + (int)cv.size();
+	for (size_t i = 0; i < m_reg.size(); ++i)
+	{
+		if (m_reg[i].type == REG_TEMP) reg[i] = base + m_reg[i].index;
+	}
+
+	m_prg.m_code = m_code;
+	for (MProgram::Instr& ins : m_prg.m_code)
+	{
+		if (ins.op != MProgram::OP_FND)
+		{
+			ins.a = reg[ins.a];
+			if (ins.b >= 0) ins.b = reg[ins.b];
+		}
+	}
+	m_prg.m_args.resize(m_args.size());
+	for (size_t i = 0; i < m_args.size(); ++i) m_prg.m_args[i] = reg[m_args[i]];
+
+	m_prg.m_narg = 0;
+	for (const MProgram::Instr& ins : m_prg.m_code)
+		if ((ins.op == MProgram::OP_FND) && (ins.b > m_prg.m_narg)) m_prg.m_narg = ins.b;
+
+	m_prg.m_nvar = nvar;
+	m_prg.m_out = reg[out];
+
+	return true;
+}
+
+//=============================================================================
+MProgram::MProgram()
+{
+	m_nvar = 0;
+	m_out = -1;
+	m_narg = 0;
+}
+
+//-----------------------------------------------------------------------------
+void MProgram::Clear()
+{
+	m_nvar = 0;
+	m_out = -1;
+	m_narg = 0;
+	m_const.clear();
+	m_code.clear();
+	m_args.clear();
+}
+
+//-----------------------------------------------------------------------------
+bool MProgram::Compile(const MItem* pi)
+{
+	MCompiler compiler(*this);
+	if (compiler.Compile(pi) == false)
+	{
+		Clear();
+		return false;
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Execute the instructions. The register file must be initialized with the 
+// variables and constants. It also needs room for the arguments of the largest 
+// N-ary function after the last register.
+void MProgram::Run(double* r) const
+{
+	const int N = (int)m_code.size();
+	double* d = r + (m_nvar + (int)m_const.size());
+	double* arg = d + N;
+	for (int i = 0; i < N; ++i)
+	{
+		const Instr& c = m_code[i];
+		switch (c.op)
+		{
+		case OP_NEG: d[i] = -r[c.a]; break;
+		case OP_ADD: d[i] = r[c.a] + r[c.b]; break;
+		case OP_SUB: d[i] = r[c.a] - r[c.b]; break;
+		case OP_MUL: d[i] = r[c.a] * r[c.b]; break;
+		case OP_DIV: d[i] = r[c.a] / r[c.b]; break;
+		case OP_POW: d[i] = pow(r[c.a], r[c.b]); break;
+		case OP_F1D: d[i] = (c.f1)(r[c.a]); break;
+		case OP_F2D: d[i] = (c.f2)(r[c.a], r[c.b]); break;
+		case OP_FND:
+		{
+			const int* ops = &m_args[c.a];
+			for (int j = 0; j < c.b; ++j) arg[j] = r[ops[j]];
+			d[i] = (c.fn)(arg, c.b);
+		}
+		break;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Same as Run, but each register holds LANES values. The loops over the lanes
+// of the arithmetic operations are simple enough for the compiler to vectorize.
+void MProgram::RunLanes(double* r) const
+{
+	const int N = (int)m_code.size();
+	const int base = m_nvar + (int)m_const.size();
+	double* arg = r + (base + N)*LANES;
+	for (int i = 0; i < N; ++i)
+	{
+		const Instr& c = m_code[i];
+		double* d = r + (base + i)*LANES;
+		const double* a = r + c.a*LANES;
+		const double* b = r + (c.b >= 0 ? c.b : 0)*LANES;
+		switch (c.op)
+		{
+		case OP_NEG: for (int l = 0; l < LANES; ++l) d[l] = -a[l]; break;
+		case OP_ADD: for (int l = 0; l < LANES; ++l) d[l] = a[l] + b[l]; break;
+		case OP_SUB: for (int l = 0; l < LANES; ++l) d[l] = a[l] - b[l]; break;
+		case OP_MUL: for (int l = 0; l < LANES; ++l) d[l] = a[l] * b[l]; break;
+		case OP_DIV: for (int l = 0; l < LANES; ++l) d[l] = a[l] / b[l]; break;
+		case OP_POW: for (int l = 0; l < LANES; ++l) d[l] = pow(a[l], b[l]); break;
+		case OP_F1D: for (int l = 0; l < LANES; ++l) d[l] = (c.f1)(a[l]); break;
+		case OP_F2D: for (int l = 0; l < LANES; ++l) d[l] = (c.f2)(a[l], b[l]); break;
+		case OP_FND:
+		{
+			const int* ops = &m_args[c.a];
+			for (int l = 0; l < LANES; ++l)
+			{
+				for (int j = 0; j < c.b; ++j) arg[j] = r[ops[j] * LANES + l];
+				d[l] = (c.fn)(arg, c.b);
+			}
+		}
+		break;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Initialize the register file and run the program. 
+double MProgram::Evaluate(double* r, const double* var) const
+{
+	const int nc = (int)m_const.size();
+	for (int i = 0; i < m_nvar; ++i) r[i] = var[i];
+	for (int i = 0; i < nc; ++i) r[m_nvar + i] = m_const[i];
+	Run(r);
+	return r[m_out];
+}
+
+//-----------------------------------------------------------------------------
+double MProgram::value(const double* var) const
+{
+	assert(IsValid());
+
+	// the expression is a single variable or constant
+	if (m_code.empty()) return (m_out < m_nvar ? var[m_out] : m_const[m_out - m_nvar]);
+
+	// small programs use a register file on the stack
+	const int MAX_STACK = 64;
+	const int nreg = Registers() + m_narg;
+	if (nreg <= MAX_STACK)
+	{
+		double r[MAX_STACK];
+		return Evaluate(r, var);
+	}
+	else
+	{
+		ScratchScope scope;
+		ScratchArray<double> r(nreg);
+		return Evaluate(r.data(), var);
+	}
+}
+
+//-----------------------------------------------------------------------------
+void MProgram::value(const double* const* var, double* out, int n) const
+{
+	assert(IsValid());
+	if (n <= 0) return;
+
+	const int nc = (int)m_const.size();
+	const int nreg = Registers();
+
+	ScratchScope scope;
+	ScratchArray<double> r(nreg*LANES + m_narg);
+
+	// the constants don't change
+	for (int i = 0; i < nc; ++i)
+		for (int l = 0; l < LANES; ++l) r[(m_nvar + i)*LANES + l] = m_const[i];
+
+	for (int k = 0; k < n; k += LANES)
+	{
+		// If there are fewer points than lanes, the last point is repeated.
+		int nl = (n - k < LANES ? n - k : LANES);
+		for (int i = 0; i < m_nvar; ++i)
+		{
+			const double* vi = var[i] + k;
+			double* ri = &r[i*LANES];
+			for (int l = 0; l < LANES; ++l) ri[l] = vi[l < nl ? l : nl - 1];
+		}
+
+		RunLanes(r.data());
+
+		const double* ro = &r[m_out*LANES];
+		for (int l = 0; l < nl; ++l) out[k + l] = ro[l];
+	}
+}
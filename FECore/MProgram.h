@@ -0,0 +1,115 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+
+
+
+#pragma once
+#include "MItem.h"
+#include "fecore_api.h"
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// A math expression that was compiled into a flat list of register
+// instructions. Compiling folds constant subexpressions and evaluates identical
+// subexpressions only once, so that evaluating the program is much cheaper than
+// walking the MItem tree. The program does not reference the tree it was
+// compiled from. 
+// The registers are laid out as follows: first the variables (in order of their
+// index), then the constants, and then the results of the instructions.
+class FECORE_API MProgram
+{
+public:
+	// number of points that are evaluated together in the batched evaluation
+	enum { LANES = 8 };
+
+public:
+	MProgram();
+
+	void Clear();
+
+	// Compile an expression. Returns false if the expression contains items
+	// that cannot be compiled (e.g. matrices or equations). 
+	bool Compile(const MItem* pi);
+
+	// returns true if a program was compiled successfully
+	bool IsValid() const { return (m_out >= 0); }
+
+	// number of variables referenced by the program (i.e. largest variable index + 1)
+	int Variables() const { return m_nvar; }
+
+	// number of instructions
+	int Instructions() const { return (int)m_code.size(); }
+
+	// total number of registers
+	int Registers() const { return m_nvar + (int)m_const.size() + (int)m_code.size(); }
+
+public:
+	// Evaluate the program. The var array must contain (at least) Variables() values.
+	// This function is thread safe.
+	double value(const double* var) const;
+
+	// Evaluate the program at n points. var[i] is an array with the n values of 
+	// variable i and the results are stored in out. This function is thread safe.
+	void value(const double* const* var, double* out, int n) const;
+
+private:
+	enum OpCode {
+		OP_NEG,
+		OP_ADD,
+		OP_SUB,
+		OP_MUL,
+		OP_DIV,
+		OP_POW,
+		OP_F1D,
+		OP_F2D,
+		OP_FND
+	};
+
+	struct Instr
+	{
+		int			op;		// op code
+		int			a, b;	// operand registers (for OP_FND: offset and size in m_args)
+		FUNCPTR		f1;		// function for OP_F1D
+		FUNC2PTR	f2;		// function for OP_F2D
+		FUNCNPTR	fn;		// function for OP_FND
+	};
+
+	double Evaluate(double* r, const double* var) const;
+	void Run(double* r) const;
+	void RunLanes(double* r) const;
+
+private:
+	int					m_nvar;		// nr of variables
+	int					m_out;		// register that holds the result
+	std::vector<double>	m_const;	// values of the constant registers
+	std::vector<Instr>	m_code;		// instructions. The result of instruction i is stored in register m_nvar + m_const.size() + i
+	std::vector<int>	m_args;		// argument registers of N-ary functions
+	int					m_narg;		// max. nr of arguments of an N-ary function
+
+	friend class MCompiler;
+};
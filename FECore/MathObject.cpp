@@ -126,6 +126,33 @@ int MSimpleExpression::Items()
 	else return 1;
 }
 
+//-----------------------------------------------------------------------------
+void MSimpleExpression::SetExpression(MITEM& e)
+{
+	m_item = e;
+
+	// If the expression cannot be compiled, the thread safe functions walk the expression tree instead.
+	m_prg.Compile(m_item.ItemPtr());
+}
+
+//-----------------------------------------------------------------------------
+void MSimpleExpression::value_s(const double* const* var, double* out, int n) const
+{
+	if (m_prg.IsValid())
+	{
+		m_prg.value(var, out, n);
+		return;
+	}
+
+	const int nvar = (int)m_Var.size();
+	vector<double> v(nvar);
+	for (int i = 0; i < n; ++i)
+	{
+		for (int j = 0; j < nvar; ++j) v[j] = var[j][i];
+		out[i] = value(m_item.ItemPtr(), v.data());
+	}
+}
+
 //-----------------------------------------------------------------------------
 double MSimpleExpression::value(const std::string& s)
 {
@@ -182,7 +209,7 @@ double MSimpleExpression::value(const MItem* pi) const
 }
 
 //-----------------------------------------------------------------------------
-double MSimpleExpression::value(const MItem* pi, const std::vector<double>& var) const
+double MSimpleExpression::value(const MItem* pi, const double* var) const
 {
 	switch (pi->Type())
 	{
@@ -230,7 +257,7 @@ double MSimpleExpression::value(const MItem* pi, const std::vector<double>& var)
 }
 
 //-----------------------------------------------------------------------------
-MSimpleExpression::MSimpleExpression(const MSimpleExpression& mo) : MathObject(mo), m_item(mo.m_item)
+MSimpleExpression::MSimpleExpression(const MSimpleExpression& mo) : MathObject(mo), m_item(mo.m_item), m_prg(mo.m_prg)
 {
 	// The copy c'tor of MathObject copied the variables, but any MVarRefs still point to the mo object, not this object's var list.
 	// Calling the following function fixes this
@@ -245,6 +272,7 @@ void MSimpleExpression::operator=(const MSimpleExpression& mo)
 
 	// copy the item
 	m_item = mo.m_item;
+	m_prg = mo.m_prg;
 
 	// The = operator of MathObject copied the variables, but any MVarRefs still point to the mo object, not this object's var list.
 	// Calling the following function fixes this
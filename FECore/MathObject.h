@@ -28,6 +28,7 @@ SOFTWARE.*/
 
 #pragma once
 #include "MItem.h"
+#include "MProgram.h"
 #include <vector>
 #include "fecore_api.h"
 
@@ -76,7 +77,8 @@ public:
 	MSimpleExpression(const MSimpleExpression& mo);
 	void operator = (const MSimpleExpression& mo);
 
-	void SetExpression(MITEM& e) { m_item = e; }
+	// Set the expression. This also compiles the expression for the thread safe evaluation functions.
+	void SetExpression(MITEM& e);
 	MITEM& GetExpression() { return m_item; }
 	const MITEM& GetExpression() const { return m_item; }
 
@@ -100,18 +102,30 @@ public:
 	double value_s(const std::vector<double>& var) const
 	{ 
 		assert(var.size() == m_Var.size());
-		return value(m_item.ItemPtr(), var); 
+		return value_s(var.data());
 	}
 
+	// Same as above, but the var array must have (at least) Variables() values.
+	double value_s(const double* var) const
+	{
+		if (m_prg.IsValid()) return m_prg.value(var);
+		return value(m_item.ItemPtr(), var);
+	}
+
+	// Evaluate the expression at n points. var[i] is an array with the n values of
+	// variable i, and the results are stored in out. This is also thread safe.
+	void value_s(const double* const* var, double* out, int n) const;
+
 	int Items();
 
 protected:
 	double value(const MItem* pi) const;
-	double value(const MItem* pi, const std::vector<double>& var) const;
+	double value(const MItem* pi, const double* var) const;
 
 protected:
 	void fixVariableRefs(MItem* pi);
 
 protected:
-	MITEM	m_item;
+	MITEM		m_item;
+	MProgram	m_prg;	// compiled expression (used by the thread safe functions)
 };
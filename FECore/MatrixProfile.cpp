@@ -29,6 +29,7 @@ SOFTWARE.*/
 #include "stdafx.h"
 #include "MatrixProfile.h"
 #include <assert.h>
+#include <algorithm>
 using namespace std;
 
 SparseMatrixProfile::ColumnProfile::ColumnProfile(const SparseMatrixProfile::ColumnProfile& a)
@@ -153,6 +154,47 @@ void SparseMatrixProfile::ColumnProfile::insertRow(int row)
 	}
 }
 
+//-----------------------------------------------------------------------------
+// Merges a sorted list of unique row indices into the column profile.
+void SparseMatrixProfile::ColumnProfile::insertRows(const int* rows, int n)
+{
+	if (n == 0) return;
+
+	// The row entries are merged with the existing entries in a new list
+	vector<RowEntry> data;
+	data.reserve(m_data.size() + n);
+
+	// this adds an interval to the new list, merging it with the last entry
+	// if the intervals overlap or touch
+	auto add = [&](int r0, int r1) {
+		if (data.empty() || (r0 > data.back().end + 1))
+		{
+			RowEntry re = { r0, r1 };
+			data.push_back(re);
+		}
+		else if (r1 > data.back().end) data.back().end = r1;
+	};
+
+	// merge the two sorted lists
+	int N = size();
+	int i = 0, j = 0;
+	while ((i < N) || (j < n))
+	{
+		if ((j == n) || ((i < N) && (m_data[i].start <= rows[j])))
+		{
+			add(m_data[i].start, m_data[i].end);
+			i++;
+		}
+		else
+		{
+			add(rows[j], rows[j]);
+			j++;
+		}
+	}
+
+	m_data.swap(data);
+}
+
 //-----------------------------------------------------------------------------
 //! MatrixProfile constructor. Takes the nr of equations as input argument.
 //! If n is larger than zero a default profile is constructor for a diagonal
@@ -231,81 +273,112 @@ void SparseMatrixProfile::Clear()
 //! are somehow connected. Each pair of dofs that are connected contributes to
 //! the global stiffness matrix and therefor also to the matrix profile.
 void SparseMatrixProfile::UpdateProfile(vector< vector<int> >& LM, int M)
+{
+	// pack the element arrays in a compressed format
+	vector<int> pos(M + 1, 0);
+	for (int i = 0; i < M; ++i) pos[i + 1] = pos[i] + (int)LM[i].size();
+	if (pos[M] == 0) return;
+
+	vector<int> lm(pos[M]);
+	for (int i = 0; i < M; ++i)
+	{
+		if (LM[i].empty() == false) std::copy(LM[i].begin(), LM[i].end(), lm.begin() + pos[i]);
+	}
+
+	UpdateProfile(&lm[0], &pos[0], M);
+}
+
+//-----------------------------------------------------------------------------
+//! Updates the profile from a compressed element array. The equation numbers of
+//! element i are stored in LM[pos[i]] to LM[pos[i+1]-1]. Negative equation 
+//! numbers are ignored. The profile is built in two passes: first, the number of
+//! elements that contribute to each column is counted, which is then used to build
+//! a compressed column-to-element table. Next, for each column, the row indices
+//! of all contributing elements are collected, sorted, and merged into the column
+//! profile. Both passes are done in parallel.
+void SparseMatrixProfile::UpdateProfile(const int* LM, const int* pos, int M)
 {
 	// get the dimensions of the matrix
 	int nr = m_nrow;
 	int nc = m_ncol;
 
 	// make sure there is work to do
-	if (nr*nc == 0) return;
+	if ((nr == 0) || (nc == 0) || (M == 0)) return;
 
 	// Count the number of elements that contribute to a certain column
 	// The pval array stores this number (which I also call the valence
 	// of the column)
 	vector<int> pval(nc, 0);
-
-	// fill the valence array
-	int Ntot = 0;
+#pragma omp parallel for
 	for (int i = 0; i<M; ++i)
 	{
-		int* lm = &(LM[i])[0];
-		int N = (int)LM[i].size();
-		Ntot += N;
-		for (int j = 0; j<N; ++j)
+		for (int j = pos[i]; j<pos[i + 1]; ++j)
 		{
-			if (lm[j] >= 0) pval[lm[j]]++;
+			int n = LM[j];
+			if (n >= 0)
+			{
+#pragma omp atomic
+				pval[n]++;
+			}
 		}
 	}
 
 	// create a "compact" 2D array that stores for each column the element
 	// numbers that contribute to that column. The compact array consists
 	// of two arrays. The first one (pelc) contains all element numbers, sorted
-	// by column. The second array stores for each column a pointer to the first
-	// element in the pelc array that contributes to that column.
-	vector<int> pelc(Ntot);
-	vector<int*> ppelc(nc);
-
-	// set the column pointers
-	ppelc[0] = &pelc[0];
-	for (int i = 1; i<nc; ++i) ppelc[i] = ppelc[i - 1] + pval[i - 1];
+	// by column. The second array (ppelc) stores for each column the offset of 
+	// the first element in the pelc array that contributes to that column.
+	vector<size_t> ppelc(nc + 1);
+	ppelc[0] = 0;
+	for (int i = 0; i<nc; ++i) ppelc[i + 1] = ppelc[i] + pval[i];
+	if (ppelc[nc] == 0) return;
 
 	// fill the pelc array
+	vector<int> pelc(ppelc[nc]);
+	vector<size_t> pnext(ppelc.begin(), ppelc.end() - 1);
+#pragma omp parallel for
 	for (int i = 0; i<M; ++i)
 	{
-		int* lm = &(LM[i])[0];
-		int N = (int)LM[i].size();
-		for (int j = 0; j<N; ++j)
+		for (int j = pos[i]; j<pos[i + 1]; ++j)
 		{
-			if (lm[j] >= 0) *(ppelc[lm[j]])++ = i;
+			int n = LM[j];
+			if (n >= 0)
+			{
+				size_t k;
+#pragma omp atomic capture
+				k = pnext[n]++;
+				pelc[k] = i;
+			}
 		}
 	}
 
-	// reset pelc pointers
-	ppelc[0] = &pelc[0];
-	for (int i = 1; i<nc; ++i) ppelc[i] = ppelc[i - 1] + pval[i - 1];
-
 	// loop over all columns
-#pragma omp parallel for schedule(dynamic)
-	for (int i = 0; i<nc; ++i)
+#pragma omp parallel
 	{
-		if (pval[i] > 0)
-		{
-			// get the column
-			ColumnProfile& a = m_prof[i];
+		vector<int> rows;
 
-			// loop over all elements in the plec
-			for (int j = 0; j<pval[i]; ++j)
+#pragma omp for schedule(dynamic, 64)
+		for (int i = 0; i<nc; ++i)
+		{
+			if (pval[i] > 0)
 			{
-				int iel = (ppelc[i])[j];
-				int* lm = &(LM[iel])[0];
-				int N = (int)LM[iel].size();
-				for (int k = 0; k<N; ++k)
+				// collect the row indices of all elements that contribute to this column
+				rows.clear();
+				for (size_t j = ppelc[i]; j<ppelc[i + 1]; ++j)
 				{
-					if (lm[k] >= 0)
-					{ 
-						a.insertRow(lm[k]);
+					int iel = pelc[j];
+					for (int k = pos[iel]; k<pos[iel + 1]; ++k)
+					{
+						if (LM[k] >= 0) rows.push_back(LM[k]);
 					}
 				}
+
+				// sort and remove duplicates
+				std::sort(rows.begin(), rows.end());
+				rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+				// add them to the column profile
+				m_prof[i].insertRows(&rows[0], (int)rows.size());
 			}
 		}
 	}
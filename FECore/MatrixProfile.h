@@ -85,6 +85,9 @@ public:
 		// add row index to column profile
 		void insertRow(int row);
 
+		// add a sorted list of unique row indices to column profile
+		void insertRows(const int* rows, int n);
+
 	private:
 		std::vector<RowEntry>	m_data;	// the column profile data
 	};
@@ -111,6 +114,10 @@ public:
 	//! updates the profile for an array of elements
 	void UpdateProfile(std::vector< std::vector<int> >& LM, int N);
 
+	//! updates the profile for a compressed array of elements
+	//! The equation numbers of element i are stored in LM[pos[i]] to LM[pos[i+1]-1].
+	void UpdateProfile(const int* LM, const int* pos, int N);
+
 	//! inserts an entry into the profile (This is an expensive operation!)
 	void Insert(int i, int j);
 
@@ -0,0 +1,135 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#include "stdafx.h"
+#include "ScratchArena.h"
+#include <stdlib.h>
+#include <mutex>
+#include <algorithm>
+
+// min size of a block
+#define SCRATCH_BLOCK_SIZE	(64*1024)
+
+//-----------------------------------------------------------------------------
+// registry of all arenas, needed to collect the statistics
+static std::mutex scratch_mutex;
+static std::vector<ScratchArena*> scratch_arenas;
+
+//-----------------------------------------------------------------------------
+ScratchArena::ScratchArena()
+{
+	m_block = 0;
+	m_offset = 0;
+	m_base = 0;
+	m_nblocks = 0;
+	m_nrequests = 0;
+	m_peak = 0;
+
+	std::lock_guard<std::mutex> lock(scratch_mutex);
+	scratch_arenas.push_back(this);
+}
+
+//-----------------------------------------------------------------------------
+ScratchArena::~ScratchArena()
+{
+	for (Block& b : m_blocks) free(b.data);
+	m_blocks.clear();
+
+	std::lock_guard<std::mutex> lock(scratch_mutex);
+	scratch_arenas.erase(std::remove(scratch_arenas.begin(), scratch_arenas.end(), this), scratch_arenas.end());
+}
+
+//-----------------------------------------------------------------------------
+ScratchArena& ScratchArena::ThreadLocal()
+{
+	static thread_local ScratchArena arena;
+	return arena;
+}
+
+//-----------------------------------------------------------------------------
+// This should only be called outside of parallel regions.
+ScratchArenaStats ScratchArena::GetStats()
+{
+	ScratchArenaStats s;
+	std::lock_guard<std::mutex> lock(scratch_mutex);
+	for (ScratchArena* a : scratch_arenas)
+	{
+		s.narenas++;
+		s.nblocks += a->m_nblocks;
+		s.nrequests += a->m_nrequests;
+		for (Block& b : a->m_blocks) s.bytes += b.size;
+		if (a->m_peak > s.peak) s.peak = a->m_peak;
+	}
+	return s;
+}
+
+//-----------------------------------------------------------------------------
+void* ScratchArena::Allocate(size_t bytes, size_t align)
+{
+	m_nrequests++;
+	if (bytes == 0) bytes = 1;
+
+	// find a block that can hold this allocation
+	while (m_block < m_blocks.size())
+	{
+		Block& b = m_blocks[m_block];
+		size_t offset = (m_offset + align - 1) / align * align;
+		if (offset + bytes <= b.size)
+		{
+			m_offset = offset + bytes;
+			if (m_base + m_offset > m_peak) m_peak = m_base + m_offset;
+			return b.data + offset;
+		}
+
+		// try the next block
+		m_base += b.size;
+		m_block++;
+		m_offset = 0;
+	}
+
+	// we need a new block
+	Block b;
+	b.size = std::max<size_t>(SCRATCH_BLOCK_SIZE, bytes + align);
+	b.data = (char*)malloc(b.size);
+	if (b.data == nullptr) throw std::bad_alloc();
+	m_blocks.push_back(b);
+	m_nblocks++;
+
+	size_t offset = ((size_t)b.data + align - 1) / align * align - (size_t)b.data;
+	m_offset = offset + bytes;
+	if (m_base + m_offset > m_peak) m_peak = m_base + m_offset;
+	return b.data + offset;
+}
+
+//-----------------------------------------------------------------------------
+void ScratchArena::Rewind(const Marker& m)
+{
+	m_block = m.block;
+	m_offset = m.offset;
+	m_base = 0;
+	for (size_t i = 0; i < m_block; ++i) m_base += m_blocks[i].size;
+}
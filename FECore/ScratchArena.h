@@ -0,0 +1,203 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#pragma once
+#include "fecore_api.h"
+#include <stddef.h>
+#include <new>
+#include <vector>
+#include <type_traits>
+
+//-----------------------------------------------------------------------------
+// Statistics of the scratch arenas of all threads.
+struct ScratchArenaStats
+{
+	size_t	narenas = 0;	// nr of arenas (i.e. threads that requested scratch memory)
+	size_t	nblocks = 0;	// nr of heap allocations made by the arenas
+	size_t	nrequests = 0;	// nr of scratch allocations that were served
+	size_t	bytes = 0;		// total size of all arenas
+	size_t	peak = 0;		// max. nr of bytes in use by one arena
+};
+
+//-----------------------------------------------------------------------------
+// A stack allocator for the short-lived temporaries of element and material
+// routines. Each thread owns its own arena (see ThreadLocal), so allocating from
+// it does not require any synchronization. Memory is released in LIFO order by
+// rewinding to a marker, usually through a ScratchScope. The arena keeps its
+// memory blocks when it is rewound, so once it has grown to the working size of
+// a loop, no more heap allocations are made.
+class FECORE_API ScratchArena
+{
+public:
+	struct Marker
+	{
+		size_t	block;
+		size_t	offset;
+	};
+
+public:
+	ScratchArena();
+	~ScratchArena();
+
+	// return the arena of the calling thread
+	static ScratchArena& ThreadLocal();
+
+	// collect the statistics of all arenas
+	static ScratchArenaStats GetStats();
+
+public:
+	// allocate memory. This never returns null.
+	void* Allocate(size_t bytes, size_t align = alignof(double));
+
+	// get the current top of the stack
+	Marker GetMarker() const { return Marker{ m_block, m_offset }; }
+
+	// release all memory that was allocated after the marker was taken
+	void Rewind(const Marker& m);
+
+private:
+	ScratchArena(const ScratchArena&) = delete;
+	void operator = (const ScratchArena&) = delete;
+
+private:
+	struct Block
+	{
+		char*	data;
+		size_t	size;
+	};
+
+	std::vector<Block>	m_blocks;
+	size_t	m_block;		// current block
+	size_t	m_offset;		// offset into current block
+	size_t	m_base;			// size of all blocks before the current one
+
+	size_t	m_nblocks;		// nr of blocks allocated
+	size_t	m_nrequests;	// nr of allocation requests
+	size_t	m_peak;			// max. bytes in use
+};
+
+//-----------------------------------------------------------------------------
+// Releases all scratch memory that was allocated in the current thread during the
+// lifetime of this object.
+class ScratchScope
+{
+public:
+	ScratchScope() : m_arena(ScratchArena::ThreadLocal()), m_marker(m_arena.GetMarker()) {}
+	~ScratchScope() { m_arena.Rewind(m_marker); }
+
+private:
+	ScratchScope(const ScratchScope&) = delete;
+	void operator = (const ScratchScope&) = delete;
+
+private:
+	ScratchArena&			m_arena;
+	ScratchArena::Marker	m_marker;
+};
+
+//-----------------------------------------------------------------------------
+// A fixed-size array allocated from the scratch arena of the calling thread. The
+// memory is owned by the arena and released by the enclosing ScratchScope, so the
+// array must not outlive that scope. Only types that don't need a destructor can
+// be stored.
+template <class T> class ScratchArray
+{
+	static_assert(std::is_trivially_destructible<T>::value, "ScratchArray requires a trivially destructible type");
+
+public:
+	explicit ScratchArray(size_t n) : m_n(n)
+	{
+		m_d = (T*)ScratchArena::ThreadLocal().Allocate(n * sizeof(T), alignof(T));
+		for (size_t i = 0; i < n; ++i) new (m_d + i) T();
+	}
+
+	ScratchArray(size_t n, const T& v) : m_n(n)
+	{
+		m_d = (T*)ScratchArena::ThreadLocal().Allocate(n * sizeof(T), alignof(T));
+		for (size_t i = 0; i < n; ++i) new (m_d + i) T(v);
+	}
+
+	T& operator [] (size_t i) { return m_d[i]; }
+	const T& operator [] (size_t i) const { return m_d[i]; }
+
+	size_t size() const { return m_n; }
+
+	T* data() { return m_d; }
+	const T* data() const { return m_d; }
+
+	T* begin() { return m_d; }
+	T* end() { return m_d + m_n; }
+
+	void assign(const T& v) { for (size_t i = 0; i < m_n; ++i) m_d[i] = v; }
+
+private:
+	ScratchArray(const ScratchArray&) = delete;
+	void operator = (const ScratchArray&) = delete;
+
+private:
+	T*		m_d;
+	size_t	m_n;
+};
+
+//-----------------------------------------------------------------------------
+// A small, row-major matrix allocated from the scratch arena of the calling thread.
+// The same lifetime rules as for ScratchArray apply.
+template <class T> class ScratchMatrix
+{
+	static_assert(std::is_trivially_destructible<T>::value, "ScratchMatrix requires a trivially destructible type");
+
+public:
+	ScratchMatrix(size_t nr, size_t nc) : m_nr(nr), m_nc(nc)
+	{
+		m_d = (T*)ScratchArena::ThreadLocal().Allocate(nr * nc * sizeof(T), alignof(T));
+		for (size_t i = 0; i < nr*nc; ++i) new (m_d + i) T();
+	}
+
+	ScratchMatrix(size_t nr, size_t nc, const T& v) : m_nr(nr), m_nc(nc)
+	{
+		m_d = (T*)ScratchArena::ThreadLocal().Allocate(nr * nc * sizeof(T), alignof(T));
+		for (size_t i = 0; i < nr*nc; ++i) new (m_d + i) T(v);
+	}
+
+	T* operator [] (size_t i) { return m_d + i*m_nc; }
+	const T* operator [] (size_t i) const { return m_d + i*m_nc; }
+
+	T& operator () (size_t i, size_t j) { return m_d[i*m_nc + j]; }
+	const T& operator () (size_t i, size_t j) const { return m_d[i*m_nc + j]; }
+
+	size_t rows() const { return m_nr; }
+	size_t columns() const { return m_nc; }
+
+	void assign(const T& v) { for (size_t i = 0; i < m_nr*m_nc; ++i) m_d[i] = v; }
+
+private:
+	ScratchMatrix(const ScratchMatrix&) = delete;
+	void operator = (const ScratchMatrix&) = delete;
+
+private:
+	T*		m_d;
+	size_t	m_nr, m_nc;
+};
@@ -30,8 +30,9 @@ SOFTWARE.*/
 #include "SkylineSolver.h"
 
 //-----------------------------------------------------------------------------
-void colsol_factor(int N, double* values, int* pointers);
-void colsol_solve(int N, double* values, int* pointers, double* R);
+// These functions are defined in colsol.cpp
+void colsol_factor_mt(int N, double* values, int* pointers);
+void colsol_solve_mt(int N, double* values, int* pointers, double* R);
 
 //-----------------------------------------------------------------------------
 SkylineSolver::SkylineSolver(FEModel* fem) : LinearSolver(fem), m_pA(0)
@@ -55,7 +56,7 @@ bool SkylineSolver::PreProcess()
 //-----------------------------------------------------------------------------
 bool SkylineSolver::Factor()
 {
-	colsol_factor(m_pA->Rows(), m_pA->values(), m_pA->pointers());
+	colsol_factor_mt(m_pA->Rows(), m_pA->values(), m_pA->pointers());
 	return true;
 }
 
@@ -66,7 +67,7 @@ bool SkylineSolver::BackSolve(double* x, double* b)
 	// with the solution
 	int neq = m_pA->Rows();
 	for (int i=0; i<neq; ++i) x[i] = b[i];
-	colsol_solve(m_pA->Rows(), m_pA->values(), m_pA->pointers(), x);
+	colsol_solve_mt(m_pA->Rows(), m_pA->values(), m_pA->pointers(), x);
 
 	return true;
 }
@@ -29,6 +29,7 @@ SOFTWARE.*/
 #include "stdafx.h"
 #include "math.h"
 #include "fecore_api.h"
+#include "sys.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 // LINEAR SOLVER : colsol
@@ -171,6 +172,212 @@ FECORE_API void colsol_solve(int N, double* values, int* pointers, double* R)
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// MULTITHREADED COLSOL
+// These routines compute the same LDLt factorization and back substitution as 
+// colsol_factor and colsol_solve, but distribute the work over multiple threads.
+// The columns are grouped in panels of consecutive columns. Since the columns 
+// of a panel only depend on the columns to their left, the reduction of a panel
+// against all the columns left of the panel can be done for all columns of the
+// panel concurrently. This is where most of the work is done. The remaining
+// reduction inside the panel is done one pivot column at a time, where the 
+// update of the trailing panel columns is again done in parallel. The panels
+// form a chain, so each panel is processed after the previous one is finished.
+//
+// For small matrices, or matrices with a small profile, the overhead of the 
+// threads outweighs the gain and the serial routines are called instead.
+//
+
+// minimum number of equations for using the multithreaded routines
+#define COLSOL_MT_MIN_EQS		2000
+
+// minimum average column height for using the multithreaded routines
+#define COLSOL_MT_MIN_HEIGHT	64
+
+// rows per chunk in the parallel part of the backward substitution
+#define COLSOL_MT_CHUNK			1024
+
+//-----------------------------------------------------------------------------
+// dot product of two contiguous arrays
+static inline double colsol_dot(const double* a, const double* b, int n)
+{
+	double s = 0.0;
+	for (int k = 0; k < n; ++k) s += a[k] * b[k];
+	return s;
+}
+
+//-----------------------------------------------------------------------------
+// See if the multithreaded routines should be used and calculate the panel width.
+// Returns 0 if the serial routines should be used.
+static int colsol_panel_width(int N, int* pointers)
+{
+	int nt = omp_get_max_threads();
+	if ((nt <= 1) || (N < COLSOL_MT_MIN_EQS)) return 0;
+
+	// average column height
+	int h = (pointers[N] - pointers[0]) / N;
+	if (h < COLSOL_MT_MIN_HEIGHT) return 0;
+
+	// The work outside the panels grows with the column height, while the work 
+	// inside the panels grows with the panel width, so we take the panel width as 
+	// a fraction of the column height. But we need enough columns to keep all 
+	// the threads busy.
+	int B = h / 8;
+	if (B < 4 * nt) B = 4 * nt;
+	if (B > 256) B = 256;
+	return B;
+}
+
+//-----------------------------------------------------------------------------
+FECORE_API void colsol_factor_mt(int N, double* values, int* pointers)
+{
+	const int B = colsol_panel_width(N, pointers);
+	if (B == 0) { colsol_factor(N, values, pointers); return; }
+
+	#pragma omp parallel
+	{
+		// repeat over all panels
+		for (int c0 = 1; c0 < N; c0 += B)
+		{
+			const int c1 = (c0 + B < N ? c0 + B : N);
+
+			// reduce the panel columns with all the columns left of the panel
+			#pragma omp for schedule(dynamic, 2)
+			for (int j = c0; j < c1; ++j)
+			{
+				const int mj = j + 1 - pointers[j + 1] + pointers[j];
+				const int pj = pointers[j] + j;
+				for (int i = mj + 1; i < c0; ++i)
+				{
+					const int mi = i + 1 - pointers[i + 1] + pointers[i];
+					const int mm = (mi > mj ? mi : mj);
+					const int pi = pointers[i] + i;
+					values[pj - i] -= colsol_dot(values + pi - i + 1, values + pj - i + 1, i - mm);
+				}
+			}
+
+			// reduce the panel, one pivot column at a time
+			for (int k = c0; k < c1; ++k)
+			{
+				// column k is now fully reduced, so we can calculate l[i][k] and d[k][k]
+				#pragma omp single
+				{
+					const int mk = k + 1 - pointers[k + 1] + pointers[k];
+					const int pk = pointers[k] + k;
+					double& dkk = values[pointers[k]];
+					for (int r = mk; r < k; ++r)
+					{
+						const double grk = values[pk - r];
+						const double lrk = grk / values[pointers[r]];
+						values[pk - r] = lrk;
+						dkk -= grk*lrk;
+					}
+				}
+
+				// update the remaining panel columns
+				#pragma omp for schedule(static)
+				for (int j = k + 1; j < c1; ++j)
+				{
+					const int mj = j + 1 - pointers[j + 1] + pointers[j];
+					if (k > mj)
+					{
+						const int mk = k + 1 - pointers[k + 1] + pointers[k];
+						const int mm = (mk > mj ? mk : mj);
+						const int pk = pointers[k] + k;
+						const int pj = pointers[j] + j;
+						values[pj - k] -= colsol_dot(values + pk - k + 1, values + pj - k + 1, k - mm);
+					}
+				}
+			}
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+FECORE_API void colsol_solve_mt(int N, double* values, int* pointers, double* R)
+{
+	const int B = colsol_panel_width(N, pointers);
+	if (B == 0) { colsol_solve(N, values, pointers, R); return; }
+
+	#pragma omp parallel
+	{
+		// calculate V = L^(-T)*R vector
+		for (int c0 = 1; c0 < N; c0 += B)
+		{
+			const int c1 = (c0 + B < N ? c0 + B : N);
+
+			// contributions of the rows above the panel
+			#pragma omp for schedule(static)
+			for (int i = c0; i < c1; ++i)
+			{
+				const int mi = i + 1 - pointers[i + 1] + pointers[i];
+				if (mi < c0)
+				{
+					const int pi = pointers[i] + i;
+					double s = 0.0;
+					for (int r = mi; r < c0; ++r) s += values[pi - r] * R[r];
+					R[i] -= s;
+				}
+			}
+
+			// contributions of the rows inside the panel
+			#pragma omp single
+			for (int i = c0; i < c1; ++i)
+			{
+				const int mi = i + 1 - pointers[i + 1] + pointers[i];
+				const int pi = pointers[i] + i;
+				for (int r = (mi > c0 ? mi : c0); r < i; ++r) R[i] -= values[pi - r] * R[r];
+			}
+		}
+
+		// calculate Vbar = D^(-1)*V
+		#pragma omp for schedule(static)
+		for (int i = 0; i < N; ++i) R[i] /= values[pointers[i]];
+
+		// calculate the solution
+		const int npanels = (N - 1 + B - 1) / B;
+		for (int n = npanels - 1; n >= 0; --n)
+		{
+			const int c0 = 1 + n*B;
+			const int c1 = (c0 + B < N ? c0 + B : N);
+
+			// back substitution inside the panel
+			#pragma omp single
+			for (int i = c1 - 1; i >= c0; --i)
+			{
+				const int mi = i + 1 - pointers[i + 1] + pointers[i];
+				const int pi = pointers[i] + i;
+				const double ri = R[i];
+				for (int r = (mi > c0 ? mi : c0); r < i; ++r) R[r] -= values[pi - r] * ri;
+			}
+
+			// find the first row above the panel that is affected
+			int rmin = c0;
+			for (int i = c0; i < c1; ++i)
+			{
+				const int mi = i + 1 - pointers[i + 1] + pointers[i];
+				if (mi < rmin) rmin = mi;
+			}
+
+			// update the rows above the panel
+			const int nchunks = (c0 - rmin + COLSOL_MT_CHUNK - 1) / COLSOL_MT_CHUNK;
+			#pragma omp for schedule(dynamic)
+			for (int m = 0; m < nchunks; ++m)
+			{
+				const int r0 = rmin + m*COLSOL_MT_CHUNK;
+				const int r1 = (r0 + COLSOL_MT_CHUNK < c0 ? r0 + COLSOL_MT_CHUNK : c0);
+				for (int i = c0; i < c1; ++i)
+				{
+					const int mi = i + 1 - pointers[i + 1] + pointers[i];
+					const int pi = pointers[i] + i;
+					const double ri = R[i];
+					for (int r = (mi > r0 ? mi : r0); r < r1; ++r) R[r] -= values[pi - r] * ri;
+				}
+			}
+		}
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // This LU solver is grabbed from Numerical Recipes in C.
 // To solve a system of equations first call ludcmp to calculate
@@ -101,6 +101,57 @@ void vsub(vector<double>& a, const vector<double>& l, const vector<double>& r)
 	for (size_t i=0; i<a.size(); ++i) a[i] = l[i] - r[i];
 }
 
+// The rows are processed in blocks, so that the block of x stays in cache while
+// it is multiplied with each of the m vectors.
+#define VM_BLOCK_SIZE	1024
+
+void vmdot(int n, int m, const double* const* V, const double* x, double* h)
+{
+	for (int j = 0; j < m; ++j) h[j] = 0.0;
+	if (m == 0) return;
+
+	int nb = (n + VM_BLOCK_SIZE - 1) / VM_BLOCK_SIZE;
+#pragma omp parallel
+	{
+		vector<double> hl(m, 0.0);
+#pragma omp for schedule(static)
+		for (int b = 0; b < nb; ++b)
+		{
+			int i0 = b*VM_BLOCK_SIZE;
+			int i1 = (i0 + VM_BLOCK_SIZE < n ? i0 + VM_BLOCK_SIZE : n);
+			for (int j = 0; j < m; ++j)
+			{
+				const double* vj = V[j];
+				double s = 0.0;
+				for (int i = i0; i < i1; ++i) s += vj[i] * x[i];
+				hl[j] += s;
+			}
+		}
+
+#pragma omp critical
+		for (int j = 0; j < m; ++j) h[j] += hl[j];
+	}
+}
+
+void vmadds(int n, int m, const double* const* V, const double* h, double* x)
+{
+	if (m == 0) return;
+
+	int nb = (n + VM_BLOCK_SIZE - 1) / VM_BLOCK_SIZE;
+#pragma omp parallel for schedule(static)
+	for (int b = 0; b < nb; ++b)
+	{
+		int i0 = b*VM_BLOCK_SIZE;
+		int i1 = (i0 + VM_BLOCK_SIZE < n ? i0 + VM_BLOCK_SIZE : n);
+		for (int j = 0; j < m; ++j)
+		{
+			const double* vj = V[j];
+			const double hj = h[j];
+			for (int i = i0; i < i1; ++i) x[i] += hj * vj[i];
+		}
+	}
+}
+
 vector<double> operator + (const vector<double>& a, const vector<double>& b)
 {
 	assert(a.size() == b.size());
@@ -71,6 +71,12 @@ void FECORE_API scatter(std::vector<double>& v, FEMesh& mesh, int ndof);
 void FECORE_API scatter3(std::vector<double>& v, FEMesh& mesh, int ndof1, int ndof2, int ndof3);
 void FECORE_API scatter(std::vector<double>& v, FEMesh& mesh, const FEDofList& dofs);
 
+// multiple dot products: h[j] = V[j]*x, j = 0..m-1 (single pass over x)
+void FECORE_API vmdot(int n, int m, const double* const* V, const double* x, double* h);
+
+// multiple scaled additions: x += sum_j h[j]*V[j], j = 0..m-1 (single pass over x)
+void FECORE_API vmadds(int n, int m, const double* const* V, const double* h, double* x);
+
 // calculate l2 norm of vector
 double FECORE_API l2_norm(const std::vector<double>& v);
 double FECORE_API l2_sqrnorm(const std::vector<double>& v);
@@ -0,0 +1,1002 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+
+
+
+#include "stdafx.h"
+#include "AMGPreconditioner.h"
+#include <FECore/CompactSymmMatrix.h>
+#include <FECore/CompactUnSymmMatrix.h>
+#include <FECore/FEModel.h>
+#include <FECore/FEMesh.h>
+#include <FECore/log.h>
+#include <algorithm>
+#include <math.h>
+using namespace std;
+
+BEGIN_FECORE_CLASS(AMGPreconditioner, Preconditioner)
+	ADD_PARAMETER(m_maxLevels , "max_levels");
+	ADD_PARAMETER(m_coarseSize, "coarse_size");
+	ADD_PARAMETER(m_theta     , "strong_threshold");
+	ADD_PARAMETER(m_nsmooth   , "smooth_iters");
+	ADD_PARAMETER(m_omega     , "omega");
+	ADD_PARAMETER(m_useRBM    , "rigid_body_modes");
+	ADD_PARAMETER(m_reuse     , "reuse_setup");
+	ADD_PARAMETER(m_printLevel, "print_level");
+END_FECORE_CLASS();
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Simple zero-based compressed row storage matrix used for the AMG hierarchy.
+struct CSR
+{
+	int	nr = 0, nc = 0;
+	vector<int>		ptr;	// row pointers (size nr + 1)
+	vector<int>		col;	// column indices
+	vector<double>	val;	// values
+
+	size_t nnz() const { return col.size(); }
+
+	// y = A*x
+	void mult(const double* x, double* y) const
+	{
+#pragma omp parallel for schedule(static)
+		for (int i = 0; i < nr; ++i)
+		{
+			double s = 0.0;
+			for (int k = ptr[i]; k < ptr[i + 1]; ++k) s += val[k] * x[col[k]];
+			y[i] = s;
+		}
+	}
+
+	// y += A*x
+	void multadd(const double* x, double* y) const
+	{
+#pragma omp parallel for schedule(static)
+		for (int i = 0; i < nr; ++i)
+		{
+			double s = 0.0;
+			for (int k = ptr[i]; k < ptr[i + 1]; ++k) s += val[k] * x[col[k]];
+			y[i] += s;
+		}
+	}
+
+	// extract the diagonal
+	void diagonal(vector<double>& d) const
+	{
+		d.assign(nr, 0.0);
+#pragma omp parallel for schedule(static)
+		for (int i = 0; i < nr; ++i)
+		{
+			for (int k = ptr[i]; k < ptr[i + 1]; ++k)
+				if (col[k] == i) { d[i] = val[k]; break; }
+		}
+	}
+};
+
+//-----------------------------------------------------------------------------
+// Convert one of the compact matrix formats to a (full) CSR matrix.
+bool ConvertMatrix(CompactMatrix* K, CSR& A)
+{
+	int n = K->Rows();
+	int off = K->Offset();
+	const double* pv = K->Values();
+	const int* pi = K->Indices();
+	const int* pp = K->Pointers();
+	if ((pv == nullptr) || (pi == nullptr) || (pp == nullptr)) return false;
+
+	A.nr = A.nc = n;
+
+	// row-based, unsymmetric storage can be copied directly
+	if (K->isRowBased() && (K->isSymmetric() == false))
+	{
+		A.ptr.resize(n + 1);
+		for (int i = 0; i <= n; ++i) A.ptr[i] = pp[i] - off;
+		size_t nnz = A.ptr[n];
+		A.col.resize(nnz);
+		A.val.resize(nnz);
+#pragma omp parallel for schedule(static)
+		for (int i = 0; i < n; ++i)
+		{
+			for (int k = A.ptr[i]; k < A.ptr[i + 1]; ++k)
+			{
+				A.col[k] = pi[k] - off;
+				A.val[k] = pv[k];
+			}
+		}
+		return true;
+	}
+
+	// Otherwise, we have either half of a symmetric matrix, or a column-based
+	// format, which is transposed here.
+	bool symm = K->isSymmetric();
+	vector<int> cnt(n + 1, 0);
+	for (int j = 0; j < n; ++j)
+	{
+		for (int k = pp[j] - off; k < pp[j + 1] - off; ++k)
+		{
+			int i = pi[k] - off;
+			cnt[i + 1]++;
+			if (symm && (i != j)) cnt[j + 1]++;
+		}
+	}
+	for (int i = 0; i < n; ++i) cnt[i + 1] += cnt[i];
+
+	A.ptr = cnt;
+	A.col.resize(cnt[n]);
+	A.val.resize(cnt[n]);
+	for (int j = 0; j < n; ++j)
+	{
+		for (int k = pp[j] - off; k < pp[j + 1] - off; ++k)
+		{
+			int i = pi[k] - off;
+			int m = cnt[i]++;
+			A.col[m] = j; A.val[m] = pv[k];
+			if (symm && (i != j))
+			{
+				m = cnt[j]++;
+				A.col[m] = i; A.val[m] = pv[k];
+			}
+		}
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// sparse matrix-matrix product C = A*B
+void Multiply(const CSR& A, const CSR& B, CSR& C)
+{
+	C.nr = A.nr;
+	C.nc = B.nc;
+	C.ptr.assign(A.nr + 1, 0);
+
+	// first pass: count the nonzeroes of each row
+#pragma omp parallel
+	{
+		vector<int> mark(B.nc, -1);
+#pragma omp for schedule(dynamic, 256)
+		for (int i = 0; i < A.nr; ++i)
+		{
+			int n = 0;
+			for (int k = A.ptr[i]; k < A.ptr[i + 1]; ++k)
+			{
+				int j = A.col[k];
+				for (int l = B.ptr[j]; l < B.ptr[j + 1]; ++l)
+				{
+					int c = B.col[l];
+					if (mark[c] != i) { mark[c] = i; n++; }
+				}
+			}
+			C.ptr[i + 1] = n;
+		}
+	}
+	for (int i = 0; i < A.nr; ++i) C.ptr[i + 1] += C.ptr[i];
+
+	C.col.resize(C.ptr[A.nr]);
+	C.val.resize(C.ptr[A.nr]);
+
+	// second pass: evaluate the products
+#pragma omp parallel
+	{
+		vector<int> mark(B.nc, -1);
+		vector<int> pos(B.nc, 0);
+#pragma omp for schedule(dynamic, 256)
+		for (int i = 0; i < A.nr; ++i)
+		{
+			int n = C.ptr[i];
+			for (int k = A.ptr[i]; k < A.ptr[i + 1]; ++k)
+			{
+				int j = A.col[k];
+				double a = A.val[k];
+				for (int l = B.ptr[j]; l < B.ptr[j + 1]; ++l)
+				{
+					int c = B.col[l];
+					if (mark[c] != i)
+					{
+						mark[c] = i;
+						pos[c] = n;
+						C.col[n] = c;
+						C.val[n] = a * B.val[l];
+						n++;
+					}
+					else C.val[pos[c]] += a * B.val[l];
+				}
+			}
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// T = A^T
+void Transpose(const CSR& A, CSR& T)
+{
+	T.nr = A.nc;
+	T.nc = A.nr;
+	T.ptr.assign(A.nc + 1, 0);
+	for (size_t k = 0; k < A.nnz(); ++k) T.ptr[A.col[k] + 1]++;
+	for (int i = 0; i < A.nc; ++i) T.ptr[i + 1] += T.ptr[i];
+
+	T.col.resize(A.nnz());
+	T.val.resize(A.nnz());
+	vector<int> pos(T.ptr.begin(), T.ptr.end() - 1);
+	for (int i = 0; i < A.nr; ++i)
+	{
+		for (int k = A.ptr[i]; k < A.ptr[i + 1]; ++k)
+		{
+			int m = pos[A.col[k]]++;
+			T.col[m] = i;
+			T.val[m] = A.val[k];
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Dense LU factorization with partial pivoting, used for the coarsest level.
+class DenseLU
+{
+public:
+	bool Factor(const CSR& A)
+	{
+		m_n = A.nr;
+		int n = m_n;
+		m_a.assign((size_t)n*n, 0.0);
+		m_piv.resize(n);
+		for (int i = 0; i < n; ++i)
+			for (int k = A.ptr[i]; k < A.ptr[i + 1]; ++k) m_a[(size_t)i*n + A.col[k]] += A.val[k];
+
+		// tolerance for (near) singular pivots
+		double amax = 0.0;
+		for (size_t i = 0; i < m_a.size(); ++i) amax = max(amax, fabs(m_a[i]));
+		if (amax == 0.0) amax = 1.0;
+		double eps = 1e-14*amax;
+
+		for (int k = 0; k < n; ++k)
+		{
+			// find pivot
+			int p = k;
+			double pmax = fabs(m_a[(size_t)k*n + k]);
+			for (int i = k + 1; i < n; ++i)
+			{
+				double v = fabs(m_a[(size_t)i*n + k]);
+				if (v > pmax) { pmax = v; p = i; }
+			}
+			m_piv[k] = p;
+			if (p != k)
+			{
+				for (int j = 0; j < n; ++j) swap(m_a[(size_t)k*n + j], m_a[(size_t)p*n + j]);
+			}
+
+			// regularize singular pivots (e.g. from unconstrained modes)
+			double& akk = m_a[(size_t)k*n + k];
+			if (fabs(akk) < eps) akk = (akk < 0 ? -eps : eps);
+
+			// eliminate
+#pragma omp parallel for schedule(static)
+			for (int i = k + 1; i < n; ++i)
+			{
+				double* ai = &m_a[(size_t)i*n];
+				const double* ak = &m_a[(size_t)k*n];
+				double f = ai[k] / ak[k];
+				ai[k] = f;
+				if (f != 0.0)
+				{
+					for (int j = k + 1; j < n; ++j) ai[j] -= f * ak[j];
+				}
+			}
+		}
+		return true;
+	}
+
+	void Solve(double* x) const
+	{
+		int n = m_n;
+		for (int k = 0; k < n; ++k) if (m_piv[k] != k) swap(x[k], x[m_piv[k]]);
+		for (int i = 0; i < n; ++i)
+		{
+			const double* ai = &m_a[(size_t)i*n];
+			double s = x[i];
+			for (int j = 0; j < i; ++j) s -= ai[j] * x[j];
+			x[i] = s;
+		}
+		for (int i = n - 1; i >= 0; --i)
+		{
+			const double* ai = &m_a[(size_t)i*n];
+			double s = x[i];
+			for (int j = i + 1; j < n; ++j) s -= ai[j] * x[j];
+			x[i] = s / ai[i];
+		}
+	}
+
+	int Size() const { return m_n; }
+
+private:
+	int				m_n = 0;
+	vector<double>	m_a;
+	vector<int>		m_piv;
+};
+
+//-----------------------------------------------------------------------------
+// One level of the multigrid hierarchy
+struct AMGLevel
+{
+	CSR		A;		// level operator
+	CSR		Pt;		// tentative prolongator
+	CSR		P;		// smoothed prolongator
+	CSR		R;		// restriction operator (= P^T)
+
+	vector<int>		blk;	// block index for each equation
+	int				nblk = 0;	// number of blocks
+	vector<double>	B;		// near null space (row-major, nb columns)
+	int				nb = 0;	// number of null space vectors
+
+	vector<double>	dinv;	// inverse diagonal scaled with smoother weight
+	double			rho = 1.0;	// spectral radius estimate of D^-1*A
+
+	vector<double>	x, b, r;	// work vectors for the V-cycle
+};
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+class AMGPreconditioner::Implementation
+{
+public:
+	vector<AMGLevel>	levels;
+	DenseLU				coarse;
+	bool				useDense = false;
+
+	AMGPreconditioner*	pc;
+
+public:
+	Implementation(AMGPreconditioner* p) : pc(p) {}
+
+	void BuildNullSpace(FEModel* fem, AMGLevel& L);
+	int Aggregate(AMGLevel& L, vector<int>& agg);
+	void TentativeProlongator(AMGLevel& L, const vector<int>& agg, int nagg, AMGLevel& C);
+	void EstimateSpectralRadius(AMGLevel& L);
+	void BuildGalerkin(AMGLevel& L, AMGLevel& C);
+	void SetupSmoother(AMGLevel& L);
+	void Jacobi(AMGLevel& L, bool zeroGuess);
+	void VCycle(int l);
+};
+
+//-----------------------------------------------------------------------------
+// Build the block structure and near null space for the finest level. If a 
+// model is available each node defines a block, and the null space consists of
+// the rigid body modes of the displacement degrees of freedom and a constant mode
+// for every other nodal degree of freedom. Otherwise, each equation is a block and
+// the constant vector is used.
+void AMGPreconditioner::Implementation::BuildNullSpace(FEModel* fem, AMGLevel& L)
+{
+	int neq = L.A.nr;
+	L.blk.assign(neq, -1);
+	L.nblk = 0;
+	L.nb = 0;
+	L.B.clear();
+
+	if (fem && pc->m_useRBM)
+	{
+		FEMesh& mesh = fem->GetMesh();
+		int dofX = fem->GetDOFIndex("x");
+		int dofY = fem->GetDOFIndex("y");
+		int dofZ = fem->GetDOFIndex("z");
+
+		// figure out which degrees of freedom are active
+		int maxdofs = 0;
+		for (int i = 0; i < mesh.Nodes(); ++i) maxdofs = max(maxdofs, mesh.Node(i).dofs());
+		vector<int> dofCol(maxdofs, -1);
+		bool hasDisp = false;
+		vec3d c(0, 0, 0); int nc = 0;
+		for (int i = 0; i < mesh.Nodes(); ++i)
+		{
+			FENode& node = mesh.Node(i);
+			bool active = false;
+			for (int j = 0; j < node.dofs(); ++j)
+			{
+				int id = node.m_ID[j];
+				if ((id >= 0) && (id < neq))
+				{
+					active = true;
+					if ((j == dofX) || (j == dofY) || (j == dofZ)) hasDisp = true;
+					else dofCol[j] = 0;
+				}
+			}
+			if (active) { c += node.m_rt; nc++; }
+		}
+		if (nc > 0) c /= (double)nc;
+
+		int nb = (hasDisp ? 6 : 0);
+		for (int j = 0; j < maxdofs; ++j) if (dofCol[j] == 0) dofCol[j] = nb++;
+
+		if (nb > 0)
+		{
+			L.nb = nb;
+			L.B.assign((size_t)neq*nb, 0.0);
+			for (int i = 0; i < mesh.Nodes(); ++i)
+			{
+				FENode& node = mesh.Node(i);
+				vec3d r = node.m_rt - c;
+				int nblk = -1;
+				for (int j = 0; j < node.dofs(); ++j)
+				{
+					int id = node.m_ID[j];
+					if ((id < 0) || (id >= neq) || (L.blk[id] != -1)) continue;
+
+					if (nblk == -1) nblk = L.nblk++;
+					L.blk[id] = nblk;
+
+					double* b = &L.B[(size_t)id*nb];
+					if (j == dofX) { b[0] = 1.0; b[4] = r.z; b[5] = -r.y; }
+					else if (j == dofY) { b[1] = 1.0; b[3] = -r.z; b[5] = r.x; }
+					else if (j == dofZ) { b[2] = 1.0; b[3] = r.y; b[4] = -r.x; }
+					else b[dofCol[j]] = 1.0;
+				}
+			}
+
+			// equations that are not associated with a node get their own block
+			for (int i = 0; i < neq; ++i) if (L.blk[i] == -1) L.blk[i] = L.nblk++;
+			return;
+		}
+	}
+
+	// scalar problem
+	L.nb = 1;
+	L.B.assign(neq, 1.0);
+	L.nblk = neq;
+	for (int i = 0; i < neq; ++i) L.blk[i] = i;
+}
+
+//-----------------------------------------------------------------------------
+// Build the aggregates of the blocks of this level, using a greedy algorithm
+// on the graph of strong connections. Returns the number of aggregates.
+int AMGPreconditioner::Implementation::Aggregate(AMGLevel& L, vector<int>& agg)
+{
+	const CSR& A = L.A;
+	int nblk = L.nblk;
+	double theta = pc->m_theta;
+
+	vector<double> d;
+	A.diagonal(d);
+	for (int i = 0; i < A.nr; ++i) d[i] = fabs(d[i]);
+
+	// the dofs of each block
+	vector<int> bptr(nblk + 1, 0), bdof(A.nr);
+	for (int i = 0; i < A.nr; ++i) bptr[L.blk[i] + 1]++;
+	for (int i = 0; i < nblk; ++i) bptr[i + 1] += bptr[i];
+	{
+		vector<int> pos(bptr.begin(), bptr.end() - 1);
+		for (int i = 0; i < A.nr; ++i) bdof[pos[L.blk[i]]++] = i;
+	}
+
+	// build the strength graph between blocks
+	vector< vector<int> > S(nblk);
+#pragma omp parallel
+	{
+		vector<int> mark(nblk, -1);
+#pragma omp for schedule(dynamic, 256)
+		for (int I = 0; I < nblk; ++I)
+		{
+			for (int m = bptr[I]; m < bptr[I + 1]; ++m)
+			{
+				int i = bdof[m];
+				for (int k = A.ptr[i]; k < A.ptr[i + 1]; ++k)
+				{
+					int j = A.col[k];
+					int J = L.blk[j];
+					if ((J == I) || (mark[J] == I)) continue;
+					double dij = d[i] * d[j];
+					if ((A.val[k] != 0.0) && (fabs(A.val[k]) >= theta*sqrt(dij)))
+					{
+						mark[J] = I;
+						S[I].push_back(J);
+					}
+				}
+			}
+		}
+	}
+
+	agg.assign(nblk, -1);
+	int nagg = 0;
+
+	// phase 1: form aggregates from blocks whose neighbors are all unaggregated
+	for (int I = 0; I < nblk; ++I)
+	{
+		if ((agg[I] != -1) || S[I].empty()) continue;
+		bool free = true;
+		for (int J : S[I]) if (agg[J] != -1) { free = false; break; }
+		if (free)
+		{
+			agg[I] = nagg;
+			for (int J : S[I]) agg[J] = nagg;
+			nagg++;
+		}
+	}
+
+	// phase 2: add remaining blocks to a neighboring aggregate
+	vector<int> agg1(agg);
+	for (int I = 0; I < nblk; ++I)
+	{
+		if (agg[I] != -1) continue;
+		for (int J : S[I]) if (agg1[J] != -1) { agg[I] = agg1[J]; break; }
+	}
+
+	// phase 3: whatever is left forms new aggregates
+	for (int I = 0; I < nblk; ++I)
+	{
+		if (agg[I] != -1) continue;
+		agg[I] = nagg;
+		for (int J : S[I]) if (agg[J] == -1) agg[J] = nagg;
+		nagg++;
+	}
+
+	return nagg;
+}
+
+//-----------------------------------------------------------------------------
+// Build the tentative prolongator from the aggregates by a local QR factorization
+// of the near null space. This also sets up the null space and blocks of the next level. 
+void AMGPreconditioner::Implementation::TentativeProlongator(AMGLevel& L, const vector<int>& agg, int nagg, AMGLevel& C)
+{
+	int n = L.A.nr;
+	int nb = L.nb;
+
+	// collect the dofs of each aggregate
+	vector<int> aptr(nagg + 1, 0), adof(n), loc(n);
+	for (int i = 0; i < n; ++i) aptr[agg[L.blk[i]] + 1]++;
+	for (int a = 0; a < nagg; ++a) aptr[a + 1] += aptr[a];
+	{
+		vector<int> pos(aptr.begin(), aptr.end() - 1);
+		for (int i = 0; i < n; ++i)
+		{
+			int a = agg[L.blk[i]];
+			loc[i] = pos[a] - aptr[a];
+			adof[pos[a]++] = i;
+		}
+	}
+
+	// QR factorization of the null space of each aggregate (modified Gram-Schmidt)
+	// Q is stored in place, R in a nb x nb array for each aggregate.
+	vector<double> Q(L.B);
+	vector<double> R((size_t)nagg*nb*nb, 0.0);
+	vector<int> rank(nagg, 0);
+	vector<int> qcol((size_t)nagg*nb, -1);	// column of Q for each retained vector
+#pragma omp parallel for schedule(dynamic, 64)
+	for (int a = 0; a < nagg; ++a)
+	{
+		int m0 = aptr[a], m1 = aptr[a + 1];
+		double* Ra = &R[(size_t)a*nb*nb];
+		int* qa = &qcol[(size_t)a*nb];
+		int r = 0;
+		for (int c = 0; c < nb; ++c)
+		{
+			double nrm0 = 0.0;
+			for (int m = m0; m < m1; ++m) { double v = Q[(size_t)adof[m] * nb + c]; nrm0 += v*v; }
+			if (nrm0 == 0.0) continue;
+
+			// orthogonalize against previous vectors
+			for (int q = 0; q < r; ++q)
+			{
+				int cq = qa[q];
+				double s = 0.0;
+				for (int m = m0; m < m1; ++m) { const double* Qi = &Q[(size_t)adof[m] * nb]; s += Qi[cq] * Qi[c]; }
+				for (int m = m0; m < m1; ++m) { double* Qi = &Q[(size_t)adof[m] * nb]; Qi[c] -= s*Qi[cq]; }
+				Ra[q*nb + c] = s;
+			}
+
+			double nrm = 0.0;
+			for (int m = m0; m < m1; ++m) { double v = Q[(size_t)adof[m] * nb + c]; nrm += v*v; }
+			if (nrm > 1e-20*nrm0)
+			{
+				nrm = sqrt(nrm);
+				for (int m = m0; m < m1; ++m) Q[(size_t)adof[m] * nb + c] /= nrm;
+				Ra[r*nb + c] = nrm;
+				qa[r++] = c;
+			}
+		}
+		rank[a] = r;
+	}
+
+	// coarse equation offsets
+	vector<int> off(nagg + 1, 0);
+	for (int a = 0; a < nagg; ++a) off[a + 1] = off[a] + rank[a];
+	int nc = off[nagg];
+
+	// build the tentative prolongator
+	CSR& P = L.Pt;
+	P.nr = n;
+	P.nc = nc;
+	P.ptr.assign(n + 1, 0);
+	for (int i = 0; i < n; ++i) P.ptr[i + 1] = P.ptr[i] + rank[agg[L.blk[i]]];
+	P.col.resize(P.ptr[n]);
+	P.val.resize(P.ptr[n]);
+#pragma omp parallel for schedule(static)
+	for (int i = 0; i < n; ++i)
+	{
+		int a = agg[L.blk[i]];
+		const int* qa = &qcol[(size_t)a*nb];
+		int k = P.ptr[i];
+		for (int q = 0; q < rank[a]; ++q, ++k)
+		{
+			P.col[k] = off[a] + q;
+			P.val[k] = Q[(size_t)i*nb + qa[q]];
+		}
+	}
+
+	// setup the next level's null space and blocks
+	C.nb = nb;
+	C.B.assign((size_t)nc*nb, 0.0);
+	C.blk.resize(nc);
+	C.nblk = 0;
+	for (int a = 0; a < nagg; ++a)
+	{
+		if (rank[a] == 0) continue;
+		const double* Ra = &R[(size_t)a*nb*nb];
+		for (int q = 0; q < rank[a]; ++q)
+		{
+			int i = off[a] + q;
+			C.blk[i] = C.nblk;
+			for (int c = 0; c < nb; ++c) C.B[(size_t)i*nb + c] = Ra[q*nb + c];
+		}
+		C.nblk++;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// estimate the spectral radius of D^-1*A with a few power iterations
+void AMGPreconditioner::Implementation::EstimateSpectralRadius(AMGLevel& L)
+{
+	const CSR& A = L.A;
+	int n = A.nr;
+	vector<double> d;
+	A.diagonal(d);
+	for (int i = 0; i < n; ++i) d[i] = (d[i] != 0.0 ? 1.0 / d[i] : 0.0);
+
+	vector<double> x(n), y(n);
+	for (int i = 0; i < n; ++i) x[i] = 1.0 + 0.1*(i % 7);
+
+	double rho = 1.0;
+	for (int k = 0; k < 15; ++k)
+	{
+		double nx = 0.0;
+#pragma omp parallel for reduction(+:nx)
+		for (int i = 0; i < n; ++i) nx += x[i] * x[i];
+		nx = sqrt(nx);
+		if (nx == 0.0) break;
+
+		A.mult(&x[0], &y[0]);
+
+		double ny = 0.0;
+#pragma omp parallel for reduction(+:ny)
+		for (int i = 0; i < n; ++i) { y[i] *= d[i]; ny += y[i] * y[i]; }
+		ny = sqrt(ny);
+
+		rho = ny / nx;
+		if (ny == 0.0) break;
+		for (int i = 0; i < n; ++i) x[i] = y[i] / ny;
+	}
+	L.rho = (rho > 0.0 ? rho : 1.0);
+}
+
+//-----------------------------------------------------------------------------
+// Smooth the tentative prolongator, P = (I - w*D^-1*A)*Pt, and calculate the
+// coarse level operator, Ac = P^T*A*P.
+void AMGPreconditioner::Implementation::BuildGalerkin(AMGLevel& L, AMGLevel& C)
+{
+	EstimateSpectralRadius(L);
+
+	vector<double> d;
+	L.A.diagonal(d);
+	double w = pc->m_omega / L.rho;
+
+	// AP = A*Pt
+	CSR AP;
+	Multiply(L.A, L.Pt, AP);
+
+	// P = Pt - w*D^-1*A*Pt
+	CSR& P = L.P;
+	P.nr = L.Pt.nr;
+	P.nc = L.Pt.nc;
+	P.ptr.assign(P.nr + 1, 0);
+#pragma omp parallel
+	{
+		vector<int> mark(P.nc, -1);
+#pragma omp for schedule(static)
+		for (int i = 0; i < P.nr; ++i)
+		{
+			int n = 0;
+			for (int k = AP.ptr[i]; k < AP.ptr[i + 1]; ++k) { mark[AP.col[k]] = i; n++; }
+			for (int k = L.Pt.ptr[i]; k < L.Pt.ptr[i + 1]; ++k) if (mark[L.Pt.col[k]] != i) n++;
+			P.ptr[i + 1] = n;
+		}
+	}
+	for (int i = 0; i < P.nr; ++i) P.ptr[i + 1] += P.ptr[i];
+	P.col.resize(P.ptr[P.nr]);
+	P.val.resize(P.ptr[P.nr]);
+#pragma omp parallel
+	{
+		vector<int> pos(P.nc, -1);
+#pragma omp for schedule(static)
+		for (int i = 0; i < P.nr; ++i)
+		{
+			double s = (d[i] != 0.0 ? w / d[i] : 0.0);
+			int n = P.ptr[i];
+			for (int k = AP.ptr[i]; k < AP.ptr[i + 1]; ++k)
+			{
+				P.col[n] = AP.col[k];
+				P.val[n] = -s*AP.val[k];
+				pos[AP.col[k]] = n++;
+			}
+			for (int k = L.Pt.ptr[i]; k < L.Pt.ptr[i + 1]; ++k)
+			{
+				int c = L.Pt.col[k];
+				int m = pos[c];
+				if ((m >= P.ptr[i]) && (m < n) && (P.col[m] == c)) P.val[m] += L.Pt.val[k];
+				else
+				{
+					P.col[n] = c;
+					P.val[n] = L.Pt.val[k];
+					n++;
+				}
+			}
+		}
+	}
+
+	// R = P^T
+	Transpose(P, L.R);
+
+	// Ac = R*A*P
+	Multiply(L.A, P, AP);
+	Multiply(L.R, AP, C.A);
+}
+
+//-----------------------------------------------------------------------------
+void AMGPreconditioner::Implementation::SetupSmoother(AMGLevel& L)
+{
+	int n = L.A.nr;
+	L.A.diagonal(L.dinv);
+	double w = pc->m_omega / L.rho;
+	for (int i = 0; i < n; ++i) L.dinv[i] = (L.dinv[i] != 0.0 ? w / L.dinv[i] : 0.0);
+	L.x.assign(n, 0.0);
+	L.b.assign(n, 0.0);
+	L.r.assign(n, 0.0);
+}
+
+//-----------------------------------------------------------------------------
+// one sweep of damped Jacobi
+void AMGPreconditioner::Implementation::Jacobi(AMGLevel& L, bool zeroGuess)
+{
+	int n = L.A.nr;
+	if (zeroGuess)
+	{
+#pragma omp parallel for schedule(static)
+		for (int i = 0; i < n; ++i) L.x[i] = L.dinv[i] * L.b[i];
+	}
+	else
+	{
+		L.A.mult(&L.x[0], &L.r[0]);
+#pragma omp parallel for schedule(static)
+		for (int i = 0; i < n; ++i) L.x[i] += L.dinv[i] * (L.b[i] - L.r[i]);
+	}
+}
+
+//-----------------------------------------------------------------------------
+void AMGPreconditioner::Implementation::VCycle(int l)
+{
+	AMGLevel& L = levels[l];
+	int n = L.A.nr;
+	if (n == 0) return;
+
+	// coarsest level
+	if (l == (int)levels.size() - 1)
+	{
+		if (useDense)
+		{
+			L.x = L.b;
+			coarse.Solve(&L.x[0]);
+		}
+		else
+		{
+			Jacobi(L, true);
+			for (int i = 1; i < 2 * pc->m_nsmooth; ++i) Jacobi(L, false);
+		}
+		return;
+	}
+
+	// pre-smoothing
+	Jacobi(L, true);
+	for (int i = 1; i < pc->m_nsmooth; ++i) Jacobi(L, false);
+
+	// restrict the residual
+	L.A.mult(&L.x[0], &L.r[0]);
+#pragma omp parallel for schedule(static)
+	for (int i = 0; i < n; ++i) L.r[i] = L.b[i] - L.r[i];
+
+	AMGLevel& C = levels[l + 1];
+	L.R.mult(&L.r[0], &C.b[0]);
+
+	// coarse grid correction
+	VCycle(l + 1);
+	L.P.multadd(&C.x[0], &L.x[0]);
+
+	// post-smoothing
+	for (int i = 0; i < pc->m_nsmooth; ++i) Jacobi(L, false);
+}
+
+//=============================================================================
+AMGPreconditioner::AMGPreconditioner(FEModel* fem) : Preconditioner(fem)
+{
+	m_maxLevels = 10;
+	m_coarseSize = 500;
+	m_theta = 0.08;
+	m_nsmooth = 1;
+	m_omega = 4.0 / 3.0;
+	m_useRBM = true;
+	m_reuse = true;
+	m_printLevel = 0;
+
+	m_K = nullptr;
+	m_imp = new Implementation(this);
+}
+
+//-----------------------------------------------------------------------------
+AMGPreconditioner::~AMGPreconditioner()
+{
+	delete m_imp;
+}
+
+//-----------------------------------------------------------------------------
+SparseMatrix* AMGPreconditioner::CreateSparseMatrix(Matrix_Type ntype)
+{
+	if (ntype == REAL_SYMMETRIC) m_K = new CompactSymmMatrix(1);
+	else m_K = new CRSSparseMatrix(1);
+	return m_K;
+}
+
+//-----------------------------------------------------------------------------
+bool AMGPreconditioner::Factor()
+{
+	SparseMatrix* A = GetSparseMatrix();
+	if (A == nullptr) A = m_K;
+	CompactMatrix* K = dynamic_cast<CompactMatrix*>(A);
+	if (K == nullptr)
+	{
+		feLogError("The AMG preconditioner requires a compact matrix format.");
+		return false;
+	}
+
+	CSR A0;
+	if (ConvertMatrix(K, A0) == false) return false;
+
+	vector<AMGLevel>& levels = m_imp->levels;
+
+	// see if we can reuse the aggregation of the previous setup
+	bool reuse = false;
+	if (m_reuse && (levels.empty() == false))
+	{
+		CSR& Ap = levels[0].A;
+		reuse = ((Ap.nr == A0.nr) && (Ap.ptr == A0.ptr) && (Ap.col == A0.col));
+	}
+
+	if (reuse)
+	{
+		// only the values changed, so we just recalculate the operators
+		levels[0].A.val.swap(A0.val);
+		for (size_t l = 0; l + 1 < levels.size(); ++l)
+		{
+			m_imp->BuildGalerkin(levels[l], levels[l + 1]);
+		}
+	}
+	else
+	{
+		levels.clear();
+		levels.push_back(AMGLevel());
+		levels[0].A.nr = levels[0].A.nc = A0.nr;
+		levels[0].A.ptr.swap(A0.ptr);
+		levels[0].A.col.swap(A0.col);
+		levels[0].A.val.swap(A0.val);
+		m_imp->BuildNullSpace(GetFEModel(), levels[0]);
+
+		int maxLevels = (m_maxLevels > 1 ? m_maxLevels : 1);
+		while ((int)levels.size() < maxLevels)
+		{
+			AMGLevel& L = levels.back();
+			int n = L.A.nr;
+			if (n <= m_coarseSize) break;
+
+			vector<int> agg;
+			int nagg = m_imp->Aggregate(L, agg);
+
+			AMGLevel C;
+			m_imp->TentativeProlongator(L, agg, nagg, C);
+
+			// stop if the coarsening stagnates
+			int nc = L.Pt.nc;
+			if ((nc == 0) || (nc >= n)) { L.Pt = CSR(); break; }
+
+			levels.push_back(C);
+			m_imp->BuildGalerkin(levels[levels.size() - 2], levels.back());
+		}
+	}
+
+	// setup smoothers
+	int nlevels = (int)levels.size();
+	for (int l = 0; l < nlevels - 1; ++l) m_imp->SetupSmoother(levels[l]);
+
+	// setup coarse level solver
+	AMGLevel& Lc = levels.back();
+	m_imp->useDense = (Lc.A.nr <= 2 * m_coarseSize);
+	if (m_imp->useDense)
+	{
+		Lc.x.assign(Lc.A.nr, 0.0);
+		Lc.b.assign(Lc.A.nr, 0.0);
+		Lc.r.assign(Lc.A.nr, 0.0);
+		if (Lc.A.nr > 0) m_imp->coarse.Factor(Lc.A);
+	}
+	else
+	{
+		m_imp->EstimateSpectralRadius(Lc);
+		m_imp->SetupSmoother(Lc);
+	}
+
+	if (m_printLevel > 0)
+	{
+		double nnz0 = (double)levels[0].A.nnz(), nnz = 0.0;
+		feLog("AMG hierarchy (%s):\n", (reuse ? "reused" : "new"));
+		for (int l = 0; l < nlevels; ++l)
+		{
+			feLog("\tlevel %d: rows = %d, nonzeroes = %d\n", l, levels[l].A.nr, (int)levels[l].A.nnz());
+			nnz += (double)levels[l].A.nnz();
+		}
+		feLog("\toperator complexity: %lg\n", (nnz0 > 0 ? nnz / nnz0 : 0.0));
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+bool AMGPreconditioner::BackSolve(double* x, double* y)
+{
+	vector<AMGLevel>& levels = m_imp->levels;
+	if (levels.empty()) return false;
+
+	AMGLevel& L0 = levels[0];
+	int n = L0.A.nr;
+	for (int i = 0; i < n; ++i) L0.b[i] = y[i];
+	m_imp->VCycle(0);
+	for (int i = 0; i < n; ++i) x[i] = L0.x[i];
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+void AMGPreconditioner::Destroy()
+{
+	m_imp->levels.clear();
+}
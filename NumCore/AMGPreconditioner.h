@@ -0,0 +1,75 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+
+
+
+#pragma once
+#include <FECore/Preconditioner.h>
+
+//-----------------------------------------------------------------------------
+// Smoothed aggregation algebraic multigrid (AMG) preconditioner.
+// The near null space is built from the rigid body modes of the mesh nodes
+// (and a constant mode for each additional nodal degree of freedom), which makes
+// this preconditioner well suited for (3D) elasticity problems. 
+// The preconditioner applies a single V-cycle with damped Jacobi smoothing.
+class AMGPreconditioner : public Preconditioner
+{
+	class Implementation;
+
+public:
+	AMGPreconditioner(FEModel* fem);
+	~AMGPreconditioner();
+
+	// create the sparse matrix
+	SparseMatrix* CreateSparseMatrix(Matrix_Type ntype) override;
+
+	// set up the multigrid hierarchy
+	bool Factor() override;
+
+	// apply to vector P x = y
+	bool BackSolve(double* x, double* y) override;
+
+	// clean up
+	void Destroy() override;
+
+public:
+	int		m_maxLevels;	// max number of levels
+	int		m_coarseSize;	// max size of coarsest level
+	double	m_theta;		// strength of connection threshold
+	int		m_nsmooth;		// number of pre- and post-smoothing sweeps
+	double	m_omega;		// prolongator smoothing weight (divided by the spectral radius estimate)
+	bool	m_useRBM;		// use rigid body modes as near null space
+	bool	m_reuse;		// reuse aggregation if the matrix structure did not change
+	int		m_printLevel;	// output level
+
+private:
+	SparseMatrix*	m_K;
+	Implementation*	m_imp;
+
+	DECLARE_FECORE_CLASS();
+};
@@ -32,6 +32,8 @@ SOFTWARE.*/
 #include <FECore/CompactUnSymmMatrix.h>
 #include <FECore/log.h>
 #include "MatrixTools.h"
+#include "VectorKernels.h"
+#include <math.h>
 
 //-----------------------------------------------------------------------------
 // We must undef PARDISO since it is defined as a function in mkl_solver.h
@@ -52,6 +54,7 @@ BEGIN_FECORE_CLASS(FGMRESSolver, IterativeLinearSolver)
 	ADD_PARAMETER(m_reltol        , "tol");
 	ADD_PARAMETER(m_abstol        , "abs_tol");
 	ADD_PARAMETER(m_maxIterFail   , "fail_max_iters");
+	ADD_PARAMETER(m_orthog        , "orthogonalization")->setEnums("MGS\0CGS\0CGS2\0");
 
 	ADD_PROPERTY(m_P, "pc_left")->SetFlags(FEProperty::Optional);
 	ADD_PROPERTY(m_R, "pc_right")->SetFlags(FEProperty::Optional);
@@ -70,6 +73,7 @@ FGMRESSolver::FGMRESSolver(FEModel* fem) : IterativeLinearSolver(fem), m_pA(0)
 	m_print_cn = false;
 
 	m_do_jacobi = false;
+	m_orthog = 2;
 
 	m_P = 0;	// we don't use a preconditioner for this solver
 	m_R = 0;	// no right preconditioner
@@ -187,10 +191,16 @@ void FGMRESSolver::DoJacobiPreconditioning(bool b)
 	m_do_jacobi = b;
 }
 
+//-----------------------------------------------------------------------------
+// set the orthogonalization method
+void FGMRESSolver::SetOrthogonalization(int n)
+{
+	m_orthog = n;
+}
+
 //-----------------------------------------------------------------------------
 SparseMatrix* FGMRESSolver::CreateSparseMatrix(Matrix_Type ntype)
 {
-#ifdef MKL_ISS
 	// Cleanup if necessary
 	if (m_pA) delete m_pA; 
 	m_pA = nullptr;
@@ -224,9 +234,6 @@ SparseMatrix* FGMRESSolver::CreateSparseMatrix(Matrix_Type ntype)
 
 	// return the matrix (Can be null if matrix format not supported!)
 	return m_pA;
-#else
-	return 0;
-#endif
 }
 
 //-----------------------------------------------------------------------------
@@ -265,7 +272,22 @@ bool FGMRESSolver::PreProcess()
 
 	return true; 
 #else
-	return false;
+	// number of equations
+	int N = m_pA->Rows();
+
+	int M = (N < 150 ? N : 150);
+	if (m_nrestart > 0) M = m_nrestart;
+	else if (m_maxiter > 0) M = m_maxiter;
+	if (M > N) M = N;
+
+	// allocate storage for the Krylov vectors (V) and preconditioned vectors (Z)
+	m_tmp.resize((size_t)N*(2 * M + 1));
+
+	m_Rv.resize(N);
+
+	m_W.resize(N, 1.0);
+
+	return true;
 #endif
 }
 
@@ -443,10 +465,203 @@ bool FGMRESSolver::BackSolve(double* x, double* b)
 	return bconverged;
 
 #else
-	return false;
+	// make sure we have a matrix
+	if (m_pA == 0) return false;
+
+	return SolveFGMRES(x, b);
 #endif // MKL_ISS
 }
 
+//-----------------------------------------------------------------------------
+// Native implementation of the flexible, restarted GMRES(m) method. The left
+// preconditioner is applied as a (flexible) right preconditioner, as in the 
+// MKL implementation, and the right preconditioner is applied to the matrix.
+bool FGMRESSolver::SolveFGMRES(double* x, const double* b)
+{
+	int N = m_pA->Rows();
+	if (N == 0) return true;
+
+	int M = (N < 150 ? N : 150);
+	int nrestart = M;
+	if (m_nrestart > 0) nrestart = m_nrestart;
+	else if (m_maxiter > 0) nrestart = m_maxiter;
+	if (nrestart > N) nrestart = N;
+
+	int maxIter = M;
+	if (m_maxiter > 0) maxIter = m_maxiter;
+
+	if (m_tmp.size() < (size_t)N*(2 * nrestart + 1)) m_tmp.resize((size_t)N*(2 * nrestart + 1));
+	if ((int)m_Rv.size() < N) m_Rv.resize(N);
+	if ((int)m_W.size() < N) m_W.resize(N, 1.0);
+
+	// Krylov vectors V[0..m] and preconditioned vectors Z[0..m-1]
+	vector<double*> V(nrestart + 1), Z(nrestart);
+	for (int i = 0; i <= nrestart; ++i) V[i] = &m_tmp[(size_t)i*N];
+	for (int i = 0; i < nrestart; ++i) Z[i] = (m_P ? &m_tmp[(size_t)(nrestart + 1 + i)*N] : V[i]);
+
+	// Hessenberg matrix (column major), Givens rotations, and rhs of least squares problem
+	vector<double> H((size_t)(nrestart + 1)*nrestart, 0.0);
+	vector<double> cs(nrestart), sn(nrestart), g(nrestart + 1), y(nrestart), h2(nrestart + 1);
+
+	// scale rhs
+	vector<double> F(N), r(N);
+	for (int i = 0; i < N; ++i) F[i] = m_W[i] * b[i];
+
+	// zero solution vector
+	for (int i = 0; i < N; ++i) x[i] = 0.0;
+
+	// initial residual
+	double beta = sqrt(NumCore::norm2(N, &F[0]));
+	double reltol = (m_reltol > 0 ? m_reltol : 1e-6);
+	double tol = reltol*beta;
+	if (m_abstol > tol) tol = m_abstol;
+
+	if (m_print_level > 0) feLog("FGMRES:\n");
+
+	// applies the operator y = A*R*x
+	auto matvec = [=](double* xi, double* yi) {
+		if (m_R)
+		{
+			m_R->mult_vector(xi, &m_Rv[0]);
+			return m_pA->mult_vector(&m_Rv[0], yi);
+		}
+		else return m_pA->mult_vector(xi, yi);
+	};
+
+	bool bconverged = (beta == 0.0);
+	int iter = 0;
+	double rnorm = beta;
+	for (int i = 0; i < N; ++i) r[i] = F[i];
+	while (!bconverged && (iter < maxIter))
+	{
+		// v0 = r / |r|
+		double* v0 = V[0];
+		for (int i = 0; i < N; ++i) v0[i] = r[i] / beta;
+		for (int i = 0; i <= nrestart; ++i) g[i] = 0.0;
+		g[0] = beta;
+
+		bool bdone = false;
+		int k = 0;
+		for (int j = 0; j < nrestart; ++j)
+		{
+			// apply preconditioner
+			if (m_P)
+			{
+				if (m_P->mult_vector(V[j], Z[j]) == false) return false;
+			}
+
+			// w = A*z
+			double* w = V[j + 1];
+			if (matvec(Z[j], w) == false) return false;
+
+			// orthogonalize against previous vectors
+			double* hj = &H[(size_t)j*(nrestart + 1)];
+			if (m_orthog == 0)
+			{
+				// modified Gram-Schmidt
+				for (int i = 0; i <= j; ++i)
+				{
+					hj[i] = NumCore::dot(N, V[i], w);
+					NumCore::axpy(N, -hj[i], V[i], w);
+				}
+			}
+			else
+			{
+				// classical Gram-Schmidt, optionally with one reorthogonalization step
+				NumCore::multi_dot(N, j + 1, &V[0], w, hj);
+				NumCore::multi_axpy(N, j + 1, &V[0], hj, w);
+				if (m_orthog == 2)
+				{
+					NumCore::multi_dot(N, j + 1, &V[0], w, &h2[0]);
+					NumCore::multi_axpy(N, j + 1, &V[0], &h2[0], w);
+					for (int i = 0; i <= j; ++i) hj[i] += h2[i];
+				}
+			}
+
+			double hn = sqrt(NumCore::norm2(N, w));
+			hj[j + 1] = hn;
+			if (hn != 0.0) NumCore::scale_norm2(N, 1.0 / hn, w);
+
+			// apply previous Givens rotations to new column
+			for (int i = 0; i < j; ++i)
+			{
+				double t = cs[i] * hj[i] + sn[i] * hj[i + 1];
+				hj[i + 1] = -sn[i] * hj[i] + cs[i] * hj[i + 1];
+				hj[i] = t;
+			}
+
+			// calculate new rotation
+			double d = sqrt(hj[j] * hj[j] + hj[j + 1] * hj[j + 1]);
+			if (d == 0.0) { cs[j] = 1.0; sn[j] = 0.0; }
+			else { cs[j] = hj[j] / d; sn[j] = hj[j + 1] / d; }
+			hj[j] = d;
+			hj[j + 1] = 0.0;
+			g[j + 1] = -sn[j] * g[j];
+			g[j] = cs[j] * g[j];
+
+			rnorm = fabs(g[j + 1]);
+			iter++;
+			k = j + 1;
+
+			if (m_print_level > 1)
+			{
+				feLog("%3d = %lg (%lg)\n", iter, rnorm, tol);
+			}
+
+			if (m_doResidualTest && (rnorm <= tol)) { bconverged = true; bdone = true; }
+			if (m_doZeroNormTest && (hn == 0.0)) bdone = true;
+			if (iter >= maxIter) bdone = true;
+			if (bdone) break;
+		}
+
+		// solve the upper triangular system H*y = g
+		for (int i = k - 1; i >= 0; --i)
+		{
+			double s = g[i];
+			for (int l = i + 1; l < k; ++l) s -= H[(size_t)l*(nrestart + 1) + i] * y[l];
+			double hii = H[(size_t)i*(nrestart + 1) + i];
+			y[i] = (hii != 0.0 ? s / hii : 0.0);
+		}
+
+		// update the solution, x += Z*y
+		for (int i = 0; i < k; ++i) y[i] = -y[i];
+		NumCore::multi_axpy(N, k, &Z[0], &y[0], x);
+
+		if (bconverged || (iter >= maxIter) || bdone) break;
+
+		// calculate the true residual for the restart
+		if (matvec(x, &r[0]) == false) return false;
+		for (int i = 0; i < N; ++i) r[i] = F[i] - r[i];
+		beta = sqrt(NumCore::norm2(N, &r[0]));
+		rnorm = beta;
+		if (m_doResidualTest && (beta <= tol)) bconverged = true;
+	}
+
+	// without the residual test, we're done when the iterations are exhausted
+	if (m_doResidualTest == false) bconverged = true;
+
+	if (m_do_jacobi)
+	{
+		for (int i = 0; i < N; ++i) x[i] *= m_W[i];
+	}
+
+	if (m_R)
+	{
+		m_R->mult_vector(&x[0], &m_Rv[0]);
+		for (int i = 0; i < N; ++i) x[i] = m_Rv[i];
+	}
+
+	if (m_print_level > 0)
+	{
+		feLog("%3d = %lg (%lg)\n", iter, rnorm, tol);
+	}
+
+	// update stats
+	UpdateStats(iter);
+
+	return (bconverged || !m_maxIterFail);
+}
+
 //! convenience function for solving linear system Ax = b
 bool FGMRESSolver::Solve(SparseMatrix* A, vector<double>& x, vector<double>& b)
 {
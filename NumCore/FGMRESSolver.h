@@ -29,7 +29,8 @@ SOFTWARE.*/
 
 //-----------------------------------------------------------------------------
 //! This class implements an interface to the MKL FGMRES iterative solver for 
-//! nonsymmetric indefinite matrices (without pre-conditioning).
+//! nonsymmetric indefinite matrices. When MKL is not available, a native 
+//! implementation of the flexible, restarted GMRES(m) method is used instead.
 class FGMRESSolver : public IterativeLinearSolver
 {
 public:
@@ -93,6 +94,9 @@ public:
 	// do jacobi preconditioning
 	void DoJacobiPreconditioning(bool b);
 
+	// set the orthogonalization method (only used by native implementation)
+	void SetOrthogonalization(int n);
+
 public:
 	// set the preconditioner
 	void SetLeftPreconditioner(LinearSolver* P) override;
@@ -105,6 +109,10 @@ public:
 protected:
 	SparseMatrix* GetSparseMatrix() { return m_pA; }
 
+private:
+	// native FGMRES implementation
+	bool SolveFGMRES(double* x, const double* b);
+
 private:
 	int		m_maxiter;			// max nr of iterations
 	int		m_nrestart;			// max nr of non-restarted iterations
@@ -116,6 +124,7 @@ private:
 	bool	m_maxIterFail;
 	bool	m_print_cn;			// Calculate and print the condition number
 	bool	m_do_jacobi;
+	int		m_orthog;			// orthogonalization method (0 = modified GS, 1 = classical GS, 2 = classical GS with reorthogonalization)
 
 private:
 	SparseMatrix*	m_pA;		//!< the sparse matrix format
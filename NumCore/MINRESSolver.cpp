@@ -0,0 +1,222 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+#include "stdafx.h"
+#include "MINRESSolver.h"
+#include "VectorKernels.h"
+#include <FECore/log.h>
+#include <math.h>
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+BEGIN_FECORE_CLASS(MINRESSolver, IterativeLinearSolver)
+	ADD_PARAMETER(m_print_level, "print_level");
+	ADD_PARAMETER(m_tol, "tol");
+	ADD_PARAMETER(m_maxiter, "max_iter");
+	ADD_PARAMETER(m_fail_max_iters, "fail_max_iters");
+	ADD_PROPERTY(m_P, "pc_left")->SetFlags(FEProperty::Optional);
+END_FECORE_CLASS();
+
+//-----------------------------------------------------------------------------
+MINRESSolver::MINRESSolver(FEModel* fem) : IterativeLinearSolver(fem), m_pA(0), m_P(0)
+{
+	m_maxiter = 0;
+	m_tol = 1e-5;
+	m_print_level = 0;
+	m_fail_max_iters = true;
+}
+
+//-----------------------------------------------------------------------------
+SparseMatrix* MINRESSolver::CreateSparseMatrix(Matrix_Type ntype)
+{
+	if (ntype != REAL_SYMMETRIC) return nullptr;
+
+	// let the preconditioner decide
+	m_pA = nullptr;
+	if (m_P)
+	{
+		m_P->SetPartitions(m_part);
+		m_pA = m_P->CreateSparseMatrix(ntype);
+	}
+	if (m_pA == nullptr) m_pA = new CompactSymmMatrix(1);
+	return m_pA;
+}
+
+//-----------------------------------------------------------------------------
+bool MINRESSolver::SetSparseMatrix(SparseMatrix* A)
+{
+	m_pA = A;
+	return (m_pA != 0);
+}
+
+//-----------------------------------------------------------------------------
+void MINRESSolver::SetLeftPreconditioner(LinearSolver* P)
+{
+	m_P = dynamic_cast<Preconditioner*>(P);
+}
+
+//-----------------------------------------------------------------------------
+LinearSolver* MINRESSolver::GetLeftPreconditioner()
+{
+	return m_P;
+}
+
+//-----------------------------------------------------------------------------
+bool MINRESSolver::HasPreconditioner() const
+{
+	return (m_P != nullptr);
+}
+
+//-----------------------------------------------------------------------------
+bool MINRESSolver::PreProcess()
+{
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+bool MINRESSolver::Factor()
+{
+	if (m_pA == 0) return false;
+	if (m_P)
+	{
+		if (m_P->PreProcess() == false) return false;
+		if (m_P->Factor() == false) return false;
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// This implements the preconditioned MINRES algorithm of Paige and Saunders. 
+// The residual norm that is monitored is the preconditioned residual norm.
+bool MINRESSolver::BackSolve(double* x, double* b)
+{
+	if (m_pA == nullptr) return false;
+
+	SparseMatrix& A = *m_pA;
+	int n = A.Rows();
+
+	// assume initial guess is zero
+	for (int i = 0; i < n; ++i) x[i] = 0.0;
+
+	// r1 = b, y = P^-1*r1
+	std::vector<double> r1(b, b + n), r2(b, b + n), y(n), v(n), w(n, 0.0), w1(n, 0.0), w2(n, 0.0);
+	if (m_P) { if (m_P->mult_vector(&r1[0], &y[0]) == false) return false; }
+	else y = r1;
+
+	double beta1 = NumCore::dot(n, &r1[0], &y[0]);
+	if (beta1 < 0.0) return false;	// preconditioner is not positive definite
+	beta1 = sqrt(beta1);
+	if (beta1 == 0.0) return true;
+
+	double tol = m_tol*beta1;
+
+	int max_iter = m_maxiter;
+	if (max_iter == 0) max_iter = (n < 150 ? n : 150);
+
+	double oldb = 0.0, beta = beta1, dbar = 0.0, epsln = 0.0, phibar = beta1;
+	double cs = -1.0, sn = 0.0;
+	double rnorm = beta1;
+
+	int iter = 0;
+	bool converged = false;
+	while (iter < max_iter)
+	{
+		// v = y / beta
+		double s = 1.0 / beta;
+		for (int i = 0; i < n; ++i) v[i] = s*y[i];
+
+		// y = A*v - (beta/oldb)*r1
+		if (A.mult_vector(&v[0], &y[0]) == false) return false;
+		if (iter > 0) NumCore::axpy(n, -beta / oldb, &r1[0], &y[0]);
+
+		// y = y - (alpha/beta)*r2
+		double alfa = NumCore::dot(n, &v[0], &y[0]);
+		NumCore::axpy(n, -alfa / beta, &r2[0], &y[0]);
+
+		r1.swap(r2);
+		r2 = y;
+
+		// y = P^-1*r2
+		if (m_P) { if (m_P->mult_vector(&r2[0], &y[0]) == false) return false; }
+
+		oldb = beta;
+		beta = NumCore::dot(n, &r2[0], &y[0]);
+		if (beta < 0.0) return false;	// preconditioner is not positive definite
+		beta = sqrt(beta);
+
+		// apply previous rotation
+		double oldeps = epsln;
+		double delta = cs*dbar + sn*alfa;
+		double gbar = sn*dbar - cs*alfa;
+		epsln = sn*beta;
+		dbar = -cs*beta;
+
+		// compute the next plane rotation
+		double gamma = sqrt(gbar*gbar + beta*beta);
+		if (gamma == 0.0) gamma = 1e-300;
+		cs = gbar / gamma;
+		sn = beta / gamma;
+		double phi = cs*phibar;
+		phibar = sn*phibar;
+
+		// update w and x in a single pass
+		double denom = 1.0 / gamma;
+		w1.swap(w2);
+		w2.swap(w);
+#pragma omp parallel for schedule(static)
+		for (int i = 0; i < n; ++i)
+		{
+			w[i] = (v[i] - oldeps*w1[i] - delta*w2[i])*denom;
+			x[i] += phi*w[i];
+		}
+
+		rnorm = phibar;
+		iter++;
+
+		if (m_print_level > 1)
+		{
+			feLog("%d:%lg, %lg\n", iter, rnorm, tol);
+		}
+
+		if (rnorm <= tol) { converged = true; break; }
+		if (beta == 0.0) { converged = true; break; }
+	}
+
+	if (m_print_level == 1)
+	{
+		feLog("%d:%lg, %lg\n", iter, rnorm, beta1);
+	}
+
+	UpdateStats(iter);
+
+	return (m_fail_max_iters ? converged : true);
+}
+
+//-----------------------------------------------------------------------------
+void MINRESSolver::Destroy()
+{
+}
@@ -37,9 +37,11 @@ SOFTWARE.*/
 #include "Hypre_PCG_AMG.h"
 #include "SchurSolver.h"
 #include "IncompleteCholesky.h"
+#include "AMGPreconditioner.h"
 #include "BoomerAMGSolver.h"
 #include "BlockSolver.h"
 #include "BiCGStabSolver.h"
+#include "MINRESSolver.h"
 #include "StrategySolver.h"
 #include <FECore/fecore_enum.h>
 #include <FECore/FECoreFactory.h>
@@ -68,6 +70,7 @@ NUMCORE_API void NumCore::InitModule()
 	REGISTER_FECORE_CLASS(BlockIterativeSolver, "block");
 	REGISTER_FECORE_CLASS(BIPNSolver          , "bipn");
 	REGISTER_FECORE_CLASS(BiCGStabSolver      , "bicgstab");
+	REGISTER_FECORE_CLASS(MINRESSolver        , "minres");
 	REGISTER_FECORE_CLASS(StrategySolver      , "strategy");
 	REGISTER_FECORE_CLASS(TestSolver          , "test");
     REGISTER_FECORE_CLASS(AccelerateSparseSolver, "accelerate");
@@ -78,6 +81,7 @@ NUMCORE_API void NumCore::InitModule()
 	REGISTER_FECORE_CLASS(ILU0_Preconditioner, "ilu0");
 	REGISTER_FECORE_CLASS(ILUT_Preconditioner, "ilut");
 	REGISTER_FECORE_CLASS(IncompleteCholesky , "ichol");
+	REGISTER_FECORE_CLASS(AMGPreconditioner  , "amg");
 
 	// register eigen solvers
 	REGISTER_FECORE_CLASS(FEASTEigenSolver, "feast");
@@ -29,6 +29,9 @@ SOFTWARE.*/
 #include "stdafx.h"
 #include "RCICGSolver.h"
 #include "IncompleteCholesky.h"
+#include "VectorKernels.h"
+#include <FECore/log.h>
+#include <math.h>
 
 //-----------------------------------------------------------------------------
 // We must undef PARDISO since it is defined as a function in mkl_solver.h
@@ -62,14 +65,10 @@ RCICGSolver::RCICGSolver(FEModel* fem) : IterativeLinearSolver(fem), m_pA(0), m_
 //-----------------------------------------------------------------------------
 SparseMatrix* RCICGSolver::CreateSparseMatrix(Matrix_Type ntype)
 {
-#ifdef MKL_ISS
 	if (ntype != REAL_SYMMETRIC) return 0;
 	m_pA = new CompactSymmMatrix(1);
 	if (m_P) m_P->SetSparseMatrix(m_pA);
 	return m_pA;
-#else
-	return 0;
-#endif
 }
 
 //-----------------------------------------------------------------------------
@@ -209,10 +208,85 @@ bool RCICGSolver::BackSolve(double* x, double* b)
 
 	return (m_fail_max_iters ? bsuccess : true);
 #else
-	return false;
+	// make sure we have a matrix
+	if (m_pA == 0) return false;
+
+	return SolvePCG(x, b);
 #endif // MKL_ISS
 }
 
+//-----------------------------------------------------------------------------
+// Native implementation of the preconditioned conjugate gradient method
+bool RCICGSolver::SolvePCG(double* x, const double* b)
+{
+	int n = m_pA->Rows();
+
+	// zero solution vector
+	for (int i = 0; i < n; ++i) x[i] = 0.0;
+
+	// initial residual
+	vector<double> r(b, b + n), z(n), p(n), q(n);
+	double rr = NumCore::norm2(n, &r[0]);
+	double norm0 = sqrt(rr);
+	if (norm0 == 0.0) return true;
+
+	double tol = m_tol*norm0;
+
+	int maxiter = m_maxiter;
+	if (maxiter <= 0) maxiter = (n < 150 ? n : 150);
+
+	// z = P^-1 r
+	if (m_P) { if (m_P->mult_vector(&r[0], &z[0]) == false) return false; }
+	else z = r;
+	p = z;
+	double rz = NumCore::dot(n, &r[0], &z[0]);
+
+	bool bconverged = false;
+	int niter = 0;
+	double normi = norm0;
+	while (niter < maxiter)
+	{
+		// q = A*p
+		if (m_pA->mult_vector(&p[0], &q[0]) == false) return false;
+
+		double pq = NumCore::dot(n, &p[0], &q[0]);
+		if (pq == 0.0) break;
+		double alpha = rz / pq;
+
+		// x += alpha*p, r -= alpha*q
+		rr = NumCore::cg_update(n, alpha, &p[0], &q[0], x, &r[0]);
+		normi = sqrt(rr);
+		niter++;
+
+		if (m_print_level > 1)
+		{
+			feLog("%3d = %lg (%lg)\n", niter, normi, tol);
+		}
+
+		if (normi <= tol) { bconverged = true; break; }
+
+		// z = P^-1 r
+		if (m_P) { if (m_P->mult_vector(&r[0], &z[0]) == false) return false; }
+		else z = r;
+
+		double rz_new = NumCore::dot(n, &r[0], &z[0]);
+		double beta = rz_new / rz;
+		rz = rz_new;
+
+		// p = z + beta*p
+		NumCore::xpby(n, &z[0], beta, &p[0]);
+	}
+
+	if (m_print_level > 0)
+	{
+		feLog("%3d = %lg (%lg)\n", niter, normi, norm0);
+	}
+
+	UpdateStats(niter);
+
+	return (m_fail_max_iters ? bconverged : true);
+}
+
 //-----------------------------------------------------------------------------
 void RCICGSolver::Destroy()
 {
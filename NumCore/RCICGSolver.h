@@ -28,6 +28,7 @@ SOFTWARE.*/
 #include <FECore/CompactSymmMatrix.h>
 
 // This class implements an interface to the RCI CG iterative solver from the MKL math library.
+// When MKL is not available, a native implementation of the preconditioned CG method is used.
 class RCICGSolver : public IterativeLinearSolver
 {
 public:
@@ -51,6 +52,10 @@ public:
 	void SetTolerance(double tol) { m_tol = tol; }
 	void SetPrintLevel(int n) override { m_print_level = n; }
 
+private:
+	// native preconditioned CG implementation
+	bool SolvePCG(double* x, const double* b);
+
 protected:
 	SparseMatrix*		m_pA;
 	Preconditioner*		m_P;
@@ -0,0 +1,127 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+
+
+
+#include "stdafx.h"
+#include "VectorKernels.h"
+#include <vector>
+
+//-----------------------------------------------------------------------------
+double NumCore::dot(int n, const double* x, const double* y)
+{
+	double s = 0.0;
+#pragma omp parallel for reduction(+:s) schedule(static)
+	for (int i = 0; i < n; ++i) s += x[i] * y[i];
+	return s;
+}
+
+//-----------------------------------------------------------------------------
+double NumCore::norm2(int n, const double* x)
+{
+	double s = 0.0;
+#pragma omp parallel for reduction(+:s) schedule(static)
+	for (int i = 0; i < n; ++i) s += x[i] * x[i];
+	return s;
+}
+
+//-----------------------------------------------------------------------------
+void NumCore::axpy(int n, double a, const double* x, double* y)
+{
+#pragma omp parallel for schedule(static)
+	for (int i = 0; i < n; ++i) y[i] += a*x[i];
+}
+
+//-----------------------------------------------------------------------------
+void NumCore::xpby(int n, const double* x, double b, double* y)
+{
+#pragma omp parallel for schedule(static)
+	for (int i = 0; i < n; ++i) y[i] = x[i] + b*y[i];
+}
+
+//-----------------------------------------------------------------------------
+double NumCore::cg_update(int n, double a, const double* p, const double* q, double* x, double* r)
+{
+	double s = 0.0;
+#pragma omp parallel for reduction(+:s) schedule(static)
+	for (int i = 0; i < n; ++i)
+	{
+		x[i] += a*p[i];
+		r[i] -= a*q[i];
+		s += r[i] * r[i];
+	}
+	return s;
+}
+
+//-----------------------------------------------------------------------------
+void NumCore::multi_dot(int n, int m, const double* const* V, const double* w, double* h)
+{
+	for (int j = 0; j < m; ++j) h[j] = 0.0;
+	if (m == 0) return;
+
+#pragma omp parallel
+	{
+		// each thread accumulates into its own array
+		std::vector<double> hl(m, 0.0);
+#pragma omp for schedule(static) nowait
+		for (int i = 0; i < n; ++i)
+		{
+			double wi = w[i];
+			for (int j = 0; j < m; ++j) hl[j] += V[j][i] * wi;
+		}
+
+#pragma omp critical
+		for (int j = 0; j < m; ++j) h[j] += hl[j];
+	}
+}
+
+//-----------------------------------------------------------------------------
+void NumCore::multi_axpy(int n, int m, const double* const* V, const double* h, double* w)
+{
+	if (m == 0) return;
+#pragma omp parallel for schedule(static)
+	for (int i = 0; i < n; ++i)
+	{
+		double s = 0.0;
+		for (int j = 0; j < m; ++j) s += h[j] * V[j][i];
+		w[i] -= s;
+	}
+}
+
+//-----------------------------------------------------------------------------
+double NumCore::scale_norm2(int n, double s, double* w)
+{
+	double r = 0.0;
+#pragma omp parallel for reduction(+:r) schedule(static)
+	for (int i = 0; i < n; ++i)
+	{
+		w[i] *= s;
+		r += w[i] * w[i];
+	}
+	return r;
+}
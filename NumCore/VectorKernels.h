@@ -0,0 +1,62 @@
+/*This file is part of the FEBio source code and is licensed under the MIT license
+listed below.
+
+See Copyright-FEBio.txt for details.
+
+Copyright (c) 2021 University of Utah, The Trustees of Columbia University in
+the City of New York, and others.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.*/
+
+
+
+
+
+#pragma once
+
+//-----------------------------------------------------------------------------
+// OpenMP parallel vector kernels used by the native iterative solvers.
+// Where possible, several vector operations are fused into a single pass
+// over the data to reduce memory traffic.
+namespace NumCore
+{
+	// return x.y
+	double dot(int n, const double* x, const double* y);
+
+	// return x.x
+	double norm2(int n, const double* x);
+
+	// y += a*x
+	void axpy(int n, double a, const double* x, double* y);
+
+	// y = x + b*y
+	void xpby(int n, const double* x, double b, double* y);
+
+	// x += a*p and r -= a*q, returns r.r
+	double cg_update(int n, double a, const double* p, const double* q, double* x, double* r);
+
+	// h[j] = V[j].w, for j = 0..m-1 (single pass over w)
+	void multi_dot(int n, int m, const double* const* V, const double* w, double* h);
+
+	// w -= sum_j h[j]*V[j], for j = 0..m-1 (single pass over w)
+	void multi_axpy(int n, int m, const double* const* V, const double* h, double* w);
+
+	// w = s*w, returns the (new) w.w
+	double scale_norm2(int n, double s, double* w);
+}
@@ -28,6 +28,17 @@ SOFTWARE.*/
 #include <stdarg.h>
 #include <fstream>
 #include <sstream>
+#include <algorithm>
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 using namespace std;
 
 //=============================================================================
@@ -574,6 +585,10 @@ XMLReader::XMLReader()
 	m_eof = false;
 	m_currentPos = 0;
 	m_buf = new char[BUF_SIZE];
+	m_map = nullptr;
+	m_mapSize = 0;
+	m_hfile = nullptr;
+	m_hmap = nullptr;
 }
 
 //-----------------------------------------------------------------------------
@@ -598,6 +613,8 @@ void XMLReader::Close()
         m_stream = nullptr;
     }
 
+	UnmapFile();
+
 	m_nline = 0;
 	m_bufIndex = 0;
 	m_bufSize = 0;
@@ -609,7 +626,24 @@ void XMLReader::Close()
 bool XMLReader::Open(const char* szfile, bool checkForXMLTag)
 {
 	// make sure this reader has not been attached to a file yet
-    if(m_stream) return false;
+    if(m_stream || m_map) return false;
+
+	// Try to map the file into memory first. This avoids copying the file through 
+	// the stream buffer and allows large sections to be processed in bulk.
+	if (MapFile(szfile))
+	{
+		if (checkForXMLTag)
+		{
+			if ((m_mapSize < 5) || (strncmp(m_map, "<?xml", 5) != 0))
+			{
+				// This file is not an XML file
+				UnmapFile();
+				return false;
+			}
+		}
+		m_currentPos = 0;
+		return true;
+	}
 
 	// open the file
     m_stream = new ifstream;
@@ -641,7 +675,7 @@ bool XMLReader::Open(const char* szfile, bool checkForXMLTag)
 bool XMLReader::OpenString(std::string& xml, bool checkForXMLTag)
 {
     // make sure this we don't already have a stream
-    if(m_stream) return false;
+    if(m_stream || m_map) return false;
 
     // create string stream
     m_stream = new std::istringstream(xml);
@@ -782,7 +816,7 @@ private:
 bool XMLReader::FindTag(const char* xpath, XMLTag& tag)
 {
 	// go to the beginning of the file
-    m_stream->seekg(0, ios_base::beg);
+    if (m_stream) m_stream->seekg(0, ios_base::beg);
 	m_bufIndex = m_bufSize = 0;
 	m_currentPos = 0;
 	m_eof = false;
@@ -836,7 +870,11 @@ void XMLReader::NextTag(XMLTag& tag)
 	m_nline = tag.m_ncurrent_line;
 
 	// set the current file position
-	if (m_currentPos != tag.m_fpos)
+	if (m_map)
+	{
+		m_currentPos = tag.m_fpos;
+	}
+	else if (m_currentPos != tag.m_fpos)
 	{
         m_stream->seekg(tag.m_fpos, ios_base::beg);
 		m_currentPos = tag.m_fpos;
@@ -1055,6 +1093,14 @@ void XMLReader::ReadEndTag(XMLTag& tag)
 //-----------------------------------------------------------------------------
 char XMLReader::readNextChar()
 {
+	if (m_map)
+	{
+		if (m_currentPos >= m_mapSize) throw UnexpectedEOF();
+		char ch = m_map[m_currentPos++];
+		if (ch == '\n') m_nline++;
+		return ch;
+	}
+
 	if (m_bufIndex >= m_bufSize)
 	{
 		if (m_eof) 
@@ -1089,6 +1135,12 @@ int64_t XMLReader::currentPos()
 void XMLReader::rewind(int64_t nstep)
 {
 	// NOTE: What if we rewind past a newline? Won't that mess up the line index?
+	if (m_map)
+	{
+		m_currentPos -= nstep;
+		return;
+	}
+
 	m_bufIndex -= nstep;
 	m_currentPos -= nstep;
 
@@ -1219,6 +1271,134 @@ char XMLReader::GetNextChar()
 	return ch;
 }
 
+//-----------------------------------------------------------------------------
+bool XMLReader::MapFile(const char* szfile)
+{
+#ifdef WIN32
+	HANDLE hfile = CreateFileA(szfile, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (hfile == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(hfile, &size) || (size.QuadPart == 0)) { CloseHandle(hfile); return false; }
+
+	HANDLE hmap = CreateFileMappingA(hfile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (hmap == NULL) { CloseHandle(hfile); return false; }
+
+	void* p = MapViewOfFile(hmap, FILE_MAP_READ, 0, 0, 0);
+	if (p == NULL) { CloseHandle(hmap); CloseHandle(hfile); return false; }
+
+	m_hfile = hfile;
+	m_hmap = hmap;
+	m_map = (const char*)p;
+	m_mapSize = (int64_t)size.QuadPart;
+#else
+	int fd = open(szfile, O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat st;
+	if ((fstat(fd, &st) != 0) || (st.st_size == 0) || !S_ISREG(st.st_mode)) { close(fd); return false; }
+
+	void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED) return false;
+
+	// we mostly read the file front to back
+	madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+	m_map = (const char*)p;
+	m_mapSize = (int64_t)st.st_size;
+#endif
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+void XMLReader::UnmapFile()
+{
+	if (m_map == nullptr) return;
+#ifdef WIN32
+	UnmapViewOfFile(m_map);
+	CloseHandle((HANDLE)m_hmap);
+	CloseHandle((HANDLE)m_hfile);
+	m_hmap = m_hfile = nullptr;
+#else
+	munmap((void*)m_map, (size_t)m_mapSize);
+#endif
+	m_map = nullptr;
+	m_mapSize = 0;
+}
+
+//-----------------------------------------------------------------------------
+bool XMLReader::IsMapped() const
+{
+	return (m_map != nullptr);
+}
+
+//-----------------------------------------------------------------------------
+// Note that the tag's children should not contain tags with the same name as the tag.
+bool XMLReader::GetRawContent(const XMLTag& tag, const char*& szbeg, const char*& szend)
+{
+	if ((m_map == nullptr) || tag.isend() || tag.isempty() || tag.isleaf()) return false;
+	if ((tag.m_fpos < 0) || (tag.m_fpos > m_mapSize)) return false;
+
+	// for non-leaf tags, the file position points to the first child
+	const char* sz = m_map + tag.m_fpos;
+	const char* szeof = m_map + m_mapSize;
+
+	const char* szname = tag.m_sztag.c_str();
+	size_t l = tag.m_sztag.size();
+
+	// find the end tag
+	const char* ch = sz;
+	while (ch < szeof)
+	{
+		ch = (const char*)memchr(ch, '<', szeof - ch);
+		if (ch == nullptr) return false;
+		if ((szeof - ch > (int64_t)l + 2) && (ch[1] == '/') && (strncmp(ch + 2, szname, l) == 0))
+		{
+			char c = ch[l + 2];
+			if ((c == '>') || isspace(c))
+			{
+				szbeg = sz;
+				szend = ch;
+				return true;
+			}
+		}
+		ch++;
+	}
+
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+void XMLReader::SkipRawContent(XMLTag& tag, const char* szend)
+{
+	assert(m_map && (szend > m_map) && (szend < m_map + m_mapSize));
+
+	// find the end of the end tag
+	const char* ch = (const char*)memchr(szend, '>', m_map + m_mapSize - szend);
+	if (ch == nullptr) throw UnexpectedEOF();
+
+	// update the line numbers
+	const char* sz = m_map + tag.m_fpos;
+	int nstart = tag.m_ncurrent_line + (int)std::count(sz, szend, '\n');
+	int nend = nstart + (int)std::count(szend, ch, '\n');
+
+	// set up the tag as if we just read the end tag
+	tag.m_path.push_back(tag.m_sztag);
+	std::string name = tag.m_sztag;
+	tag.clear();
+	tag.m_sztag = name;
+	tag.m_bend = true;
+	tag.m_nstart_line = nstart;
+	tag.m_ncurrent_line = nend;
+	tag.m_fpos = (ch - m_map) + 1;
+
+	m_comment.clear();
+	m_nline = nend;
+	m_currentPos = tag.m_fpos;
+}
+
+//-----------------------------------------------------------------------------
 ifstream* XMLReader::GetFileStream()
 {
     return dynamic_cast<ifstream*>(m_stream);
@@ -112,9 +112,9 @@ public:
 
 	void skip();
 
-	bool isend() { return m_bend; }
-	bool isleaf() { return m_bleaf; }
-	bool isempty() { return m_bempty; }
+	bool isend() const { return m_bend; }
+	bool isleaf() const { return m_bleaf; }
+	bool isempty() const { return m_bempty; }
 
 	// count the number of children
 	int children();
@@ -289,6 +289,18 @@ public:
 
 	const std::string& GetLastComment();
 
+	//! Returns true if the file is memory-mapped
+	bool IsMapped() const;
+
+	//! Get the raw content of a tag that has child tags, i.e. all the text between its start and
+	//! end tag. The tag must have just been read. The tag is not modified. Returns false if the
+	//! file is not memory-mapped or the end tag cannot be found.
+	bool GetRawContent(const XMLTag& tag, const char*& szbeg, const char*& szend);
+
+	//! Move the tag to its end tag, after the raw content was processed by the caller.
+	//! This is equivalent to reading all the child tags. 
+	void SkipRawContent(XMLTag& tag, const char* szend);
+
 protected: // helper functions
 
 	//! Get the next character in the file
@@ -312,6 +324,12 @@ protected: // helper functions
 	//! move the file pointer
     void rewind(int64_t nstep);
 
+	//! try to memory-map the file
+	bool MapFile(const char* szfile);
+
+	//! release the file mapping
+	void UnmapFile();
+
 	// only used for processing comments
 	char GetNextChar();
 	
@@ -326,6 +344,12 @@ protected:
 	char*		m_buf;
     int64_t    m_bufIndex, m_bufSize;
 	bool		m_eof;
+
+	// memory-mapped file
+	const char*	m_map;		//!< start of mapped file (or null if file is read through m_stream)
+	int64_t		m_mapSize;	//!< size of the mapped file
+	void*		m_hfile;	//!< file handle (Windows only)
+	void*		m_hmap;		//!< file mapping handle (Windows only)
 };
 
 //-----------------------------------------------------------------------------